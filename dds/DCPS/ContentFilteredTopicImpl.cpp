@@ -27,6 +27,7 @@ ContentFilteredTopicImpl::ContentFilteredTopicImpl(const char* name,
       participant)
   , filter_expression_(filter_expression)
   , filter_eval_(filter_expression, false /*allowOrderBy*/)
+  , parameters_generation_(0)
   , related_topic_(DDS::Topic::_duplicate(related_topic))
 {
   if (DCPS_debug_level > 5) {
@@ -96,6 +97,7 @@ ContentFilteredTopicImpl::set_expression_parameters(const DDS::StringSeq& p)
   }
 
   expression_parameters_ = p;
+  ++parameters_generation_;
 
   Readers readers_still_alive;
 
@@ -61,6 +61,33 @@ public:
     return filter_eval_.eval(s, expression_parameters_);
   }
 
+  /**
+   * Returns true if the serialized sample, which has all of its fields,
+   * matches the filter.  This lets a reader drop samples without
+   * deserializing them.  If header_read is true, serialized is past the
+   * encapsulation header and encoding is the one it gave.  Throws
+   * std::runtime_error if a field can't be read.
+   */
+  bool filter(ACE_Message_Block* serialized, Encoding encoding, bool header_read = false) const
+  {
+    ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, lock_, false);
+    TypeSupportImpl* const ts = dynamic_cast<TypeSupportImpl*>(type_support_.in());
+    if (!ts) {
+      return true;
+    }
+    return filter_eval_.eval(serialized, encoding, *ts, expression_parameters_, header_read);
+  }
+
+  /**
+   * Changes each time the expression parameters change, so that a result of
+   * filter() can be checked for still being valid later on.
+   */
+  ACE_UINT32 parameters_generation() const
+  {
+    ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, lock_, 0);
+    return parameters_generation_;
+  }
+
   void add_reader(DataReaderImpl& reader);
   void remove_reader(DataReaderImpl& reader);
 
@@ -73,11 +100,13 @@ private:
   OPENDDS_STRING filter_expression_;
   FilterEvaluator filter_eval_;
   DDS::StringSeq expression_parameters_;
+  ACE_UINT32 parameters_generation_;
   DDS::Topic_var related_topic_;
   typedef OPENDDS_VECTOR(WeakRcHandle<DataReaderImpl>) Readers;
   Readers readers_;
 
-  /// Concurrent access to expression_parameters_ and readers_
+  /// Concurrent access to expression_parameters_, parameters_generation_,
+  /// and readers_
   mutable ACE_Recursive_Thread_Mutex lock_;
 };
 
@@ -45,6 +45,7 @@
 #include <ace/Reactor.h>
 #include <ace/OS_NS_sys_time.h>
 
+#include <algorithm>
 #include <cstdio>
 #include <stdexcept>
 #ifndef OPENDDS_NO_OBJECT_MODEL_PROFILE
@@ -68,6 +69,10 @@ DataReaderImpl::DataReaderImpl()
   , topic_id_(GUID_UNKNOWN)
 #ifndef OPENDDS_NO_OWNERSHIP_KIND_EXCLUSIVE
   , is_exclusive_ownership_(false)
+#endif
+#ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
+  , early_filter_writer_(GUID_UNKNOWN)
+  , early_filter_generation_(0)
 #endif
   , coherent_(false)
   , subqos_(TheServiceParticipant->initial_SubscriberQos())
@@ -79,16 +84,37 @@ DataReaderImpl::DataReaderImpl()
   , last_deadline_missed_total_count_(0)
   , deadline_queue_enabled_(false)
   , deadline_task_(make_rch<DRISporadicTask>(TheServiceParticipant->time_source(), TheServiceParticipant->reactor_task(), rchandle_from(this), &DataReaderImpl::deadline_task))
+  , release_task_(make_rch<DRISporadicTask>(TheServiceParticipant->time_source(), TheServiceParticipant->reactor_task(), rchandle_from(this), &DataReaderImpl::release_task))
   , is_bit_(false)
   , always_get_history_(false)
+  , deliver_queued_event_(make_rch<DeliverQueuedEvent>(rchandle_from(this)))
+  , delivery_queue_max_(0)
+  , delivery_queue_space_(delivery_queue_lock_)
+  , delivering_queued_samples_(false)
+  , queue_when_busy_(false)
+  , deserialize_min_size_(0)
+  , listener_dispatch_(false)
+  , data_available_pending_(false)
+  , data_available_running_(false)
+  , data_available_again_(false)
+  , data_available_event_(make_rch<DataAvailableEvent>(rchandle_from(this)))
   , statistics_enabled_(false)
   , raw_latency_buffer_size_(0)
   , raw_latency_buffer_type_(DataCollector<double>::KeepOldest)
+#ifndef OPENDDS_NO_QUERY_CONDITION
+  , query_result_bits_(0)
+  , query_samples_(0)
+#endif
   , transport_disabled_(false)
   , mb_alloc_(DEFAULT_TRANSPORT_RECEIVE_BUFFERS)
 {
   reactor_ = TheServiceParticipant->timer();
 
+#ifndef OPENDDS_NO_QUERY_CONDITION
+  std::fill(query_evaluated_, query_evaluated_ + query_result_bit_count, 0);
+  std::fill(query_matched_, query_matched_ + query_result_bit_count, 0);
+#endif
+
   liveliness_changed_status_.alive_count = 0;
   liveliness_changed_status_.not_alive_count = 0;
   liveliness_changed_status_.alive_count_change = 0;
@@ -136,6 +162,7 @@ DataReaderImpl::~DataReaderImpl()
   DBG_ENTRY_LVL("DataReaderImpl", "~DataReaderImpl", 6);
 
   deadline_task_->cancel();
+  release_task_->cancel();
 
 #ifndef OPENDDS_SAFETY_PROFILE
   RcHandle<DomainParticipantImpl> participant = participant_servant_.lock();
@@ -203,6 +230,8 @@ void DataReaderImpl::init(
   is_bit_ = topicIsBIT(topic_name, topic_type_name);
 #endif // !defined (DDS_HAS_MINIMUM_BIT)
 
+  listener_dispatch_ = !is_bit_ && TheServiceParticipant->listener_threads();
+
   qos_ = qos;
   passed_qos_ = qos;
 
@@ -216,6 +245,14 @@ void DataReaderImpl::init(
   // parent, we will exist as long as it does
   participant_servant_ = *participant;
 
+  if (!is_bit_) {
+    deserialize_dispatcher_ = participant->deserialize_dispatcher();
+    delivery_dispatcher_ = participant->delivery_dispatcher();
+    queue_when_busy_ = TheServiceParticipant->queued_delivery();
+    delivery_queue_max_ = TheServiceParticipant->delivery_queue_max();
+    deserialize_min_size_ = TheServiceParticipant->deserialize_min_size();
+  }
+
   domain_id_ = participant->get_domain_id();
 
   subscriber_servant_ = rchandle_from(subscriber);
@@ -284,11 +321,11 @@ DataReaderImpl::add_association(const WriterAssociation& writer,
     }
 
     {
-      ACE_Guard<ACE_Recursive_Thread_Mutex> guard(statistics_lock_);
+      ACE_WRITE_GUARD(ACE_RW_Thread_Mutex, write_guard, statistics_lock_);
       statistics_.insert(
         StatsMapType::value_type(
           writer_id,
-          WriterStats(static_cast<int>(raw_latency_buffer_size_), raw_latency_buffer_type_)));
+          make_rch<WriterStats>(static_cast<int>(raw_latency_buffer_size_), raw_latency_buffer_type_)));
     }
 
     // If this is a durable reader
@@ -474,7 +511,7 @@ DataReaderImpl::remove_associations(const WriterIdSeq& writers,
       for (CORBA::ULong i = 0; i < wr_len; i++) {
         const GUID_t writer_id = writers[i];
         {
-          ACE_Guard<ACE_Recursive_Thread_Mutex> guard(statistics_lock_);
+          ACE_WRITE_GUARD(ACE_RW_Thread_Mutex, stats_guard, statistics_lock_);
           statistics_.erase(writer_id);
         }
       }
@@ -769,6 +806,18 @@ DDS::QueryCondition_ptr DataReaderImpl::create_querycondition(
     if (qc->set_query_parameters(query_parameters) != DDS::RETCODE_OK) {
       return 0;
     }
+    // Give it a free bit of the samples' query results, if any are left.
+    // The samples may still have results from the last QueryCondition
+    // that had it.  Without a filter every sample matches, so there's
+    // nothing to keep.
+    for (ACE_UINT32 bit = qc->hasFilter() ? 1 : 0; bit; bit <<= 1) {
+      if (!(query_result_bits_ & bit)) {
+        query_result_bits_ |= bit;
+        clear_query_results(bit);
+        dynamic_cast<QueryConditionImpl*>(qc.in())->result_bit(bit);
+        break;
+      }
+    }
     DDS::ReadCondition_var rc = DDS::ReadCondition::_duplicate(qc);
     read_conditions_.insert(rc);
     return qc._retn();
@@ -796,18 +845,97 @@ DDS::ReturnCode_t DataReaderImpl::delete_readcondition(
   ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, this->sample_lock_,
       DDS::RETCODE_OUT_OF_RESOURCES);
   DDS::ReadCondition_var rc = DDS::ReadCondition::_duplicate(a_condition);
-  return read_conditions_.erase(rc)
-      ? DDS::RETCODE_OK : DDS::RETCODE_PRECONDITION_NOT_MET;
+  if (!read_conditions_.erase(rc)) {
+    return DDS::RETCODE_PRECONDITION_NOT_MET;
+  }
+#ifndef OPENDDS_NO_QUERY_CONDITION
+  release_result_bit(rc);
+#endif
+  return DDS::RETCODE_OK;
 }
 
 DDS::ReturnCode_t DataReaderImpl::delete_contained_entities()
 {
   ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, this->sample_lock_,
       DDS::RETCODE_OUT_OF_RESOURCES);
+#ifndef OPENDDS_NO_QUERY_CONDITION
+  for (ReadConditionSet::iterator it = read_conditions_.begin(); it != read_conditions_.end(); ++it) {
+    release_result_bit(*it);
+  }
+#endif
   read_conditions_.clear();
   return DDS::RETCODE_OK;
 }
 
+#ifndef OPENDDS_NO_QUERY_CONDITION
+void DataReaderImpl::release_result_bit(DDS::ReadCondition_ptr condition)
+{
+  // The condition may still be used, for example by a WaitSet, so it stops
+  // using the bit before another QueryCondition can have it.
+  QueryConditionImpl* const query = dynamic_cast<QueryConditionImpl*>(condition);
+  if (query) {
+    query_result_bits_ &= ~query->result_bit();
+    query->result_bit(0);
+  }
+}
+
+namespace {
+  size_t result_bit_index(ACE_UINT32 bit)
+  {
+    size_t index = 0;
+    while (bit >>= 1) {
+      ++index;
+    }
+    return index;
+  }
+}
+
+void DataReaderImpl::query_sample_added()
+{
+  ++query_samples_;
+}
+
+void DataReaderImpl::query_sample_removed(ReceivedDataElement& item)
+{
+  --query_samples_;
+  if (item.query_evaluated_) {
+    for (size_t i = 0; i < query_result_bit_count; ++i) {
+      const ACE_UINT32 bit = ACE_UINT32(1) << i;
+      if (item.query_evaluated_ & bit) {
+        --query_evaluated_[i];
+        if (item.query_matched_ & bit) {
+          --query_matched_[i];
+        }
+      }
+    }
+    item.query_evaluated_ = 0;
+    item.query_matched_ = 0;
+  }
+}
+
+void DataReaderImpl::query_result(ACE_UINT32 bit, bool match)
+{
+  const size_t index = result_bit_index(bit);
+  ++query_evaluated_[index];
+  if (match) {
+    ++query_matched_[index];
+  }
+}
+
+void DataReaderImpl::reset_query_counts(ACE_UINT32 bit)
+{
+  const size_t index = result_bit_index(bit);
+  query_evaluated_[index] = 0;
+  query_matched_[index] = 0;
+}
+
+bool DataReaderImpl::query_may_match(ACE_UINT32 bit) const
+{
+  const size_t index = result_bit_index(bit);
+  return query_matched_[index] || query_evaluated_[index] < query_samples_;
+}
+#endif
+
 DDS::ReturnCode_t DataReaderImpl::set_qos(const DDS::DataReaderQos& qos)
 {
   OPENDDS_NO_OWNERSHIP_KIND_EXCLUSIVE_COMPATIBILITY_CHECK(qos, DDS::RETCODE_UNSUPPORTED);
@@ -1354,6 +1482,164 @@ DataReaderImpl::data_received(const ReceivedDataSample& sample)
     }
   }
 
+  DeserializeJob_rch job;
+  const DataSampleHeader& header = sample.header_;
+  if (deserialize_dispatcher_ && header.message_id_ == SAMPLE_DATA && header.valid_data() &&
+      !header.key_fields_only_ && sample.data_length() >= deserialize_min_size_) {
+    job = deserialize_job(sample, publication_handle);
+  }
+
+  if (delivery_dispatcher_) {
+    ACE_GUARD(ACE_Thread_Mutex, queue_guard, delivery_queue_lock_);
+    if (job || delivering_queued_samples_ || !delivery_queue_.empty() ||
+        (queue_when_busy_ && sample_lock_.tryacquire() == -1)) {
+      // Don't hold up the transport while the DataReader is busy or the
+      // sample is being deserialized.  Everything behind a queued sample is
+      // queued too so that the samples are stored in the order they were
+      // received.  The job isn't dispatched until its sample has a place
+      // in the queue, so the queue limit also bounds the deserialize jobs.
+      wait_for_delivery_queue_space();
+      delivery_queue_.push_back(QueuedSample(sample, publication_handle, job));
+      const bool deliver = !delivering_queued_samples_ && delivery_queue_.front().ready();
+      if (deliver) {
+        delivering_queued_samples_ = true;
+      }
+      queue_guard.release();
+
+      if (job && !deserialize_dispatcher_->dispatch(job)) {
+        // The participant is shutting down, deserialize it here.
+        deserialize_ahead(*job);
+        job->deserialized_ = true;
+        deserialize_job_ready(*job);
+      }
+      if (deliver && !delivery_dispatcher_->dispatch(deliver_queued_event_)) {
+        // The participant is shutting down, deliver here instead.
+        deliver_queued_samples();
+      }
+      return;
+    }
+    if (queue_when_busy_) {
+      // Not busy.  data_received_i() takes the lock itself since it may
+      // need to release it part way through.
+      sample_lock_.release();
+    }
+  }
+
+  data_received_i(sample, publication_handle);
+}
+
+void
+DataReaderImpl::deliver_queued_samples()
+{
+  for (;;) {
+    ACE_GUARD(ACE_Thread_Mutex, queue_guard, delivery_queue_lock_);
+    if (delivery_queue_.empty() || !delivery_queue_.front().ready()) {
+      // deserialize_job_ready() picks up from here once the front sample
+      // has been deserialized.
+      delivering_queued_samples_ = false;
+      return;
+    }
+    const QueuedSample queued = delivery_queue_.front();
+    delivery_queue_.pop_front();
+    if (delivery_queue_max_) {
+      delivery_queue_space_.notify_all();
+    }
+    queue_guard.release();
+
+    // delivering_queued_samples_ is still set so later samples wait in the
+    // queue until this one has been delivered.
+    DeserializeJob* const job = queued.job_ && queued.job_->deserialized_ ? queued.job_.in() : 0;
+    data_received_i(queued.sample_, queued.publication_handle_, job);
+  }
+}
+
+void
+DataReaderImpl::deserialize_job_ready(DeserializeJob& job)
+{
+  {
+    ACE_GUARD(ACE_Thread_Mutex, queue_guard, delivery_queue_lock_);
+    job.ready_ = true;
+    if (delivering_queued_samples_ || delivery_queue_.empty() || !delivery_queue_.front().ready()) {
+      return;
+    }
+    delivering_queued_samples_ = true;
+  }
+
+  // The sample is stored on the delivery thread, not this one, so that the
+  // DataReader's samples and listener calls are always on the same thread.
+  if (!delivery_dispatcher_->dispatch(deliver_queued_event_)) {
+    // The participant is shutting down and the DataReader with it.
+    clear_delivery_queue();
+  }
+}
+
+void
+DataReaderImpl::clear_delivery_queue()
+{
+  ACE_GUARD(ACE_Thread_Mutex, queue_guard, delivery_queue_lock_);
+  delivery_queue_.clear();
+  delivering_queued_samples_ = false;
+  delivery_queue_space_.notify_all();
+}
+
+void
+DataReaderImpl::wait_for_delivery_queue_space()
+{
+  if (!delivery_queue_max_ || delivery_dispatcher_->on_thread()) {
+    // The delivery thread itself can't wait for room, a listener it called
+    // is writing a sample that's delivered to this DataReader.
+    return;
+  }
+  ThreadStatusManager& thread_status_manager = TheServiceParticipant->get_thread_status_manager();
+  while (delivery_queue_.size() >= delivery_queue_max_) {
+    if (delivery_queue_space_.wait(thread_status_manager) == CvStatus_Error) {
+      return;
+    }
+  }
+}
+
+DataReaderImpl::DeserializeJob_rch
+DataReaderImpl::deserialize_job(const ReceivedDataSample&, DDS::InstanceHandle_t)
+{
+  return DeserializeJob_rch();
+}
+
+void
+DataReaderImpl::deserialize_ahead(DeserializeJob&)
+{
+}
+
+void
+DataReaderImpl::store_deserialized(DeserializeJob&, SubscriptionInstance_rch&, bool&, bool&)
+{
+}
+
+void
+DataReaderImpl::DeserializeJob::handle_event()
+{
+  RcHandle<DataReaderImpl> data_reader = data_reader_.lock();
+  if (data_reader) {
+    data_reader->deserialize_ahead(*this);
+    deserialized_ = true;
+    data_reader->deserialize_job_ready(*this);
+  }
+}
+
+void
+DataReaderImpl::DeserializeJob::handle_cancel()
+{
+  // Let data_received_i() deserialize it.
+  RcHandle<DataReaderImpl> data_reader = data_reader_.lock();
+  if (data_reader) {
+    data_reader->deserialize_job_ready(*this);
+  }
+}
+
+void
+DataReaderImpl::data_received_i(const ReceivedDataSample& sample,
+                                DDS::InstanceHandle_t publication_handle,
+                                DeserializeJob* job)
+{
   // ensure some other thread is not changing the sample container
   // or statuses related to samples.
   ACE_GUARD(ACE_Recursive_Thread_Mutex, guard, this->sample_lock_);
@@ -1397,8 +1683,12 @@ DataReaderImpl::data_received(const ReceivedDataSample& sample)
 
     bool is_new_instance = false;
     bool filtered = false;
-    dds_demarshal(sample, publication_handle, instance, is_new_instance, filtered,
-                  sample.header_.key_fields_only_ ? KEY_ONLY_MARSHALING : FULL_MARSHALING);
+    if (job) {
+      store_deserialized(*job, instance, is_new_instance, filtered);
+    } else {
+      dds_demarshal(sample, publication_handle, instance, is_new_instance, filtered,
+                    sample.header_.key_fields_only_ ? KEY_ONLY_MARSHALING : FULL_MARSHALING);
+    }
 
     // Per sample logging
     if (DCPS_debug_level >= 8) {
@@ -1772,6 +2062,21 @@ CORBA::Long DataReaderImpl::total_samples() const
   return count;
 }
 
+void DataReaderImpl::get_memory_estimate(MemoryEstimate& estimate) const
+{
+  ACE_GUARD(ACE_Recursive_Thread_Mutex, guard, sample_lock_);
+  ACE_GUARD(ACE_Recursive_Thread_Mutex, instance_guard, instances_lock_);
+
+  estimate.instances = instances_.size();
+  estimate.samples = 0;
+  for (SubscriptionInstanceMapType::const_iterator iter = instances_.begin();
+       iter != instances_.end(); ++iter) {
+    estimate.samples += iter->second->rcvd_samples_.size();
+  }
+  estimate.estimated_bytes = estimate.instances * (sizeof(SubscriptionInstance) + sizeof(InstanceState))
+    + estimate.samples * sample_footprint();
+}
+
 void
 DataReaderImpl::release_instance(DDS::InstanceHandle_t handle)
 {
@@ -1828,42 +2133,69 @@ DataReaderImpl::state_updated(DDS::InstanceHandle_t handle)
 }
 
 OpenDDS::DCPS::WriterStats::WriterStats(int amount, DataCollector<double>::OnFull type)
-  : stats_(static_cast<unsigned int>(amount), type)
+  : collect_raw_(amount > 0 || type == DataCollector<double>::Unbounded)
+  , raw_(static_cast<unsigned int>(amount), type)
 {
 }
 
 void OpenDDS::DCPS::WriterStats::add_stat(const TimeDuration& delay)
 {
-  double datum = static_cast<double>(delay.value().sec());
-  datum += delay.value().usec() / 1000000.0;
-  this->stats_.add(datum);
+  latency_.record(delay);
+
+  if (collect_raw_) {
+    double datum = static_cast<double>(delay.value().sec());
+    datum += delay.value().usec() / 1000000.0;
+    ACE_Guard<ACE_Thread_Mutex> guard(raw_lock_);
+    raw_.collect(datum);
+  }
+}
+
+void OpenDDS::DCPS::WriterStats::add_take_stat(const TimeDuration& delay)
+{
+  take_latency_.record(delay);
 }
 
 OpenDDS::DCPS::LatencyStatistics OpenDDS::DCPS::WriterStats::get_stats() const
 {
   LatencyStatistics value;
 
+  const LatencyHistogram::Summary summary = latency_.summarize();
   value.publication = GUID_UNKNOWN;
-  value.n           = this->stats_.n();
-  value.maximum     = this->stats_.maximum();
-  value.minimum     = this->stats_.minimum();
-  value.mean        = static_cast<double>(this->stats_.mean());
-  value.variance    = static_cast<double>(this->stats_.var());
+  value.n           = static_cast<CORBA::ULong>(summary.n);
+  value.maximum     = summary.maximum;
+  value.minimum     = summary.minimum;
+  value.mean        = summary.mean;
+  value.variance    = summary.variance;
+  value.p50         = summary.p50;
+  value.p99         = summary.p99;
+  value.p999        = summary.p999;
+
+  const LatencyHistogram::Summary take = take_latency_.summarize();
+  value.take_n        = static_cast<CORBA::ULong>(take.n);
+  value.take_maximum  = take.maximum;
+  value.take_minimum  = take.minimum;
+  value.take_mean     = take.mean;
+  value.take_variance = take.variance;
+  value.take_p50      = take.p50;
+  value.take_p99      = take.p99;
+  value.take_p999     = take.p999;
 
   return value;
 }
 
 void OpenDDS::DCPS::WriterStats::reset_stats()
 {
-  this->stats_.reset();
+  latency_.reset();
+  take_latency_.reset();
 }
 
 #ifndef OPENDDS_SAFETY_PROFILE
 std::ostream& OpenDDS::DCPS::WriterStats::raw_data(std::ostream& str) const
 {
-  str << std::dec << this->stats_.size()
-                              << " samples out of " << this->stats_.n() << std::endl;
-  return str << this->stats_;
+  ACE_Guard<ACE_Thread_Mutex> guard(raw_lock_);
+  str << std::dec << raw_.size()
+                              << " samples out of " << latency_.summarize().n << std::endl;
+  return str << raw_;
 }
 #endif //OPENDDS_SAFETY_PROFILE
 
@@ -2120,10 +2452,16 @@ void DataReaderImpl::dispose_unregister(const ReceivedDataSample&,
 
 void DataReaderImpl::process_latency(const ReceivedDataSample& sample)
 {
-  ACE_Guard<ACE_Recursive_Thread_Mutex> guard(statistics_lock_);
-  StatsMapType::iterator location = this->statistics_.find(sample.header_.publication_id_);
+  WriterStats_rch stats;
+  {
+    ACE_READ_GUARD(ACE_RW_Thread_Mutex, read_guard, statistics_lock_);
+    const StatsMapType::iterator location = statistics_.find(sample.header_.publication_id_);
+    if (location != statistics_.end()) {
+      stats = location->second;
+    }
+  }
 
-  if (location != this->statistics_.end()) {
+  if (stats) {
     const DDS::Duration_t zero = { DDS::DURATION_ZERO_SEC, DDS::DURATION_ZERO_NSEC };
 
     // Only when the user has specified a latency budget or statistics
@@ -2137,7 +2475,7 @@ void DataReaderImpl::process_latency(const ReceivedDataSample& sample)
       const TimeDuration latency = SystemTimePoint::now() - SystemTimePoint(timestamp);
 
       if (this->statistics_enabled()) {
-        location->second.add_stat(latency);
+        stats->add_stat(latency);
       }
 
       if (DCPS_debug_level > 9) {
@@ -2171,6 +2509,34 @@ void DataReaderImpl::process_latency(const ReceivedDataSample& sample)
   }
 }
 
+void DataReaderImpl::process_take_latency(const ReceivedDataElement& sample,
+                                          const SystemTimePoint& now)
+{
+  ACE_READ_GUARD(ACE_RW_Thread_Mutex, read_guard, statistics_lock_);
+  const StatsMapType::iterator location = statistics_.find(sample.pub_);
+  if (location != statistics_.end()) {
+    location->second->add_take_stat(now - SystemTimePoint(sample.destination_timestamp_));
+  }
+}
+
+bool DataReaderImpl::drop_undecodable(ReceivedDataElement* sample,
+                                      ReceivedDataElementList& samples)
+{
+  if (!samples.contains(sample)) {
+    return false;
+  }
+  if (log_level >= LogLevel::Warning) {
+    ACE_DEBUG((LM_WARNING,
+               "(%P|%t) WARNING: DataReaderImpl::drop_undecodable: "
+               "reader %C dropping sample from writer %C that could not be deserialized\n",
+               LogGuid(get_guid()).c_str(),
+               LogGuid(sample->pub_).c_str()));
+  }
+  samples.remove(sample);
+  sample->dec_ref();
+  return true;
+}
+
 void DataReaderImpl::notify_latency(GUID_t writer)
 {
   // Narrow to DDS::DCPS::DataReaderListener. If a DDS::DataReaderListener
@@ -2206,13 +2572,13 @@ void
 DataReaderImpl::get_latency_stats(
     OpenDDS::DCPS::LatencyStatisticsSeq & stats)
 {
-  ACE_Guard<ACE_Recursive_Thread_Mutex> guard(statistics_lock_);
+  ACE_READ_GUARD(ACE_RW_Thread_Mutex, read_guard, statistics_lock_);
   stats.length(static_cast<CORBA::ULong>(this->statistics_.size()));
   DDS::UInt32 index = 0;
   for (StatsMapType::const_iterator current = this->statistics_.begin();
       current != this->statistics_.end();
       ++current, ++index) {
-    stats[index] = current->second.get_stats();
+    stats[index] = current->second->get_stats();
     stats[index].publication = current->first;
   }
 }
@@ -2221,11 +2587,11 @@ DataReaderImpl::get_latency_stats(
 void
 DataReaderImpl::reset_latency_stats()
 {
-  ACE_Guard<ACE_Recursive_Thread_Mutex> guard(statistics_lock_);
+  ACE_READ_GUARD(ACE_RW_Thread_Mutex, read_guard, statistics_lock_);
   for (StatsMapType::iterator current = this->statistics_.begin();
       current != this->statistics_.end();
       ++current) {
-    current->second.reset_stats();
+    current->second->reset_stats();
   }
 }
 
@@ -2470,6 +2836,37 @@ DataReaderImpl::ownership_filter_instance(const SubscriptionInstance_rch& instan
 #ifndef OPENDDS_NO_OWNERSHIP_KIND_EXCLUSIVE
   if (this->is_exclusive_ownership_) {
 
+    // Most samples are from the owner or from a writer that was already
+    // evaluated and isn't the owner.  The instance state has the handle and
+    // strength of the owner in one atomic word, so these are decided without
+    // the ownership manager or exclusive access to the writers.  Any change
+    // of owner or strength goes through select_owner below, as does an
+    // instance without an owner, which doesn't need the writers at all here.
+    const ACE_UINT64 owner = instance->instance_state_->owner_word();
+    if (owner) {
+      ACE_READ_GUARD_RETURN(ACE_RW_Thread_Mutex, read_guard, writers_lock_, true);
+      const WriterMapType::iterator iter = writers_.find(pubid);
+      if (iter != writers_.end()) {
+        const ACE_UINT64 writer = InstanceState::make_owner_word(
+          iter->second->handle(), iter->second->writer_qos_ownership_strength());
+        if (writer == owner) {
+          return false;
+        }
+        if (InstanceState::owner_word_handle(writer) != InstanceState::owner_word_handle(owner)
+            && iter->second->is_owner_evaluated(instance->instance_handle_)) {
+          if (DCPS_debug_level >= 1) {
+            ACE_DEBUG((LM_DEBUG,
+                       ACE_TEXT("(%P|%t) DataReaderImpl::ownership_filter_instance: ")
+                       ACE_TEXT("reader %C writer %C is not owner %C\n"),
+                       LogGuid(get_guid()).c_str(),
+                       LogGuid(pubid).c_str(),
+                       LogGuid(instance->instance_state_->get_owner()).c_str()));
+          }
+          return true;
+        }
+      }
+    }
+
     ACE_WRITE_GUARD_RETURN(ACE_RW_Thread_Mutex, write_guard, writers_lock_, true);
     WriterMapType::iterator iter = writers_.find(pubid);
 
@@ -2498,7 +2895,8 @@ DataReaderImpl::ownership_filter_instance(const SubscriptionInstance_rch& instan
         instance->instance_handle_,
         iter->second->writer_id(),
         iter->second->writer_qos_ownership_strength(),
-        instance->instance_state_);
+        instance->instance_state_,
+        iter->second->handle());
       iter->second->set_owner_evaluated(instance->instance_handle_, true);
 
       if (! is_owner) {
@@ -2880,15 +3278,19 @@ DataReaderImpl::coherent_changes_completed(DataReaderImpl* reader)
 
     if (!CORBA::is_nil(listener.in()))
     {
-      if (!is_bit()) {
+      if (dispatch_data_available()) {
+        // Called on the participant's listener threads.
+      } else if (!is_bit()) {
         set_status_changed_flag(::DDS::DATA_AVAILABLE_STATUS, false);
         subscriber->set_status_changed_flag(::DDS::DATA_ON_READERS_STATUS, false);
         if (reader == this) {
           // Release the sample_lock before listener callback.
           ACE_GUARD(Reverse_Lock_t, unlock_guard, reverse_sample_lock_);
           listener->on_data_available(this);
+          data_available_called();
         } else {
           listener->on_data_available(this);
+          data_available_called();
         }
       } else {
         TheServiceParticipant->job_queue()->enqueue(make_rch<OnDataAvailable>(listener, rchandle_from(this), reader == this, true, true));
@@ -2934,15 +3336,14 @@ void DataReaderImpl::get_ordered_data(GroupRakeData& data,
 
   ACE_GUARD(ACE_Recursive_Thread_Mutex, guard, sample_lock_);
 
+  // The samples are read in this order until the end of the access, or until
+  // the order is requested again.
+  group_coherent_ordered_data_.reset();
   for (SubscriptionInstanceSet::iterator iter = localsubs.begin(); iter != localsubs.end(); ++iter) {
     const SubscriptionInstance_rch inst = *iter;
     if (inst->instance_state_->match(view_states, instance_states)) {
-      size_t i(0);
-      for (ReceivedDataElement* item = inst->rcvd_samples_.get_next_match(sample_states, 0);
-           item; item = inst->rcvd_samples_.get_next_match(sample_states, item)) {
-          data.insert_sample(item, &inst->rcvd_samples_, *iter, ++i);
-          group_coherent_ordered_data_.insert_sample(item, &inst->rcvd_samples_, *iter, ++i);
-      }
+      data.insert_instance(&inst->rcvd_samples_, inst, sample_states);
+      group_coherent_ordered_data_.insert_instance(&inst->rcvd_samples_, inst, sample_states);
     }
   }
 }
@@ -3035,6 +3436,30 @@ DataReaderImpl::resume_sample_processing(WriterInfo& info)
   }
 }
 
+#ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
+bool DataReaderImpl::early_filter_matched_i(const DataSampleHeader& header)
+{
+  if (early_filter_writer_ != header.publication_id_
+      || early_filter_sequence_ != header.sequence_) {
+    return false;
+  }
+  early_filter_writer_ = GUID_UNKNOWN;
+  return early_filter_generation_ == content_filtered_topic_->parameters_generation();
+}
+
+void DataReaderImpl::early_filtered(const ReceivedDataSample& sample)
+{
+  ACE_GUARD(ACE_Recursive_Thread_Mutex, guard, sample_lock_);
+  if (get_deleted() || !check_historic(sample)) {
+    return;
+  }
+  // The writer is still alive and the sample counts towards the latency
+  // statistics even though it doesn't make it to this reader.
+  writer_activity(sample.header_);
+  process_latency(sample);
+}
+#endif
+
 bool DataReaderImpl::check_historic(const ReceivedDataSample& sample)
 {
   ACE_WRITE_GUARD_RETURN(ACE_RW_Thread_Mutex, write_guard, writers_lock_, true);
@@ -3229,10 +3654,11 @@ void DataReaderImpl::accept_sample_processing(const SubscriptionInstance_rch& in
     instance->last_sample_tv_ = instance->cur_sample_tv_;
     instance->cur_sample_tv_.set_to_now();
 
+    // An instance that is already scheduled stays in deadline_queue_ under
+    // its current deadline.  deadline_task() checks cur_sample_tv_ when that
+    // deadline passes, so receiving a sample doesn't touch the queue.
     if (is_new_instance) {
       schedule_deadline(instance, false);
-    } else {
-      process_deadline(instance, MonotonicTimePoint::now(), false);
     }
   }
 
@@ -3300,6 +3726,122 @@ void DataReaderImpl::OnDataAvailable::execute()
   }
 }
 
+bool DataReaderImpl::dispatch_data_available()
+{
+  if (!listener_dispatch_) {
+    return false;
+  }
+  {
+    ACE_Guard<ACE_Thread_Mutex> guard(data_available_lock_);
+    if (data_available_running_) {
+      // Called again once the running callback returns, not alongside it.
+      data_available_again_ = true;
+      return true;
+    }
+    if (data_available_pending_) {
+      // Coalesced with the callback that is already waiting to run.
+      return true;
+    }
+    data_available_pending_ = true;
+  }
+  RcHandle<DomainParticipantImpl> participant = participant_servant_.lock();
+  if (!participant || !participant->dispatch_listener(data_available_event_)) {
+    // The caller makes the callback, which counts as running.
+    ACE_Guard<ACE_Thread_Mutex> guard(data_available_lock_);
+    data_available_pending_ = false;
+    data_available_running_ = true;
+    return false;
+  }
+  return true;
+}
+
+void DataReaderImpl::data_available_called()
+{
+  while (data_available_returned()) {
+    call_data_available();
+  }
+}
+
+bool DataReaderImpl::data_available_returned()
+{
+  ACE_Guard<ACE_Thread_Mutex> guard(data_available_lock_);
+  if (data_available_again_) {
+    data_available_again_ = false;
+    return true;
+  }
+  data_available_running_ = false;
+  return false;
+}
+
+void DataReaderImpl::data_available_dispatched()
+{
+  {
+    ACE_Guard<ACE_Thread_Mutex> guard(data_available_lock_);
+    data_available_pending_ = false;
+    data_available_running_ = true;
+  }
+  do {
+    call_data_available();
+  } while (data_available_returned());
+}
+
+void DataReaderImpl::call_data_available()
+{
+  if (get_deleted()) {
+    return;
+  }
+
+  DDS::DataReaderListener_var listener = listener_for(DDS::DATA_AVAILABLE_STATUS);
+  if (CORBA::is_nil(listener.in())) {
+    return;
+  }
+
+  set_status_changed_flag(DDS::DATA_AVAILABLE_STATUS, false);
+  RcHandle<SubscriberImpl> subscriber = get_subscriber_servant();
+  if (subscriber) {
+    subscriber->set_status_changed_flag(DDS::DATA_ON_READERS_STATUS, false);
+  }
+  listener->on_data_available(this);
+}
+
+void DataReaderImpl::DeliverQueuedEvent::handle_event()
+{
+  RcHandle<DataReaderImpl> data_reader = data_reader_.lock();
+  if (data_reader) {
+    data_reader->deliver_queued_samples();
+  }
+}
+
+void DataReaderImpl::DeliverQueuedEvent::handle_cancel()
+{
+  RcHandle<DataReaderImpl> data_reader = data_reader_.lock();
+  if (data_reader) {
+    data_reader->clear_delivery_queue();
+  }
+}
+
+void DataReaderImpl::DataAvailableEvent::handle_event()
+{
+  RcHandle<DataReaderImpl> data_reader = data_reader_.lock();
+  if (!data_reader) {
+    return;
+  }
+  RcHandle<DomainParticipantImpl> participant = data_reader->participant_servant_.lock();
+  if (participant) {
+    participant->listener_dispatched();
+  }
+  data_reader->data_available_dispatched();
+}
+
+void DataReaderImpl::DataAvailableEvent::handle_cancel()
+{
+  RcHandle<DataReaderImpl> data_reader = data_reader_.lock();
+  if (data_reader) {
+    ACE_Guard<ACE_Thread_Mutex> guard(data_reader->data_available_lock_);
+    data_reader->data_available_pending_ = false;
+  }
+}
+
 void DataReaderImpl::initialize_lookup_maps()
 {
   // These all start at 1 (0 mask is bogus) and include the full mask (any)
@@ -3379,10 +3921,9 @@ void DataReaderImpl::cancel_deadline(SubscriptionInstance_rch instance)
 }
 
 void DataReaderImpl::process_deadline(SubscriptionInstance_rch instance,
-                                      const MonotonicTimePoint& now,
-                                      bool timer_called)
+                                      const MonotonicTimePoint& now)
 {
-  // Should be called with sample_lock_.
+  // Should be called with sample_lock_ from deadline_task().
 
   if (instance->deadline_ != MonotonicTimePoint::zero_value) {
     bool missed = false;
@@ -3390,62 +3931,56 @@ void DataReaderImpl::process_deadline(SubscriptionInstance_rch instance,
     if (instance->cur_sample_tv_.is_zero()) { // not received any sample.
       missed = true;
 
-    } else if (timer_called) { // handle_timeout is called
+    } else {
       missed = (now - instance->cur_sample_tv_) >= deadline_period_;
-
-    } else { // upon receiving sample.
-      missed = (instance->cur_sample_tv_ - instance->last_sample_tv_) > deadline_period_;
     }
 
     if (missed) {
       ACE_GUARD(ACE_Recursive_Thread_Mutex, monitor, sample_lock_);
-      // Only update the status upon timer is called and not
-      // when receiving a sample after the interval.
-      // Otherwise the counter is doubled.
-      if (timer_called) {
-        ++requested_deadline_missed_status_.total_count;
-        requested_deadline_missed_status_.total_count_change =
-          requested_deadline_missed_status_.total_count - last_deadline_missed_total_count_;
-        requested_deadline_missed_status_.last_instance_handle = instance->instance_handle_;
+      ++requested_deadline_missed_status_.total_count;
+      requested_deadline_missed_status_.total_count_change =
+        requested_deadline_missed_status_.total_count - last_deadline_missed_total_count_;
+      requested_deadline_missed_status_.last_instance_handle = instance->instance_handle_;
 
-        set_status_changed_flag(DDS::REQUESTED_DEADLINE_MISSED_STATUS, true);
+      set_status_changed_flag(DDS::REQUESTED_DEADLINE_MISSED_STATUS, true);
 
-        DDS::DataReaderListener_var listener = listener_for(DDS::REQUESTED_DEADLINE_MISSED_STATUS);
+      DDS::DataReaderListener_var listener = listener_for(DDS::REQUESTED_DEADLINE_MISSED_STATUS);
 
 #ifndef OPENDDS_NO_OWNERSHIP_KIND_EXCLUSIVE
-        if (instance->instance_state_->is_exclusive()) {
-          DataReaderImpl::OwnershipManagerPtr owner_manager = ownership_manager();
-          if (owner_manager)
-            owner_manager->remove_writers (instance->instance_handle_);
-        }
+      if (instance->instance_state_->is_exclusive()) {
+        DataReaderImpl::OwnershipManagerPtr owner_manager = ownership_manager();
+        if (owner_manager)
+          owner_manager->remove_writers (instance->instance_handle_);
+      }
 #endif
 
-        if (!CORBA::is_nil(listener.in())) {
-          // Copy before releasing the lock.
-          DDS::RequestedDeadlineMissedStatus const status = requested_deadline_missed_status_;
-
-          // Release the lock during the upcall.
-          ACE_GUARD(Reverse_Lock_t, unlock_guard, reverse_sample_lock_);
-          // @todo Will this operation ever throw?  If so we may want to
-          //       catch all exceptions, and act accordingly.
-          listener->on_requested_deadline_missed(this, status);
+      if (!CORBA::is_nil(listener.in())) {
+        // Copy before releasing the lock.
+        DDS::RequestedDeadlineMissedStatus const status = requested_deadline_missed_status_;
 
-          // We need to update the last total count value to our current total
-          // so that the next time we will calculate the correct total_count_change;
-          last_deadline_missed_total_count_ = requested_deadline_missed_status_.total_count;
-        }
+        // Release the lock during the upcall.
+        ACE_GUARD(Reverse_Lock_t, unlock_guard, reverse_sample_lock_);
+        // @todo Will this operation ever throw?  If so we may want to
+        //       catch all exceptions, and act accordingly.
+        listener->on_requested_deadline_missed(this, status);
 
-        notify_status_condition();
+        // We need to update the last total count value to our current total
+        // so that the next time we will calculate the correct total_count_change;
+        last_deadline_missed_total_count_ = requested_deadline_missed_status_.total_count;
       }
+
+      notify_status_condition();
     }
 
     // This next part is without status_lock_ held to avoid reactor deadlock.
-    if (timer_called) {
+    if (missed) {
       instance->deadline_ = MonotonicTimePoint::zero_value;
-      schedule_deadline(instance, timer_called);
+      schedule_deadline(instance, true);
     } else {
-      cancel_deadline(instance);
-      schedule_deadline(instance, timer_called);
+      // A sample arrived since the instance was scheduled, so the next
+      // deadline is measured from that sample.
+      instance->deadline_ = instance->cur_sample_tv_ + deadline_period_;
+      deadline_queue_.insert(std::make_pair(instance->deadline_, instance));
     }
   }
 }
@@ -3515,7 +4050,7 @@ void DataReaderImpl::deadline_task(const MonotonicTimePoint& now)
     SubscriptionInstance_rch instance = pos->second;
     deadline_queue_.erase(pos++);
     // pos is no longer valid.
-    process_deadline(instance, now, true);
+    process_deadline(instance, now);
   }
 
   if (!deadline_queue_.empty()) {
@@ -3523,6 +4058,73 @@ void DataReaderImpl::deadline_task(const MonotonicTimePoint& now)
   }
 }
 
+MonotonicTimePoint DataReaderImpl::schedule_instance_release(DDS::InstanceHandle_t handle,
+                                                             const TimeDuration& delay)
+{
+  const MonotonicTimePoint deadline = MonotonicTimePoint::now() + delay;
+  bool schedule;
+  {
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, release_queue_lock_, deadline);
+    schedule = release_queue_.empty() || deadline < release_queue_.begin()->first;
+    release_queue_.insert(std::make_pair(deadline, handle));
+  }
+  if (schedule) {
+    release_task_->schedule(delay);
+  }
+  return deadline;
+}
+
+void DataReaderImpl::cancel_instance_release(DDS::InstanceHandle_t handle,
+                                             const MonotonicTimePoint& deadline)
+{
+  ACE_GUARD(ACE_Thread_Mutex, guard, release_queue_lock_);
+  for (ReleaseQueue::iterator pos = release_queue_.lower_bound(deadline), limit = release_queue_.upper_bound(deadline); pos != limit; ++pos) {
+    if (pos->second == handle) {
+      release_queue_.erase(pos);
+      break;
+    }
+  }
+  // The task is left scheduled; it reschedules itself for whatever is
+  // at the front of the queue when it runs.
+}
+
+void DataReaderImpl::release_task(const MonotonicTimePoint& now)
+{
+  ThreadStatusManager::Event ev(TheServiceParticipant->get_thread_status_manager());
+
+  // Collect everything that is due under one acquisition of the queue
+  // lock, then release the instances without holding it since
+  // release_instance() takes the ownership manager and sample locks.
+  typedef OPENDDS_VECTOR(ReleaseQueue::value_type) DueReleases;
+  DueReleases due;
+  {
+    ACE_GUARD(ACE_Thread_Mutex, guard, release_queue_lock_);
+    ReleaseQueue::iterator pos = release_queue_.begin();
+    for (; pos != release_queue_.end() && pos->first <= now; ++pos) {
+      due.push_back(*pos);
+    }
+    release_queue_.erase(release_queue_.begin(), pos);
+    if (!release_queue_.empty()) {
+      release_task_->schedule(release_queue_.begin()->first - now);
+    }
+  }
+
+  for (DueReleases::const_iterator pos = due.begin(); pos != due.end(); ++pos) {
+    const SubscriptionInstance_rch instance = get_handle_instance(pos->second);
+    if (!instance || !instance->instance_state_->release_due(pos->first)) {
+      continue;
+    }
+    if (DCPS_debug_level) {
+      ACE_DEBUG((LM_NOTICE,
+                 ACE_TEXT("(%P|%t) NOTICE:")
+                 ACE_TEXT(" DataReaderImpl::release_task:")
+                 ACE_TEXT(" autopurging samples with instance handle 0x%x!\n"),
+                 pos->second));
+    }
+    release_instance(pos->second);
+  }
+}
+
 } // namespace DCPS
 } // namespace OpenDDS
 
@@ -12,20 +12,24 @@
 #include "AtomicBool.h"
 #include "Cached_Allocator_With_Overflow_T.h"
 #include "CoherentChangeControl.h"
+#include "ConditionVariable.h"
 #include "ContentFilteredTopicImpl.h"
 #include "DataReaderCallbacks.h"
 #include "Definitions.h"
 #include "DisjointSequence.h"
 #include "DomainParticipantImpl.h"
 #include "EntityImpl.h"
+#include "EventDispatcher.h"
 #include "GroupRakeData.h"
 #include "InstanceState.h"
+#include "LatencyHistogram.h"
 #include "MultiTopicImpl.h"
 #include "OwnershipManager.h"
 #include "PoolAllocator.h"
 #include "RcEventHandler.h"
 #include "RcHandle_T.h"
 #include "RcObject.h"
+#include "ServiceEventDispatcher.h"
 #include "Service_Participant.h"
 #include "Stats_T.h"
 #include "SubscriptionInstance.h"
@@ -70,6 +74,8 @@ class TopicDescriptionImpl;
 class Monitor;
 class DataReaderImpl;
 class FilterEvaluator;
+class QueryConditionImpl;
+template <class MessageType> class RakeResults;
 
 typedef Cached_Allocator_With_Overflow<ReceivedDataElementMemoryBlock, ACE_Thread_Mutex>
 ReceivedDataAllocator;
@@ -80,19 +86,19 @@ enum MarshalingType {
 };
 
 /// Elements stored for managing statistical data.
-class OpenDDS_Dcps_Export WriterStats {
+class OpenDDS_Dcps_Export WriterStats : public virtual RcObject {
 public:
   /// Default constructor.
   WriterStats(
     int amount = 0,
     DataCollector<double>::OnFull type = DataCollector<double>::KeepOldest);
-#ifdef ACE_HAS_CPP11
-  WriterStats(const WriterStats&) = default;
-#endif
 
   /// Add a datum to the latency statistics.
   void add_stat(const TimeDuration& delay);
 
+  /// Add the time a sample spent in the reader before it was taken.
+  void add_take_stat(const TimeDuration& delay);
+
   /// Extract the current latency statistics for this writer.
   LatencyStatistics get_stats() const;
 
@@ -105,9 +111,18 @@ public:
 #endif
 
 private:
-  /// Latency statistics for the DataWriter to this DataReader.
-  Stats<double> stats_;
+  /// Latency from the DataWriter to this DataReader.
+  LatencyHistogram latency_;
+
+  /// Latency from reception until the sample is taken.
+  LatencyHistogram take_latency_;
+
+  /// Raw latency data, only kept when a raw latency buffer is configured.
+  const bool collect_raw_;
+  mutable ACE_Thread_Mutex raw_lock_;
+  DataCollector<double> raw_;
 };
+typedef RcHandle<WriterStats> WriterStats_rch;
 
 #ifndef OPENDDS_NO_CONTENT_SUBSCRIPTION_PROFILE
 
@@ -149,7 +164,7 @@ public:
   typedef OPENDDS_SET(DDS::InstanceHandle_t) InstanceSet;
   typedef OPENDDS_SET(SubscriptionInstance_rch) SubscriptionInstanceSet;
   /// Type of collection of statistics for writers to this reader.
-  typedef OPENDDS_MAP_CMP(GUID_t, WriterStats, GUID_tKeyLessThan) StatsMapType;
+  typedef OPENDDS_MAP_CMP(GUID_t, WriterStats_rch, GUID_tKeyLessThan) StatsMapType;
 
   DataReaderImpl();
 
@@ -301,6 +316,18 @@ public:
 
   /// @}
 
+  /// Instances and samples held by this reader and an estimate of their
+  /// memory.
+  struct MemoryEstimate {
+    size_t instances;
+    size_t samples;
+    /// Sum of the sizes of the instance and sample objects.  Variable-length
+    /// members of the samples and allocator overhead are not included.
+    size_t estimated_bytes;
+  };
+
+  void get_memory_estimate(MemoryEstimate& estimate) const;
+
   /// update liveliness info for this writer.
   void writer_activity(const DataSampleHeader& header);
 
@@ -318,12 +345,21 @@ public:
                        DDS::ViewStateMask view_states,
                        DDS::InstanceStateMask instance_states);
 
-#ifndef OPENDDS_NO_CONTENT_SUBSCRIPTION_PROFILE
+#ifndef OPENDDS_NO_QUERY_CONDITION
   virtual bool contains_sample_filtered(DDS::SampleStateMask sample_states,
                                         DDS::ViewStateMask view_states,
                                         DDS::InstanceStateMask instance_states,
-                                        const FilterEvaluator& evaluator,
-                                        const DDS::StringSeq& params) = 0;
+                                        const QueryConditionImpl& query) = 0;
+
+  /// Forget the results kept in every sample for the QueryCondition that
+  /// has bit, see QueryConditionImpl::filter.
+  virtual void clear_query_results(ACE_UINT32 bit) = 0;
+
+  /// Keep the counts of query results up to date when a sample is added to
+  /// or removed from the ReceivedDataElementList of an instance.  The
+  /// caller must hold the sample lock.
+  void query_sample_added();
+  void query_sample_removed(ReceivedDataElement& item);
 #endif
 
   virtual void dds_demarshal(const ReceivedDataSample& sample,
@@ -333,11 +369,75 @@ public:
                              bool& filtered,
                              MarshalingType marshaling_type) = 0;
 
+  /// A received sample being deserialized by the threads configured by
+  /// DCPSDeserializeThreads.  It waits in the delivery queue, so samples are
+  /// stored in the order they were received even when a later one finishes
+  /// deserializing first.
+  class OpenDDS_Dcps_Export DeserializeJob : public EventBase {
+  public:
+    DeserializeJob(WeakRcHandle<DataReaderImpl> data_reader,
+                   const ReceivedDataSample& sample,
+                   DDS::InstanceHandle_t publication_handle)
+      : sample_(sample)
+      , publication_handle_(publication_handle)
+      , deserialized_(false)
+      , ready_(false)
+      , data_reader_(data_reader)
+    {}
+
+    void handle_event();
+    void handle_cancel();
+
+    const ReceivedDataSample sample_;
+    const DDS::InstanceHandle_t publication_handle_;
+    /// deserialize_ahead() has run, so store_deserialized() stores the
+    /// sample instead of dds_demarshal().
+    bool deserialized_;
+    /// The sample may be stored once the ones before it are.
+    /// Protected by delivery_queue_lock_.
+    bool ready_;
+
+  private:
+    WeakRcHandle<DataReaderImpl> data_reader_;
+  };
+  typedef RcHandle<DeserializeJob> DeserializeJob_rch;
+
+  /// Create a job for deserializing a sample on the participant's
+  /// deserialization threads, or return a nil handle if this sample has to
+  /// be deserialized by dds_demarshal().
+  virtual DeserializeJob_rch deserialize_job(const ReceivedDataSample& sample,
+                                             DDS::InstanceHandle_t publication_handle);
+
+  /// Deserialize the sample of a job created by deserialize_job().  Called
+  /// without any locks held.
+  virtual void deserialize_ahead(DeserializeJob& job);
+
+  /// The equivalent of dds_demarshal() for a job that was passed to
+  /// deserialize_ahead().
+  virtual void store_deserialized(DeserializeJob& job,
+                                  SubscriptionInstance_rch& instance,
+                                  bool& is_new_instance,
+                                  bool& filtered);
+
+  /// Drop samples waiting in the delivery queue.  Called by the destructor
+  /// of the subclass since deserialized samples use its allocator.
+  void clear_delivery_queue();
+
   virtual void dispose_unregister(const ReceivedDataSample& sample,
                                   DDS::InstanceHandle_t publication_handle,
                                   SubscriptionInstance_rch& instance);
 
   void process_latency(const ReceivedDataSample& sample);
+
+  /// Record how long a sample that is being taken waited in the reader.
+  void process_take_latency(const ReceivedDataElement& sample,
+                            const SystemTimePoint& now);
+
+  /// Remove a sample whose deferred payload couldn't be deserialized so it
+  /// is never returned from read or take.  Returns false if the sample
+  /// wasn't in samples (anymore).
+  bool drop_undecodable(ReceivedDataElement* sample,
+                        ReceivedDataElementList& samples);
   void notify_latency(GUID_t writer);
 
   size_t get_depth() const
@@ -649,9 +749,22 @@ protected:
   */
   DDS::InstanceHandle_t get_next_handle(const DDS::BuiltinTopicKey_t& key);
 
+  /// Hand on_data_available to the participant's listener threads.
+  /// Returns false if the caller should make the callback itself, and then
+  /// call data_available_called() once it returns.
+  bool dispatch_data_available();
+
+  /// Make the calls of on_data_available that were asked for while the
+  /// caller of dispatch_data_available was making its own.
+  void data_available_called();
+
   virtual void purge_data(SubscriptionInstance_rch instance) = 0;
 
   virtual void release_instance_i(DDS::InstanceHandle_t handle) = 0;
+
+  /// Size of a received sample and its data, used by get_memory_estimate().
+  virtual size_t sample_footprint() const { return sizeof(ReceivedDataElement); }
+
   virtual void state_updated_i(DDS::InstanceHandle_t handle) = 0;
 
   bool has_readcondition(DDS::ReadCondition_ptr a_condition);
@@ -713,6 +826,22 @@ protected:
 #ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
   mutable ACE_Thread_Mutex content_filtered_topic_mutex_;
   TopicDescriptionPtr<ContentFilteredTopicImpl> content_filtered_topic_;
+  /// The last sample that drop_received() matched against the filter, so
+  /// that the filter isn't evaluated again when the sample is demarshaled,
+  /// and the generation of the filter parameters it was matched with.
+  GUID_t early_filter_writer_;
+  SequenceNumber early_filter_sequence_;
+  ACE_UINT32 early_filter_generation_;
+
+  /// Returns true, once, if drop_received() already matched the filter
+  /// against the sample with this header and the filter parameters haven't
+  /// changed since.  The caller holds content_filtered_topic_mutex_ and
+  /// content_filtered_topic_ is set.
+  bool early_filter_matched_i(const DataSampleHeader& header);
+
+  /// Do what data_received() does for a sample before it is demarshaled for
+  /// a sample that drop_received() filtered out instead.
+  void early_filtered(const ReceivedDataSample& sample);
 #endif
 
 #ifndef OPENDDS_NO_MULTI_TOPIC
@@ -725,6 +854,9 @@ protected:
   /// Ordered group samples.
   GroupRakeData group_coherent_ordered_data_;
 
+  /// Storage for RakeResults, protected by sample_lock_.
+  RakeScratch rake_scratch_;
+
   DDS::SubscriberQos subqos_;
 
   virtual void add_link(const DataLink_rch& link, const GUID_t& peer);
@@ -787,6 +919,7 @@ private:
   void deliver_historic(OPENDDS_MAP(SequenceNumber, ReceivedDataSample)& samples);
 
   friend class InstanceState;
+  template <class MessageType> friend class RakeResults;
 
   friend class ::DDS_TEST; //allows tests to get at private data
 
@@ -854,8 +987,21 @@ private:
   void cancel_all_deadlines();
   void deadline_task(const MonotonicTimePoint& now);
   void process_deadline(SubscriptionInstance_rch instance,
-                        const MonotonicTimePoint& now,
-                        bool timer_called);
+                        const MonotonicTimePoint& now);
+
+  /// Autopurge releases that are due for instances of this reader.
+  /// They are reclaimed in batches by release_task_ rather than by a
+  /// timer per instance.
+  typedef OPENDDS_MULTIMAP(MonotonicTimePoint, DDS::InstanceHandle_t) ReleaseQueue;
+  ACE_Thread_Mutex release_queue_lock_;
+  ReleaseQueue release_queue_;
+  RcHandle<DRISporadicTask> release_task_;
+
+  MonotonicTimePoint schedule_instance_release(DDS::InstanceHandle_t handle,
+                                               const TimeDuration& delay);
+  void cancel_instance_release(DDS::InstanceHandle_t handle,
+                               const MonotonicTimePoint& deadline);
+  void release_task(const MonotonicTimePoint& now);
 
   /// Flag indicates that this datareader is a builtin topic
   /// datareader.
@@ -863,6 +1009,75 @@ private:
 
   bool always_get_history_;
 
+  /// Samples that arrived while sample_lock_ was held by another thread
+  /// when DCPSQueuedDelivery is enabled, samples being deserialized when
+  /// DCPSDeserializeThreads is set, and any samples received after them.
+  /// They are delivered in order by deliver_queued_samples() on the
+  /// participant's delivery thread.
+  struct QueuedSample {
+    QueuedSample(const ReceivedDataSample& sample,
+                 DDS::InstanceHandle_t publication_handle,
+                 const DeserializeJob_rch& job)
+      : sample_(sample)
+      , publication_handle_(publication_handle)
+      , job_(job)
+    {}
+
+    /// Requires delivery_queue_lock_.
+    bool ready() const { return !job_ || job_->ready_; }
+
+    ReceivedDataSample sample_;
+    DDS::InstanceHandle_t publication_handle_;
+    DeserializeJob_rch job_;
+  };
+  typedef OPENDDS_DEQUE(QueuedSample) DeliveryQueue;
+  ServiceEventDispatcher_rch delivery_dispatcher_;
+  EventBase_rch deliver_queued_event_;
+  ACE_Thread_Mutex delivery_queue_lock_;
+  DeliveryQueue delivery_queue_;
+  /// Most samples delivery_queue_ holds (DCPSDeliveryQueueMax), 0 for no
+  /// limit.  Once it's full, data_received() waits for the delivery thread
+  /// to make room so the transport can't outrun the DataReader.
+  size_t delivery_queue_max_;
+  ConditionVariable<ACE_Thread_Mutex> delivery_queue_space_;
+  /// deliver_queued_event_ has been dispatched and not yet finished.
+  /// While set, new samples go to the back of the queue to keep their order.
+  /// While it's not set, the queue is either empty or its front isn't ready.
+  bool delivering_queued_samples_;
+  /// DCPSQueuedDelivery is set, so samples are also queued while the
+  /// DataReader is busy.
+  bool queue_when_busy_;
+
+  void deliver_queued_samples();
+  /// Wait until delivery_queue_ has room for another sample.  Requires
+  /// delivery_queue_lock_.
+  void wait_for_delivery_queue_space();
+  void deserialize_job_ready(DeserializeJob& job);
+  void data_received_i(const ReceivedDataSample& sample,
+                       DDS::InstanceHandle_t publication_handle,
+                       DeserializeJob* job = 0);
+
+  ServiceEventDispatcher_rch deserialize_dispatcher_;
+  size_t deserialize_min_size_;
+
+  /// on_data_available is made by the participant's listener threads
+  /// (DCPSListenerThreads) instead of the thread that received the data.
+  bool listener_dispatch_;
+  /// Keeps on_data_available calls of this reader from overlapping when
+  /// there are several listener threads.  A DataAvailableEvent has been
+  /// dispatched and has not started to run (pending), on_data_available is
+  /// running (running), and data arrived while it was (again).
+  ACE_Thread_Mutex data_available_lock_;
+  bool data_available_pending_;
+  bool data_available_running_;
+  bool data_available_again_;
+  EventBase_rch data_available_event_;
+
+  void data_available_dispatched();
+  void call_data_available();
+  /// on_data_available has returned, true if it has to be called again.
+  bool data_available_returned();
+
   /// Flag indicating status of statistics gathering.
   AtomicBool statistics_enabled_;
 
@@ -877,7 +1092,8 @@ private:
 
   /// Statistics for this reader, collected for each writer.
   StatsMapType statistics_;
-  ACE_Recursive_Thread_Mutex statistics_lock_;
+  /// Only protects the map; the statistics are recorded without a lock.
+  ACE_RW_Thread_Mutex statistics_lock_;
 
   /// Bound (or initial reservation) of raw latency buffer.
   unsigned int raw_latency_buffer_size_;
@@ -888,6 +1104,33 @@ private:
   typedef VarLess<DDS::ReadCondition> RCCompLess;
   typedef OPENDDS_SET_CMP(DDS::ReadCondition_var,  RCCompLess) ReadConditionSet;
   ReadConditionSet read_conditions_;
+#ifndef OPENDDS_NO_QUERY_CONDITION
+  /// Bits of ReceivedDataElement::query_evaluated_ and query_matched_ that
+  /// QueryConditions of this DataReader have.  Once they're all taken, the
+  /// results of further QueryConditions aren't kept.
+  ACE_UINT32 query_result_bits_;
+
+  /// The samples held in the instances, and for the QueryCondition that has
+  /// each bit of query_result_bits_, how many of them have a result and how
+  /// many of those match.  Guarded by sample_lock_.
+  static const size_t query_result_bit_count = 32;
+  size_t query_samples_;
+  size_t query_evaluated_[query_result_bit_count];
+  size_t query_matched_[query_result_bit_count];
+
+  void release_result_bit(DDS::ReadCondition_ptr condition);
+
+  /// Count a result kept in a sample for the QueryCondition that has bit.
+  void query_result(ACE_UINT32 bit, bool match);
+
+  /// Reset the counts of the QueryCondition that has bit, once the results
+  /// are cleared from the samples.
+  void reset_query_counts(ACE_UINT32 bit);
+
+  /// False if every sample has a result for the QueryCondition that has bit
+  /// and none of them match.
+  bool query_may_match(ACE_UINT32 bit) const;
+#endif
 
   /// Monitor object for this entity
   unique_ptr<Monitor> monitor_;
@@ -950,6 +1193,32 @@ public:
     const bool set_subscriber_status_;
   };
 
+  class OpenDDS_Dcps_Export DeliverQueuedEvent : public EventBase {
+  public:
+    DeliverQueuedEvent(WeakRcHandle<DataReaderImpl> data_reader)
+      : data_reader_(data_reader)
+    {}
+
+    void handle_event();
+    void handle_cancel();
+
+  private:
+    WeakRcHandle<DataReaderImpl> data_reader_;
+  };
+
+  class OpenDDS_Dcps_Export DataAvailableEvent : public EventBase {
+  public:
+    DataAvailableEvent(WeakRcHandle<DataReaderImpl> data_reader)
+      : data_reader_(data_reader)
+    {}
+
+    void handle_event();
+    void handle_cancel();
+
+  private:
+    WeakRcHandle<DataReaderImpl> data_reader_;
+  };
+
 protected:
 #if OPENDDS_CONFIG_SECURITY
   Security::SecurityConfig_rch security_config_;
@@ -10,8 +10,11 @@
 #include "BuiltInTopicUtils.h"
 #include "EncapsulationHeader.h"
 #include "GuidConverter.h"
+#include "Hash.h"
 #include "MultiTopicImpl.h"
+#include "QueryConditionImpl.h"
 #include "RakeResults_T.h"
+#include "SpillLog.h"
 #include "SubscriberImpl.h"
 #include "TypeSupportImpl.h"
 #include "Util.h"
@@ -67,6 +70,47 @@ namespace OpenDDS {
 
     typedef RcHandle<SharedInstanceMap> SharedInstanceMap_rch;
 
+    /// Refers to the key fields of a sample along with a hash of them, so
+    /// instances can be found without walking instance_map_.
+    struct InstanceKey {
+      InstanceKey(const MessageType& sample, size_t hash)
+        : sample_(&sample)
+        , hash_(hash)
+      {}
+
+      bool operator==(const InstanceKey& other) const
+      {
+        typename TraitsType::LessThanType less;
+        return hash_ == other.hash_
+          && !less(*sample_, *other.sample_) && !less(*other.sample_, *sample_);
+      }
+
+      bool operator<(const InstanceKey& other) const
+      {
+        if (hash_ != other.hash_) {
+          return hash_ < other.hash_;
+        }
+        typename TraitsType::LessThanType less;
+        return less(*sample_, *other.sample_);
+      }
+
+      const MessageType* sample_;
+      size_t hash_;
+    };
+
+    struct InstanceKeyHash {
+      size_t operator()(const InstanceKey& key) const
+      {
+        return key.hash_;
+      }
+    };
+
+#ifdef ACE_HAS_CPP11
+    typedef OPENDDS_UNORDERED_MAP_CHASH_T(InstanceKey, typename InstanceMap::iterator, InstanceKeyHash) InstanceIndex;
+#else
+    typedef OPENDDS_MAP_T(InstanceKey, typename InstanceMap::iterator) InstanceIndex;
+#endif
+
     typedef typename TraitsType::DataReaderType Interface;
 
     CORBA::Boolean _is_a(const char* type_id)
@@ -107,11 +151,78 @@ namespace OpenDDS {
 
       const MessageType* message() const { return this; }
 
+      /// Keep the serialized form of the sample instead of deserializing it.
+      /// The payload must start at the first byte after the encapsulation
+      /// header.
+      void defer(ACE_Message_Block* payload, const Encoding& encoding)
+      {
+        deferred_.reset(new Deferred(encoding));
+        deferred_->payload_.reset(payload);
+      }
+
+      /// Like defer(), but the payload was written to a spill log.  Samples
+      /// of keyed types keep their key fields.
+      void spill(const OpenDDS::DCPS::SpillLog_rch& log,
+                 const OpenDDS::DCPS::SpillLog::Record& record,
+                 const Encoding& encoding)
+      {
+        deferred_.reset(new Deferred(encoding));
+        deferred_->spill_log_ = log;
+        deferred_->spill_record_ = record;
+      }
+
+      /// Deserialize a sample that was stored with defer() or spill().
+      bool materialize()
+      {
+        if (!deferred_) {
+          return true;
+        }
+        unique_ptr<Deferred> deferred(deferred_.release());
+        if (deferred->spill_log_) {
+          deferred->payload_.reset(deferred->spill_log_->read(deferred->spill_record_));
+          if (!deferred->payload_) {
+            return false;
+          }
+        }
+        Serializer ser(deferred->payload_.get(), deferred->encoding_);
+        const bool ok = ser >> static_cast<MessageType&>(*this);
+        if (!ok && DCPS_debug_level > 0) {
+          ACE_ERROR((LM_ERROR, ACE_TEXT("(%P|%t) ERROR %CDataReaderImpl::MessageTypeWithAllocator::materialize: ")
+                     ACE_TEXT("deserialization of deferred sample failed.\n"),
+                     TraitsType::type_name()));
+        }
+        return ok;
+      }
+
 #ifndef OPENDDS_HAS_STD_UNIQUE_PTR
       using EnableContainerSupportedUniquePtr<MessageTypeWithAllocator>::_remove_ref;
       using EnableContainerSupportedUniquePtr<MessageTypeWithAllocator>::_add_ref;
       using EnableContainerSupportedUniquePtr<MessageTypeWithAllocator>::ref_count;
 #endif
+
+    private:
+      /// Where to find the serialized form of a sample that hasn't been
+      /// deserialized yet.  Only allocated for those samples, so samples that
+      /// are deserialized on arrival just carry a null pointer.
+      struct Deferred {
+        explicit Deferred(const Encoding& encoding)
+          : encoding_(encoding)
+        {}
+
+        ~Deferred()
+        {
+          if (spill_log_) {
+            spill_log_->release(spill_record_);
+          }
+        }
+
+        Message_Block_Ptr payload_;
+        const Encoding encoding_;
+        OpenDDS::DCPS::SpillLog_rch spill_log_;
+        OpenDDS::DCPS::SpillLog::Record spill_record_;
+      };
+
+      unique_ptr<Deferred> deferred_;
     };
 
     struct MessageTypeMemoryBlock {
@@ -124,6 +235,11 @@ namespace OpenDDS {
     DataReaderImpl_T()
       : filter_delayed_sample_task_(make_rch<DRISporadicTask>(TheServiceParticipant->time_source(), TheServiceParticipant->reactor_task(), rchandle_from(this), &DataReaderImpl_T::filter_delayed))
       , marshal_skip_serialize_(false)
+      , lazy_deserialization_(false)
+      , has_key_(false)
+      , spill_budget_(0)
+      , spill_payload_bytes_(0)
+      , spill_payloads_(0)
     {
       initialize_lookup_maps();
     }
@@ -131,6 +247,7 @@ namespace OpenDDS {
     virtual ~DataReaderImpl_T()
     {
       filter_delayed_sample_task_->cancel();
+      clear_delivery_queue();
 
       for (typename InstanceMap::iterator it = instance_map_.begin();
            it != instance_map_.end(); ++it)
@@ -159,6 +276,15 @@ namespace OpenDDS {
                    data_allocator().get(),
                    get_n_chunks ()));
 
+      // Instance lookup needs the key fields, so only samples of keyless
+      // types can be stored before they are deserialized.
+      has_key_ = type_support_->has_dcps_key();
+      lazy_deserialization_ = TheServiceParticipant->lazy_deserialization()
+        && !is_bit() && !has_key_;
+      if (!is_bit()) {
+        spill_budget_ = TheServiceParticipant->spill_budget();
+      }
+
       return DDS::RETCODE_OK;
     }
 
@@ -292,8 +418,13 @@ namespace OpenDDS {
       if (!inst) continue;
 
       bool most_recent_generation = false;
-      for (ReceivedDataElement* item = inst->rcvd_samples_.get_next_match(sample_states, 0);
-           !found_data && item; item = inst->rcvd_samples_.get_next_match(sample_states, item)) {
+      for (ReceivedDataElement* item = inst->rcvd_samples_.get_next_match(sample_states, 0), *next_item = 0;
+           !found_data && item; item = next_item) {
+        next_item = inst->rcvd_samples_.get_next_match(sample_states, item);
+        if (!item->materialize()) {
+          drop_undecodable(item, inst->rcvd_samples_);
+          continue;
+        }
         if (item->registered_data_) {
           received_data = *static_cast<MessageType*>(item->registered_data_);
         }
@@ -347,6 +478,10 @@ namespace OpenDDS {
 
       bool most_recent_generation = false;
       ReceivedDataElement* item = inst->rcvd_samples_.get_next_match(sample_states, 0);
+      while (item && !item->materialize()) {
+        item = drop_undecodable(item, inst->rcvd_samples_) ?
+          inst->rcvd_samples_.get_next_match(sample_states, 0) : 0;
+      }
       if (item) {
         if (item->registered_data_) {
           received_data = *static_cast<MessageType*>(item->registered_data_);
@@ -372,6 +507,10 @@ namespace OpenDDS {
         // absolute_generation_ranks for this info_seq
         sample_info(sample_info_ref, inst->rcvd_samples_.peek_tail());
 
+        if (statistics_enabled()) {
+          process_take_latency(*item, SystemTimePoint::now());
+        }
+
         inst->rcvd_samples_.remove(item);
         item->dec_ref();
         item = 0;
@@ -676,9 +815,9 @@ namespace OpenDDS {
   {
     ACE_Guard<ACE_Recursive_Thread_Mutex> guard(sample_lock_);
 
-    const typename InstanceMap::const_iterator it = instance_map_.find(instance_data);
-    if (it != instance_map_.end()) {
-      return it->second;
+    const typename InstanceIndex::const_iterator it = instance_index_.find(instance_key(instance_data));
+    if (it != instance_index_.end()) {
+      return it->second->second;
     }
     return DDS::HANDLE_NIL;
   }
@@ -702,20 +841,15 @@ namespace OpenDDS {
   }
 
 #ifndef OPENDDS_NO_CONTENT_SUBSCRIPTION_PROFILE
+#ifndef OPENDDS_NO_QUERY_CONDITION
   bool contains_sample_filtered(DDS::SampleStateMask sample_states,
                                 DDS::ViewStateMask view_states,
                                 DDS::InstanceStateMask instance_states,
-                                const FilterEvaluator& evaluator,
-                                const DDS::StringSeq& params)
+                                const QueryConditionImpl& query)
   {
     ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, sample_lock_, false);
     ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, instance_guard, instances_lock_, false);
 
-    TopicDescriptionPtr<TopicImpl> topic(topic_servant_);
-    TypeSupport* const ts = topic->get_type_support();
-    TypeSupportImpl* const type_support = dynamic_cast<TypeSupportImpl*>(ts);
-    const bool filter_has_non_key_fields = type_support ? evaluator.has_non_key_fields(*type_support) : true;
-
     const HandleSet& matches = lookup_matching_instances(sample_states, view_states, instance_states);
     for (HandleSet::const_iterator it = matches.begin(), next = it; it != matches.end(); it = next) {
       ++next; // pre-increment iterator, in case updates cause changes to match set
@@ -725,10 +859,7 @@ namespace OpenDDS {
 
       for (ReceivedDataElement* item = inst->rcvd_samples_.get_next_match(sample_states, 0); item;
            item = inst->rcvd_samples_.get_next_match(sample_states, item)) {
-        if (!item->registered_data_ || (!item->valid_data_ && filter_has_non_key_fields)) {
-          continue;
-        }
-        if (evaluator.eval(*static_cast<MessageType*>(item->registered_data_), params)) {
+        if (query.filter<MessageType>(*item)) {
           return true;
         }
       }
@@ -737,6 +868,23 @@ namespace OpenDDS {
     return false;
   }
 
+  void clear_query_results(ACE_UINT32 bit)
+  {
+    ACE_GUARD(ACE_Recursive_Thread_Mutex, guard, sample_lock_);
+    ACE_GUARD(ACE_Recursive_Thread_Mutex, instance_guard, instances_lock_);
+
+    for (typename SubscriptionInstanceMapType::iterator it = instances_.begin(); it != instances_.end(); ++it) {
+      ReceivedDataElementList& samples = it->second->rcvd_samples_;
+      for (ReceivedDataElement* item = samples.get_next_match(DDS::ANY_SAMPLE_STATE, 0); item;
+           item = samples.get_next_match(DDS::ANY_SAMPLE_STATE, item)) {
+        item->query_evaluated_ &= ~bit;
+        item->query_matched_ &= ~bit;
+      }
+    }
+    reset_query_counts(bit);
+  }
+#endif
+
   DDS::ReturnCode_t read_generic(GenericBundle& gen,
                                  DDS::SampleStateMask sample_states,
                                  DDS::ViewStateMask view_states,
@@ -998,9 +1146,9 @@ namespace OpenDDS {
     }
 
     DDS::InstanceHandle_t handle(DDS::HANDLE_NIL);
-    typename InstanceMap::const_iterator const it = instance_map_.find(data);
-    if (it != instance_map_.end()) {
-      handle = it->second;
+    const typename InstanceIndex::const_iterator it = instance_index_.find(instance_key(data));
+    if (it != instance_index_.end()) {
+      handle = it->second->second;
     }
 
     if (handle == DDS::HANDLE_NIL) {
@@ -1097,115 +1245,108 @@ protected:
       store_instance_data(OPENDDS_MOVE_NS::move(data), publication_handle, sample.header_, instance, just_registered, filtered);
       return;
     }
-    const bool encapsulated = sample.header_.cdr_encapsulation_;
 
-    OpenDDS::DCPS::Serializer ser(
-      payload.get(),
-      encapsulated ? Encoding::KIND_XCDR1 : Encoding::KIND_UNALIGNED_CDR,
+    const Encoding encoding(
+      sample.header_.cdr_encapsulation_ ? Encoding::KIND_XCDR1 : Encoding::KIND_UNALIGNED_CDR,
       static_cast<Endianness>(sample.header_.byte_order_));
+    const bool key_only_marshaling =
+      marshaling_type == OpenDDS::DCPS::KEY_ONLY_MARSHALING;
 
-    if (encapsulated) {
-      EncapsulationHeader encap;
-      if (!(ser >> encap)) {
-        if (DCPS_debug_level > 0) {
-          ACE_ERROR((LM_ERROR, ACE_TEXT("(%P|%t) ERROR ")
-            ACE_TEXT("%CDataReaderImpl::dds_demarshal: ")
-            ACE_TEXT("deserialization of encapsulation header failed.\n"),
-            TraitsType::type_name()));
-        }
+    OpenDDS::DCPS::Serializer ser(payload.get(), encoding);
+    if (!read_encapsulation(sample.header_, ser)) {
+      return;
+    }
+
+    // Samples in an encoding the DataReader doesn't accept were rejected by
+    // read_encapsulation, so they aren't counted as filtered.
+    bool filter_applied = false;
+    if (!key_only_marshaling && !filter_serialized(sample.header_, *payload, ser.encoding(), filter_applied)) {
+      filtered = true;
+      return;
+    }
+
+    OpenDDS::DCPS::SpillLog::Record spill_record;
+    bool spilled = false;
+    if (!key_only_marshaling && can_defer_deserialization(sample.header_)) {
+      spilled = spill_payload(*payload, spill_record);
+      if (spilled && !has_key_) {
+        data->spill(spill_log_, spill_record, ser.encoding());
+        store_instance_data(OPENDDS_MOVE_NS::move(data), publication_handle, sample.header_, instance, just_registered, filtered);
         return;
       }
-      Encoding encoding;
-      if (!to_encoding(encoding, encap, type_support_->base_extensibility())) {
-        if (log_level >= LogLevel::Error) {
-          ACE_ERROR((LM_ERROR,
-                     "(%P|%t) ERROR: %CDataReaderImpl::dds_demarshal: "
-                     "to_encoding failed writer %C reader %C\n",
-                     LogGuid(sample.header_.publication_id_).c_str(),
-                     LogGuid(subscription_id()).c_str()));
-        }
+      if (!spilled && lazy_deserialization_) {
+        data->defer(copy_remaining(*payload), ser.encoding());
+        store_instance_data(OPENDDS_MOVE_NS::move(data), publication_handle, sample.header_, instance, just_registered, filtered);
         return;
       }
+    }
 
-      if (decoding_modes_.find(encoding.kind()) == decoding_modes_.end()) {
-        if (DCPS_debug_level >= 1) {
-          ACE_DEBUG((LM_WARNING, ACE_TEXT("(%P|%t) WARNING ")
-            ACE_TEXT("%CDataReaderImpl::dds_demarshal: ")
-            ACE_TEXT("Encoding kind %C of the received sample does not ")
-            ACE_TEXT("match the ones specified by DataReader.\n"),
-            TraitsType::type_name(),
-            Encoding::kind_to_string(encoding.kind()).c_str()));
-        }
-        return;
-      }
-      if (DCPS_debug_level >= 8) {
-        ACE_DEBUG((LM_DEBUG, ACE_TEXT("(%P|%t) ")
-          ACE_TEXT("%CDataReaderImpl::dds_demarshal: ")
-          ACE_TEXT("Deserializing with encoding kind %C.\n"),
-          TraitsType::type_name(),
-          Encoding::kind_to_string(encoding.kind()).c_str()));
+    if (!deserialize(ser, *data, key_only_marshaling)) {
+      if (spilled) {
+        spill_log_->release(spill_record);
       }
+      return;
+    }
 
-      ser.encoding(encoding);
+    if (spilled) {
+      // The instance is found by the key fields, so only they stay in memory.
+      MessageType keys;
+      TraitsType::copy_keys(keys, *data);
+      static_cast<MessageType&>(*data) = keys;
+      data->spill(spill_log_, spill_record, ser.encoding());
     }
 
-    const bool key_only_marshaling =
-      marshaling_type == OpenDDS::DCPS::KEY_ONLY_MARSHALING;
+    filter_and_store(OPENDDS_MOVE_NS::move(data), publication_handle, sample.header_, instance, just_registered, filtered,
+                     key_only_marshaling, filter_applied);
+  }
 
-    bool ser_ret = true;
-    if (key_only_marshaling) {
-      ser_ret = ser >> OpenDDS::DCPS::KeyOnly<MessageType>(*data);
-    } else {
-      ser_ret = ser >> *data;
-    }
-    if (!ser_ret) {
-      if (ser.get_construction_status() != Serializer::ConstructionSuccessful) {
-        if (DCPS_debug_level > 1) {
-          ACE_DEBUG((LM_WARNING, ACE_TEXT("(%P|%t) %CDataReaderImpl::dds_demarshal ")
-                     ACE_TEXT("object construction failure, dropping sample.\n"),
-                     TraitsType::type_name()));
-        }
-      } else {
-        if (DCPS_debug_level > 0) {
-          ACE_ERROR((LM_ERROR, ACE_TEXT("(%P|%t) ERROR %CDataReaderImpl::dds_demarshal ")
-                    ACE_TEXT("deserialization failed, dropping sample.\n"),
-                    TraitsType::type_name()));
-        }
-      }
-      return;
+  struct DeserializedSample : OpenDDS::DCPS::DataReaderImpl::DeserializeJob {
+    DeserializedSample(OpenDDS::DCPS::WeakRcHandle<OpenDDS::DCPS::DataReaderImpl> data_reader,
+                       const OpenDDS::DCPS::ReceivedDataSample& sample,
+                       DDS::InstanceHandle_t publication_handle)
+      : DeserializeJob(data_reader, sample, publication_handle)
+    {}
+
+    /// Null if deserialization failed.
+    unique_ptr<MessageTypeWithAllocator> data_;
+  };
+
+  virtual DeserializeJob_rch deserialize_job(const OpenDDS::DCPS::ReceivedDataSample& sample,
+                                             DDS::InstanceHandle_t publication_handle)
+  {
+    if (marshal_skip_serialize_ || lazy_deserialization_ || spill_budget_) {
+      return DeserializeJob_rch();
     }
+    return OpenDDS::DCPS::make_rch<DeserializedSample>(rchandle_from(static_cast<OpenDDS::DCPS::DataReaderImpl*>(this)),
+                                                       sample, publication_handle);
+  }
 
-#ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
-    /*
-     * If sample.header_.content_filter_ is true, the writer has already
-     * filtered.
-     */
-    if (!sample.header_.content_filter_) {
-      ACE_Guard<ACE_Thread_Mutex> guard(content_filtered_topic_mutex_);
-      if (content_filtered_topic_) {
-        const bool sample_only_has_key_fields = !sample.header_.valid_data();
-        if (key_only_marshaling != sample_only_has_key_fields) {
-          if (DCPS_debug_level > 0) {
-            ACE_ERROR((LM_ERROR, ACE_TEXT("(%P|%t) ERROR ")
-              ACE_TEXT("%CDataReaderImpl::dds_demarshal: ")
-              ACE_TEXT("Mismatch between the key only and valid data properties ")
-              ACE_TEXT("of a %C message of a content filtered topic!\n"),
-              TraitsType::type_name(),
-              to_string(static_cast<MessageId>(sample.header_.message_id_))));
-          }
-          filtered = true;
-          return;
-        }
-        const MessageType& type = static_cast<MessageType&>(*data);
-        if (!content_filtered_topic_->filter(type, sample_only_has_key_fields)) {
-          filtered = true;
-          return;
-        }
-      }
+  virtual void deserialize_ahead(DeserializeJob& job)
+  {
+    DeserializedSample& ds = static_cast<DeserializedSample&>(job);
+    unique_ptr<MessageTypeWithAllocator> data(new (*data_allocator()) MessageTypeWithAllocator);
+    dynamic_hook(*data);
+
+    Message_Block_Ptr payload(ds.sample_.data(&mb_alloc_));
+    OpenDDS::DCPS::Serializer ser(
+      payload.get(),
+      ds.sample_.header_.cdr_encapsulation_ ? Encoding::KIND_XCDR1 : Encoding::KIND_UNALIGNED_CDR,
+      static_cast<Endianness>(ds.sample_.header_.byte_order_));
+    if (read_encapsulation(ds.sample_.header_, ser) && deserialize(ser, *data, false)) {
+      ds.data_ = OPENDDS_MOVE_NS::move(data);
     }
-#endif
+  }
 
-    store_instance_data(OPENDDS_MOVE_NS::move(data), publication_handle, sample.header_, instance, just_registered, filtered);
+  virtual void store_deserialized(DeserializeJob& job,
+                                  OpenDDS::DCPS::SubscriptionInstance_rch& instance,
+                                  bool& just_registered,
+                                  bool& filtered)
+  {
+    DeserializedSample& ds = static_cast<DeserializedSample&>(job);
+    if (ds.data_) {
+      filter_and_store(OPENDDS_MOVE_NS::move(ds.data_), ds.publication_handle_, ds.sample_.header_,
+                       instance, just_registered, filtered, false);
+    }
   }
 
   virtual void dispose_unregister(const OpenDDS::DCPS::ReceivedDataSample& sample,
@@ -1262,11 +1403,18 @@ protected:
     const typename ReverseInstanceMap::iterator pos = reverse_instance_map_.find(handle);
     if (pos != reverse_instance_map_.end()) {
       remove_from_lookup_maps(handle);
+      instance_index_.erase(instance_key(pos->second->first));
       instance_map_.erase(pos->second);
       reverse_instance_map_.erase(pos);
     }
   }
 
+  virtual size_t sample_footprint() const
+  {
+    return sizeof(OpenDDS::DCPS::ReceivedDataElementWithType<MessageTypeWithAllocator>)
+      + sizeof(MessageTypeWithAllocator);
+  }
+
   virtual void state_updated_i(DDS::InstanceHandle_t handle)
   {
     const typename SubscriptionInstanceMapType::iterator pos = instances_.find(handle);
@@ -1281,6 +1429,290 @@ private:
   /// change the sample before dds_demarshal deserializes into it
   void dynamic_hook(MessageType&) {}
 
+  /// Read the encapsulation header, if the sample has one, and set the
+  /// encoding of ser.  Returns false if the sample can't be deserialized,
+  /// which is logged unless quiet is true.
+  bool read_encapsulation(const OpenDDS::DCPS::DataSampleHeader& header,
+                          OpenDDS::DCPS::Serializer& ser,
+                          bool quiet = false)
+  {
+    if (!header.cdr_encapsulation_) {
+      return true;
+    }
+
+    EncapsulationHeader encap;
+    if (!(ser >> encap)) {
+      if (!quiet && DCPS_debug_level > 0) {
+        ACE_ERROR((LM_ERROR, ACE_TEXT("(%P|%t) ERROR ")
+          ACE_TEXT("%CDataReaderImpl::dds_demarshal: ")
+          ACE_TEXT("deserialization of encapsulation header failed.\n"),
+          TraitsType::type_name()));
+      }
+      return false;
+    }
+    Encoding encoding;
+    if (!to_encoding(encoding, encap, type_support_->base_extensibility())) {
+      if (!quiet && log_level >= LogLevel::Error) {
+        ACE_ERROR((LM_ERROR,
+                   "(%P|%t) ERROR: %CDataReaderImpl::dds_demarshal: "
+                   "to_encoding failed writer %C reader %C\n",
+                   LogGuid(header.publication_id_).c_str(),
+                   LogGuid(subscription_id()).c_str()));
+      }
+      return false;
+    }
+
+    if (decoding_modes_.find(encoding.kind()) == decoding_modes_.end()) {
+      if (!quiet && DCPS_debug_level >= 1) {
+        ACE_DEBUG((LM_WARNING, ACE_TEXT("(%P|%t) WARNING ")
+          ACE_TEXT("%CDataReaderImpl::dds_demarshal: ")
+          ACE_TEXT("Encoding kind %C of the received sample does not ")
+          ACE_TEXT("match the ones specified by DataReader.\n"),
+          TraitsType::type_name(),
+          Encoding::kind_to_string(encoding.kind()).c_str()));
+      }
+      return false;
+    }
+    if (DCPS_debug_level >= 8) {
+      ACE_DEBUG((LM_DEBUG, ACE_TEXT("(%P|%t) ")
+        ACE_TEXT("%CDataReaderImpl::dds_demarshal: ")
+        ACE_TEXT("Deserializing with encoding kind %C.\n"),
+        TraitsType::type_name(),
+        Encoding::kind_to_string(encoding.kind()).c_str()));
+    }
+
+    ser.encoding(encoding);
+    return true;
+  }
+
+  bool deserialize(OpenDDS::DCPS::Serializer& ser,
+                   MessageTypeWithAllocator& data,
+                   bool key_only_marshaling)
+  {
+    bool ser_ret = true;
+    if (key_only_marshaling) {
+      ser_ret = ser >> OpenDDS::DCPS::KeyOnly<MessageType>(data);
+    } else {
+      ser_ret = ser >> data;
+    }
+    if (!ser_ret) {
+      if (ser.get_construction_status() != Serializer::ConstructionSuccessful) {
+        if (DCPS_debug_level > 1) {
+          ACE_DEBUG((LM_WARNING, ACE_TEXT("(%P|%t) %CDataReaderImpl::dds_demarshal ")
+                     ACE_TEXT("object construction failure, dropping sample.\n"),
+                     TraitsType::type_name()));
+        }
+      } else {
+        if (DCPS_debug_level > 0) {
+          ACE_ERROR((LM_ERROR, ACE_TEXT("(%P|%t) ERROR %CDataReaderImpl::dds_demarshal ")
+                    ACE_TEXT("deserialization failed, dropping sample.\n"),
+                    TraitsType::type_name()));
+        }
+      }
+      return false;
+    }
+    return true;
+  }
+
+  /// Apply the content filter while the transport is delivering the sample,
+  /// so that samples that don't match aren't copied for the other readers on
+  /// the DataLink, queued, or handed to the deserialization threads.  Samples
+  /// that are part of a coherent set are left to data_received() since they
+  /// count towards the set, and so are samples that can't be decoded so that
+  /// it can report them.
+  virtual bool drop_received(const OpenDDS::DCPS::ReceivedDataSample& sample)
+  {
+#ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
+    const OpenDDS::DCPS::DataSampleHeader& header = sample.header_;
+    if (!header.valid_data() || header.key_fields_only_ || header.content_filter_
+        || header.coherent_change_ || !sample.has_data() || marshal_skip_serialize_) {
+      return false;
+    }
+
+    ACE_Guard<ACE_Thread_Mutex> guard(content_filtered_topic_mutex_);
+    if (!content_filtered_topic_) {
+      return false;
+    }
+    const Encoding encoding(
+      header.cdr_encapsulation_ ? Encoding::KIND_XCDR1 : Encoding::KIND_UNALIGNED_CDR,
+      static_cast<Endianness>(header.byte_order_));
+    Message_Block_Ptr payload(sample.data(&mb_alloc_));
+    OpenDDS::DCPS::Serializer ser(payload.get(), encoding);
+    if (!read_encapsulation(header, ser, true)) {
+      return false;
+    }
+    // Taken before the filter is evaluated so that a change of parameters
+    // while it is being evaluated invalidates the result.
+    const ACE_UINT32 generation = content_filtered_topic_->parameters_generation();
+    try {
+      if (content_filtered_topic_->filter(payload.get(), ser.encoding(), true)) {
+        early_filter_writer_ = header.publication_id_;
+        early_filter_sequence_ = header.sequence_;
+        early_filter_generation_ = generation;
+        return false;
+      }
+    } catch (const std::runtime_error&) {
+      // Try again once the sample is deserialized.
+      return false;
+    }
+    guard.release();
+
+    early_filtered(sample);
+    return true;
+#else
+    ACE_UNUSED_ARG(sample);
+    return false;
+#endif
+  }
+
+  /// Apply the content filter to a sample that hasn't been deserialized yet.
+  /// payload is past the encapsulation header read by read_encapsulation
+  /// and encoding is the one it gave.  Returns false if the filter doesn't
+  /// match, and sets filter_applied if the filter could be evaluated so that
+  /// filter_and_store can skip it.
+  bool filter_serialized(const OpenDDS::DCPS::DataSampleHeader& header,
+                         ACE_Message_Block& payload,
+                         const Encoding& encoding,
+                         bool& filter_applied)
+  {
+#ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
+    if (header.content_filter_ || !header.valid_data()) {
+      return true;
+    }
+    ACE_Guard<ACE_Thread_Mutex> guard(content_filtered_topic_mutex_);
+    if (!content_filtered_topic_) {
+      return true;
+    }
+    if (early_filter_matched_i(header)) {
+      filter_applied = true;
+      return true;
+    }
+    try {
+      const bool match = content_filtered_topic_->filter(&payload, encoding, true);
+      filter_applied = true;
+      return match;
+    } catch (const std::runtime_error&) {
+      // Try again once the sample is deserialized.
+      return true;
+    }
+#else
+    ACE_UNUSED_ARG(header);
+    ACE_UNUSED_ARG(payload);
+    ACE_UNUSED_ARG(encoding);
+    ACE_UNUSED_ARG(filter_applied);
+    return true;
+#endif
+  }
+
+  /// Apply the content filter, if any, to a deserialized sample and store it.
+  void filter_and_store(unique_ptr<MessageTypeWithAllocator> data,
+                        DDS::InstanceHandle_t publication_handle,
+                        const OpenDDS::DCPS::DataSampleHeader& header,
+                        OpenDDS::DCPS::SubscriptionInstance_rch& instance,
+                        bool& just_registered,
+                        bool& filtered,
+                        bool key_only_marshaling,
+                        bool filter_applied = false)
+  {
+#ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
+    /*
+     * If header.content_filter_ is true, the writer has already
+     * filtered.
+     */
+    if (!header.content_filter_ && !filter_applied) {
+      ACE_Guard<ACE_Thread_Mutex> guard(content_filtered_topic_mutex_);
+      if (content_filtered_topic_ && !early_filter_matched_i(header)) {
+        const bool sample_only_has_key_fields = !header.valid_data();
+        if (key_only_marshaling != sample_only_has_key_fields) {
+          if (DCPS_debug_level > 0) {
+            ACE_ERROR((LM_ERROR, ACE_TEXT("(%P|%t) ERROR ")
+              ACE_TEXT("%CDataReaderImpl::dds_demarshal: ")
+              ACE_TEXT("Mismatch between the key only and valid data properties ")
+              ACE_TEXT("of a %C message of a content filtered topic!\n"),
+              TraitsType::type_name(),
+              to_string(static_cast<MessageId>(header.message_id_))));
+          }
+          filtered = true;
+          return;
+        }
+        const MessageType& type = static_cast<MessageType&>(*data);
+        if (!content_filtered_topic_->filter(type, sample_only_has_key_fields)) {
+          filtered = true;
+          return;
+        }
+      }
+    }
+#else
+    ACE_UNUSED_ARG(key_only_marshaling);
+    ACE_UNUSED_ARG(filter_applied);
+#endif
+
+    store_instance_data(OPENDDS_MOVE_NS::move(data), publication_handle, header, instance, just_registered, filtered);
+  }
+
+  /// True if a sample with this header can be stored without deserializing it.
+  /// Anything that looks at the sample before it's read or taken (content
+  /// filtering, access control) requires it to be deserialized on arrival.
+  bool can_defer_deserialization(const OpenDDS::DCPS::DataSampleHeader& header)
+  {
+    if ((!lazy_deserialization_ && !spill_budget_) || !header.valid_data()) {
+      return false;
+    }
+#if OPENDDS_CONFIG_SECURITY
+    if (security_config_) {
+      return false;
+    }
+#endif
+#ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
+    if (!header.content_filter_) {
+      ACE_Guard<ACE_Thread_Mutex> guard(content_filtered_topic_mutex_);
+      if (content_filtered_topic_) {
+        return false;
+      }
+    }
+#endif
+    return true;
+  }
+
+  /// Once the estimated memory used by the reader's samples reaches
+  /// spill_budget_, write the payload to spill_log_ instead of keeping it in
+  /// memory.  The estimate counts the fixed size of each sample and the
+  /// average size of the payloads received so far for each sample that
+  /// isn't in spill_log_.
+  bool spill_payload(const ACE_Message_Block& payload,
+                     OpenDDS::DCPS::SpillLog::Record& record)
+  {
+    if (!spill_budget_) {
+      return false;
+    }
+    spill_payload_bytes_ += payload.total_length();
+    ++spill_payloads_;
+
+    const size_t samples = static_cast<size_t>(total_samples());
+    const size_t spilled = spill_log_ ? spill_log_->live_records() : 0;
+    const ACE_UINT64 estimate = static_cast<ACE_UINT64>(samples) * sample_footprint()
+      + static_cast<ACE_UINT64>(samples > spilled ? samples - spilled : 0) * (spill_payload_bytes_ / spill_payloads_);
+    if (estimate < spill_budget_) {
+      return false;
+    }
+
+    if (!spill_log_) {
+      spill_log_ = OpenDDS::DCPS::make_rch<OpenDDS::DCPS::SpillLog>(TheServiceParticipant->spill_directory());
+    }
+    return spill_log_->append(payload, record);
+  }
+
+  /// Copy the unread part of payload so that the transport's receive buffers
+  /// aren't held by samples waiting in the reader.
+  static ACE_Message_Block* copy_remaining(const ACE_Message_Block& payload)
+  {
+    ACE_Message_Block* const copy = new ACE_Message_Block(payload.total_length());
+    for (const ACE_Message_Block* mb = &payload; mb; mb = mb->cont()) {
+      copy->copy(mb->rd_ptr(), mb->length());
+    }
+    return copy;
+  }
+
   bool store_instance_data_check(unique_ptr<MessageTypeWithAllocator>& instance_data,
                                  DDS::InstanceHandle_t publication_handle,
                                  const OpenDDS::DCPS::DataSampleHeader& header,
@@ -1404,7 +1836,7 @@ private:
         results.insert_sample(item, &inst->rcvd_samples_, inst, ++i);
 
         const ValueDispatcher* vd = get_value_dispatcher();
-        if (observer && item->registered_data_ && vd) {
+        if (observer && item->registered_data_ && vd && item->materialize()) {
           Observer::Sample s(handle, inst->instance_state_->instance_state(), *item, *vd);
           observer->on_sample_read(this, s);
         }
@@ -1412,10 +1844,12 @@ private:
     }
 #ifndef OPENDDS_NO_OBJECT_MODEL_PROFILE
   } else {
-    const RakeData item = group_coherent_ordered_data_.get_data();
-    results.insert_sample(item.rde_, item.rdel_, item.si_, item.index_in_instance_);
+    RakeData item = RakeData();
+    if (group_coherent_ordered_data_.get_data(item)) {
+      results.insert_sample(item.rde_, item.rdel_, item.si_, item.index_in_instance_);
+    }
     const ValueDispatcher* vd = get_value_dispatcher();
-    if (observer && item.rde_->registered_data_ && vd) {
+    if (observer && item.rde_ && item.rde_->registered_data_ && vd && item.rde_->materialize()) {
       typename InstanceMap::iterator i = instance_map_.begin();
       const DDS::InstanceHandle_t handle = (i != instance_map_.end()) ? i->second : DDS::HANDLE_NIL;
       Observer::Sample s(handle, item.si_->instance_state_->instance_state(), *item.rde_, *vd);
@@ -1491,7 +1925,7 @@ DDS::ReturnCode_t take_i(MessageSequenceType& received_data,
         results.insert_sample(item, &inst->rcvd_samples_, inst, ++i);
 
         const ValueDispatcher* vd = get_value_dispatcher();
-        if (observer && item->registered_data_ && vd) {
+        if (observer && item->registered_data_ && vd && item->materialize()) {
           Observer::Sample s(handle, inst->instance_state_->instance_state(), *item, *vd);
           observer->on_sample_taken(this, s);
         }
@@ -1499,8 +1933,10 @@ DDS::ReturnCode_t take_i(MessageSequenceType& received_data,
     }
 #ifndef OPENDDS_NO_OBJECT_MODEL_PROFILE
   } else {
-    const RakeData item = group_coherent_ordered_data_.get_data();
-    results.insert_sample(item.rde_, item.rdel_, item.si_, item.index_in_instance_);
+    RakeData item = RakeData();
+    if (group_coherent_ordered_data_.get_data(item)) {
+      results.insert_sample(item.rde_, item.rdel_, item.si_, item.index_in_instance_);
+    }
   }
 #endif
 
@@ -1550,7 +1986,7 @@ DDS::ReturnCode_t read_instance_i(MessageSequenceType& received_data,
          item = inst->rcvd_samples_.get_next_match(sample_states, item)) {
       results.insert_sample(item, &inst->rcvd_samples_, inst, ++i);
       const ValueDispatcher* vd = get_value_dispatcher();
-      if (observer && item->registered_data_ && vd) {
+      if (observer && item->registered_data_ && vd && item->materialize()) {
         Observer::Sample s(a_handle, inst->instance_state_->instance_state(), *item, *vd);
         observer->on_sample_read(this, s);
       }
@@ -1617,7 +2053,7 @@ DDS::ReturnCode_t take_instance_i(MessageSequenceType& received_data,
          item = inst->rcvd_samples_.get_next_match(sample_states, item)) {
       results.insert_sample(item, &inst->rcvd_samples_, inst, ++i);
       const ValueDispatcher* vd = get_value_dispatcher();
-      if (observer && item->registered_data_ && vd) {
+      if (observer && item->registered_data_ && vd && item->materialize()) {
         Observer::Sample s(a_handle, inst->instance_state_->instance_state(), *item, *vd);
         observer->on_sample_taken(this, s);
       }
@@ -1763,9 +2199,10 @@ void store_instance_data(unique_ptr<MessageTypeWithAllocator> instance_data,
   //!!! caller should already have the sample_lock_
   //We will unlock it before calling into listeners
 
-  typename InstanceMap::const_iterator const it = instance_map_.find(*instance_data);
+  const InstanceKey key = instance_key(*instance_data);
+  const typename InstanceIndex::const_iterator it = instance_index_.find(key);
 
-  if (it == instance_map_.end()) {
+  if (it == instance_index_.end()) {
     if (is_dispose_msg || is_unregister_msg) {
       return;
     }
@@ -1919,12 +2356,13 @@ void store_instance_data(unique_ptr<MessageTypeWithAllocator> instance_data,
       }
       return;
     }
+    instance_index_.insert(std::make_pair(InstanceKey(bpair.first->first, key.hash_), bpair.first));
     reverse_instance_map_[handle] = bpair.first;
   }
   else
   {
     just_registered = false;
-    handle = it->second;
+    handle = it->second->second;
   }
 
   if (header.message_id_ != OpenDDS::DCPS::INSTANCE_REGISTRATION)
@@ -2103,7 +2541,7 @@ void finish_store_instance_data(unique_ptr<MessageTypeWithAllocator> instance_da
     instance_ptr->instance_state_->data_was_received(header.publication_id_);
 
     const Observer_rch sample_received_observer = get_observer(Observer::e_SAMPLE_RECEIVED);
-    if (sample_received_observer && instance_data && vd) {
+    if (sample_received_observer && instance_data && vd && instance_data->materialize()) {
       Observer::Sample s(instance_ptr->instance_handle_, instance_ptr->instance_state_->instance_state(), timestamp, header.sequence_, instance_data->message(), *vd);
       sample_received_observer->on_sample_received(this, s);
     }
@@ -2185,12 +2623,15 @@ void finish_store_instance_data(unique_ptr<MessageTypeWithAllocator> instance_da
         listener_for (DDS::DATA_AVAILABLE_STATUS);
 
       if (!CORBA::is_nil(listener.in())) {
-        if (!is_bit()) {
+        if (dispatch_data_available()) {
+          // Called on the participant's listener threads.
+        } else if (!is_bit()) {
           set_status_changed_flag(DDS::DATA_AVAILABLE_STATUS, false);
           sub->set_status_changed_flag(DDS::DATA_ON_READERS_STATUS, false);
           sub.reset();
           ACE_GUARD(typename DataReaderImpl::Reverse_Lock_t, unlock_guard, reverse_sample_lock_);
           listener->on_data_available(this);
+          data_available_called();
         } else {
           TheServiceParticipant->job_queue()->enqueue(make_rch<OnDataAvailable>(listener, rchandle_from(static_cast<DataReaderImpl*>(this)), true, true, true));
         }
@@ -2464,9 +2905,18 @@ unique_ptr<DataAllocator>& data_allocator() { return data_allocator_; }
 
 unique_ptr<DataAllocator> data_allocator_;
 
+/// Ordered by key so read/take_next_instance can visit instances in order.
 InstanceMap instance_map_;
+/// Hash index into instance_map_ used for lookups by key.
+InstanceIndex instance_index_;
 ReverseInstanceMap reverse_instance_map_;
 
+static InstanceKey instance_key(const MessageType& sample)
+{
+  // key_hash agrees with LessThanType, so keys it finds equal share a hash.
+  return InstanceKey(sample, TraitsType::key_hash(sample));
+}
+
 typedef DCPS::PmfSporadicTask<DataReaderImpl_T> DRISporadicTask;
 
 RcHandle<DRISporadicTask> filter_delayed_sample_task_;
@@ -2492,6 +2942,15 @@ typedef OPENDDS_MULTIMAP(MonotonicTimePoint, DDS::InstanceHandle_t) FilterDelaye
 FilterDelayedSampleQueue filter_delayed_sample_queue_;
 
 bool marshal_skip_serialize_;
+bool lazy_deserialization_;
+bool has_key_;
+/// Estimated bytes of samples held before payloads go to spill_log_, 0 if
+/// spilling is disabled.
+ACE_UINT64 spill_budget_;
+/// Payloads seen by spill_payload(), for their average size.
+ACE_UINT64 spill_payload_bytes_;
+ACE_UINT64 spill_payloads_;
+OpenDDS::DCPS::SpillLog_rch spill_log_;
 
 };
 
@@ -245,11 +245,20 @@ DataWriterImpl::add_association(const ReaderAssociation& reader,
 
   {
     ACE_GUARD(ACE_Thread_Mutex, reader_info_guard, this->reader_info_lock_);
-    reader_info_.insert(std::make_pair(reader.readerId,
-                                       ReaderInfo(reader.filterClassName,
-                                                  publisher_content_filter_ ? reader.filterExpression.in() : "",
-                                                  reader.exprParams, participant_servant_,
-                                                  reader.readerQos.durability.kind > DDS::VOLATILE_DURABILITY_QOS)));
+    const std::pair<RepoIdToReaderInfoMap::iterator, bool> inserted =
+      reader_info_.insert(std::make_pair(reader.readerId,
+                                         ReaderInfo(reader.filterClassName,
+                                                    publisher_content_filter_ ? reader.filterExpression.in() : "",
+                                                    reader.exprParams, participant_servant_,
+                                                    reader.readerQos.durability.kind > DDS::VOLATILE_DURABILITY_QOS)));
+#ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
+    const ReaderInfo& ri = inserted.first->second;
+    if (inserted.second && !ri.eval_.is_nil()) {
+      filter_index_.insert(reader.readerId, ri.eval_, ri.expression_params_);
+    }
+#else
+    ACE_UNUSED_ARG(inserted);
+#endif
   }
 
   if (DCPS_debug_level > 4) {
@@ -432,7 +441,7 @@ DataWriterImpl::association_complete_i(const GUID_t& remote_id)
     if (!participant)
       return;
 
-    data_container_->add_reader_acks(remote_id, get_max_sn());
+    data_container_->add_reader_acks(remote_id);
 
     const DDS::InstanceHandle_t handle = participant->assign_handle(remote_id);
 
@@ -479,7 +488,7 @@ DataWriterImpl::association_complete_i(const GUID_t& remote_id)
 
     notify_status_condition();
   } else {
-    data_container_->add_reader_acks(remote_id, get_max_sn());
+    data_container_->add_reader_acks(remote_id);
   }
 
   // Support DURABILITY QoS
@@ -623,6 +632,9 @@ DataWriterImpl::remove_associations(const ReaderIdSeq & readers,
 
       ACE_GUARD(ACE_Thread_Mutex, reader_info_guard, this->reader_info_lock_);
       reader_info_.erase(readers[i]);
+#ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
+      filter_index_.remove(readers[i]);
+#endif
       //else reader is already removed which indicates remove_association()
       //is called multiple times.
     }
@@ -910,6 +922,9 @@ DataWriterImpl::update_subscription_params(const GUID_t& readerId,
 
   if (iter != reader_info_.end()) {
     iter->second.expression_params_ = params;
+    if (!iter->second.eval_.is_nil()) {
+      filter_index_.insert(readerId, iter->second.eval_, params);
+    }
 
   } else if (DCPS_debug_level > 4 &&
              publisher_content_filter_) {
@@ -1918,7 +1933,7 @@ DataWriterImpl::write(Message_Block_Ptr data,
 
   element->set_filter_out(filter_out_var._retn()); // ownership passed to element
 
-  ret = this->data_container_->enqueue(element, handle);
+  ret = this->data_container_->enqueue(element);
 
   if (ret != DDS::RETCODE_OK) {
     data_container_->release_buffer(element);
@@ -1978,17 +1993,20 @@ void
 DataWriterImpl::track_sequence_number(GUIDSeq* filter_out)
 {
   const SequenceNumber sn = get_max_sn();
-  ACE_GUARD(ACE_Thread_Mutex, reader_info_guard, this->reader_info_lock_);
 
 #ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
-  // Track individual expected sequence numbers in ReaderInfo
+  // Track individual expected sequence numbers in ReaderInfo.  The set of
+  // excluded readers only depends on filter_out, so build it before taking
+  // reader_info_lock_ to keep that critical section short.
   RepoIdSet excluded;
 
-  if (filter_out && !reader_info_.empty()) {
+  if (filter_out && filter_out->length()) {
     const GUID_t* buf = filter_out->get_buffer();
     excluded.insert(buf, buf + filter_out->length());
   }
 
+  ACE_GUARD(ACE_Thread_Mutex, reader_info_guard, this->reader_info_lock_);
+
   for (RepoIdToReaderInfoMap::iterator iter = reader_info_.begin(),
        end = reader_info_.end(); iter != end; ++iter) {
     // If not excluding this reader, update expected sequence
@@ -1999,6 +2017,7 @@ DataWriterImpl::track_sequence_number(GUIDSeq* filter_out)
 
 #else
   ACE_UNUSED_ARG(filter_out);
+  ACE_GUARD(ACE_Thread_Mutex, reader_info_guard, this->reader_info_lock_);
   for (RepoIdToReaderInfoMap::iterator iter = reader_info_.begin(),
        end = reader_info_.end(); iter != end; ++iter) {
     iter->second.expected_sequence_ = sn;
@@ -2988,6 +3007,35 @@ DDS::ReturnCode_t DataWriterImpl::dispose_w_timestamp(
 }
 
 ACE_Message_Block* DataWriterImpl::serialize_sample(const Sample& sample)
+{
+  if (!skip_serialize_ && !sample.key_only() && !encoding_mode_.bound()) {
+    // Try to avoid walking the sample twice by serializing it into a buffer
+    // that's probably big enough.
+    return serialized_size_hint_.serialize(HintedSample(*this, sample));
+  }
+  return serialize_sample_i(sample, encoding_mode_.buffer_size(sample), true);
+}
+
+ACE_Message_Block* DataWriterImpl::HintedSample::serialize(size_t buffer_size, bool log_errors) const
+{
+  return writer_.serialize_sample_i(sample_, buffer_size, log_errors);
+}
+
+size_t DataWriterImpl::HintedSample::exact_size() const
+{
+  return writer_.encoding_mode_.buffer_size(sample_);
+}
+
+void DataWriterImpl::HintedSample::serialize_failed() const
+{
+  if (log_level >= LogLevel::Error) {
+    ACE_ERROR((LM_ERROR, "(%P|%t) ERROR: DataWriterImpl::serialize_sample: "
+      "failed to serialize sample data\n"));
+  }
+}
+
+ACE_Message_Block* DataWriterImpl::serialize_sample_i(
+  const Sample& sample, size_t buffer_size, bool log_errors)
 {
   const bool encapsulated = cdr_encapsulation();
   const Encoding& encoding = encoding_mode_.encoding();
@@ -2999,7 +3047,7 @@ ACE_Message_Block* DataWriterImpl::serialize_sample(const Sample& sample)
   if (sample.key_only() && !skip_serialize_) {
     ACE_NEW_RETURN(tmp_mb,
       ACE_Message_Block(
-        encoding_mode_.buffer_size(sample),
+        buffer_size,
         ACE_Message_Block::MB_DATA,
         0, // cont
         0, // data
@@ -3011,7 +3059,7 @@ ACE_Message_Block* DataWriterImpl::serialize_sample(const Sample& sample)
       static_cast<ACE_Message_Block*>(
         mb_allocator_->malloc(sizeof(ACE_Message_Block))),
       ACE_Message_Block(
-        encoding_mode_.buffer_size(sample),
+        buffer_size,
         ACE_Message_Block::MB_DATA,
         0, // cont
         0, // data
@@ -3028,8 +3076,8 @@ ACE_Message_Block* DataWriterImpl::serialize_sample(const Sample& sample)
 
   if (skip_serialize_) {
     if (!sample.to_message_block(*mb)) {
-      if (log_level >= LogLevel::Error) {
-        ACE_ERROR((LM_ERROR, "(%P|%t) ERROR: DataWriterImpl::serialize_sample: "
+      if (log_errors && log_level >= LogLevel::Error) {
+        ACE_ERROR((LM_ERROR, "(%P|%t) ERROR: DataWriterImpl::serialize_sample_i: "
                    "to_message_block failed\n"));
       }
       return 0;
@@ -3043,23 +3091,23 @@ ACE_Message_Block* DataWriterImpl::serialize_sample(const Sample& sample)
         return 0;
       }
       if (!(serializer << encap)) {
-        if (log_level >= LogLevel::Error) {
-          ACE_ERROR((LM_ERROR, "(%P|%t) ERROR: DataWriterImpl::serialize_sample: "
+        if (log_errors && log_level >= LogLevel::Error) {
+          ACE_ERROR((LM_ERROR, "(%P|%t) ERROR: DataWriterImpl::serialize_sample_i: "
             "failed to serialize data encapsulation header\n"));
         }
         return 0;
       }
     }
     if (!sample.serialize(serializer)) {
-      if (log_level >= LogLevel::Error) {
-        ACE_ERROR((LM_ERROR, "(%P|%t) ERROR: DataWriterImpl::serialize_sample: "
+      if (log_errors && log_level >= LogLevel::Error) {
+        ACE_ERROR((LM_ERROR, "(%P|%t) ERROR: DataWriterImpl::serialize_sample_i: "
           "failed to serialize sample data\n"));
       }
       return 0;
     }
     if (encapsulated && !EncapsulationHeader::set_encapsulation_options(mb)) {
-      if (log_level >= LogLevel::Error) {
-        ACE_ERROR((LM_ERROR, "(%P|%t) ERROR: DataWriterImpl::serialize_sample: "
+      if (log_errors && log_level >= LogLevel::Error) {
+        ACE_ERROR((LM_ERROR, "(%P|%t) ERROR: DataWriterImpl::serialize_sample_i: "
           "set_encapsulation_options failed\n"));
       }
       return 0;
@@ -3217,17 +3265,9 @@ DDS::ReturnCode_t DataWriterImpl::write_w_timestamp(
 #ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
   if (publisher_content_filter_) {
     ACE_GUARD_RETURN(ACE_Thread_Mutex, reader_info_guard, reader_info_lock_, DDS::RETCODE_ERROR);
-    for (RepoIdToReaderInfoMap::iterator iter = reader_info_.begin(),
-         end = reader_info_.end(); iter != end; ++iter) {
-      const ReaderInfo& ri = iter->second;
-      if (!ri.eval_.is_nil()) {
-        if (!filter_out.ptr()) {
-          filter_out = new OpenDDS::DCPS::GUIDSeq;
-        }
-        if (!sample.eval(*ri.eval_, ri.expression_params_)) {
-          push_back(filter_out.inout(), iter->first);
-        }
-      }
+    if (!filter_index_.empty()) {
+      filter_out = new OpenDDS::DCPS::GUIDSeq;
+      filter_index_.filter(sample, filter_out.inout());
     }
   }
 #endif
@@ -13,12 +13,14 @@
 #include "DataWriterCallbacks.h"
 #include "Definitions.h"
 #include "EncapsulationHeader.h"
+#include "FilterIndex.h"
 #include "GuidUtils.h"
 #include "MessageTracker.h"
 #include "Message_Block_Ptr.h"
 #include "PoolAllocator.h"
 #include "RcEventHandler.h"
 #include "Sample.h"
+#include "SerializedSizeHint.h"
 #include "SporadicTask.h"
 #include "TimeTypes.h"
 #include "Time_Helper.h"
@@ -586,6 +588,11 @@ protected:
   typedef OPENDDS_MAP_CMP(GUID_t, ReaderInfo, GUID_tKeyLessThan) RepoIdToReaderInfoMap;
   RepoIdToReaderInfoMap reader_info_;
 
+#ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
+  /// Filters of the readers in reader_info_, also protected by reader_info_lock_.
+  FilterIndex filter_index_;
+#endif
+
   struct AckCustomization {
     GUIDSeq customized_;
     AckToken& token_;
@@ -652,6 +659,29 @@ protected:
     SerializedSizeBound key_only_bound_;
   } encoding_mode_;
 
+  SerializedSizeHint serialized_size_hint_;
+
+  /// How serialized_size_hint_ serializes a sample.
+  class HintedSample {
+  public:
+    HintedSample(DataWriterImpl& writer, const Sample& sample)
+      : writer_(writer)
+      , sample_(sample)
+    {
+    }
+
+    ACE_Message_Block* serialize(size_t buffer_size, bool log_errors) const;
+    size_t exact_size() const;
+    void serialize_failed() const;
+
+  private:
+    DataWriterImpl& writer_;
+    const Sample& sample_;
+  };
+  friend class HintedSample;
+
+  ACE_Message_Block* serialize_sample_i(const Sample& sample, size_t buffer_size, bool log_errors);
+
   TypeSupportImpl* get_type_support() const
   {
     return type_support_;
@@ -67,6 +67,13 @@ public:
    */
   void shutdown(bool immediate = false, EventQueue* pending = 0);
 
+  /// True if the calling thread is one of the threads of this DispatchService,
+  /// which shutdown can't wait for.
+  bool on_thread() const
+  {
+    return pool_.contains(ACE_Thread::self());
+  }
+
   /**
    * Dispatch an event
    * @param fun the function pointer to dispatch
@@ -89,6 +89,38 @@ OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 namespace OpenDDS {
 namespace DCPS {
 
+namespace {
+  /// Shuts down a dispatcher from the job queue when the thread that is
+  /// done with it is one of its own threads.
+  class DispatcherShutdown : public Job {
+  public:
+    explicit DispatcherShutdown(const ServiceEventDispatcher_rch& dispatcher)
+      : dispatcher_(dispatcher)
+    {}
+
+    void execute()
+    {
+      dispatcher_->shutdown(true);
+    }
+
+  private:
+    const ServiceEventDispatcher_rch dispatcher_;
+  };
+
+  void shutdown_dispatcher(const ServiceEventDispatcher_rch& dispatcher)
+  {
+    if (!dispatcher) {
+      return;
+    }
+    const JobQueue_rch job_queue = TheServiceParticipant->job_queue();
+    if (dispatcher->on_thread() && job_queue) {
+      job_queue->enqueue(make_rch<DispatcherShutdown>(dispatcher));
+    } else {
+      dispatcher->shutdown(true);
+    }
+  }
+}
+
 //TBD - add check for enabled in most methods.
 //      Currently this is not needed because auto_enable_created_entities
 //      cannot be false.
@@ -115,6 +147,14 @@ DomainParticipantImpl::DomainParticipantImpl(
   , handle_waiters_(handle_protector_)
   , participant_handles_(handle_generator)
   , pub_id_gen_(dp_id_)
+  , listener_max_pending_(TheServiceParticipant->listener_max_pending())
+  , listener_pending_(0)
+  , deserialize_dispatcher_(TheServiceParticipant->deserialize_threads() ?
+                            make_rch<ServiceEventDispatcher>(TheServiceParticipant->deserialize_threads()) :
+                            ServiceEventDispatcher_rch())
+  , delivery_dispatcher_(TheServiceParticipant->queued_delivery() || TheServiceParticipant->deserialize_threads() ?
+                         make_rch<ServiceEventDispatcher>(1) :
+                         ServiceEventDispatcher_rch())
   , automatic_liveliness_timer_(make_rch<AutomaticLivelinessTimer>(ref(*this)))
   , automatic_liveliness_task_(make_rch<AutomaticLivelinessTask>(
     TheServiceParticipant->time_source(),
@@ -131,10 +171,18 @@ DomainParticipantImpl::DomainParticipantImpl(
   (void) this->set_listener(a_listener, mask);
   monitor_.reset(TheServiceParticipant->monitor_factory_->create_dp_monitor(this));
   type_lookup_service_ = make_rch<XTypes::TypeLookupService>();
+  start_listener_dispatcher();
 }
 
 DomainParticipantImpl::~DomainParticipantImpl()
 {
+  stop_listener_dispatcher();
+  // The last reference to the participant can be released by a callback,
+  // which then runs on one of these threads.
+  shutdown_dispatcher(retired_listener_dispatcher_);
+  shutdown_dispatcher(deserialize_dispatcher_);
+  shutdown_dispatcher(delivery_dispatcher_);
+
 #if OPENDDS_CONFIG_SECURITY
   if (security_config_ && perm_handle_ != DDS::HANDLE_NIL) {
     Security::AccessControl_var access = security_config_->get_access_control();
@@ -1074,6 +1122,10 @@ DomainParticipantImpl::delete_contained_entities()
   if (disc)
     disc->fini_bit(this);
 
+  // Let callbacks that are already running finish and drop the ones that
+  // are waiting before the readers they are for are deleted.
+  stop_listener_dispatcher();
+
   RcHandle<ShutdownHandler> handler = make_rch<ShutdownHandler>(rchandle_from(this));
   TheServiceParticipant->reactor_task()->execute_or_enqueue(handler);
   if (!TheServiceParticipant->reactor_task()->on_thread()) {
@@ -1086,6 +1138,7 @@ DomainParticipantImpl::delete_contained_entities()
   Registered_Data_Types->unregister_participant(this);
 
   // the participant can now start creating new contained entities
+  start_listener_dispatcher();
   set_deleted(false);
   return handler->shutdown_result();
 }
@@ -2617,6 +2670,67 @@ bool DomainParticipantImpl::set_wait_pending_deadline(const MonotonicTimePoint&
   return result;
 }
 
+bool DomainParticipantImpl::dispatch_listener(const EventBase_rch& event)
+{
+  ACE_Guard<ACE_Thread_Mutex> guard(listener_dispatch_lock_);
+  if (!listener_dispatcher_ ||
+      (listener_max_pending_ && listener_pending_ >= listener_max_pending_)) {
+    return false;
+  }
+  if (!listener_dispatcher_->dispatch(event)) {
+    return false;
+  }
+  ++listener_pending_;
+  return true;
+}
+
+void DomainParticipantImpl::listener_dispatched()
+{
+  ACE_Guard<ACE_Thread_Mutex> guard(listener_dispatch_lock_);
+  if (listener_pending_) {
+    --listener_pending_;
+  }
+}
+
+void DomainParticipantImpl::start_listener_dispatcher()
+{
+  const DDS::UInt32 threads = TheServiceParticipant->listener_threads();
+  ACE_Guard<ACE_Thread_Mutex> guard(listener_dispatch_lock_);
+  if (threads && !listener_dispatcher_) {
+    listener_dispatcher_ = make_rch<ServiceEventDispatcher>(threads);
+  }
+}
+
+void DomainParticipantImpl::stop_listener_dispatcher()
+{
+  ServiceEventDispatcher_rch dispatchers[2];
+  {
+    ACE_Guard<ACE_Thread_Mutex> guard(listener_dispatch_lock_);
+    dispatchers[0].swap(listener_dispatcher_);
+    dispatchers[1].swap(retired_listener_dispatcher_);
+  }
+  ServiceEventDispatcher_rch retired;
+  for (size_t i = 0; i < 2; ++i) {
+    if (!dispatchers[i]) {
+      continue;
+    }
+    if (dispatchers[i]->on_thread()) {
+      // A listener callback is deleting the contained entities, so this
+      // is one of the threads that shutdown would wait for.  The callbacks
+      // already waiting still run, but they find their readers deleted.
+      // The dispatcher is shut down by the next call from another thread.
+      retired = dispatchers[i];
+    } else {
+      // Events that are still waiting are canceled, which lets their
+      // readers dispatch again once there is a new dispatcher.
+      dispatchers[i]->shutdown(true);
+    }
+  }
+  ACE_Guard<ACE_Thread_Mutex> guard(listener_dispatch_lock_);
+  retired_listener_dispatcher_ = retired;
+  listener_pending_ = 0;
+}
+
 #ifndef OPENDDS_SAFETY_PROFILE
 DDS::ReturnCode_t DomainParticipantImpl::get_dynamic_type(
   DDS::DynamicType_var& type, const DDS::BuiltinTopicKey_t& key)
@@ -17,6 +17,7 @@
 #include "PoolAllocator.h"
 #include "Recorder.h"
 #include "Replayer.h"
+#include "ServiceEventDispatcher.h"
 #include "SporadicTask.h"
 #include "TimeTypes.h"
 #include "TopicImpl.h"
@@ -422,6 +423,22 @@ public:
   bool prepare_to_delete_datawriters();
   bool set_wait_pending_deadline(const MonotonicTimePoint& deadline);
 
+  /// Hand a listener callback to the threads configured by
+  /// DCPSListenerThreads.  Returns false if there are none or if
+  /// DCPSListenerMaxPending callbacks are already waiting, in which case
+  /// the caller makes the callback itself.
+  bool dispatch_listener(const EventBase_rch& event);
+
+  /// Called by an event accepted by dispatch_listener() once it has run.
+  void listener_dispatched();
+
+  /// The threads configured by DCPSDeserializeThreads, or a nil handle.
+  ServiceEventDispatcher_rch deserialize_dispatcher() const { return deserialize_dispatcher_; }
+
+  /// The thread that delivers samples queued by DataReaders when
+  /// DCPSQueuedDelivery or DCPSDeserializeThreads is set, or a nil handle.
+  ServiceEventDispatcher_rch delivery_dispatcher() const { return delivery_dispatcher_; }
+
 #ifndef OPENDDS_SAFETY_PROFILE
   DDS::ReturnCode_t get_dynamic_type(
     DDS::DynamicType_var& type, const DDS::BuiltinTopicKey_t& key);
@@ -553,6 +570,24 @@ private:
   /// Publisher ID generator.
   RepoIdSequence pub_id_gen_;
 
+  /// Threads that make listener callbacks when DCPSListenerThreads is set.
+  ACE_Thread_Mutex listener_dispatch_lock_;
+  ServiceEventDispatcher_rch listener_dispatcher_;
+  /// Stopped from one of its own threads and not shut down yet.
+  ServiceEventDispatcher_rch retired_listener_dispatcher_;
+  const size_t listener_max_pending_;
+  size_t listener_pending_;
+
+  void start_listener_dispatcher();
+  void stop_listener_dispatcher();
+
+  /// Threads that deserialize samples when DCPSDeserializeThreads is set.
+  const ServiceEventDispatcher_rch deserialize_dispatcher_;
+
+  /// Thread that delivers queued samples when DCPSQueuedDelivery or
+  /// DCPSDeserializeThreads is set.
+  const ServiceEventDispatcher_rch delivery_dispatcher_;
+
 #ifndef OPENDDS_NO_CONTENT_SUBSCRIPTION_PROFILE
   ACE_Thread_Mutex filter_cache_lock_;
   OPENDDS_MAP(OPENDDS_STRING, RcHandle<FilterEvaluator> ) filter_cache_;
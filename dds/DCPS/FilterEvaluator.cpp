@@ -43,7 +43,6 @@ FilterEvaluator::DeserializedForEval::~DeserializedForEval()
 
 FilterEvaluator::FilterEvaluator(const char* filter, bool allowOrderBy)
   : extended_grammar_(false)
-  , filter_root_(0)
   , number_parameters_(0)
 {
   const char* out = filter + std::strlen(filter);
@@ -61,58 +60,18 @@ FilterEvaluator::FilterEvaluator(const char* filter, bool allowOrderBy)
     } else if (found_order_by && iter->TypeMatches<FieldName>()) {
       order_bys_.push_back(toString(iter));
     } else {
-      filter_root_ = walkAst(iter);
+      compile(iter);
     }
   }
 }
 
 FilterEvaluator::FilterEvaluator(const AstNodeWrapper& yardNode)
   : extended_grammar_(false)
-  , filter_root_(walkAst(yardNode))
   , number_parameters_(0)
 {
+  compile(yardNode);
 }
 
-class FilterEvaluator::EvalNode {
-public:
-  void addChild(EvalNode* n)
-  {
-    children_.push_back(n);
-  }
-
-  virtual ~EvalNode()
-  {
-    std::for_each(children_.begin(), children_.end(), deleteChild);
-  }
-
-  virtual bool has_non_key_fields(const TypeSupportImpl& ts) const
-  {
-    for (OPENDDS_VECTOR(EvalNode*)::const_iterator i = children_.begin(); i != children_.end(); ++i) {
-      EvalNode* child = *i;
-      if (child->has_non_key_fields(ts)) {
-        return true;
-      }
-    }
-    return false;
-  }
-
-  virtual Value eval(DataForEval& data) = 0;
-
-private:
-  static void deleteChild(EvalNode* child)
-  {
-    delete child;
-  }
-
-protected:
-  OPENDDS_VECTOR(EvalNode*) children_;
-};
-
-class FilterEvaluator::Operand : public FilterEvaluator::EvalNode {
-public:
-  virtual bool isParameter() const { return false; }
-};
-
 Value
 FilterEvaluator::DeserializedForEval::lookup(const char* field) const
 {
@@ -122,24 +81,24 @@ FilterEvaluator::DeserializedForEval::lookup(const char* field) const
 FilterEvaluator::SerializedForEval::SerializedForEval(ACE_Message_Block* data,
                                                       TypeSupportImpl& type_support,
                                                       const DDS::StringSeq& params,
-                                                      Encoding encoding)
+                                                      Encoding encoding,
+                                                      const OPENDDS_VECTOR(OPENDDS_STRING)& fields,
+                                                      bool header_read)
   : DataForEval(type_support.getMetaStructForType(), params)
+  , fields_(fields)
+  , fields_read_(false)
+  , values_read_(false)
   , serialized_(data)
   , encoding_(encoding)
+  , header_read_(header_read)
   , type_support_(type_support)
   , exten_(type_support.base_extensibility())
 {}
 
-Value
-FilterEvaluator::SerializedForEval::lookup(const char* field) const
+void
+FilterEvaluator::SerializedForEval::open(Serializer& ser) const
 {
-  const OPENDDS_MAP(OPENDDS_STRING, Value)::const_iterator iter = cache_.find(field);
-  if (iter != cache_.end()) {
-    return iter->second;
-  }
-  Message_Block_Ptr mb(serialized_->duplicate());
-  Serializer ser(mb.get(), encoding_);
-  if (encoding_.is_encapsulated()) {
+  if (encoding_.is_encapsulated() && !header_read_) {
     EncapsulationHeader encap;
     if (!(ser >> encap)) {
       ACE_ERROR((LM_ERROR, ACE_TEXT("(%P|%t) ERROR ")
@@ -158,413 +117,515 @@ FilterEvaluator::SerializedForEval::lookup(const char* field) const
     }
     ser.encoding(encoding);
   }
+}
+
+void
+FilterEvaluator::SerializedForEval::read_fields() const
+{
+  fields_read_ = true;
+  if (fields_.size() < 2 || !meta_.hasGetValues()) {
+    return;
+  }
+  Message_Block_Ptr mb(serialized_->duplicate());
+  Serializer ser(mb.get(), encoding_);
+  open(ser);
+  FieldValues values(fields_);
+  if (!meta_.getValues(ser, values)) {
+    throw std::runtime_error("FilterEvaluator::SerializedForEval::read_fields: "
+      "failed to read the fields of the serialized sample");
+  }
+  values_read_ = true;
+  for (size_t i = 0; i < fields_.size(); ++i) {
+    const Value* const value = values.get(i);
+    if (value) {
+      cache_.insert(std::make_pair(fields_[i], *value));
+    }
+  }
+}
+
+Value
+FilterEvaluator::SerializedForEval::lookup(const char* field) const
+{
+  if (!fields_read_) {
+    read_fields();
+  }
+  const OPENDDS_MAP(OPENDDS_STRING, Value)::const_iterator iter = cache_.find(field);
+  if (iter != cache_.end()) {
+    return iter->second;
+  }
+  if (values_read_) {
+    // The sample ended before the field, it was written with an older
+    // version of the type.  Reading it on its own would read past the end.
+    throw std::runtime_error("FilterEvaluator::SerializedForEval::lookup: "
+      "field " + OPENDDS_STRING(field) + " is not in the serialized sample");
+  }
+  Message_Block_Ptr mb(serialized_->duplicate());
+  Serializer ser(mb.get(), encoding_);
+  open(ser);
   const Value v = meta_.getValue(ser, field, &type_support_);
   cache_.insert(std::make_pair(OPENDDS_STRING(field), v));
   return v;
 }
 
-FilterEvaluator::~FilterEvaluator()
+FieldValues::Entry::Entry(const OPENDDS_STRING& field, Slot* slot)
+  : slot_(slot)
 {
-  delete filter_root_;
+  const size_t dot = field.find('.');
+  if (dot == OPENDDS_STRING::npos) {
+    member_ = field;
+  } else {
+    member_ = field.substr(0, dot);
+    rest_ = field.substr(dot + 1);
+  }
 }
 
-bool FilterEvaluator::has_non_key_fields(const TypeSupportImpl& ts) const
+FieldValues::FieldValues(const OPENDDS_VECTOR(OPENDDS_STRING)& fields)
+  : slots_(fields.size())
+  , remaining_fields_(fields.size())
+  , remaining_(&remaining_fields_)
 {
-  for (OPENDDS_VECTOR(OPENDDS_STRING)::const_iterator i = order_bys_.begin(); i != order_bys_.end(); ++i) {
-    if (!ts.is_dcps_key(i->c_str())) {
-      return true;
-    }
+  entries_.reserve(fields.size());
+  for (size_t i = 0; i < fields.size(); ++i) {
+    entries_.push_back(Entry(fields[i], &slots_[i]));
   }
-
-  return filter_root_->has_non_key_fields(ts);
 }
 
-namespace {
-
-  class FieldLookup : public FilterEvaluator::Operand {
-  public:
-    explicit FieldLookup(AstNode* fnNode)
-      : fieldName_(toString(fnNode))
-    {
-    }
-
-    Value eval(FilterEvaluator::DataForEval& data)
-    {
-      return data.lookup(fieldName_.c_str());
-    }
-
-    bool has_non_key_fields(const TypeSupportImpl& ts) const
-    {
-      return !ts.is_dcps_key(fieldName_.c_str());
-    }
-
-    OPENDDS_STRING fieldName_;
-  };
-
-  class LiteralInt : public FilterEvaluator::Operand {
-  public:
-    explicit LiteralInt(AstNode* fnNode)
-      : value_(0, true)
-    {
-      const OPENDDS_STRING strVal = toString(fnNode);
-      if (strVal.length() > 2 && strVal[0] == '0'
-          && (strVal[1] == 'x' || strVal[1] == 'X')) {
-        std::istringstream is(strVal.c_str() + 2);
-        ACE_UINT64 val;
-        is >> std::hex >> val;
-        value_ = Value(val, true);
-      } else if (!strVal.empty() && strVal[0] == '-') {
-        ACE_INT64 val;
-        std::istringstream is(strVal.c_str());
-        is >> val;
-        value_ = Value(val, true);
-      } else {
-        ACE_UINT64 val;
-        std::istringstream is(strVal.c_str());
-        is >> val;
-        value_ = Value(val, true);
-      }
+FieldValues::FieldValues(const FieldValues& outer, const char* member)
+  : remaining_fields_(0)
+  , remaining_(outer.remaining_)
+{
+  for (size_t i = 0; i < outer.entries_.size(); ++i) {
+    const Entry& entry = outer.entries_[i];
+    if (entry.member_ == member && !entry.slot_->found_) {
+      entries_.push_back(Entry(entry.rest_, entry.slot_));
     }
+  }
+}
 
-    Value eval(FilterEvaluator::DataForEval&)
-    {
-      return value_;
+bool
+FieldValues::wants(const char* member) const
+{
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    if (!entries_[i].slot_->found_ && entries_[i].member_ == member) {
+      return true;
     }
+  }
+  return false;
+}
 
-    Value value_;
-  };
-
-  class LiteralChar : public FilterEvaluator::Operand {
-  public:
-    explicit LiteralChar(AstNode* fnNode)
-      : value_(toString(fnNode)[1])
-    {}
-
-    Value eval(FilterEvaluator::DataForEval&)
-    {
-      return Value(value_, true);
+void
+FieldValues::set(const char* member, const Value& value)
+{
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    Entry& entry = entries_[i];
+    if (!entry.slot_->found_ && entry.rest_.empty() && entry.member_ == member) {
+      entry.slot_->value_ = value;
+      entry.slot_->found_ = true;
+      --*remaining_;
     }
+  }
+}
 
-    char value_;
-  };
+const Value*
+FieldValues::get(size_t index) const
+{
+  return index < slots_.size() && slots_[index].found_ ? &slots_[index].value_ : 0;
+}
 
-  class LiteralFloat : public FilterEvaluator::Operand {
-  public:
-    explicit LiteralFloat(AstNode* fnNode)
-      : value_(std::atof(toString(fnNode).c_str()))
-    {}
+FilterEvaluator::~FilterEvaluator()
+{
+}
 
-    Value eval(FilterEvaluator::DataForEval&)
-    {
-      return Value(value_, true);
+bool FilterEvaluator::has_non_key_fields(const TypeSupportImpl& ts) const
+{
+  for (OPENDDS_VECTOR(OPENDDS_STRING)::const_iterator i = order_bys_.begin(); i != order_bys_.end(); ++i) {
+    if (!ts.is_dcps_key(i->c_str())) {
+      return true;
     }
+  }
 
-    double value_;
-  };
-
-  class LiteralString : public FilterEvaluator::Operand {
-  public:
-    explicit LiteralString(AstNode* fnNode)
-      : value_(toString(fnNode).substr(1) /* trim left ' */)
-    {
-      value_.erase(value_.length() - 1); // trim right '
+  for (OPENDDS_VECTOR(OPENDDS_STRING)::const_iterator i = fields_.begin(); i != fields_.end(); ++i) {
+    if (!ts.is_dcps_key(i->c_str())) {
+      return true;
     }
+  }
+  return false;
+}
 
-    Value eval(FilterEvaluator::DataForEval&)
-    {
-      return Value(value_.c_str(), true);
+namespace {
+  Value int_literal(const OPENDDS_STRING& strVal)
+  {
+    if (strVal.length() > 2 && strVal[0] == '0'
+        && (strVal[1] == 'x' || strVal[1] == 'X')) {
+      std::istringstream is(strVal.c_str() + 2);
+      ACE_UINT64 val;
+      is >> std::hex >> val;
+      return Value(val, true);
+    } else if (!strVal.empty() && strVal[0] == '-') {
+      ACE_INT64 val;
+      std::istringstream is(strVal.c_str());
+      is >> val;
+      return Value(val, true);
     }
+    ACE_UINT64 val;
+    std::istringstream is(strVal.c_str());
+    is >> val;
+    return Value(val, true);
+  }
 
-    OPENDDS_STRING value_;
-  };
-
-  class Parameter : public FilterEvaluator::Operand {
-  public:
-    explicit Parameter(AstNode* fnNode)
-      : param_(static_cast<size_t>(std::atoi(toString(fnNode).c_str() + 1 /* skip % */)))
-    {}
-
-    bool isParameter() const { return true; }
-
-    Value eval(FilterEvaluator::DataForEval& data)
-    {
-      return Value(data.params_[static_cast<CORBA::ULong>(param_)], true);
+  /// Translate a LIKE pattern to the wildcards used by ACE::wild_match().
+  OPENDDS_STRING like_pattern(const char* like)
+  {
+    OPENDDS_STRING pattern(like);
+    // escape ? or * in the pattern string so they are not wildcards
+    for (size_t i = pattern.find_first_of("?*"); i < pattern.length();
+        i = pattern.find_first_of("?*", i + 1)) {
+      pattern.insert(i++, 1, '\\');
     }
-
-    size_t param() { return param_; }
-
-    size_t param_;
-  };
-
-  class Comparison : public FilterEvaluator::EvalNode {
-  public:
-    enum Operator {OPER_EQ, OPER_LT, OPER_GT, OPER_LTEQ, OPER_GTEQ, OPER_NEQ,
-      OPER_LIKE, OPER_INVALID};
-
-    explicit Comparison(AstNode* op, FilterEvaluator::Operand* left, FilterEvaluator::Operand* right)
-      : left_(left)
-      , right_(right)
-    {
-      addChild(left_);
-      addChild(right_);
-      setOperator(op);
+    // translate _ and % wildcards into those used by ACE::wild_match() (?, *)
+    for (size_t i = pattern.find_first_of("_%"); i < pattern.length();
+        i = pattern.find_first_of("_%", i + 1)) {
+      pattern[i] = (pattern[i] == '_') ? '?' : '*';
     }
+    return pattern;
+  }
 
-    Value eval(FilterEvaluator::DataForEval& data)
-    {
-      Value left = left_->eval(data);
-      Value right = right_->eval(data);
-      switch (oper_type_) {
-      case OPER_EQ:
-        return left == right;
-      case OPER_LT:
-        return left < right;
-      case OPER_GT:
-        return right < left;
-      case OPER_LTEQ:
-        return !(right < left);
-      case OPER_GTEQ:
-        return !(left < right);
-      case OPER_NEQ:
-        return !(left == right);
-      case OPER_LIKE:
-        return left.like(right);
-      default:
-        break;
-      }
-      return false; // not reached
-    }
+  typedef OpenDDS::DCPS::FilterEvaluator::AstNodeWrapper AstNodeWrapper;
 
-  private:
-    void setOperator(AstNode* node)
-    {
-      if (node->TypeMatches<OP_EQ>()) {
-        oper_type_ = OPER_EQ;
-      } else if (node->TypeMatches<OP_LT>()) {
-        oper_type_ = OPER_LT;
-      } else if (node->TypeMatches<OP_GT>()) {
-        oper_type_ = OPER_GT;
-      } else if (node->TypeMatches<OP_LTEQ>()) {
-        oper_type_ = OPER_LTEQ;
-      } else if (node->TypeMatches<OP_GTEQ>()) {
-        oper_type_ = OPER_GTEQ;
-      } else if (node->TypeMatches<OP_NEQ>()) {
-        oper_type_ = OPER_NEQ;
-      } else if (node->TypeMatches<OP_LIKE>()) {
-        oper_type_ = OPER_LIKE;
-      } else {
-        oper_type_ = OPER_INVALID;
-      }
+  size_t arity(const AstNodeWrapper& node)
+  {
+    size_t a = 0;
+    for (AstNode* iter = node->GetFirstChild(); iter; iter = iter->GetSibling()) {
+      ++a;
     }
+    return a;
+  }
 
-    FilterEvaluator::Operand* left_;
-    FilterEvaluator::Operand* right_;
-    Operator oper_type_;
-  };
+  AstNodeWrapper child(const AstNodeWrapper& node, size_t idx)
+  {
+    AstNode* iter = 0;
+    for (iter = node->GetFirstChild(); idx != 0; iter = iter->GetSibling(), --idx) {}
+    return iter;
+  }
+}
 
-  class Between : public FilterEvaluator::EvalNode {
-  public:
-    Between(FilterEvaluator::Operand* field, AstNode* betweenOrNot, FilterEvaluator::Operand* left, FilterEvaluator::Operand* right)
-      : invert_(betweenOrNot->TypeMatches<NOT_BETWEEN>())
-      , field_(field)
-      , left_(left)
-      , right_(right)
-    {
-      addChild(field_);
-      addChild(left_);
-      addChild(right_);
+void
+FilterEvaluator::compile(const AstNodeWrapper& node)
+{
+  if (node->TypeMatches<CompPredDef>()) {
+    const size_t left = compile_operand(child(node, 0));
+    const AstNodeWrapper& op = child(node, 1);
+    const size_t right = compile_operand(child(node, 2));
+    if (operands_[left].kind_ == OperandCode::OPERAND_PARAMETER &&
+        operands_[right].kind_ == OperandCode::OPERAND_PARAMETER) {
+      extended_grammar_ = true;
     }
 
-    Value eval(FilterEvaluator::DataForEval& data)
-    {
-      Value field = field_->eval(data);
-      Value left = left_->eval(data);
-      Value right = right_->eval(data);
-      bool btwn = !(field < left) && !(right < field);
-      return invert_ ? !btwn : btwn;
-    }
-
-  private:
-    bool invert_;
-    FilterEvaluator::Operand* field_;
-    FilterEvaluator::Operand* left_;
-    FilterEvaluator::Operand* right_;
-  };
-
-  class Call : public FilterEvaluator::Operand {
-  public:
-    enum Operator { OP_MOD };
-
-    explicit Call(const OPENDDS_STRING& name)
-    {
-      if (name == MOD) {
-        op_ = OP_MOD;
+    if (op->TypeMatches<OP_EQ>()) {
+      program_.push_back(Instruction(Instruction::COMPARE_EQ, left, right));
+    } else if (op->TypeMatches<OP_LT>()) {
+      program_.push_back(Instruction(Instruction::COMPARE_LT, left, right));
+    } else if (op->TypeMatches<OP_GT>()) {
+      program_.push_back(Instruction(Instruction::COMPARE_GT, left, right));
+    } else if (op->TypeMatches<OP_LTEQ>()) {
+      program_.push_back(Instruction(Instruction::COMPARE_LTEQ, left, right));
+    } else if (op->TypeMatches<OP_GTEQ>()) {
+      program_.push_back(Instruction(Instruction::COMPARE_GTEQ, left, right));
+    } else if (op->TypeMatches<OP_NEQ>()) {
+      program_.push_back(Instruction(Instruction::COMPARE_NEQ, left, right));
+    } else if (op->TypeMatches<OP_LIKE>()) {
+      const OperandCode& pattern = operands_[right];
+      if (pattern.kind_ == OperandCode::OPERAND_CONSTANT &&
+          constants_[pattern.index_].type_ == Value::VAL_STRING) {
+        const size_t translated = add_operand(OperandCode::OPERAND_CONSTANT,
+          add_constant(Value(like_pattern(constants_[pattern.index_].s_).c_str(), true)));
+        program_.push_back(Instruction(Instruction::LIKE_PATTERN, left, translated));
       } else {
-        throw std::runtime_error("Unknown function: " + std::string(name.c_str ()));
-      }
-    }
-
-    virtual Value eval(FilterEvaluator::DataForEval& data)
-    {
-      switch (op_) {
-      case OP_MOD:
-        {
-          if (children_.size() != 2) {
-            std::stringstream ss;
-            ss << MOD << " expects 2 arguments, given " << children_.size();
-            throw std::runtime_error(ss.str ());
-          }
-          Value left = children_[0]->eval(data);
-          Value right = children_[1]->eval(data);
-          return left % right;
-        }
-        break;
+        program_.push_back(Instruction(Instruction::COMPARE_LIKE, left, right));
       }
+    } else {
       OPENDDS_ASSERT(0);
-      return Value(0);
-    }
-
-  private:
-    Operator op_;
-  };
-
-  class Logical : public FilterEvaluator::EvalNode {
-  public:
-    enum LogicalOp {LG_AND, LG_OR, LG_NOT};
-
-    explicit Logical(EvalNode* child)
-      : op_(LG_NOT)
-    {
-      addChild(child);
-    }
-
-    Logical(AstNode* op, EvalNode* left, EvalNode* right)
-    {
-      addChild(left);
-      addChild(right);
-      if (op->TypeMatches<AND>()) {
-        op_ = LG_AND;
-      } else if (op->TypeMatches<OR>()) {
-        op_ = LG_OR;
-      } else {
-        OPENDDS_ASSERT(0);
-      }
     }
+    return;
 
-    Value eval(FilterEvaluator::DataForEval& data)
-    {
-      Value left = children_[0]->eval(data);
-      OPENDDS_ASSERT(left.type_ == Value::VAL_BOOL);
-      switch (op_) {
-      case LG_NOT:
-        return !left.b_;
-      case LG_AND:
-        if (!left.b_) return false;
-        break;
-      case LG_OR:
-        if (left.b_) return true;
-        break;
-      }
-      return children_[1]->eval(data);
-    }
-
-  private:
-    LogicalOp op_;
-  };
-}
-
-static size_t arity(const FilterEvaluator::AstNodeWrapper& node)
-{
-  size_t a = 0;
-  for (AstNode* iter = node->GetFirstChild(); iter; iter = iter->GetSibling()) {
-    ++a;
-  }
-  return a;
-}
-
-static FilterEvaluator::AstNodeWrapper child(const FilterEvaluator::AstNodeWrapper& node, size_t idx)
-{
-  AstNode* iter = 0;
-  for (iter = node->GetFirstChild(); idx != 0; iter = iter->GetSibling(), --idx) {}
-  return iter;
-}
-
-FilterEvaluator::EvalNode*
-FilterEvaluator::walkAst(const FilterEvaluator::AstNodeWrapper& node)
-{
-  if (node->TypeMatches<CompPredDef>()) {
-    Operand* left = walkOperand(child(node, 0));
-    const FilterEvaluator::AstNodeWrapper& op = child(node, 1);
-    Operand* right = walkOperand(child(node, 2));
-    if (left->isParameter() && right->isParameter()) {
-      extended_grammar_ = true;
-    }
-    return new Comparison(op, left, right);
   } else if (node->TypeMatches<BetweenPredDef>()) {
-    Operand* field = walkOperand(child(node, 0));
-    const FilterEvaluator::AstNodeWrapper& op = child(node, 1);
-    Operand* low = walkOperand(child(node, 2));
-    Operand* high = walkOperand(child(node, 3));
-    return new Between(field, op, low, high);
+    const size_t field = compile_operand(child(node, 0));
+    const AstNodeWrapper& op = child(node, 1);
+    const size_t low = compile_operand(child(node, 2));
+    const size_t high = compile_operand(child(node, 3));
+    program_.push_back(Instruction(op->TypeMatches<NOT_BETWEEN>() ? Instruction::NOT_BETWEEN : Instruction::BETWEEN,
+                                   field, low, high));
+    return;
+
   } else if (node->TypeMatches<CondDef>() || node->TypeMatches<Cond>()) {
-    size_t a = arity(node);
+    const size_t a = arity(node);
     if (a == 1) {
-      return walkAst(child(node, 0));
+      compile(child(node, 0));
+      return;
     } else if (a == 2) {
       OPENDDS_ASSERT(child(node, 0)->TypeMatches<NOT>());
-      return new Logical(walkAst(child(node, 1)));
+      compile(child(node, 1));
+      program_.push_back(Instruction(Instruction::NOT));
+      return;
     } else if (a == 3) {
-      EvalNode* left = walkAst(child(node, 0));
-      const FilterEvaluator::AstNodeWrapper& op = child(node, 1);
-      EvalNode* right = walkAst(child(node, 2));
-      return new Logical(op, left, right);
+      compile(child(node, 0));
+      const AstNodeWrapper& op = child(node, 1);
+      const size_t jump = program_.size();
+      if (op->TypeMatches<AND>()) {
+        program_.push_back(Instruction(Instruction::JUMP_IF_FALSE));
+      } else if (op->TypeMatches<OR>()) {
+        program_.push_back(Instruction(Instruction::JUMP_IF_TRUE));
+      } else {
+        OPENDDS_ASSERT(0);
+      }
+      compile(child(node, 2));
+      program_[jump].args_[0] = program_.size();
+      return;
     }
   }
 
   OPENDDS_ASSERT(0);
-  return 0;
 }
 
-FilterEvaluator::Operand*
-FilterEvaluator::walkOperand(const FilterEvaluator::AstNodeWrapper& node)
+size_t
+FilterEvaluator::compile_operand(const AstNodeWrapper& node)
 {
   if (node->TypeMatches<FieldName>()) {
-    return new FieldLookup(node);
+    const OPENDDS_STRING name = toString(node);
+    const OPENDDS_VECTOR(OPENDDS_STRING)::iterator pos = std::find(fields_.begin(), fields_.end(), name);
+    if (pos != fields_.end()) {
+      return add_operand(OperandCode::OPERAND_FIELD, static_cast<size_t>(pos - fields_.begin()));
+    }
+    fields_.push_back(name);
+    return add_operand(OperandCode::OPERAND_FIELD, fields_.size() - 1);
   } else if (node->TypeMatches<IntVal>()) {
-    return new LiteralInt(node);
+    return add_operand(OperandCode::OPERAND_CONSTANT, add_constant(int_literal(toString(node))));
   } else if (node->TypeMatches<CharVal>()) {
-    return new LiteralChar(node);
+    return add_operand(OperandCode::OPERAND_CONSTANT, add_constant(Value(toString(node)[1], true)));
   } else if (node->TypeMatches<FloatVal>()) {
-    return new LiteralFloat(node);
+    return add_operand(OperandCode::OPERAND_CONSTANT,
+                       add_constant(Value(std::atof(toString(node).c_str()), true)));
   } else if (node->TypeMatches<StrVal>()) {
-    return new LiteralString(node);
+    OPENDDS_STRING value = toString(node).substr(1); // trim left '
+    value.erase(value.length() - 1); // trim right '
+    return add_operand(OperandCode::OPERAND_CONSTANT, add_constant(Value(value.c_str(), true)));
   } else if (node->TypeMatches<ParamVal>()) {
-    Parameter* retval = new Parameter(node);
+    const size_t param = static_cast<size_t>(std::atoi(toString(node).c_str() + 1 /* skip % */));
     // Keep track of the highest parameter number
-    if (retval->param() + 1 > number_parameters_) {
-      number_parameters_ = retval->param() + 1;
+    if (param + 1 > number_parameters_) {
+      number_parameters_ = param + 1;
     }
-    return retval;
+    return add_operand(OperandCode::OPERAND_PARAMETER, param);
   } else if (node->TypeMatches<CallDef>()) {
     if (arity(node) == 1) {
-      return walkOperand(child(node, 0));
+      return compile_operand(child(node, 0));
     } else {
       extended_grammar_ = true;
-      Call* call = new Call(toString(child(node, 0)));
+      const OPENDDS_STRING name = toString(child(node, 0));
+      if (name != MOD) {
+        throw std::runtime_error("Unknown function: " + std::string(name.c_str ()));
+      }
+      OPENDDS_VECTOR(size_t) args;
       for (AstNode* iter = child(node, 1); iter != 0; iter = iter->GetSibling()) {
-        call->addChild(walkOperand(iter));
+        args.push_back(compile_operand(iter));
       }
-      return call;
+      const size_t index = add_operand(OperandCode::OPERAND_MOD, 0);
+      operands_[index].args_.swap(args);
+      return index;
     }
   }
   OPENDDS_ASSERT(0);
   return 0;
 }
 
+size_t
+FilterEvaluator::add_operand(OperandCode::Kind kind, size_t index)
+{
+  operands_.push_back(OperandCode(kind, index));
+  return operands_.size() - 1;
+}
+
+size_t
+FilterEvaluator::add_constant(const Value& value)
+{
+  constants_.push_back(value);
+  return constants_.size() - 1;
+}
+
+const Value&
+FilterEvaluator::operand_value(size_t index, DataForEval& data, Value& scratch) const
+{
+  const OperandCode& operand = operands_[index];
+  switch (operand.kind_) {
+  case OperandCode::OPERAND_CONSTANT:
+    return constants_[operand.index_];
+  case OperandCode::OPERAND_FIELD:
+    {
+      Value field = data.lookup(fields_[operand.index_].c_str());
+      scratch.swap(field);
+      return scratch;
+    }
+  case OperandCode::OPERAND_PARAMETER:
+    {
+      Value param(data.params_[static_cast<CORBA::ULong>(operand.index_)], true);
+      scratch.swap(param);
+      return scratch;
+    }
+  case OperandCode::OPERAND_MOD:
+    {
+      if (operand.args_.size() != 2) {
+        std::stringstream ss;
+        ss << MOD << " expects 2 arguments, given " << operand.args_.size();
+        throw std::runtime_error(ss.str ());
+      }
+      Value left_scratch(false), right_scratch(false);
+      Value result = operand_value(operand.args_[0], data, left_scratch)
+        % operand_value(operand.args_[1], data, right_scratch);
+      scratch.swap(result);
+      return scratch;
+    }
+  }
+  OPENDDS_ASSERT(0);
+  return scratch;
+}
+
 bool
 FilterEvaluator::eval_i(DataForEval& data) const
 {
-  return filter_root_->eval(data).b_;
+  bool result = false;
+  const size_t end = program_.size();
+  size_t pc = 0;
+  while (pc < end) {
+    const Instruction& ins = program_[pc++];
+    Value scratch0(false), scratch1(false), scratch2(false);
+    switch (ins.op_) {
+    case Instruction::COMPARE_EQ:
+      result = operand_value(ins.args_[0], data, scratch0) == operand_value(ins.args_[1], data, scratch1);
+      break;
+    case Instruction::COMPARE_LT:
+      result = operand_value(ins.args_[0], data, scratch0) < operand_value(ins.args_[1], data, scratch1);
+      break;
+    case Instruction::COMPARE_GT:
+      result = operand_value(ins.args_[1], data, scratch1) < operand_value(ins.args_[0], data, scratch0);
+      break;
+    case Instruction::COMPARE_LTEQ:
+      result = !(operand_value(ins.args_[1], data, scratch1) < operand_value(ins.args_[0], data, scratch0));
+      break;
+    case Instruction::COMPARE_GTEQ:
+      result = !(operand_value(ins.args_[0], data, scratch0) < operand_value(ins.args_[1], data, scratch1));
+      break;
+    case Instruction::COMPARE_NEQ:
+      result = !(operand_value(ins.args_[0], data, scratch0) == operand_value(ins.args_[1], data, scratch1));
+      break;
+    case Instruction::COMPARE_LIKE:
+      result = operand_value(ins.args_[0], data, scratch0).like(operand_value(ins.args_[1], data, scratch1));
+      break;
+    case Instruction::LIKE_PATTERN:
+      {
+        const Value& value = operand_value(ins.args_[0], data, scratch0);
+        if (value.type_ != Value::VAL_STRING) {
+          throw std::runtime_error("'like' operator called on non-string arguments.");
+        }
+        result = ACE::wild_match(value.s_, operand_value(ins.args_[1], data, scratch1).s_, true, true);
+      }
+      break;
+    case Instruction::BETWEEN:
+    case Instruction::NOT_BETWEEN:
+      {
+        const Value& field = operand_value(ins.args_[0], data, scratch0);
+        result = !(field < operand_value(ins.args_[1], data, scratch1))
+          && !(operand_value(ins.args_[2], data, scratch2) < field);
+        if (ins.op_ == Instruction::NOT_BETWEEN) {
+          result = !result;
+        }
+      }
+      break;
+    case Instruction::NOT:
+      result = !result;
+      break;
+    case Instruction::JUMP_IF_FALSE:
+      if (!result) {
+        pc = ins.args_[0];
+      }
+      break;
+    case Instruction::JUMP_IF_TRUE:
+      if (result) {
+        pc = ins.args_[0];
+      }
+      break;
+    }
+  }
+  return result;
+}
+
+bool
+FilterEvaluator::as_predicate(const DDS::StringSeq& params, Predicate& predicate) const
+{
+  if (program_.size() != 1) {
+    return false;
+  }
+  const Instruction& ins = program_[0];
+
+  size_t field = ins.args_[0];
+  size_t bound = ins.args_[1];
+  bool swapped = false;
+  switch (ins.op_) {
+  case Instruction::COMPARE_EQ:
+  case Instruction::COMPARE_LT:
+  case Instruction::COMPARE_GT:
+  case Instruction::COMPARE_LTEQ:
+  case Instruction::COMPARE_GTEQ:
+    if (operands_[field].kind_ != OperandCode::OPERAND_FIELD) {
+      std::swap(field, bound);
+      swapped = true;
+    }
+    break;
+  case Instruction::BETWEEN:
+    break;
+  default:
+    return false;
+  }
+
+  if (operands_[field].kind_ != OperandCode::OPERAND_FIELD) {
+    return false;
+  }
+  const size_t last = ins.op_ == Instruction::BETWEEN ? 2 : 1;
+  for (size_t i = 1; i <= last; ++i) {
+    const size_t arg = i == 1 ? bound : ins.args_[i];
+    const OperandCode& operand = operands_[arg];
+    if (operand.kind_ == OperandCode::OPERAND_CONSTANT) {
+      (i == 1 ? predicate.bound_ : predicate.upper_) = constants_[operand.index_];
+    } else if (operand.kind_ == OperandCode::OPERAND_PARAMETER &&
+               operand.index_ < params.length()) {
+      (i == 1 ? predicate.bound_ : predicate.upper_) =
+        Value(params[static_cast<CORBA::ULong>(operand.index_)], true);
+    } else {
+      return false;
+    }
+  }
+
+  predicate.field_ = fields_[operands_[field].index_];
+  switch (ins.op_) {
+  case Instruction::COMPARE_EQ:
+    predicate.op_ = Predicate::PRED_EQ;
+    break;
+  case Instruction::COMPARE_LT:
+    predicate.op_ = swapped ? Predicate::PRED_GT : Predicate::PRED_LT;
+    break;
+  case Instruction::COMPARE_GT:
+    predicate.op_ = swapped ? Predicate::PRED_LT : Predicate::PRED_GT;
+    break;
+  case Instruction::COMPARE_LTEQ:
+    predicate.op_ = swapped ? Predicate::PRED_GTEQ : Predicate::PRED_LTEQ;
+    break;
+  case Instruction::COMPARE_GTEQ:
+    predicate.op_ = swapped ? Predicate::PRED_LTEQ : Predicate::PRED_GTEQ;
+    break;
+  default:
+    predicate.op_ = Predicate::PRED_BETWEEN;
+    break;
+  }
+  return true;
 }
 
 OPENDDS_VECTOR(OPENDDS_STRING)
@@ -576,7 +637,7 @@ FilterEvaluator::getOrderBys() const
 bool
 FilterEvaluator::hasFilter() const
 {
-  return filter_root_ != 0;
+  return !program_.empty();
 }
 
 Value::Value(bool b, bool conversion_preferred)
@@ -751,29 +812,28 @@ Value::operator=(const Value& v)
   return *this;
 }
 
+namespace {
+  /// Move the contents of from to to, which must not hold a string.
+  /// Strings change owner instead of being copied.
+  void move_value(Value& to, Value& from)
+  {
+    to.type_ = from.type_;
+    to.conversion_preferred_ = from.conversion_preferred_;
+    Assign visitor(to, true);
+    visit(visitor, from);
+    if (from.type_ == Value::VAL_STRING) {
+      from.type_ = Value::VAL_BOOL;
+    }
+  }
+}
+
 void
 Value::swap(Value& v)
 {
-  Value t(v);
-
-  if (v.type_ == VAL_STRING) {
-    ACE_OS::free(v.s_);
-  }
-
-  Assign visitor1(v, true);
-  visit(visitor1, *this);
-  if (type_ == VAL_STRING) {
-    s_ = 0;
-  }
-
-  Assign visitor2(*this, true);
-  visit(visitor2, t);
-  if (t.type_ == VAL_STRING) {
-    t.s_ = 0;
-  }
-
-  std::swap(conversion_preferred_, v.conversion_preferred_);
-  std::swap(type_, v.type_);
+  Value t(false);
+  move_value(t, v);
+  move_value(v, *this);
+  move_value(*this, t);
 }
 
 namespace {
@@ -845,6 +905,10 @@ namespace {
 bool
 Value::operator==(const Value& v) const
 {
+  if (type_ == v.type_) {
+    Equals visitor(*this);
+    return visit(visitor, v);
+  }
   Value lhs = *this;
   Value rhs = v;
   conversion(lhs, rhs);
@@ -855,6 +919,10 @@ Value::operator==(const Value& v) const
 bool
 Value::operator<(const Value& v) const
 {
+  if (type_ == v.type_) {
+    Less visitor(*this);
+    return visit(visitor, v);
+  }
   Value lhs = *this;
   Value rhs = v;
   conversion(lhs, rhs);
@@ -878,18 +946,7 @@ Value::like(const Value& v) const
   if (type_ != VAL_STRING || v.type_ != VAL_STRING) {
     throw std::runtime_error("'like' operator called on non-string arguments.");
   }
-  OPENDDS_STRING pattern(v.s_);
-  // escape ? or * in the pattern string so they are not wildcards
-  for (size_t i = pattern.find_first_of("?*"); i < pattern.length();
-      i = pattern.find_first_of("?*", i + 1)) {
-    pattern.insert(i++, 1, '\\');
-  }
-  // translate _ and % wildcards into those used by ACE::wild_match() (?, *)
-  for (size_t i = pattern.find_first_of("_%"); i < pattern.length();
-      i = pattern.find_first_of("_%", i + 1)) {
-    pattern[i] = (pattern[i] == '_') ? '?' : '*';
-  }
-  return ACE::wild_match(s_, pattern.c_str(), true, true);
+  return ACE::wild_match(s_, like_pattern(v.s_).c_str(), true, true);
 }
 
 namespace {
@@ -995,6 +1052,18 @@ MetaStruct::~MetaStruct()
 {
 }
 
+bool
+MetaStruct::hasGetValues() const
+{
+  return false;
+}
+
+bool
+MetaStruct::getValues(Serializer&, FieldValues&) const
+{
+  return false;
+}
+
 }
 }
 
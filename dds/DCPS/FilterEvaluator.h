@@ -89,6 +89,53 @@ struct OpenDDS_Dcps_Export Value {
   bool conversion_preferred_;
 };
 
+/**
+ * Fields of a serialized struct that are read in one pass by
+ * MetaStruct::getValues.  The names are the ones used in filter expressions,
+ * with '.' separating the members of nested structs.
+ */
+class OpenDDS_Dcps_Export FieldValues {
+public:
+  explicit FieldValues(const OPENDDS_VECTOR(OPENDDS_STRING)& fields);
+
+  /// The fields of outer that are in its nested struct member.
+  FieldValues(const FieldValues& outer, const char* member);
+
+  /// True if member, or a field nested in it, hasn't been read yet.
+  bool wants(const char* member) const;
+
+  void set(const char* member, const Value& value);
+
+  /// True when every field of the outermost FieldValues has been read.
+  bool done() const { return *remaining_ == 0; }
+
+  /// Value of the index-th field passed to the constructor, or null if it
+  /// wasn't read.
+  const Value* get(size_t index) const;
+
+private:
+  FieldValues(const FieldValues&);
+  FieldValues& operator=(const FieldValues&);
+
+  struct Slot {
+    Slot() : value_(false), found_(false) {}
+    Value value_;
+    bool found_;
+  };
+
+  struct Entry {
+    Entry(const OPENDDS_STRING& field, Slot* slot);
+    OPENDDS_STRING member_;
+    OPENDDS_STRING rest_;
+    Slot* slot_;
+  };
+
+  OPENDDS_VECTOR(Slot) slots_;
+  OPENDDS_VECTOR(Entry) entries_;
+  size_t remaining_fields_;
+  size_t* remaining_;
+};
+
 class OpenDDS_Dcps_Export FilterEvaluator : public RcObject {
 public:
 
@@ -121,18 +168,40 @@ public:
   }
 
   /**
-   * Returns true if the serialized sample matches the filter.
+   * Returns true if the serialized sample matches the filter.  If
+   * header_read is true, the encapsulation header has already been read
+   * and encoding is the one it gave.
    */
   bool eval(ACE_Message_Block* serializedSample, Encoding encoding,
             TypeSupportImpl& typeSupport,
-            const DDS::StringSeq& params) const
+            const DDS::StringSeq& params,
+            bool header_read = false) const
   {
-    SerializedForEval data(serializedSample, typeSupport, params, encoding);
+    SerializedForEval data(serializedSample, typeSupport, params, encoding, fields_, header_read);
     return eval_i(data);
   }
 
-  class EvalNode;
-  class Operand;
+  /// A filter that compares a single field with literals or parameters.
+  struct OpenDDS_Dcps_Export Predicate {
+    enum Op {PRED_EQ, PRED_LT, PRED_LTEQ, PRED_GT, PRED_GTEQ, PRED_BETWEEN};
+
+    Predicate() : op_(PRED_EQ), bound_(false), upper_(false) {}
+
+    Op op_;
+    OPENDDS_STRING field_;
+    /// The value that field_ is compared to, or the lower bound of BETWEEN.
+    Value bound_;
+    /// The upper bound of BETWEEN.
+    Value upper_;
+  };
+
+  /**
+   * Returns true and fills in predicate if the whole filter is either
+   * "field op value" or "field BETWEEN low AND high", where op is one of
+   * =, <, <=, >, >= and the values are literals or parameters.  Writers use
+   * this to index the filters of their readers.
+   */
+  bool as_predicate(const DDS::StringSeq& params, Predicate& predicate) const;
 
   struct OpenDDS_Dcps_Export DataForEval {
     DataForEval(const MetaStruct& meta, const DDS::StringSeq& params)
@@ -150,8 +219,56 @@ private:
   FilterEvaluator(const FilterEvaluator&);
   FilterEvaluator& operator=(const FilterEvaluator&);
 
-  EvalNode* walkAst(const AstNodeWrapper& node);
-  Operand* walkOperand(const AstNodeWrapper& node);
+  /**
+   * The filter is compiled to a flat program.  Each instruction sets or
+   * tests a single boolean result, so evaluating it needs no stack and no
+   * virtual calls.  AND and OR jump past their right side when the left
+   * side decides the result.
+   */
+  struct Instruction {
+    enum Op {
+      COMPARE_EQ, COMPARE_LT, COMPARE_GT, COMPARE_LTEQ, COMPARE_GTEQ,
+      COMPARE_NEQ, COMPARE_LIKE,
+      LIKE_PATTERN, ///< LIKE with a literal pattern that's already translated
+      BETWEEN, NOT_BETWEEN,
+      NOT,
+      JUMP_IF_FALSE, JUMP_IF_TRUE ///< args_[0] is the target
+    };
+
+    Instruction(Op op, size_t arg0 = 0, size_t arg1 = 0, size_t arg2 = 0)
+      : op_(op)
+    {
+      args_[0] = arg0;
+      args_[1] = arg1;
+      args_[2] = arg2;
+    }
+
+    Op op_;
+    /// Indexes into operands_, or a jump target.
+    size_t args_[3];
+  };
+
+  /// Literals are converted to a Value once when the filter is compiled,
+  /// parameters each time the filter is evaluated.
+  struct OperandCode {
+    enum Kind {OPERAND_FIELD, OPERAND_CONSTANT, OPERAND_PARAMETER, OPERAND_MOD};
+
+    OperandCode(Kind kind, size_t index)
+      : kind_(kind), index_(index) {}
+
+    Kind kind_;
+    /// Index into fields_ or constants_, or the parameter number.
+    size_t index_;
+    /// Arguments of OPERAND_MOD, indexes into operands_.
+    OPENDDS_VECTOR(size_t) args_;
+  };
+
+  void compile(const AstNodeWrapper& node);
+  size_t compile_operand(const AstNodeWrapper& node);
+  size_t add_operand(OperandCode::Kind kind, size_t index);
+  size_t add_constant(const Value& value);
+
+  const Value& operand_value(size_t index, DataForEval& data, Value& scratch) const;
 
   struct OpenDDS_Dcps_Export DeserializedForEval : DataForEval {
     DeserializedForEval(const void* data, const MetaStruct& meta,
@@ -164,10 +281,22 @@ private:
 
   struct SerializedForEval : DataForEval {
     SerializedForEval(ACE_Message_Block* data, TypeSupportImpl& type_support,
-                      const DDS::StringSeq& params, Encoding encoding);
+                      const DDS::StringSeq& params, Encoding encoding,
+                      const OPENDDS_VECTOR(OPENDDS_STRING)& fields,
+                      bool header_read);
     Value lookup(const char* field) const;
+    void open(Serializer& ser) const;
+    /// Read all of fields_ into cache_ with MetaStruct::getValues.  Throws
+    /// std::runtime_error if the sample couldn't be read.
+    void read_fields() const;
+    const OPENDDS_VECTOR(OPENDDS_STRING)& fields_;
+    mutable bool fields_read_;
+    /// getValues has read the sample, fields that aren't in cache_ aren't in
+    /// the sample.
+    mutable bool values_read_;
     ACE_Message_Block* serialized_;
     Encoding encoding_;
+    const bool header_read_;
     TypeSupportImpl& type_support_;
     mutable OPENDDS_MAP(OPENDDS_STRING, Value) cache_;
     Extensibility exten_;
@@ -176,7 +305,10 @@ private:
   bool eval_i(DataForEval& data) const;
 
   bool extended_grammar_;
-  EvalNode* filter_root_;
+  OPENDDS_VECTOR(Instruction) program_;
+  OPENDDS_VECTOR(OperandCode) operands_;
+  OPENDDS_VECTOR(OPENDDS_STRING) fields_;
+  OPENDDS_VECTOR(Value) constants_;
   OPENDDS_VECTOR(OPENDDS_STRING) order_bys_;
   /// Number of parameters used in the filter, this should
   /// match the number of values passed when evaluating the filter
@@ -191,6 +323,15 @@ public:
   virtual Value getValue(const void* stru, const char* fieldSpec) const = 0;
   virtual Value getValue(Serializer& ser, const char* fieldSpec, TypeSupportImpl* ts = 0) const = 0;
 
+  /// True if getValues is implemented, otherwise fields of a serialized
+  /// struct are read one at a time with getValue.
+  virtual bool hasGetValues() const;
+
+  /// Read several fields in one pass over a serialized struct.  Returns false
+  /// if the struct couldn't be read.  Fields that aren't set in values when
+  /// it returns true aren't in the struct, which ended before them.
+  virtual bool getValues(Serializer& ser, FieldValues& values) const;
+
   virtual ComparatorBase::Ptr create_qc_comparator(const char* fieldSpec,
     ComparatorBase::Ptr next) const = 0;
 
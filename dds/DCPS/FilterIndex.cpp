@@ -0,0 +1,224 @@
+/*
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "DCPS/DdsDcps_pch.h" //Only the _pch include should start with DCPS/
+
+#ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
+
+#include "FilterIndex.h"
+
+#include "Sample.h"
+#include "Util.h"
+
+#include <stdexcept>
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+FilterIndex::FilterIndex()
+  : dirty_(false)
+  , generation_(0)
+{
+}
+
+void FilterIndex::insert(const GUID_t& reader, const RcHandle<FilterEvaluator>& eval,
+                         const DDS::StringSeq& params)
+{
+  remove(reader);
+
+  GroupKey key(eval.in(), Params());
+  for (CORBA::ULong i = 0; i < params.length(); ++i) {
+    key.second.push_back(params[i].in());
+  }
+
+  Group& group = groups_[key];
+  if (group.readers_.empty()) {
+    group.eval_ = eval;
+    group.params_ = params;
+    group.has_predicate_ = eval->as_predicate(params, group.predicate_);
+  }
+  group.readers_.insert(reader);
+  readers_[reader] = key;
+  dirty_ = true;
+}
+
+void FilterIndex::remove(const GUID_t& reader)
+{
+  const OPENDDS_MAP_CMP(GUID_t, GroupKey, GUID_tKeyLessThan)::iterator it = readers_.find(reader);
+  if (it == readers_.end()) {
+    return;
+  }
+  const Groups::iterator group = groups_.find(it->second);
+  if (group != groups_.end()) {
+    group->second.readers_.erase(reader);
+    if (group->second.readers_.empty()) {
+      groups_.erase(group);
+    }
+  }
+  readers_.erase(it);
+  dirty_ = true;
+}
+
+void FilterIndex::rebuild()
+{
+  fields_.clear();
+  generic_.clear();
+  for (Groups::iterator it = groups_.begin(); it != groups_.end(); ++it) {
+    Group& group = it->second;
+    if (group.has_predicate_) {
+      fields_[group.predicate_.field_].groups_.push_back(&group);
+    } else {
+      generic_.push_back(&group);
+    }
+  }
+  dirty_ = false;
+}
+
+bool FilterIndex::convert_bound(const Value& sample_value, Value& bound)
+{
+  // Comparing a string field to a number converts the field when it reads as
+  // a number, so the result of the conversion depends on the sample.
+  if (sample_value.type_ == Value::VAL_STRING && bound.type_ != Value::VAL_STRING
+      && bound.type_ != Value::VAL_CHAR && !bound.conversion_preferred_) {
+    return false;
+  }
+  Value field = sample_value;
+  try {
+    Value::conversion(field, bound);
+  } catch (const std::runtime_error&) {
+    return false;
+  }
+  // Keys have to be of the type of the field, or else every sample would
+  // need to be converted before looking it up.
+  return field.type_ == sample_value.type_;
+}
+
+void FilterIndex::index_field(FieldIndex& index, const Value& sample_value)
+{
+  index.eq_.clear();
+  index.lt_.clear();
+  index.lteq_.clear();
+  index.gt_.clear();
+  index.gteq_.clear();
+  index.between_.clear();
+  index.unindexed_.clear();
+
+  for (size_t i = 0; i < index.groups_.size(); ++i) {
+    Group* const group = index.groups_[i];
+    const FilterEvaluator::Predicate& predicate = group->predicate_;
+    Value bound = predicate.bound_;
+    if (!convert_bound(sample_value, bound)) {
+      index.unindexed_.push_back(group);
+      continue;
+    }
+    switch (predicate.op_) {
+    case FilterEvaluator::Predicate::PRED_EQ:
+      index.eq_.insert(std::make_pair(bound, group));
+      break;
+    case FilterEvaluator::Predicate::PRED_LT:
+      index.lt_.insert(std::make_pair(bound, group));
+      break;
+    case FilterEvaluator::Predicate::PRED_LTEQ:
+      index.lteq_.insert(std::make_pair(bound, group));
+      break;
+    case FilterEvaluator::Predicate::PRED_GT:
+      index.gt_.insert(std::make_pair(bound, group));
+      break;
+    case FilterEvaluator::Predicate::PRED_GTEQ:
+      index.gteq_.insert(std::make_pair(bound, group));
+      break;
+    case FilterEvaluator::Predicate::PRED_BETWEEN:
+      {
+        Value upper = predicate.upper_;
+        if (convert_bound(sample_value, upper)) {
+          index.between_.insert(std::make_pair(bound, UpperBound(upper, group)));
+        } else {
+          index.unindexed_.push_back(group);
+        }
+      }
+      break;
+    }
+  }
+
+  index.typed_ = true;
+  index.type_ = sample_value.type_;
+}
+
+void FilterIndex::filter(const Sample& sample, GUIDSeq& filter_out)
+{
+  if (dirty_) {
+    rebuild();
+  }
+  ++generation_;
+
+  for (FieldIndexes::iterator it = fields_.begin(); it != fields_.end(); ++it) {
+    FieldIndex& index = it->second;
+    const Value value = sample.get_field_value(it->first.c_str());
+    if (!(value == value)) {
+      // NaN isn't ordered with the bounds, so the index can't find the
+      // filters it matches.
+      for (size_t i = 0; i < index.groups_.size(); ++i) {
+        Group* const group = index.groups_[i];
+        if (sample.eval(*group->eval_, group->params_)) {
+          match(group);
+        }
+      }
+      continue;
+    }
+    if (!index.typed_ || index.type_ != value.type_) {
+      index_field(index, value);
+    }
+
+    const std::pair<Bounds::iterator, Bounds::iterator> eq = index.eq_.equal_range(value);
+    match(eq.first, eq.second);
+    // field < bound
+    match(index.lt_.upper_bound(value), index.lt_.end());
+    // field <= bound
+    match(index.lteq_.lower_bound(value), index.lteq_.end());
+    // field > bound
+    match(index.gt_.begin(), index.gt_.lower_bound(value));
+    // field >= bound
+    match(index.gteq_.begin(), index.gteq_.upper_bound(value));
+    // lower <= field, then check field <= upper
+    for (Ranges::iterator r = index.between_.begin(), end = index.between_.upper_bound(value);
+         r != end; ++r) {
+      if (!(r->second.first < value)) {
+        match(r->second.second);
+      }
+    }
+
+    for (size_t i = 0; i < index.unindexed_.size(); ++i) {
+      Group* const group = index.unindexed_[i];
+      if (sample.eval(*group->eval_, group->params_)) {
+        match(group);
+      }
+    }
+  }
+
+  for (size_t i = 0; i < generic_.size(); ++i) {
+    Group* const group = generic_[i];
+    if (sample.eval(*group->eval_, group->params_)) {
+      match(group);
+    }
+  }
+
+  for (Groups::const_iterator it = groups_.begin(); it != groups_.end(); ++it) {
+    if (it->second.generation_ != generation_) {
+      const GuidSet& readers = it->second.readers_;
+      for (GuidSet::const_iterator r = readers.begin(); r != readers.end(); ++r) {
+        push_back(filter_out, *r);
+      }
+    }
+  }
+}
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#endif // OPENDDS_NO_CONTENT_FILTERED_TOPIC
@@ -0,0 +1,124 @@
+/*
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#ifndef OPENDDS_DCPS_FILTER_INDEX_H
+#define OPENDDS_DCPS_FILTER_INDEX_H
+
+#include "Definitions.h"
+
+#ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
+
+#include "FilterEvaluator.h"
+#include "GuidUtils.h"
+#include "PoolAllocator.h"
+#include "RcHandle_T.h"
+
+#include <dds/DdsDcpsGuidC.h>
+
+#if !defined (ACE_LACKS_PRAGMA_ONCE)
+#  pragma once
+#endif /* ACE_LACKS_PRAGMA_ONCE */
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+class Sample;
+
+/**
+ * @class FilterIndex
+ *
+ * @brief Content filters of the readers associated with a DataWriter.
+ *
+ * Readers with the same filter and parameters are grouped so that the
+ * filter is evaluated once per group.  Groups whose filter compares a single
+ * field with a value (see FilterEvaluator::as_predicate) are also kept in
+ * ordered maps per field, so that the matching groups are found by looking
+ * up the field of the sample once instead of evaluating every filter.  The
+ * maps are keyed by the type of the field, which is only known once there is
+ * a sample, so they are built when the first sample is filtered.
+ *
+ * The index isn't locked, the DataWriter protects it with the lock it uses
+ * for the readers.
+ */
+class OpenDDS_Dcps_Export FilterIndex {
+public:
+  FilterIndex();
+
+  void insert(const GUID_t& reader, const RcHandle<FilterEvaluator>& eval,
+              const DDS::StringSeq& params);
+
+  void remove(const GUID_t& reader);
+
+  bool empty() const { return readers_.empty(); }
+
+  /// Append the readers whose filter doesn't match sample to filter_out.
+  void filter(const Sample& sample, GUIDSeq& filter_out);
+
+private:
+  typedef OPENDDS_VECTOR(OPENDDS_STRING) Params;
+  typedef std::pair<FilterEvaluator*, Params> GroupKey;
+
+  struct Group {
+    Group() : has_predicate_(false), generation_(0) {}
+
+    RcHandle<FilterEvaluator> eval_;
+    DDS::StringSeq params_;
+    GuidSet readers_;
+    bool has_predicate_;
+    FilterEvaluator::Predicate predicate_;
+    /// Equal to FilterIndex::generation_ when the current sample matches.
+    ACE_UINT64 generation_;
+  };
+
+  typedef OPENDDS_MAP(GroupKey, Group) Groups;
+  typedef OPENDDS_MULTIMAP(Value, Group*) Bounds;
+  typedef std::pair<Value, Group*> UpperBound;
+  typedef OPENDDS_MULTIMAP(Value, UpperBound) Ranges;
+
+  struct FieldIndex {
+    FieldIndex() : typed_(false), type_(Value::VAL_BOOL) {}
+
+    /// All the groups whose predicate is on this field.
+    OPENDDS_VECTOR(Group*) groups_;
+    bool typed_;
+    Value::Type type_;
+    Bounds eq_, lt_, lteq_, gt_, gteq_;
+    Ranges between_;
+    /// Groups whose values can't be converted to the type of the field.
+    OPENDDS_VECTOR(Group*) unindexed_;
+  };
+
+  typedef OPENDDS_MAP(OPENDDS_STRING, FieldIndex) FieldIndexes;
+
+  void rebuild();
+  static void index_field(FieldIndex& index, const Value& sample_value);
+  static bool convert_bound(const Value& sample_value, Value& bound);
+  void match(Group* group) { group->generation_ = generation_; }
+  template<typename Iter>
+  void match(Iter begin, Iter end)
+  {
+    for (; begin != end; ++begin) {
+      match(begin->second);
+    }
+  }
+
+  Groups groups_;
+  OPENDDS_MAP_CMP(GUID_t, GroupKey, GUID_tKeyLessThan) readers_;
+  FieldIndexes fields_;
+  /// Groups that can't be indexed, their filter is evaluated for each sample.
+  OPENDDS_VECTOR(Group*) generic_;
+  bool dirty_;
+  ACE_UINT64 generation_;
+};
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#endif // OPENDDS_NO_CONTENT_FILTERED_TOPIC
+#endif /* OPENDDS_DCPS_FILTER_INDEX_H */
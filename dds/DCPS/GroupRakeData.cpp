@@ -11,51 +11,92 @@
 #include "DataReaderImpl.h"
 #include "QueryConditionImpl.h"
 
+#include <algorithm>
+
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 
 namespace OpenDDS {
 namespace DCPS {
 
 GroupRakeData::GroupRakeData()
+  : remaining_(0)
+{
+}
+
+
+void GroupRakeData::push(Heap& heap, size_t begin, size_t end)
 {
+  const Cursor cursor = {begin, end};
+  heap.push_back(cursor);
+  std::push_heap(heap.begin(), heap.end(), Later(samples_));
 }
 
 
-bool GroupRakeData::insert_sample(ReceivedDataElement* sample,
-                                  ReceivedDataElementList* rdel,
-                                  SubscriptionInstance_rch instance,
-                                  size_t index_in_instance)
+bool GroupRakeData::pop(Heap& heap, RakeData& data) const
 {
-  // Ignore DISPOSE and UNREGISTER messages in case they are sent
-  // in the group coherent changes, but it shouldn't.
-  if (!sample->valid_data_) {
+  if (heap.empty()) {
     return false;
   }
 
-  RakeData rd = {sample, rdel, instance, index_in_instance};
-  this->sorted_.insert(rd);
-
-  this->current_sample_ = this->sorted_.begin();
+  std::pop_heap(heap.begin(), heap.end(), Later(samples_));
+  Cursor& cursor = heap.back();
+  data = samples_[cursor.next_];
+  if (++cursor.next_ < cursor.end_) {
+    std::push_heap(heap.begin(), heap.end(), Later(samples_));
+  } else {
+    heap.pop_back();
+  }
   return true;
 }
 
 
+void GroupRakeData::insert_instance(ReceivedDataElementList* rdel,
+                                    const SubscriptionInstance_rch& instance,
+                                    CORBA::ULong sample_states)
+{
+  // Split the samples into runs that are in order.  With
+  // BY_SOURCE_TIMESTAMP destination order the whole instance is one run.
+  size_t begin = samples_.size();
+  size_t index = 0;
+  for (ReceivedDataElement* item = rdel->get_next_match(sample_states, 0); item;
+       item = rdel->get_next_match(sample_states, item)) {
+    // Ignore DISPOSE and UNREGISTER messages in case they are sent
+    // in the group coherent changes, but it shouldn't.
+    if (!item->valid_data_) {
+      continue;
+    }
+    if (samples_.size() > begin
+        && item->source_timestamp_ < samples_.back().rde_->source_timestamp_) {
+      push(heap_, begin, samples_.size());
+      begin = samples_.size();
+    }
+    const RakeData rd = {item, rdel, instance, ++index};
+    samples_.push_back(rd);
+    ++remaining_;
+  }
+  if (samples_.size() > begin) {
+    push(heap_, begin, samples_.size());
+  }
+}
+
+
 void
-GroupRakeData::get_datareaders(DDS::DataReaderSeq & readers)
+GroupRakeData::get_datareaders(DDS::DataReaderSeq& readers) const
 {
   ACE_UNUSED_ARG(readers);
 #ifndef OPENDDS_NO_OBJECT_MODEL_PROFILE
-  readers.length(static_cast<CORBA::ULong>(this->sorted_.size()));
+  readers.length(static_cast<CORBA::ULong>(remaining_));
   CORBA::ULong i = 0;
-  SortedSet::iterator itEnd = this->sorted_.end();
-  for (SortedSet::iterator it = this->sorted_.begin(); it != itEnd; ++it) {
-    RcHandle<DDS::DataReader> reader = it->si_->instance_state_->data_reader().lock();
+  // Merge a copy of the cursors so that the samples can still be read.
+  Heap heap(heap_);
+  RakeData data = RakeData();
+  while (pop(heap, data)) {
+    RcHandle<DDS::DataReader> reader = data.si_->instance_state_->data_reader().lock();
     if (reader) {
       readers[i++] = DDS::DataReader::_duplicate(reader.in());
-    } else {
-      readers.length(readers.length() - 1);
     }
   }
+  readers.length(i);
 #endif
 }
 
@@ -63,16 +104,20 @@ GroupRakeData::get_datareaders(DDS::DataReaderSeq & readers)
 void
 GroupRakeData::reset()
 {
-  this->sorted_.clear();
+  samples_.clear();
+  heap_.clear();
+  remaining_ = 0;
 }
 
 
-RakeData
-GroupRakeData::get_data()
+bool
+GroupRakeData::get_data(RakeData& data)
 {
-  RakeData data = *this->current_sample_;
-  ++this->current_sample_;
-  return data;
+  if (!pop(heap_, data)) {
+    return false;
+  }
+  --remaining_;
+  return true;
 }
 
 } // namespace DCPS
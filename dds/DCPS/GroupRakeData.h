@@ -12,7 +12,7 @@
 #endif
 
 #include "RakeData.h"
-#include "Comparator_T.h"
+#include "Time_Helper.h"
 #include "PoolAllocator.h"
 #include "dcps_export.h"
 
@@ -25,58 +25,79 @@ namespace OpenDDS {
 namespace DCPS {
 
 /// Rake is an abbreviation for "read or take".  This class manages the
-/// results from a read() or take() operation, which are the received_data
-/// and the info_seq sequences passed in by-reference from the user.
+/// samples of the readers of a subscriber with GROUP ordered access, which
+/// are read one at a time in the order of their source timestamps.
+///
+/// The matching samples are copied when they are inserted, while the
+/// reader's sample lock is held, so later changes to the instances don't
+/// affect the order.  The samples of an instance are usually already in
+/// that order, so each ordered run of them is kept as a cursor and the
+/// cursors are merged with a heap as the samples are read, instead of
+/// sorting all of the samples up front.  The storage is kept across reset()
+/// calls.
 class OpenDDS_Dcps_Export GroupRakeData {
 public:
   GroupRakeData();
 
-  /// Returns false if the sample will definitely not be part of the
-  /// resulting dataset, however if this returns true it still may be
-  /// excluded (due to sorting and max_samples).
-  bool insert_sample(ReceivedDataElement* sample,
-                     ReceivedDataElementList* rdel,
-                     SubscriptionInstance_rch i,
-                     size_t index_in_instance);
+  /// Add the valid samples of an instance that match sample_states.
+  void insert_instance(ReceivedDataElementList* rdel,
+                       const SubscriptionInstance_rch& instance,
+                       CORBA::ULong sample_states);
 
-  void get_datareaders (DDS::DataReaderSeq & readers);
+  /// The reader of each sample that hasn't been read yet, in order.
+  void get_datareaders(DDS::DataReaderSeq& readers) const;
 
-  bool copy_to_user();
+  void reset();
 
-  void reset ();
+  /// Number of samples that haven't been read yet.
+  size_t size() const { return remaining_; }
 
-  RakeData get_data ();
+  /// Read the next sample in order.  Returns false if there are no more.
+  bool get_data(RakeData& data);
 
 private:
-
-
   GroupRakeData(const GroupRakeData&); // no copy construction
   GroupRakeData& operator=(const GroupRakeData&); // no assignment
 
-  class SortedSetCmp {
+  /// Samples from samples_[next_] up to samples_[end_], which are in order
+  /// of their source timestamps.
+  struct Cursor {
+    size_t next_;
+    size_t end_;
+  };
+
+  typedef OPENDDS_VECTOR(RakeData) Samples;
+  typedef OPENDDS_VECTOR(Cursor) Heap;
+
+  /// Heap order, with the earliest sample on top.  Samples with equal
+  /// timestamps are read in the order they were inserted.
+  class Later {
   public:
-    bool operator()(const RakeData& lhs, const RakeData& rhs) const {
-      if (!cmp_.in()) {
-        // The following assumes that if no comparator is set
-        // then BY_SOURCE_TIMESTAMP_DESTINATIONORDER_QOS is used.
-        return lhs.rde_->source_timestamp_ < rhs.rde_->source_timestamp_;
+    explicit Later(const Samples& samples) : samples_(samples) {}
+
+    bool operator()(const Cursor& lhs, const Cursor& rhs) const
+    {
+      const DDS::Time_t& l = samples_[lhs.next_].rde_->source_timestamp_;
+      const DDS::Time_t& r = samples_[rhs.next_].rde_->source_timestamp_;
+      if (r < l) {
+        return true;
       }
-
-      return false;
+      if (l < r) {
+        return false;
+      }
+      return lhs.next_ > rhs.next_;
     }
-    SortedSetCmp(){}
-    explicit SortedSetCmp(ComparatorBase::Ptr cmp) : cmp_(cmp){}
 
   private:
-    ComparatorBase::Ptr cmp_;
+    const Samples& samples_;
   };
 
-  typedef OPENDDS_MULTISET_CMP(RakeData, SortedSetCmp) SortedSet;
-
-  // Contains data for QueryCondition/Ordered access
-  SortedSet sorted_;
+  void push(Heap& heap, size_t begin, size_t end);
+  bool pop(Heap& heap, RakeData& data) const;
 
-  SortedSet::iterator current_sample_;
+  Samples samples_;
+  Heap heap_;
+  size_t remaining_;
 };
 
 } // namespace DCPS
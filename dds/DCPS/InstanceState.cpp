@@ -35,20 +35,18 @@ InstanceState::InstanceState(const DataReaderImpl_rch& reader,
   , no_writers_generation_count_(0)
   , empty_(true)
   , release_pending_(false)
-  , release_timer_id_(-1)
   , reader_(reader)
   , handle_(handle)
   , owner_(GUID_UNKNOWN)
+  , owner_word_(0)
 #ifndef OPENDDS_NO_OWNERSHIP_KIND_EXCLUSIVE
   , exclusive_(reader->qos_.ownership.kind == DDS::EXCLUSIVE_OWNERSHIP_QOS)
 #endif
   , registered_(false)
-  , release_task_(make_rch<PmfSporadicTask<InstanceState> >(TheServiceParticipant->time_source(), TheServiceParticipant->reactor_task(), rchandle_from(this), &InstanceState::do_release))
 {}
 
 InstanceState::~InstanceState()
 {
-  release_task_->cancel();
 #ifndef OPENDDS_NO_OWNERSHIP_KIND_EXCLUSIVE
   if (registered_) {
     RcHandle<DataReaderImpl> reader = reader_.lock();
@@ -100,18 +98,6 @@ void InstanceState::sample_info(DDS::SampleInfo& si, const ReceivedDataElement*
 
 // cannot ACE_INLINE because of #include loop
 
-void InstanceState::do_release(const MonotonicTimePoint&)
-{
-  if (DCPS_debug_level) {
-    ACE_DEBUG((LM_NOTICE,
-               ACE_TEXT("(%P|%t) NOTICE:")
-               ACE_TEXT(" InstanceState::do_release:")
-               ACE_TEXT(" autopurging samples with instance handle 0x%x!\n"),
-               handle_));
-  }
-  release();
-}
-
 bool InstanceState::dispose_was_received(const GUID_t& writer_id)
 {
   ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, lock_, false);
@@ -196,7 +182,8 @@ void InstanceState::schedule_release()
   if (reader) {
     qos = reader->qos_;
   } else {
-    cancel_release();
+    release_pending_ = false;
+    release_deadline_ = MonotonicTimePoint::zero_value;
     return;
   }
 
@@ -222,8 +209,12 @@ void InstanceState::schedule_release()
   if (delay.sec != DDS::DURATION_INFINITE_SEC &&
       delay.nanosec != DDS::DURATION_INFINITE_NSEC) {
 
-    release_task_->cancel();
-    release_task_->schedule(TimeDuration(delay));
+    // Releases are filed with the reader and reclaimed in batches by a
+    // single task instead of arming a timer per instance.
+    if (!release_deadline_.is_zero()) {
+      reader->cancel_instance_release(handle_, release_deadline_);
+    }
+    release_deadline_ = reader->schedule_instance_release(handle_, TimeDuration(delay));
 
   } else {
     // N.B. instance transitions are always followed by a non-valid
@@ -237,7 +228,23 @@ void InstanceState::schedule_release()
 void InstanceState::cancel_release()
 {
   release_pending_ = false;
-  release_task_->cancel();
+  if (!release_deadline_.is_zero()) {
+    RcHandle<DataReaderImpl> reader = reader_.lock();
+    if (reader) {
+      reader->cancel_instance_release(handle_, release_deadline_);
+    }
+    release_deadline_ = MonotonicTimePoint::zero_value;
+  }
+}
+
+bool InstanceState::release_due(const MonotonicTimePoint& deadline)
+{
+  ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, lock_, false);
+  if (release_deadline_.is_zero() || release_deadline_ != deadline) {
+    return false;
+  }
+  release_deadline_ = MonotonicTimePoint::zero_value;
+  return true;
 }
 
 bool InstanceState::release_if_empty()
@@ -260,10 +267,13 @@ void InstanceState::release()
   }
 }
 
-void InstanceState::set_owner(const GUID_t& owner)
+void InstanceState::set_owner(const GUID_t& owner,
+                              DDS::InstanceHandle_t owner_handle,
+                              CORBA::Long owner_strength)
 {
   ACE_Guard<ACE_Thread_Mutex> guard(owner_lock_);
   owner_ = owner;
+  owner_word_ = owner == GUID_UNKNOWN ? 0 : make_owner_word(owner_handle, owner_strength);
 }
 
 GUID_t InstanceState::get_owner()
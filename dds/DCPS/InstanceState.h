@@ -8,6 +8,7 @@
 #ifndef OPENDDS_DCPS_INSTANCESTATE_H
 #define OPENDDS_DCPS_INSTANCESTATE_H
 
+#include "Atomic.h"
 #include "Definitions.h"
 #include "GuidUtils.h"
 #include "PoolAllocator.h"
@@ -122,6 +123,10 @@ public:
   /// Remove the instance immediately.
   void release();
 
+  /// Called by the reader's release task.  Returns true and clears the
+  /// scheduled release if it is still the one due at deadline.
+  bool release_due(const MonotonicTimePoint& deadline);
+
   /// Returns true if the writer is a writer of this instance.
   bool writes_instance(const GUID_t& writer_id) const
   {
@@ -132,8 +137,29 @@ public:
   WeakRcHandle<DataReaderImpl> data_reader() const;
   void state_updated() const;
 
-  void set_owner (const GUID_t& owner);
+  /// The handle and strength of the owning writer are also kept in the
+  /// owner word so that it can be checked without taking a lock.
+  void set_owner (const GUID_t& owner,
+                  DDS::InstanceHandle_t owner_handle = DDS::HANDLE_NIL,
+                  CORBA::Long owner_strength = 0);
   GUID_t get_owner ();
+
+  /// The owner's writer handle and ownership strength packed by
+  /// make_owner_word, or 0 if they aren't known.
+  ACE_UINT64 owner_word() const { return owner_word_; }
+
+  static ACE_UINT64 make_owner_word(DDS::InstanceHandle_t writer_handle,
+                                    CORBA::Long strength)
+  {
+    return writer_handle == DDS::HANDLE_NIL ? 0 :
+      (static_cast<ACE_UINT64>(static_cast<ACE_UINT32>(writer_handle)) << 32)
+      | static_cast<ACE_UINT32>(strength);
+  }
+
+  static DDS::InstanceHandle_t owner_word_handle(ACE_UINT64 word)
+  {
+    return static_cast<DDS::InstanceHandle_t>(word >> 32);
+  }
   bool is_exclusive () const;
   bool registered();
   void registered (bool flag);
@@ -209,9 +235,10 @@ private:
   bool release_pending_;
 
   /**
-   * Keep track of a scheduled release timer.
+   * Time at which the scheduled release is due, filed in the reader's
+   * release queue.  Zero when no release is scheduled.
    */
-  long release_timer_id_;
+  MonotonicTimePoint release_deadline_;
 
   /**
    * Reference to our containing reader.  This is used to call back
@@ -224,14 +251,11 @@ private:
 
   RepoIdSet writers_;
   GUID_t owner_;
+  Atomic<ACE_UINT64> owner_word_;
   bool exclusive_;
   /// registered with participant so it can be called back as
   /// the owner is updated.
   bool registered_;
-
-  RcHandle<SporadicTask> release_task_;
-
-  void do_release(const MonotonicTimePoint& now);
 };
 
 } // namespace DCPS
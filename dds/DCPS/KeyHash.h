@@ -0,0 +1,110 @@
+/*
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#ifndef OPENDDS_DCPS_KEY_HASH_H
+#define OPENDDS_DCPS_KEY_HASH_H
+
+#include <dds/Versioned_Namespace.h>
+
+#include <ace/CDR_Base.h>
+
+#include <cstring>
+#include <limits>
+
+#if !defined (ACE_LACKS_PRAGMA_ONCE)
+#  pragma once
+#endif /* ACE_LACKS_PRAGMA_ONCE */
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+/**
+ * Helpers for the generated DDSTraits<T>::key_hash and KeyLessThan.  Key
+ * members that KeyLessThan finds equal must hash the same, so floating
+ * point members are ordered with key_float_less and hashed with
+ * key_hash_float, which both treat -0.0 and +0.0 as one value and every NaN
+ * as one value after all the numbers.
+ *
+ * The hash is the one-at-a-time hash: key_hash_bytes is called for each
+ * member and key_hash_final once at the end.
+ */
+inline ACE_UINT32 key_hash_bytes(ACE_UINT32 hash, const void* data, size_t size)
+{
+  const unsigned char* const bytes = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash += bytes[i];
+    hash += hash << 10;
+    hash ^= hash >> 6;
+  }
+  return hash;
+}
+
+inline size_t key_hash_final(ACE_UINT32 hash)
+{
+  hash += hash << 3;
+  hash ^= hash >> 11;
+  hash += hash << 15;
+  return hash;
+}
+
+/// Integers, characters, booleans, and enums.
+template <typename T>
+ACE_UINT32 key_hash_value(ACE_UINT32 hash, const T& value)
+{
+  return key_hash_bytes(hash, &value, sizeof value);
+}
+
+template <typename T>
+ACE_UINT32 key_hash_float(ACE_UINT32 hash, const T& value)
+{
+  // Hashed as a double since long double has padding on some platforms.
+  double normalized = static_cast<double>(value);
+  if (normalized != normalized) {
+    normalized = std::numeric_limits<double>::quiet_NaN();
+  } else if (normalized == 0) {
+    normalized = 0;
+  }
+  return key_hash_value(hash, normalized);
+}
+
+inline ACE_UINT32 key_hash_string(ACE_UINT32 hash, const char* value)
+{
+  // The terminator is included so that consecutive strings can't run
+  // into each other.
+  return key_hash_bytes(hash, value, value ? std::strlen(value) + 1 : 0);
+}
+
+inline ACE_UINT32 key_hash_string(ACE_UINT32 hash, const ACE_CDR::WChar* value)
+{
+  size_t length = 0;
+  if (value) {
+    while (value[length]) {
+      ++length;
+    }
+    ++length;
+  }
+  return key_hash_bytes(hash, value, length * sizeof *value);
+}
+
+template <typename T>
+bool key_float_less(const T& a, const T& b)
+{
+  if (a != a) {
+    return false;
+  }
+  if (b != b) {
+    return true;
+  }
+  return a < b;
+}
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#endif /* OPENDDS_DCPS_KEY_HASH_H */
@@ -0,0 +1,186 @@
+/*
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "DCPS/DdsDcps_pch.h" //Only the _pch include should start with DCPS/
+
+#include "LatencyHistogram.h"
+
+#include <cmath>
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+namespace {
+  unsigned int log2_floor(ACE_UINT64 value)
+  {
+    unsigned int result = 0;
+    for (unsigned int shift = 32; shift; shift >>= 1) {
+      if (value >> shift) {
+        value >>= shift;
+        result += shift;
+      }
+    }
+    return result;
+  }
+
+  const double USEC_PER_SEC = 1000000.0;
+
+  /// Store value in extreme if value is before it in the order given by
+  /// Before.  This only needs an atomic exchange: a thread that takes a
+  /// value out that should have stayed puts it back, so the extreme is
+  /// never lost, though a concurrent summarize() may briefly miss it.
+  template <typename Before>
+  void update_extreme(Atomic<ACE_UINT64>& extreme, ACE_UINT64 value, Before before)
+  {
+    if (!before(value, extreme.load())) {
+      return;
+    }
+    ACE_UINT64 previous = extreme.exchange(value);
+    while (before(previous, value)) {
+      value = previous;
+      previous = extreme.exchange(value);
+    }
+  }
+
+  bool less(ACE_UINT64 a, ACE_UINT64 b)
+  {
+    return a < b;
+  }
+
+  bool greater(ACE_UINT64 a, ACE_UINT64 b)
+  {
+    return a > b;
+  }
+
+  double clamp(double value, double minimum, double maximum)
+  {
+    return value < minimum ? minimum : value > maximum ? maximum : value;
+  }
+}
+
+LatencyHistogram::LatencyHistogram()
+{
+  reset();
+}
+
+void LatencyHistogram::record(const TimeDuration& value)
+{
+  ACE_UINT64 usec = 0;
+  if (TimeDuration::zero_value < value) {
+    const ACE_Time_Value& tv = value.value();
+    usec = static_cast<ACE_UINT64>(tv.sec()) * 1000000 + static_cast<ACE_UINT64>(tv.usec());
+  }
+  ++counts_[bucket_index(usec)];
+  update_extreme(minimum_, usec, less);
+  update_extreme(maximum_, usec, greater);
+}
+
+LatencyHistogram::Summary LatencyHistogram::summarize() const
+{
+  Summary summary = Summary();
+
+  ACE_UINT32 counts[BUCKET_COUNT];
+  unsigned int first = BUCKET_COUNT, last = 0;
+  for (unsigned int i = 0; i < BUCKET_COUNT; ++i) {
+    counts[i] = counts_[i];
+    if (counts[i]) {
+      if (first == BUCKET_COUNT) {
+        first = i;
+      }
+      last = i;
+      summary.n += counts[i];
+    }
+  }
+  const ACE_UINT64 minimum = minimum_.load();
+  const ACE_UINT64 maximum = maximum_.load();
+  if (!summary.n || minimum > maximum) {
+    // Nothing recorded yet, or only partially recorded.
+    summary.n = 0;
+    return summary;
+  }
+  const double min_usec = static_cast<double>(minimum);
+  const double max_usec = static_cast<double>(maximum);
+
+  double sum = 0;
+  for (unsigned int i = first; i <= last; ++i) {
+    sum += counts[i] * bucket_value(i);
+  }
+  const double n = static_cast<double>(summary.n);
+  const double mean = sum / n;
+
+  double squares = 0;
+  for (unsigned int i = first; i <= last; ++i) {
+    const double delta = bucket_value(i) - mean;
+    squares += counts[i] * delta * delta;
+  }
+
+  const double quantiles[] = { 0.5, 0.99, 0.999 };
+  double* const results[] = { &summary.p50, &summary.p99, &summary.p999 };
+  ACE_UINT64 seen = 0;
+  unsigned int bucket = first;
+  for (size_t q = 0; q < sizeof quantiles / sizeof quantiles[0]; ++q) {
+    const ACE_UINT64 rank = static_cast<ACE_UINT64>(std::ceil(quantiles[q] * n));
+    while (bucket < last && seen + counts[bucket] < rank) {
+      seen += counts[bucket++];
+    }
+    *results[q] = clamp(bucket_value(bucket), min_usec, max_usec) / USEC_PER_SEC;
+  }
+
+  summary.minimum = min_usec / USEC_PER_SEC;
+  summary.maximum = max_usec / USEC_PER_SEC;
+  summary.mean = clamp(mean, min_usec, max_usec) / USEC_PER_SEC;
+  summary.variance = squares / n / (USEC_PER_SEC * USEC_PER_SEC);
+  return summary;
+}
+
+void LatencyHistogram::reset()
+{
+  for (unsigned int i = 0; i < BUCKET_COUNT; ++i) {
+    counts_[i] = 0;
+  }
+  minimum_ = ACE_UINT64_MAX;
+  maximum_ = 0;
+}
+
+unsigned int LatencyHistogram::bucket_index(ACE_UINT64 usec)
+{
+  if (usec < SUB_BUCKETS) {
+    return static_cast<unsigned int>(usec);
+  }
+  const ACE_UINT64 max = (ACE_UINT64(1) << MAX_EXPONENT) - 1;
+  if (usec > max) {
+    usec = max;
+  }
+  const unsigned int shift = log2_floor(usec) - SUB_BUCKET_BITS;
+  return SUB_BUCKETS + shift * SUB_BUCKETS
+    + static_cast<unsigned int>((usec >> shift) - SUB_BUCKETS);
+}
+
+ACE_UINT64 LatencyHistogram::bucket_lower_bound(unsigned int index)
+{
+  if (index < SUB_BUCKETS) {
+    return index;
+  }
+  const unsigned int shift = (index - SUB_BUCKETS) / SUB_BUCKETS;
+  const unsigned int sub = (index - SUB_BUCKETS) % SUB_BUCKETS;
+  return static_cast<ACE_UINT64>(SUB_BUCKETS + sub) << shift;
+}
+
+double LatencyHistogram::bucket_value(unsigned int index)
+{
+  if (index < SUB_BUCKETS) {
+    return index;
+  }
+  const unsigned int shift = (index - SUB_BUCKETS) / SUB_BUCKETS;
+  const ACE_UINT64 width = ACE_UINT64(1) << shift;
+  return static_cast<double>(bucket_lower_bound(index)) + static_cast<double>(width - 1) / 2;
+}
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
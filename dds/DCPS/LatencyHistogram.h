@@ -0,0 +1,91 @@
+/*
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#ifndef OPENDDS_DCPS_LATENCY_HISTOGRAM_H
+#define OPENDDS_DCPS_LATENCY_HISTOGRAM_H
+
+#include "Atomic.h"
+#include "TimeDuration.h"
+#include "dcps_export.h"
+
+#include <ace/Basic_Types.h>
+
+#if !defined (ACE_LACKS_PRAGMA_ONCE)
+#  pragma once
+#endif /* ACE_LACKS_PRAGMA_ONCE */
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+/**
+ * @class LatencyHistogram
+ *
+ * @brief Fixed-size log-linear histogram of durations.
+ *
+ * Durations are counted in microseconds.  Below SUB_BUCKETS microseconds
+ * each value has its own bucket, above that every power of two is split
+ * into SUB_BUCKETS equal buckets, so a value read back from the histogram
+ * is within 1/SUB_BUCKETS of the recorded one.  Values that don't fit in
+ * MAX_EXPONENT bits go in the last bucket.  The smallest and largest
+ * values are also kept exactly, and the percentiles are clamped to them.
+ *
+ * record() only updates atomic variables, so it may be called from several
+ * threads at once without a lock.  summarize() and reset() read or clear
+ * them one at a time and may miss values that are recorded while they run.
+ */
+class OpenDDS_Dcps_Export LatencyHistogram {
+public:
+  static const unsigned int SUB_BUCKET_BITS = 4;
+  static const unsigned int SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+  static const unsigned int MAX_EXPONENT = 40;
+  static const unsigned int BUCKET_COUNT =
+    SUB_BUCKETS + (MAX_EXPONENT - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+  /// Values in seconds.  The minimum and maximum are exact, the rest are
+  /// computed from the bucket counts.
+  struct Summary {
+    ACE_UINT64 n;
+    double minimum;
+    double maximum;
+    double mean;
+    double variance;
+    double p50;
+    double p99;
+    double p999;
+  };
+
+  LatencyHistogram();
+
+  void record(const TimeDuration& value);
+
+  Summary summarize() const;
+
+  void reset();
+
+  static unsigned int bucket_index(ACE_UINT64 usec);
+
+  /// Smallest value, in microseconds, counted by a bucket.
+  static ACE_UINT64 bucket_lower_bound(unsigned int index);
+
+  /// Value, in microseconds, that stands for the values counted by a bucket.
+  static double bucket_value(unsigned int index);
+
+private:
+  Atomic<ACE_UINT32> counts_[BUCKET_COUNT];
+  Atomic<ACE_UINT64> minimum_;
+  Atomic<ACE_UINT64> maximum_;
+
+  LatencyHistogram(const LatencyHistogram&);
+  LatencyHistogram& operator=(const LatencyHistogram&);
+};
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#endif /* OPENDDS_DCPS_LATENCY_HISTOGRAM_H */
@@ -263,6 +263,11 @@ void MultiTopicDataReaderBase::data_available(DDS::DataReader_ptr reader)
   try {
     const MetaStruct& meta = metaStructFor(reader);
     const QueryPlan& qp = query_plans_[topic];
+    // Joins read the last sample of each instance, so the indexes are updated
+    // with all of the samples before any of them is joined.
+    for (CORBA::ULong i = 0; i < gen.samples_.size(); ++i) {
+      update_join_indexes(topic, gen.samples_[i], gen.info_[i], meta);
+    }
     for (CORBA::ULong i = 0; i < gen.samples_.size(); ++i) {
       const SampleInfo& si = gen.info_[i];
       if (si.valid_data) {
@@ -286,6 +291,133 @@ void MultiTopicDataReaderBase::data_available(DDS::DataReader_ptr reader)
   }
 }
 
+bool MultiTopicDataReaderBase::join_key_values(JoinKeyValues& values,
+  const JoinKeyNames& key_names, const void* data, const MetaStruct& meta)
+{
+  values.clear();
+  try {
+    for (size_t i = 0; i < key_names.size(); ++i) {
+      values.push_back(meta.getValue(data, key_names[i].c_str()));
+    }
+  } catch (const std::runtime_error&) {
+    // The type of the field can't be held in a Value.
+    return false;
+  }
+  return true;
+}
+
+bool MultiTopicDataReaderBase::create_join_index(const OPENDDS_STRING& topic,
+  const JoinKeyNames& key_names)
+{
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, join_index_lock_, false);
+  JoinIndexes& indexes = join_indexes_[topic];
+  if (indexes.count(key_names)) {
+    return false;
+  }
+  indexes[key_names];
+  return true;
+}
+
+void MultiTopicDataReaderBase::complete_join_index(const OPENDDS_STRING& topic,
+  const JoinKeyNames& key_names, const JoinIndex& scanned)
+{
+  ACE_GUARD(ACE_Thread_Mutex, guard, join_index_lock_);
+  JoinIndex& index = join_indexes_[topic][key_names];
+  if (!scanned.usable_) {
+    index.usable_ = false;
+  }
+  if (index.usable_) {
+    typedef OPENDDS_MAP(DDS::InstanceHandle_t, JoinKeyValues)::const_iterator iter_t;
+    for (iter_t it = scanned.values_.begin(); it != scanned.values_.end(); ++it) {
+      if (index.values_.insert(*it).second) {
+        index.instances_.insert(std::make_pair(it->second, it->first));
+      }
+    }
+  } else {
+    index.instances_.clear();
+    index.values_.clear();
+  }
+  index.ready_ = true;
+}
+
+bool MultiTopicDataReaderBase::find_join_candidates(const OPENDDS_STRING& topic,
+  const JoinKeyNames& key_names, const void* key_data, const MetaStruct& meta,
+  OPENDDS_VECTOR(DDS::InstanceHandle_t)& handles)
+{
+  JoinKeyValues values;
+  if (!join_key_values(values, key_names, key_data, meta)) {
+    return false;
+  }
+
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, join_index_lock_, false);
+  const OPENDDS_MAP(OPENDDS_STRING, JoinIndexes)::const_iterator indexes =
+    join_indexes_.find(topic);
+  if (indexes == join_indexes_.end()) {
+    return false;
+  }
+  const JoinIndexes::const_iterator found = indexes->second.find(key_names);
+  if (found == indexes->second.end() || !found->second.ready_ || !found->second.usable_) {
+    return false;
+  }
+  const JoinIndex& index = found->second;
+  typedef OPENDDS_MULTIMAP(JoinKeyValues, DDS::InstanceHandle_t)::const_iterator iter_t;
+  const std::pair<iter_t, iter_t> range = index.instances_.equal_range(values);
+  for (iter_t it = range.first; it != range.second; ++it) {
+    handles.push_back(it->second);
+  }
+  return true;
+}
+
+void MultiTopicDataReaderBase::update_join_indexes(const OPENDDS_STRING& topic,
+  const void* sample, const DDS::SampleInfo& info, const MetaStruct& meta)
+{
+  ACE_GUARD(ACE_Thread_Mutex, guard, join_index_lock_);
+  const OPENDDS_MAP(OPENDDS_STRING, JoinIndexes)::iterator indexes = join_indexes_.find(topic);
+  if (indexes == join_indexes_.end()) {
+    return;
+  }
+
+  for (JoinIndexes::iterator it = indexes->second.begin(); it != indexes->second.end(); ++it) {
+    JoinIndex& index = it->second;
+    if (!index.usable_) {
+      continue;
+    }
+    if (info.valid_data) {
+      JoinKeyValues values;
+      if (!join_key_values(values, it->first, sample, meta)) {
+        index.usable_ = false;
+        index.instances_.clear();
+        index.values_.clear();
+        continue;
+      }
+      erase_join_entry(index, info.instance_handle);
+      index.instances_.insert(std::make_pair(values, info.instance_handle));
+      index.values_[info.instance_handle] = values;
+    } else if (info.instance_state != DDS::ALIVE_INSTANCE_STATE) {
+      erase_join_entry(index, info.instance_handle);
+    }
+  }
+}
+
+void MultiTopicDataReaderBase::erase_join_entry(JoinIndex& index,
+  DDS::InstanceHandle_t handle)
+{
+  const OPENDDS_MAP(DDS::InstanceHandle_t, JoinKeyValues)::iterator found =
+    index.values_.find(handle);
+  if (found == index.values_.end()) {
+    return;
+  }
+  typedef OPENDDS_MULTIMAP(JoinKeyValues, DDS::InstanceHandle_t)::iterator iter_t;
+  const std::pair<iter_t, iter_t> range = index.instances_.equal_range(found->second);
+  for (iter_t it = range.first; it != range.second; ++it) {
+    if (it->second == handle) {
+      index.instances_.erase(it);
+      break;
+    }
+  }
+  index.values_.erase(found);
+}
+
 void MultiTopicDataReaderBase::set_status_changed_flag(DDS::StatusKind status,
   bool flag)
 {
@@ -317,6 +449,10 @@ void MultiTopicDataReaderBase::cleanup()
     sub->delete_datareader(it->second.data_reader_);
     participant->delete_topic(topic);
   }
+  {
+    ACE_GUARD(ACE_Thread_Mutex, guard, join_index_lock_);
+    join_indexes_.clear();
+  }
   DataReaderImpl* dri = dynamic_cast<DataReaderImpl*>(resulting_reader_.in());
   SubscriberImpl* si = dynamic_cast<SubscriberImpl*>(sub.in());
   if (dri) {
@@ -151,6 +151,54 @@ protected:
   // key: topicName for this reader
   OPENDDS_MAP(OPENDDS_STRING, QueryPlan) query_plans_;
 
+  typedef std::vector<OPENDDS_STRING> JoinKeyNames;
+  typedef OPENDDS_VECTOR(Value) JoinKeyValues;
+
+  // Instances of a constituent topic by the values of some of its join keys,
+  // so that joins that don't use all of the DCPS keys of the topic can look
+  // up their matches instead of reading every instance.  The values are the
+  // ones of the last sample read from the instance.
+  struct JoinIndex {
+    JoinIndex() : ready_(false), usable_(true) {}
+
+    OPENDDS_MULTIMAP(JoinKeyValues, DDS::InstanceHandle_t) instances_;
+    OPENDDS_MAP(DDS::InstanceHandle_t, JoinKeyValues) values_;
+    /// Set once the instances that existed before the index have been added.
+    bool ready_;
+    /// Cleared if the values of the keys couldn't be read from a sample.
+    bool usable_;
+  };
+
+  static bool join_key_values(JoinKeyValues& values, const JoinKeyNames& key_names,
+                              const void* data, const MetaStruct& meta);
+
+  /// Start maintaining the index of topic by key_names.  Returns false if
+  /// the index already exists.
+  bool create_join_index(const OPENDDS_STRING& topic, const JoinKeyNames& key_names);
+
+  /// Add the instances read while scanning topic to its index and start
+  /// using the index.  Instances that were updated in the meantime keep
+  /// their newer values.
+  void complete_join_index(const OPENDDS_STRING& topic, const JoinKeyNames& key_names,
+                           const JoinIndex& scanned);
+
+  /// Get the instances of topic whose join keys may have the values in
+  /// key_data.  Returns false if there is no index to use.
+  bool find_join_candidates(const OPENDDS_STRING& topic, const JoinKeyNames& key_names,
+                            const void* key_data, const MetaStruct& meta,
+                            OPENDDS_VECTOR(DDS::InstanceHandle_t)& handles);
+
+private:
+  void update_join_indexes(const OPENDDS_STRING& topic, const void* sample,
+                           const DDS::SampleInfo& info, const MetaStruct& meta);
+
+  static void erase_join_entry(JoinIndex& index, DDS::InstanceHandle_t handle);
+
+  typedef OPENDDS_MAP(JoinKeyNames, JoinIndex) JoinIndexes;
+  ACE_Thread_Mutex join_index_lock_;
+  // key: topicName of the indexed reader
+  OPENDDS_MAP(OPENDDS_STRING, JoinIndexes) join_indexes_;
+
   OPENDDS_DELETED_COPY_MOVE_CTOR_ASSIGN(MultiTopicDataReaderBase)
 };
 
@@ -94,6 +94,7 @@ MultiTopicDataReader_T<Sample, TypedDataReader>::join(
   CORBA::String_var other_topic = other_td->get_name();
   const QueryPlan& other_qp = query_plans_[other_topic.in()];
   const size_t n_keys = key_names.size();
+  OPENDDS_VECTOR(InstanceHandle_t) candidates;
 
   if (n_keys > 0 && other_meta.numDcpsKeys() == n_keys) { // complete key
     InstanceHandle_t ih = other_dri->lookup_instance_generic(key_data);
@@ -117,7 +118,29 @@ MultiTopicDataReader_T<Sample, TypedDataReader>::join(
       resulting.back().combine(SampleWithInfo(other_topic.in(), info));
       assign_fields(resulting.back().sample_, other_data.ptr_, other_qp, other_meta);
     }
+  } else if (n_keys > 0 && find_join_candidates(other_topic.in(), key_names, key_data,
+                                                 other_meta, candidates)) { // incomplete key
+    for (size_t c = 0; c < candidates.size(); ++c) {
+      GenericData other_data(other_meta, false);
+      SampleInfo info;
+      const ReturnCode_t ret = other_dri->read_instance_generic(other_data.ptr_,
+        info, candidates[c], READ_SAMPLE_STATE, ANY_VIEW_STATE, ALIVE_INSTANCE_STATE);
+      // The index may still have instances that are gone, skip them.
+      if (ret != RETCODE_OK || !info.valid_data) {
+        continue;
+      }
+
+      if (keys_match(key_names, key_data, other_data.ptr_, other_meta)) {
+        resulting.push_back(prototype);
+        resulting.back().combine(SampleWithInfo(other_topic.in(), info));
+        assign_fields(resulting.back().sample_, other_data.ptr_, other_qp, other_meta);
+      }
+    }
   } else { // incomplete key or cross-join (0 key fields)
+    // The first join on these keys reads every instance, which is also what
+    // the index needs to start with.
+    const bool build_index = n_keys > 0 && create_join_index(other_topic.in(), key_names);
+    JoinIndex scanned;
     ReturnCode_t ret = RETCODE_OK;
     for (InstanceHandle_t ih = HANDLE_NIL; ret != RETCODE_NO_DATA;) {
       GenericData other_data(other_meta, false);
@@ -130,26 +153,53 @@ MultiTopicDataReader_T<Sample, TypedDataReader>::join(
                      " read_next_instance_generic for topic %C returns %C\n",
                      other_topic.in(), retcode_to_string(ret)));
         }
+        if (build_index) {
+          scanned.usable_ = false;
+          complete_join_index(other_topic.in(), key_names, scanned);
+        }
         return false;
       }
       if (ret == RETCODE_NO_DATA || !info.valid_data) {
+        if (ret == RETCODE_OK) {
+          // The rest of the instances weren't read.
+          scanned.usable_ = false;
+        }
         break;
       }
       ih = info.instance_handle;
 
-      bool match = true;
-      for (size_t i = 0; match && i < key_names.size(); ++i) {
-        if (!other_meta.compare(key_data, other_data.ptr_, key_names[i].c_str())) {
-          match = false;
+      if (build_index && scanned.usable_) {
+        JoinKeyValues values;
+        if (join_key_values(values, key_names, other_data.ptr_, other_meta)) {
+          scanned.values_[ih] = values;
+        } else {
+          scanned.usable_ = false;
         }
       }
 
-      if (match) {
+      if (keys_match(key_names, key_data, other_data.ptr_, other_meta)) {
         resulting.push_back(prototype);
         resulting.back().combine(SampleWithInfo(other_topic.in(), info));
         assign_fields(resulting.back().sample_, other_data.ptr_, other_qp, other_meta);
       }
     }
+    if (build_index) {
+      complete_join_index(other_topic.in(), key_names, scanned);
+    }
+  }
+  return true;
+}
+
+template<typename Sample, typename TypedDataReader>
+bool
+MultiTopicDataReader_T<Sample, TypedDataReader>::keys_match(
+  const std::vector<OPENDDS_STRING>& key_names, const void* lhs, const void* rhs,
+  const MetaStruct& meta)
+{
+  for (size_t i = 0; i < key_names.size(); ++i) {
+    if (!meta.compare(lhs, rhs, key_names[i].c_str())) {
+      return false;
+    }
   }
   return true;
 }
@@ -161,29 +211,50 @@ MultiTopicDataReader_T<Sample, TypedDataReader>::combine(
   const std::vector<OPENDDS_STRING>& key_names, const TopicSet& other_topics)
 {
   const MetaStruct& meta = getResultingMeta();
+
+  // Index 'other' by its values of the keys so that each element of
+  // 'resulting' finds its matches without comparing with all of 'other'.
+  typedef OPENDDS_MULTIMAP(JoinKeyValues, size_t) OtherIndex;
+  OtherIndex other_index;
+  bool indexed = !key_names.empty();
+  for (size_t i = 0; indexed && i < other.size(); ++i) {
+    JoinKeyValues values;
+    indexed = join_key_values(values, key_names, &other[i].sample_, meta);
+    other_index.insert(std::make_pair(values, i));
+  }
+
   SampleVec new_data;
+  OPENDDS_VECTOR(size_t) candidates;
   for (typename SampleVec::iterator it_res = resulting.begin();
        it_res != resulting.end(); /*incremented in loop*/) {
-    bool found_one_match = false;
-    for (typename SampleVec::const_iterator it_other = other.begin();
-         it_other != other.end(); ++it_other) {
-      bool match = true;
-      for (size_t i = 0; match && i < key_names.size(); ++i) {
-        if (!meta.compare(&*it_res, &*it_other, key_names[i].c_str())) {
-          match = false;
-        }
+    candidates.clear();
+    JoinKeyValues values;
+    if (indexed && join_key_values(values, key_names, &it_res->sample_, meta)) {
+      const std::pair<typename OtherIndex::const_iterator, typename OtherIndex::const_iterator>
+        range = other_index.equal_range(values);
+      for (typename OtherIndex::const_iterator it = range.first; it != range.second; ++it) {
+        candidates.push_back(it->second);
+      }
+    } else {
+      for (size_t i = 0; i < other.size(); ++i) {
+        candidates.push_back(i);
       }
-      if (!match) {
+    }
+
+    bool found_one_match = false;
+    for (size_t c = 0; c < candidates.size(); ++c) {
+      const SampleWithInfo& other_data = other[candidates[c]];
+      if (!keys_match(key_names, &it_res->sample_, &other_data.sample_, meta)) {
         continue;
       }
       if (found_one_match) {
         new_data.push_back(*it_res);
-        new_data.back().combine(*it_other);
-        assign_resulting_fields(new_data.back().sample_, it_other->sample_, other_topics);
+        new_data.back().combine(other_data);
+        assign_resulting_fields(new_data.back().sample_, other_data.sample_, other_topics);
       } else {
         found_one_match = true;
-        it_res->combine(*it_other);
-        assign_resulting_fields(it_res->sample_, it_other->sample_, other_topics);
+        it_res->combine(other_data);
+        assign_resulting_fields(it_res->sample_, other_data.sample_, other_topics);
       }
     }
     if (found_one_match) {
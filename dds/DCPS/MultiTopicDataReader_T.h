@@ -145,6 +145,10 @@ private:
             const void* key_data, DDS::DataReader_ptr other_dr,
             const MetaStruct& other_meta);
 
+  // True if all fields named in 'key_names' are equal in 'lhs' and 'rhs'.
+  static bool keys_match(const std::vector<OPENDDS_STRING>& key_names,
+                         const void* lhs, const void* rhs, const MetaStruct& meta);
+
   // When no common keys are found, natural join devolves to a cross-join where
   // each instance in the joined-to-topic (qp) is combined with the results so
   // far (partialResults).
@@ -284,7 +284,8 @@ bool
 OwnershipManager::select_owner(const DDS::InstanceHandle_t& instance_handle,
                                const GUID_t& pub_id,
                                const CORBA::Long& ownership_strength,
-                               InstanceState_rch instance_state)
+                               InstanceState_rch instance_state,
+                               DDS::InstanceHandle_t writer_handle)
 {
   ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, instance_lock_, false);
 
@@ -299,18 +300,23 @@ OwnershipManager::select_owner(const DDS::InstanceHandle_t& instance_handle,
 
     // No owner at some point.
     if (infos.owner_.pub_id_ == GUID_UNKNOWN) {
-      infos.owner_ = WriterInfo(pub_id, ownership_strength);
+      infos.owner_ = WriterInfo(pub_id, ownership_strength, writer_handle);
       broadcast_new_owner(instance_handle, infos, pub_id);
       return true;
 
     } else if (infos.owner_.pub_id_ == pub_id) { // is current owner
       //still owner but strength changed to be bigger..
       if (infos.owner_.ownership_strength_ <= ownership_strength) {
-        infos.owner_.ownership_strength_ = ownership_strength;
+        if (infos.owner_.ownership_strength_ != ownership_strength
+            || infos.owner_.handle_ != writer_handle) {
+          infos.owner_.ownership_strength_ = ownership_strength;
+          infos.owner_.handle_ = writer_handle;
+          broadcast_new_owner(instance_handle, infos, pub_id);
+        }
         return true;
 
       } else { //update strength and reevaluate owner which broadcast new owner.
-        infos.candidates_.push_back(WriterInfo(pub_id, ownership_strength));
+        infos.candidates_.push_back(WriterInfo(pub_id, ownership_strength, writer_handle));
         remove_owner(instance_handle, infos, true);
         return infos.owner_.pub_id_ == pub_id;
       }
@@ -345,7 +351,7 @@ OwnershipManager::select_owner(const DDS::InstanceHandle_t& instance_handle,
       }
 
       if (!found) {
-        infos.candidates_.push_back(WriterInfo(pub_id, ownership_strength));
+        infos.candidates_.push_back(WriterInfo(pub_id, ownership_strength, writer_handle));
       }
 
       if (sort) {
@@ -366,7 +372,7 @@ OwnershipManager::select_owner(const DDS::InstanceHandle_t& instance_handle,
   } else {
     // first writer of the instance so it's owner.
     OwnershipWriterInfos& infos = instance_ownership_infos_[instance_handle];
-    infos.owner_ = WriterInfo(pub_id, ownership_strength);
+    infos.owner_ = WriterInfo(pub_id, ownership_strength, writer_handle);
     if (!instance_state->registered()) {
       infos.instance_states_.push_back(instance_state);
       instance_state->registered(true);
@@ -400,7 +406,7 @@ OwnershipManager::broadcast_new_owner(const DDS::InstanceHandle_t& instance_hand
   const InstanceStateVec::iterator the_end = infos.instance_states_.end();
   for (InstanceStateVec::iterator iter = infos.instance_states_.begin();
        iter != the_end; ++iter) {
-    (*iter)->set_owner(owner);
+    (*iter)->set_owner(owner, infos.owner_.handle_, infos.owner_.ownership_strength_);
   }
 }
 
@@ -49,18 +49,22 @@ public:
 
   struct WriterInfo {
     WriterInfo(const GUID_t& pub_id,
-               const CORBA::Long& ownership_strength)
+               const CORBA::Long& ownership_strength,
+               DDS::InstanceHandle_t handle)
       : pub_id_(pub_id)
       , ownership_strength_(ownership_strength)
+      , handle_(handle)
     {}
 
     WriterInfo()
       : pub_id_(GUID_UNKNOWN)
       , ownership_strength_(0)
+      , handle_(DDS::HANDLE_NIL)
     {}
 
     GUID_t pub_id_;
     CORBA::Long ownership_strength_;
+    DDS::InstanceHandle_t handle_;
   };
 
   typedef OPENDDS_VECTOR(WriterInfo) WriterInfos;
@@ -134,11 +138,14 @@ public:
 
   /**
   * Determine if the provided publication can be the owner.
+  * The writer_handle is the reader's handle for the publication, it's
+  * passed on to the instance states with the owner.
   */
   bool select_owner(const DDS::InstanceHandle_t& instance_handle,
                     const GUID_t& pub_id,
                     const CORBA::Long& ownership_strength,
-                    InstanceState_rch instance_state);
+                    InstanceState_rch instance_state,
+                    DDS::InstanceHandle_t writer_handle);
 
   /**
   * Remove an owner of the specified instance.
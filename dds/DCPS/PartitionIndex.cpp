@@ -0,0 +1,97 @@
+/*
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "DCPS/DdsDcps_pch.h" //Only the _pch include should start with DCPS/
+
+#include "PartitionIndex.h"
+
+#include "DCPS_Utils.h"
+
+#include <ace/ACE.h> /* For ACE::wild_match() */
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+void PartitionIndex::get_names(const DDS::PartitionQosPolicy& partition,
+                               Names& literals, Names& wildcards)
+{
+  if (partition.name.length() == 0) {
+    literals.push_back("");
+    return;
+  }
+  for (CORBA::ULong i = 0; i < partition.name.length(); ++i) {
+    const char* const name = partition.name[i];
+    if (is_wildcard(name)) {
+      wildcards.push_back(name);
+    } else {
+      literals.push_back(name);
+    }
+  }
+}
+
+void PartitionIndex::insert(const GUID_t& guid, const DDS::PartitionQosPolicy& partition)
+{
+  remove(guid);
+
+  Names literals, wildcards;
+  get_names(partition, literals, wildcards);
+  for (Names::const_iterator it = literals.begin(); it != literals.end(); ++it) {
+    literals_[*it].insert(guid);
+  }
+  if (!wildcards.empty()) {
+    wildcards_.insert(guid);
+  }
+  names_[guid].swap(literals);
+}
+
+void PartitionIndex::remove(const GUID_t& guid)
+{
+  const OPENDDS_MAP_CMP(GUID_t, Names, GUID_tKeyLessThan)::iterator pos = names_.find(guid);
+  if (pos == names_.end()) {
+    return;
+  }
+  for (Names::const_iterator it = pos->second.begin(); it != pos->second.end(); ++it) {
+    const Literals::iterator lit = literals_.find(*it);
+    if (lit != literals_.end()) {
+      lit->second.erase(guid);
+      if (lit->second.empty()) {
+        literals_.erase(lit);
+      }
+    }
+  }
+  wildcards_.erase(guid);
+  names_.erase(pos);
+}
+
+void PartitionIndex::lookup(const DDS::PartitionQosPolicy& partition, RepoIdSet& guids) const
+{
+  Names literals, wildcards;
+  get_names(partition, literals, wildcards);
+
+  for (Names::const_iterator it = literals.begin(); it != literals.end(); ++it) {
+    const Literals::const_iterator lit = literals_.find(*it);
+    if (lit != literals_.end()) {
+      guids.insert(lit->second.begin(), lit->second.end());
+    }
+  }
+  if (!literals.empty()) {
+    guids.insert(wildcards_.begin(), wildcards_.end());
+  }
+
+  for (Names::const_iterator it = wildcards.begin(); it != wildcards.end(); ++it) {
+    for (Literals::const_iterator lit = literals_.begin(); lit != literals_.end(); ++lit) {
+      if (ACE::wild_match(lit->first.c_str(), it->c_str(), true, true)) {
+        guids.insert(lit->second.begin(), lit->second.end());
+      }
+    }
+  }
+}
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
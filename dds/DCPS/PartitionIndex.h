@@ -0,0 +1,68 @@
+/*
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#ifndef OPENDDS_DCPS_PARTITION_INDEX_H
+#define OPENDDS_DCPS_PARTITION_INDEX_H
+
+#include "GuidUtils.h"
+#include "PoolAllocator.h"
+#include "dcps_export.h"
+
+#include <dds/DdsDcpsInfrastructureC.h>
+
+#if !defined (ACE_LACKS_PRAGMA_ONCE)
+#  pragma once
+#endif /* ACE_LACKS_PRAGMA_ONCE */
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+/**
+ * @class PartitionIndex
+ *
+ * @brief Endpoints of one kind (readers or writers) of a topic by partition.
+ *
+ * Endpoints are kept by each of the literal names in their partition QoS, an
+ * empty partition QoS is kept as the default partition "".  Endpoints that
+ * have a wildcard name are kept in a separate set that is part of every
+ * lookup of a literal name.  Looking up a wildcard name matches it against
+ * the literal names that are in the index, wildcards never match each other.
+ *
+ * A lookup may return endpoints that aren't in a matching partition, it is
+ * only used to avoid checking the QoS of every endpoint of the topic, but
+ * all of the endpoints that are in a matching partition are returned.
+ */
+class OpenDDS_Dcps_Export PartitionIndex {
+public:
+  /// Add guid with the names in partition, replacing the names it had.
+  void insert(const GUID_t& guid, const DDS::PartitionQosPolicy& partition);
+
+  void remove(const GUID_t& guid);
+
+  bool empty() const { return names_.empty(); }
+
+  /// Add the endpoints that may be in a partition that matches partition to guids.
+  void lookup(const DDS::PartitionQosPolicy& partition, RepoIdSet& guids) const;
+
+private:
+  typedef OPENDDS_VECTOR(String) Names;
+  typedef OPENDDS_MAP(String, RepoIdSet) Literals;
+
+  static void get_names(const DDS::PartitionQosPolicy& partition, Names& literals, Names& wildcards);
+
+  Literals literals_;
+  RepoIdSet wildcards_;
+  /// The literal names each endpoint is kept by.
+  OPENDDS_MAP_CMP(GUID_t, Names, GUID_tKeyLessThan) names_;
+};
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#endif /* OPENDDS_DCPS_PARTITION_INDEX_H */
@@ -45,7 +45,8 @@ struct OpenDDS_Dcps_Export PublicationInstance : public RcObject {
       registered_sample_(registered_sample.release()),
       instance_handle_(0),
       durable_samples_remaining_(0),
-      deadline_()
+      deadline_(),
+      deadline_key_()
   {
   }
 
@@ -72,6 +73,11 @@ struct OpenDDS_Dcps_Export PublicationInstance : public RcObject {
 
   /// Deadline for Deadline QoS.
   MonotonicTimePoint deadline_;
+
+  /// Time the instance is filed under in the writer's deadline map, or
+  /// zero_value if it isn't in the map.  Writes only move deadline_, so
+  /// this trails it until the old entry comes due and is re-filed.
+  MonotonicTimePoint deadline_key_;
 };
 
 typedef RcHandle<PublicationInstance> PublicationInstance_rch;
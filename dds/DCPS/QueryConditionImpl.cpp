@@ -23,6 +23,7 @@ QueryConditionImpl::QueryConditionImpl(
   : ReadConditionImpl(dr, sample_states, view_states, instance_states)
   , query_expression_(query_expression)
   , evaluator_(query_expression, true)
+  , result_bit_(0)
 {
   if (DCPS_debug_level > 5) {
     ACE_DEBUG((LM_DEBUG,
@@ -48,7 +49,10 @@ QueryConditionImpl::get_query_parameters(DDS::StringSeq& query_parameters)
 DDS::ReturnCode_t
 QueryConditionImpl::set_query_parameters(const DDS::StringSeq& query_parameters)
 {
-  ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, lock_, false);
+  // The sample lock is taken first, as in get_trigger_value, since the
+  // results kept in the samples are cleared.
+  ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard2, parent_->sample_lock_, DDS::RETCODE_ERROR);
+  ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, lock_, DDS::RETCODE_ERROR);
 
   // Check sequence of strings that give values to the ‘parameters’ (i.e., "%n" tokens)
   // in the query_expression matches the size of the parameter sequence.
@@ -65,9 +69,26 @@ QueryConditionImpl::set_query_parameters(const DDS::StringSeq& query_parameters)
   }
 
   query_parameters_ = query_parameters;
+  if (result_bit_) {
+    parent_->clear_query_results(result_bit_);
+  }
   return DDS::RETCODE_OK;
 }
 
+ACE_UINT32
+QueryConditionImpl::result_bit() const
+{
+  ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, lock_, 0);
+  return result_bit_;
+}
+
+void
+QueryConditionImpl::result_bit(ACE_UINT32 bit)
+{
+  ACE_GUARD(ACE_Recursive_Thread_Mutex, guard, lock_);
+  result_bit_ = bit;
+}
+
 std::vector<OPENDDS_STRING>
 QueryConditionImpl::getOrderBys() const
 {
@@ -86,13 +107,22 @@ QueryConditionImpl::get_trigger_value()
   if (hasFilter()) {
     ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard2, parent_->sample_lock_, false);
     ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, lock_, false);
+    // Every sample has a result and none of them match.
+    if (result_bit_ && !parent_->query_may_match(result_bit_)) {
+      return false;
+    }
     return parent_->contains_sample_filtered(sample_states_, view_states_,
-      instance_states_, evaluator_, query_parameters_);
+      instance_states_, *this);
   } else {
     return ReadConditionImpl::get_trigger_value();
   }
 }
 
+void QueryConditionImpl::count_result(bool match) const
+{
+  parent_->query_result(result_bit_, match);
+}
+
 TypeSupportImpl* QueryConditionImpl::get_type_support() const
 {
   DDS::TopicDescription_var td = parent_->get_topicdescription();
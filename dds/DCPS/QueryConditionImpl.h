@@ -14,6 +14,7 @@
 #include "ReadConditionImpl.h"
 #include "FilterEvaluator.h"
 #include "PoolAllocator.h"
+#include "ReceivedDataElementList.h"
 
 #if !defined (ACE_LACKS_PRAGMA_ONCE)
 #pragma once
@@ -59,6 +60,45 @@ public:
   bool filter(const Sample& s, bool sample_only_has_key_fields) const
   {
     ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, lock_, false);
+    return filter_i(s, sample_only_has_key_fields);
+  }
+
+  /**
+   * Returns true if the sample held by element matches the query.  The
+   * query is evaluated the first time it's needed for a sample, and the
+   * result is kept in element's result bits until the query parameters
+   * change.  The caller must hold the sample lock of the DataReader.
+   */
+  template<typename Sample>
+  bool filter(ReceivedDataElement& element) const
+  {
+    ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, lock_, false);
+    if (element.query_evaluated_ & result_bit_) {
+      return (element.query_matched_ & result_bit_) != 0;
+    }
+    const Sample* const sample = element.materialize() ?
+      static_cast<const Sample*>(element.registered_data_) : 0;
+    const bool match = sample && filter_i(*sample, !element.valid_data_);
+    if (result_bit_) {
+      element.query_evaluated_ |= result_bit_;
+      if (match) {
+        element.query_matched_ |= result_bit_;
+      }
+      count_result(match);
+    }
+    return match;
+  }
+
+  /// The bit of ReceivedDataElement::query_evaluated_ and query_matched_
+  /// given to this QueryCondition by its DataReader, or 0 if results
+  /// aren't kept.  See DataReaderImpl::create_querycondition.
+  ACE_UINT32 result_bit() const;
+  void result_bit(ACE_UINT32 bit);
+
+private:
+  template<typename Sample>
+  bool filter_i(const Sample& s, bool sample_only_has_key_fields) const
+  {
     /*
      * Omit the sample from results if the query references non-key fields
      * and the sample only has key fields.
@@ -77,13 +117,17 @@ public:
     return evaluator_.eval(s, query_parameters_);
   }
 
-private:
   TypeSupportImpl* get_type_support() const;
 
+  /// Count a result kept in a sample in the DataReader, see
+  /// DataReaderImpl::query_may_match.
+  void count_result(bool match) const;
+
   CORBA::String_var query_expression_;
   DDS::StringSeq query_parameters_;
   FilterEvaluator evaluator_;
-  /// Concurrent access to query_parameters_
+  ACE_UINT32 result_bit_;
+  /// Concurrent access to query_parameters_ and result_bit_
   mutable ACE_Recursive_Thread_Mutex lock_;
 };
 
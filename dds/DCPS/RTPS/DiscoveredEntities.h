@@ -14,6 +14,8 @@
 
 #include <dds/DCPS/Definitions.h>
 #include <dds/DCPS/FibonacciSequence.h>
+#include <dds/DCPS/Hash.h>
+#include <dds/DCPS/NetworkAddress.h>
 #include <dds/DCPS/PoolAllocationBase.h>
 #include <dds/DCPS/SequenceNumber.h>
 
@@ -25,6 +27,8 @@
 #  pragma once
 #endif
 
+#include <cstring>
+
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 
 namespace OpenDDS {
@@ -49,6 +53,24 @@ typedef Security::SPDPdiscoveredParticipantData ParticipantData_t;
 typedef SPDPdiscoveredParticipantData ParticipantData_t;
 #endif
 
+/// Identifies an SPDP announcement by its serialized payload, so that an
+/// announcement that repeats the previous one can be recognized without
+/// parsing it.
+struct SpdpDigest {
+  SpdpDigest() : valid_(false), user_tag_(0) {}
+
+  bool matches(const SpdpDigest& other) const
+  {
+    return valid_ && other.valid_ && user_tag_ == other.user_tag_ && from_ == other.from_
+      && std::memcmp(hash_, other.hash_, sizeof hash_) == 0;
+  }
+
+  bool valid_;
+  DCPS::MD5Result hash_;
+  ACE_CDR::ULong user_tag_;
+  DCPS::NetworkAddress from_;
+};
+
 struct DiscoveredParticipant {
   DiscoveredParticipant()
     : location_ih_(DDS::HANDLE_NIL)
@@ -157,6 +179,8 @@ struct DiscoveredParticipant {
   DCPS::SequenceNumber max_seq_;
   ACE_UINT16 seq_reset_count_;
   ACE_CDR::ULong opendds_user_tag_;
+  /// The last SPDP announcement that was fully processed.
+  SpdpDigest last_announcement_;
   typedef OPENDDS_LIST(BuiltinAssociationRecord) BuiltinAssociationRecords;
   BuiltinAssociationRecords builtin_pending_records_;
   BuiltinAssociationRecords builtin_associated_records_;
@@ -56,6 +56,33 @@ RtpsDiscoveryConfig::quick_resend_ratio(double ratio)
                                                      ratio);
 }
 
+double
+RtpsDiscoveryConfig::resend_jitter() const
+{
+  return TheServiceParticipant->config_store()->get_float64(config_key("RESEND_JITTER").c_str(), 0);
+}
+
+void
+RtpsDiscoveryConfig::resend_jitter(double ratio)
+{
+  TheServiceParticipant->config_store()->set_float64(config_key("RESEND_JITTER").c_str(),
+                                                     ratio);
+}
+
+size_t
+RtpsDiscoveryConfig::resend_load_threshold() const
+{
+  return TheServiceParticipant->config_store()->get_uint32(config_key("RESEND_LOAD_THRESHOLD").c_str(),
+                                                           0);
+}
+
+void
+RtpsDiscoveryConfig::resend_load_threshold(size_t participants)
+{
+  TheServiceParticipant->config_store()->set_uint32(config_key("RESEND_LOAD_THRESHOLD").c_str(),
+                                                    static_cast<DDS::UInt32>(participants));
+}
+
 DCPS::TimeDuration
 RtpsDiscoveryConfig::min_resend_delay() const
 {
@@ -41,6 +41,12 @@ public:
   double quick_resend_ratio() const;
   void quick_resend_ratio(double ratio);
 
+  double resend_jitter() const;
+  void resend_jitter(double ratio);
+
+  size_t resend_load_threshold() const;
+  void resend_load_threshold(size_t participants);
+
   DCPS::TimeDuration min_resend_delay() const;
   void min_resend_delay(const DCPS::TimeDuration& delay);
 
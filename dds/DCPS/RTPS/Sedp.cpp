@@ -1973,6 +1973,7 @@ Sedp::update_publication_qos(const GUID_t& publicationId,
     String topic_name = topic_names_[pb.topic_id_];
     TopicDetailsMap::iterator top_it = topics_.find(topic_name);
     if (top_it != topics_.end()) {
+      top_it->second.set_publication_partition(publicationId, pb.publisher_qos_.partition);
       match_endpoints(publicationId, top_it->second);
     }
     return true;
@@ -2025,6 +2026,7 @@ Sedp::update_subscription_qos(const GUID_t& subscriptionId,
     String topic_name = topic_names_[sb.topic_id_];
     TopicDetailsMap::iterator top_it = topics_.find(topic_name);
     if (top_it != topics_.end()) {
+      top_it->second.set_subscription_partition(subscriptionId, sb.subscriber_qos_.partition);
       match_endpoints(subscriptionId, top_it->second);
     }
     return true;
@@ -2280,6 +2282,7 @@ void Sedp::process_discovered_writer_data(DCPS::MessageId message_id,
 
       // Upsert the remote topic.
       td.add_discovered_publication(guid);
+      td.set_publication_partition(guid, pub.writer_data_.ddsPublicationData.partition);
 
       assign_bit_key(pub);
       wdata_copy = pub.writer_data_;
@@ -2306,6 +2309,7 @@ void Sedp::process_discovered_writer_data(DCPS::MessageId message_id,
         topic_name = iter->second.get_topic_name();
         TopicDetailsMap::iterator top_it = topics_.find(topic_name);
         if (top_it != topics_.end()) {
+          top_it->second.set_publication_partition(guid, iter->second.writer_data_.ddsPublicationData.partition);
           if (DCPS::DCPS_debug_level > 3) {
             ACE_DEBUG((LM_DEBUG, ACE_TEXT("(%P|%t) Sedp::process_discovered_writer_data: ")
                        ACE_TEXT("calling match_endpoints update\n")));
@@ -2582,6 +2586,7 @@ void Sedp::process_discovered_reader_data(DCPS::MessageId message_id,
 
       // Upsert the remote topic.
       td.add_discovered_subscription(guid);
+      td.set_subscription_partition(guid, sub.reader_data_.ddsSubscriptionData.partition);
 
       assign_bit_key(sub);
       rdata_copy = sub.reader_data_;
@@ -2608,6 +2613,7 @@ void Sedp::process_discovered_reader_data(DCPS::MessageId message_id,
         topic_name = iter->second.get_topic_name();
         TopicDetailsMap::iterator top_it = topics_.find(topic_name);
         if (top_it != topics_.end()) {
+          top_it->second.set_subscription_partition(guid, iter->second.reader_data_.ddsSubscriptionData.partition);
           if (DCPS::DCPS_debug_level > 3) {
             ACE_DEBUG((LM_DEBUG, ACE_TEXT("(%P|%t) Sedp::process_discovered_reader_data: ")
                        ACE_TEXT("calling match_endpoints update\n")));
@@ -6445,6 +6451,7 @@ bool Sedp::add_publication(
 
   DCPS::TopicDetails& td = topics_[topic_name];
   td.add_local_publication(rid);
+  td.set_publication_partition(rid, pb.publisher_qos_.partition);
 
   if (DDS::RETCODE_OK != add_publication_i(rid, pb)) {
     return false;
@@ -6601,6 +6608,7 @@ bool Sedp::add_subscription(
 
   DCPS::TopicDetails& td = topics_[topic_name];
   td.add_local_subscription(rid);
+  td.set_subscription_partition(rid, sb.subscriber_qos_.partition);
 
   if (DDS::RETCODE_OK != add_subscription_i(rid, sb)) {
     return false;
@@ -7027,6 +7035,10 @@ void Sedp::match_endpoints(const GUID_t& repoId, const DCPS::TopicDetails& td, b
     local_endpoints = td.local_subscriptions();
     discovered_endpoints = td.discovered_subscriptions();
   }
+  // Only the candidates are checked for QoS compatibility and associated,
+  // but the types of every endpoint of the topic are checked.
+  RepoIdSet candidates;
+  const bool indexed = !remove && match_candidates(repoId, reader, td, candidates);
 
   const bool is_remote = !equal_guid_prefixes(repoId, participant_id_);
   if (is_remote && local_endpoints.empty()) {
@@ -7040,6 +7052,8 @@ void Sedp::match_endpoints(const GUID_t& repoId, const DCPS::TopicDetails& td, b
     if (DCPS::GuidConverter(*iter).isReader() != reader) {
       if (remove) {
         remove_assoc(*iter, repoId);
+      } else if (indexed && !candidates.count(*iter)) {
+        check_type_consistency(reader ? *iter : repoId, reader ? repoId : *iter);
       } else {
         match(reader ? *iter : repoId, reader ? repoId : *iter);
       }
@@ -7057,6 +7071,8 @@ void Sedp::match_endpoints(const GUID_t& repoId, const DCPS::TopicDetails& td, b
     if (DCPS::GuidConverter(*iter).isReader() != reader) {
       if (remove) {
         remove_assoc(*iter, repoId);
+      } else if (indexed && !candidates.count(*iter)) {
+        check_type_consistency(reader ? *iter : repoId, reader ? repoId : *iter);
       } else {
         match(reader ? *iter : repoId, reader ? repoId : *iter);
       }
@@ -7064,6 +7080,47 @@ void Sedp::match_endpoints(const GUID_t& repoId, const DCPS::TopicDetails& td, b
   }
 }
 
+bool Sedp::match_candidates(const GUID_t& repoId, bool reader,
+                            const DCPS::TopicDetails& td, RepoIdSet& candidates)
+{
+  const DDS::PartitionQosPolicy* partition = 0;
+  const RepoIdSet* matched = 0;
+  if (reader) {
+    const LocalSubscriptionIter lsi = local_subscriptions_.find(repoId);
+    const DiscoveredSubscriptionIter dsi = discovered_subscriptions_.find(repoId);
+    if (lsi != local_subscriptions_.end()) {
+      partition = &lsi->second.subscriber_qos_.partition;
+      matched = &lsi->second.matched_endpoints_;
+    } else if (dsi != discovered_subscriptions_.end()) {
+      partition = &dsi->second.reader_data_.ddsSubscriptionData.partition;
+      matched = &dsi->second.matched_endpoints_;
+    }
+  } else {
+    const LocalPublicationIter lpi = local_publications_.find(repoId);
+    const DiscoveredPublicationIter dpi = discovered_publications_.find(repoId);
+    if (lpi != local_publications_.end()) {
+      partition = &lpi->second.publisher_qos_.partition;
+      matched = &lpi->second.matched_endpoints_;
+    } else if (dpi != discovered_publications_.end()) {
+      partition = &dpi->second.writer_data_.ddsPublicationData.partition;
+      matched = &dpi->second.matched_endpoints_;
+    }
+  }
+
+  if (!partition) {
+    return false;
+  }
+
+  if (reader) {
+    td.publications_in_partition(*partition, candidates);
+  } else {
+    td.subscriptions_in_partition(*partition, candidates);
+  }
+  // Endpoints that are no longer in a matching partition have to be unmatched.
+  candidates.insert(matched->begin(), matched->end());
+  return true;
+}
+
 void Sedp::cleanup_writer_association(DCPS::DataWriterCallbacks_wrch callbacks,
                                       const GUID_t& writer,
                                       const GUID_t& reader)
@@ -7286,6 +7343,131 @@ void Sedp::match(const GUID_t& writer, const GUID_t& reader)
   }
 }
 
+bool Sedp::consistent_types(const XTypes::TypeIdentifier& writer_type_id,
+                            const XTypes::TypeIdentifier& reader_type_id,
+                            const DDS::TypeConsistencyEnforcementQosPolicy& type_consistency,
+                            const String& writer_type_name,
+                            const String& reader_type_name)
+{
+  if (writer_type_id.kind() == XTypes::TK_NONE || reader_type_id.kind() == XTypes::TK_NONE) {
+    if (type_consistency.force_type_validation) {
+      // Cannot do type validation since not both TypeObjects are available
+      if (DCPS::DCPS_debug_level >= 4) {
+        ACE_DEBUG((LM_WARNING, "(%P|%t) Sedp::consistent_types: will not match because "
+          "force_type_validation is true, but TypeObjects are not available\n"));
+      }
+      return false;
+    }
+    // Fall back to matching type names
+    return reader_type_name.empty() || writer_type_name == reader_type_name;
+  }
+
+  if (type_consistency.kind != DDS::ALLOW_TYPE_COERCION) {
+    // The two types must be equivalent for DISALLOW_TYPE_COERCION
+    const bool consistent = reader_type_id == writer_type_id;
+    if (!consistent && DCPS::DCPS_debug_level >= 4) {
+      ACE_DEBUG((LM_WARNING, "(%P|%t) Sedp::consistent_types: will not match because type "
+        "ids must be the same when using DISALLOW_TYPE_COERCION\n"));
+    }
+    return consistent;
+  }
+
+  const AssignableTypesKey key(writer_type_id, reader_type_id, type_consistency);
+  const AssignableTypesMap::const_iterator pos = assignable_types_.find(key);
+  if (pos != assignable_types_.end()) {
+    return pos->second;
+  }
+
+  XTypes::TypeConsistencyAttributes attributes;
+  attributes.ignore_sequence_bounds = type_consistency.ignore_sequence_bounds;
+  attributes.ignore_string_bounds = type_consistency.ignore_string_bounds;
+  attributes.ignore_member_names = type_consistency.ignore_member_names;
+  attributes.prevent_type_widening = type_consistency.prevent_type_widening;
+  XTypes::TypeAssignability ta(type_lookup_service_, attributes);
+  const bool consistent = ta.assignable(reader_type_id, writer_type_id);
+
+  // A type object that isn't known yet could change the verdict.
+  if (type_lookup_service_ && type_lookup_service_->type_object_in_cache(writer_type_id) &&
+      type_lookup_service_->type_object_in_cache(reader_type_id)) {
+    assignable_types_[key] = consistent;
+  }
+  return consistent;
+}
+
+void Sedp::check_type_consistency(const GUID_t& writer, const GUID_t& reader)
+{
+  const LocalPublicationIter lpi = local_publications_.find(writer);
+  const DiscoveredPublicationIter dpi = discovered_publications_.find(writer);
+  const LocalSubscriptionIter lsi = local_subscriptions_.find(reader);
+  const DiscoveredSubscriptionIter dsi = discovered_subscriptions_.find(reader);
+  const bool writer_local = lpi != local_publications_.end();
+  const bool reader_local = lsi != local_subscriptions_.end();
+  if ((!writer_local && dpi == discovered_publications_.end()) ||
+      (!reader_local && dsi == discovered_subscriptions_.end()) ||
+      (!writer_local && !reader_local)) {
+    // match_continue() doesn't check discovered/discovered pairs either.
+    return;
+  }
+
+  // Like match_continue(), wait for the flexible types if there are any.
+  bool used_flexible_types = false;
+  const XTypes::TypeInformation* writer_type_info = 0;
+  String topic_name;
+  if (writer_local) {
+    writer_type_info = lpi->second.typeInfoFor(reader, &used_flexible_types);
+    if (!used_flexible_types && (lpi->second.type_info_.flags_ & DCPS::TypeInformation::Flags_FlexibleTypeSupport)) {
+      return;
+    }
+    topic_name = topic_names_[lpi->second.topic_id_];
+  } else {
+    writer_type_info = &dpi->second.type_info_;
+  }
+
+  const XTypes::TypeInformation* reader_type_info = 0;
+  const DDS::TypeConsistencyEnforcementQosPolicy* type_consistency = 0;
+  if (reader_local) {
+    used_flexible_types = false;
+    reader_type_info = lsi->second.typeInfoFor(writer, &used_flexible_types);
+    if (!used_flexible_types && (lsi->second.type_info_.flags_ & DCPS::TypeInformation::Flags_FlexibleTypeSupport)) {
+      return;
+    }
+    type_consistency = &lsi->second.qos_.type_consistency;
+    topic_name = topic_names_[lsi->second.topic_id_];
+  } else {
+    reader_type_info = &dsi->second.type_info_;
+    type_consistency = &dsi->second.reader_data_.ddsSubscriptionData.type_consistency;
+  }
+
+  const XTypes::TypeIdentifier& writer_type_id = writer_type_info->minimal.typeid_with_size.type_id;
+  const XTypes::TypeIdentifier& reader_type_id = reader_type_info->minimal.typeid_with_size.type_id;
+  if (writer_type_id.kind() != XTypes::TK_NONE && reader_type_id.kind() != XTypes::TK_NONE) {
+    // Don't ask the other participant for its types just to check an
+    // endpoint that can't be matched anyway.
+    bool need_minimal = false, need_complete = false;
+    need_type_info(writer_local ? reader_type_info : writer_type_info, need_minimal, need_complete);
+    if (need_minimal) {
+      return;
+    }
+  }
+
+  const DCPS::TopicDetailsMap::iterator td_iter = topics_.find(topic_name);
+  if (td_iter == topics_.end()) {
+    return;
+  }
+  const String writer_type_name = writer_local ?
+    td_iter->second.local_data_type_name() : dpi->second.get_type_name();
+  const String reader_type_name = reader_local ?
+    td_iter->second.local_data_type_name() : dsi->second.get_type_name();
+  if (!consistent_types(writer_type_id, reader_type_id, *type_consistency,
+                        writer_type_name, reader_type_name)) {
+    td_iter->second.increment_inconsistent();
+    if (DCPS::DCPS_debug_level) {
+      ACE_DEBUG((LM_WARNING, "(%P|%t) Sedp::check_type_consistency - WARNING Data types of topic %C do not match (inconsistent)\n",
+                 topic_name.c_str()));
+    }
+  }
+}
+
 void Sedp::request_remote_complete_type_objects(
   const GUID_t& remote_entity, const XTypes::TypeInformation& remote_type_info,
   DCPS::TypeObjReqCond& cond)
@@ -7594,7 +7776,6 @@ void Sedp::match_continue(UsedEndpoints& ue,
   }
 
   // 3. Perform type consistency check (XTypes 1.3, Section 7.6.3.4.2)
-  bool consistent = false;
 
   DCPS::TopicDetailsMap::iterator td_iter = topics_.find(topic_name);
   if (td_iter == topics_.end()) {
@@ -7624,51 +7805,24 @@ void Sedp::match_continue(UsedEndpoints& ue,
           }
         }
       }
+    }
 
-      XTypes::TypeConsistencyAttributes type_consistency;
-      type_consistency.ignore_sequence_bounds = drQos->type_consistency.ignore_sequence_bounds;
-      type_consistency.ignore_string_bounds = drQos->type_consistency.ignore_string_bounds;
-      type_consistency.ignore_member_names = drQos->type_consistency.ignore_member_names;
-      type_consistency.prevent_type_widening = drQos->type_consistency.prevent_type_widening;
-      XTypes::TypeAssignability ta(type_lookup_service_, type_consistency);
-
-      if (drQos->type_consistency.kind == DDS::ALLOW_TYPE_COERCION) {
-        consistent = ta.assignable(reader_type_id, writer_type_id);
+    String writer_type_name;
+    String reader_type_name;
+    if (writer_type_id.kind() == XTypes::TK_NONE || reader_type_id.kind() == XTypes::TK_NONE) {
+      if (writer_local) {
+        writer_type_name = td_iter->second.local_data_type_name();
       } else {
-        // The two types must be equivalent for DISALLOW_TYPE_COERCION
-        consistent = reader_type_id == writer_type_id;
-        if (!consistent && DCPS::DCPS_debug_level >= 4) {
-          ACE_DEBUG((LM_WARNING, "(%P|%t) Sedp::match_continue: will not match because type "
-            "ids must be the same when using DISALLOW_TYPE_COERCION\n"));
-        }
+        writer_type_name = dpi->second.get_type_name();
       }
-    } else {
-      if (drQos->type_consistency.force_type_validation) {
-        // Cannot do type validation since not both TypeObjects are available
-        consistent = false;
-        if (DCPS::DCPS_debug_level >= 4) {
-          ACE_DEBUG((LM_WARNING, "(%P|%t) Sedp::match_continue: will not match because "
-            "force_type_validation is true, but TypeObjects are not available\n"));
-        }
+      if (reader_local) {
+        reader_type_name = td_iter->second.local_data_type_name();
       } else {
-        // Fall back to matching type names
-        String writer_type_name;
-        String reader_type_name;
-        if (writer_local) {
-          writer_type_name = td_iter->second.local_data_type_name();
-        } else {
-          writer_type_name = dpi->second.get_type_name();
-        }
-        if (reader_local) {
-          reader_type_name = td_iter->second.local_data_type_name();
-        } else {
-          reader_type_name = dsi->second.get_type_name();
-        }
-        consistent = reader_type_name.empty() || writer_type_name == reader_type_name;
+        reader_type_name = dsi->second.get_type_name();
       }
     }
-
-    if (!consistent) {
+    if (!consistent_types(writer_type_id, reader_type_id, drQos->type_consistency,
+                          writer_type_name, reader_type_name)) {
       td_iter->second.increment_inconsistent();
       if (DCPS::DCPS_debug_level) {
         ACE_DEBUG((LM_WARNING, "(%P|%t) Sedp::match_continue - WARNING Data types of topic %C do not match (inconsistent)\n",
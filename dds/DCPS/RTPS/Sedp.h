@@ -1325,6 +1325,12 @@ protected:
   void match_endpoints(const GUID_t& repoId, const DCPS::TopicDetails& td,
                        bool remove = false);
 
+  /// Get the endpoints of td that may match repoId: the ones that may be in
+  /// a matching partition and the ones it is matched with.  Returns false if
+  /// repoId isn't a known endpoint.
+  bool match_candidates(const GUID_t& repoId, bool reader,
+                        const DCPS::TopicDetails& td, RepoIdSet& candidates);
+
   void remove_assoc(const GUID_t& remove_from, const GUID_t& removing);
 
   struct MatchingData {
@@ -1405,6 +1411,64 @@ protected:
   void match_continue(UsedEndpoints& ue,
                       const GUID_t& writer, const GUID_t& reader);
 
+  /// Type consistency check of a writer and reader (XTypes 1.3, Section
+  /// 7.6.3.4.2).  The type names are only used when either type identifier
+  /// is missing.
+  bool consistent_types(const XTypes::TypeIdentifier& writer_type_id,
+                        const XTypes::TypeIdentifier& reader_type_id,
+                        const DDS::TypeConsistencyEnforcementQosPolicy& type_consistency,
+                        const String& writer_type_name,
+                        const String& reader_type_name);
+
+  /// Count a writer and reader that the partition index kept from being
+  /// matched toward INCONSISTENT_TOPIC if their types aren't consistent, as
+  /// match_continue() would have.
+  void check_type_consistency(const GUID_t& writer, const GUID_t& reader);
+
+  /// A writer's type, a reader's type, and the parts of the reader's type
+  /// consistency policy that assignability depends on.
+  struct AssignableTypesKey {
+    AssignableTypesKey(const XTypes::TypeIdentifier& writer,
+                       const XTypes::TypeIdentifier& reader,
+                       const DDS::TypeConsistencyEnforcementQosPolicy& type_consistency)
+      : writer_type_id(writer)
+      , reader_type_id(reader)
+      , ignore_sequence_bounds(type_consistency.ignore_sequence_bounds)
+      , ignore_string_bounds(type_consistency.ignore_string_bounds)
+      , ignore_member_names(type_consistency.ignore_member_names)
+      , prevent_type_widening(type_consistency.prevent_type_widening)
+    {
+    }
+
+    bool operator<(const AssignableTypesKey& other) const
+    {
+      if (writer_type_id != other.writer_type_id) {
+        return writer_type_id < other.writer_type_id;
+      }
+      if (reader_type_id != other.reader_type_id) {
+        return reader_type_id < other.reader_type_id;
+      }
+      if (ignore_sequence_bounds != other.ignore_sequence_bounds) {
+        return ignore_sequence_bounds < other.ignore_sequence_bounds;
+      }
+      if (ignore_string_bounds != other.ignore_string_bounds) {
+        return ignore_string_bounds < other.ignore_string_bounds;
+      }
+      if (ignore_member_names != other.ignore_member_names) {
+        return ignore_member_names < other.ignore_member_names;
+      }
+      return prevent_type_widening < other.prevent_type_widening;
+    }
+
+    XTypes::TypeIdentifier writer_type_id;
+    XTypes::TypeIdentifier reader_type_id;
+    bool ignore_sequence_bounds;
+    bool ignore_string_bounds;
+    bool ignore_member_names;
+    bool prevent_type_widening;
+  };
+  typedef OPENDDS_MAP(AssignableTypesKey, bool) AssignableTypesMap;
+
   void request_type_objects(const XTypes::TypeInformation* type_info,
     const MatchingPair& mp, bool is_discovery_protected, bool get_minimal, bool get_complete);
 
@@ -1523,6 +1587,9 @@ protected:
   XTypes::TypeLookupService_rch type_lookup_service_;
   OrigSeqNumberMap orig_seq_numbers_;
   MatchingDataMap matching_data_buffer_;
+  /// Verdicts of TypeAssignability for types whose type objects are known,
+  /// since every writer and reader of a topic is checked for consistency.
+  AssignableTypesMap assignable_types_;
   RcHandle<EndpointManagerSporadic> type_lookup_reply_deadline_processor_;
   TimeDuration max_type_lookup_service_reply_period_;
   DCPS::SequenceNumber type_lookup_service_sequence_number_;
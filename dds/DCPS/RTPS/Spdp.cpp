@@ -30,6 +30,7 @@
 
 #include <ace/Reactor.h>
 #include <ace/OS_NS_sys_socket.h> // For setsockopt()
+#include <ace/OS_NS_stdlib.h>
 #include <ace/OS_NS_strings.h>
 
 #include <cstring>
@@ -233,6 +234,8 @@ Spdp::Spdp(DDS::DomainId_t domain,
   , participant_flags_(disco->config()->participant_flags())
   , resend_period_(disco->config()->resend_period())
   , quick_resend_ratio_(disco_->config()->quick_resend_ratio())
+  , resend_jitter_(disco_->config()->resend_jitter())
+  , resend_load_threshold_(disco_->config()->resend_load_threshold())
   , min_resend_delay_(disco_->config()->min_resend_delay())
   , lease_duration_(disco_->config()->lease_duration())
   , lease_extension_(disco_->config()->lease_extension())
@@ -282,6 +285,7 @@ Spdp::Spdp(DDS::DomainId_t domain,
   , total_writer_associated_(0)
   , total_reader_pending_(0)
   , total_reader_associated_(0)
+  , total_unchanged_announcements_(0)
 {
   ACE_GUARD(ACE_Thread_Mutex, g, lock_);
 
@@ -308,6 +312,8 @@ Spdp::Spdp(DDS::DomainId_t domain,
   , participant_flags_(disco->config()->participant_flags())
   , resend_period_(disco->config()->resend_period())
   , quick_resend_ratio_(disco_->config()->quick_resend_ratio())
+  , resend_jitter_(disco_->config()->resend_jitter())
+  , resend_load_threshold_(disco_->config()->resend_load_threshold())
   , min_resend_delay_(disco_->config()->min_resend_delay())
   , lease_duration_(disco_->config()->lease_duration())
   , lease_extension_(disco_->config()->lease_extension())
@@ -354,6 +360,7 @@ Spdp::Spdp(DDS::DomainId_t domain,
   , total_writer_associated_(0)
   , total_reader_pending_(0)
   , total_reader_associated_(0)
+  , total_unchanged_announcements_(0)
 {
   ACE_GUARD(ACE_Thread_Mutex, g, lock_);
 
@@ -769,7 +776,8 @@ Spdp::handle_participant_data(DCPS::MessageId id,
                               const DCPS::MonotonicTimePoint& now,
                               const DCPS::SequenceNumber& seq,
                               const DCPS::NetworkAddress& from,
-                              bool from_sedp)
+                              bool from_sedp,
+                              const SpdpDigest& digest)
 {
   // Make a (non-const) copy so we can tweak values below
   ParticipantData_t pdata(cpdata);
@@ -885,6 +893,7 @@ Spdp::handle_participant_data(DCPS::MessageId id,
 #endif
     iter = p.first;
     iter->second.discovered_at_ = now;
+    iter->second.last_announcement_ = digest;
 
     if (tport_->directed_send_task_) {
       if (tport_->directed_guids_.empty()) {
@@ -1000,6 +1009,7 @@ Spdp::handle_participant_data(DCPS::MessageId id,
     // Non-secure updates for authenticated participants are used for liveliness but
     // are otherwise ignored. Non-secure dispose messages are ignored completely.
     if (is_security_enabled() && iter->second.auth_state_ == AUTH_STATE_AUTHENTICATED && !from_sedp) {
+      iter->second.last_announcement_ = digest;
       update_lease_expiration_i(iter, now);
       if (!from_relay && from) {
         iter->second.last_recv_address_ = from;
@@ -1058,6 +1068,9 @@ Spdp::handle_participant_data(DCPS::MessageId id,
       const DCPS::MonotonicTime_t da = iter->second.pdata_.discoveredAt;
       iter->second.pdata_ = pdata;
       iter->second.pdata_.discoveredAt = da;
+      if (!from_sedp) {
+        iter->second.last_announcement_ = digest;
+      }
       update_lease_expiration_i(iter, now);
       update_rtps_relay_application_participant_i(iter, false);
       if (!from_relay && from) {
@@ -1113,10 +1126,85 @@ Spdp::validateSequenceNumber(const DCPS::MonotonicTimePoint& now, const DCPS::Se
   return true;
 }
 
+DCPS::TimeDuration
+Spdp::resend_delay(const DCPS::TimeDuration& resend_period,
+                   const DCPS::TimeDuration& lease_duration,
+                   const DCPS::TimeDuration& min_resend_delay,
+                   size_t load_threshold, size_t participants,
+                   double jitter, double random)
+{
+  TimeDuration period = resend_period;
+
+  // Announce less often in large domains so that the number of announcements
+  // each participant has to process stays about the same.
+  if (load_threshold && participants > load_threshold) {
+    const TimeDuration stretched = period * (static_cast<double>(participants) / load_threshold);
+    const TimeDuration limit = lease_duration * (1.0 / 3);
+    period = std::max(period, std::min(stretched, limit));
+  }
+
+  jitter = std::min(std::max(jitter, 0.0), 1.0);
+  if (jitter > 0) {
+    period = period * (1 - jitter * random);
+  }
+
+  return std::max(period, min_resend_delay);
+}
+
+bool
+Spdp::refresh_unchanged_participant(const GUID_t& guid,
+                                    const DCPS::SequenceNumber& seq,
+                                    const SpdpDigest& digest)
+{
+  ACE_Guard<ACE_Thread_Mutex> guard(lock_);
+  if (!initialized_flag_ || shutdown_flag_) {
+    return false;
+  }
+
+#if OPENDDS_CONFIG_SECURITY
+  // ICE needs the agent info from the parsed announcement.
+  if (!is_security_enabled() && sedp_->core().use_ice()) {
+    return false;
+  }
+#endif
+
+  DiscoveredParticipantIter iter = participants_.find(guid);
+  if (iter == participants_.end() || !iter->second.last_announcement_.matches(digest)
+      || sedp_->ignoring(guid)) {
+    return false;
+  }
+
+  // Leave sequence number resets to handle_participant_data.
+  const DCPS::SequenceNumber& max_seq = iter->second.max_seq_;
+  if (seq.getValue() != 0 && max_seq != DCPS::SequenceNumber::MAX_VALUE && seq < max_seq) {
+    return false;
+  }
+
+  const MonotonicTimePoint now = MonotonicTimePoint::now();
+  validateSequenceNumber(now, seq, iter);
+
+  const DCPS::NetworkAddress& from = digest.from_;
+  const bool from_relay = sedp_->core().from_relay(from);
+#ifndef DDS_HAS_MINIMUM_BIT
+  enqueue_location_update_i(iter, compute_location_mask(from, from_relay), from, "unchanged participant");
+#endif
+  update_lease_expiration_i(iter, now);
+  if (!from_relay && from) {
+    iter->second.last_recv_address_ = from;
+  }
+#ifndef DDS_HAS_MINIMUM_BIT
+  process_location_updates_i(iter, "unchanged participant");
+#endif
+
+  ++total_unchanged_announcements_;
+  return true;
+}
+
 void
 Spdp::data_received(const DataSubmessage& data,
                     const ParameterList& plist,
-                    const DCPS::NetworkAddress& from)
+                    const DCPS::NetworkAddress& from,
+                    const SpdpDigest& digest)
 {
   ACE_Guard<ACE_Thread_Mutex> guard(lock_);
   if (!initialized_flag_ || shutdown_flag_) {
@@ -1184,7 +1272,7 @@ Spdp::data_received(const DataSubmessage& data,
   guard.release();
 #endif
 
-  handle_participant_data(msg_id, pdata, now, to_opendds_seqnum(data.writerSN), from, false);
+  handle_participant_data(msg_id, pdata, now, to_opendds_seqnum(data.writerSN), from, false, digest);
 }
 
 void
@@ -2399,6 +2487,12 @@ Spdp::SpdpTransport::SpdpTransport(DCPS::RcHandle<Spdp> outer)
   , ice_endpoint_added_(false)
   , ignored_user_tags_(outer->get_ignored_user_tags())
 {
+  // Differ between participants that start at the same time.
+  jitter_seed_ = static_cast<unsigned int>(MonotonicTimePoint::now().value().usec());
+  for (size_t i = 0; i < sizeof outer->guid_.guidPrefix; ++i) {
+    jitter_seed_ = jitter_seed_ * 31 + outer->guid_.guidPrefix[i];
+  }
+
   hdr_.prefix[0] = 'R';
   hdr_.prefix[1] = 'T';
   hdr_.prefix[2] = 'P';
@@ -2522,7 +2616,9 @@ Spdp::SpdpTransport::open(const DCPS::ReactorTask_rch& reactor_task,
   }
 #endif
 
-  local_send_task_ = DCPS::make_rch<SpdpMulti>(reactor_task, outer->config_->resend_period(), rchandle_from(this), &SpdpTransport::send_local);
+  local_send_task_ =
+    DCPS::make_rch<SpdpSporadic>(TheServiceParticipant->time_source(), reactor_task,
+                                 rchandle_from(this), &SpdpTransport::send_local);
 
   if (outer->config_->periodic_directed_spdp()) {
     directed_send_task_ =
@@ -2637,7 +2733,7 @@ void
 Spdp::SpdpTransport::enable_periodic_tasks()
 {
   if (local_send_task_) {
-    local_send_task_->enable(TimeDuration::zero_value);
+    local_send_task_->schedule(TimeDuration::zero_value);
   }
 
   DCPS::RcHandle<Spdp> outer = outer_.lock();
@@ -2725,7 +2821,7 @@ Spdp::SpdpTransport::close(const DCPS::ReactorTask_rch& reactor_task)
   }
 #endif
   if (local_send_task_) {
-    local_send_task_->disable();
+    local_send_task_->cancel();
   }
   if (directed_send_task_) {
     directed_send_task_->cancel();
@@ -2760,7 +2856,7 @@ Spdp::SpdpTransport::shorten_local_sender_delay_i()
 
   if (local_send_task_) {
     const TimeDuration quick_resend = outer->resend_period_ * outer->quick_resend_ratio_;
-    local_send_task_->enable(std::max(quick_resend, outer->min_resend_delay_));
+    local_send_task_->schedule(std::max(quick_resend, outer->min_resend_delay_));
   }
 }
 
@@ -3214,6 +3310,7 @@ Spdp::SpdpTransport::handle_input(ACE_HANDLE h)
         }
 
         ParameterList plist;
+        SpdpDigest digest;
         if (data.smHeader.flags & (FLAG_D | FLAG_K_IN_DATA)) {
           DCPS::EncapsulationHeader encap;
           DCPS::Encoding enc;
@@ -3228,6 +3325,27 @@ Spdp::SpdpTransport::handle_input(ACE_HANDLE h)
             return 0;
           }
           ser.encoding(enc);
+
+          // Most announcements repeat the previous one from the same
+          // participant, recognize those before parsing the payload.
+          if (!data.inlineQos.length() && (data.smHeader.flags & FLAG_D)) {
+            const size_t read = start - buff_.length();
+            size_t payload_length = buff_.length();
+            if (submessageLength) {
+              const size_t end = submessageLength + SMHDR_SZ;
+              payload_length = end > read ? std::min(end - read, payload_length) : 0;
+            }
+            digest.valid_ = true;
+            DCPS::MD5Hash(digest.hash_, buff_.rd_ptr(), payload_length);
+            digest.user_tag_ = userTag;
+            digest.from_ = remote_na;
+            if (outer->refresh_unchanged_participant(make_id(header.guidPrefix, ENTITYID_PARTICIPANT),
+                                                     to_opendds_seqnum(data.writerSN), digest)) {
+              ser.skip(payload_length);
+              break;
+            }
+          }
+
           if (!(ser >> plist)) {
 
             if (DCPS::DCPS_debug_level > 0) {
@@ -3252,7 +3370,7 @@ Spdp::SpdpTransport::handle_input(ACE_HANDLE h)
 
         DCPS::RcHandle<Spdp> outer_rc = outer_.lock();
         if (outer_rc) {
-          outer_rc->data_received(data, plist, remote_na);
+          outer_rc->data_received(data, plist, remote_na, digest);
         }
         break;
       }
@@ -4486,7 +4604,27 @@ void Spdp::SpdpTransport::send_relay(const DCPS::MonotonicTimePoint& /*now*/)
 
 void Spdp::SpdpTransport::send_local(const DCPS::MonotonicTimePoint& /*now*/)
 {
-  write(SEND_MULTICAST);
+  DCPS::RcHandle<Spdp> outer = outer_.lock();
+  if (!outer) return;
+
+  ACE_GUARD(ACE_Thread_Mutex, g, outer->lock_);
+
+  // close() cancels the task after shutdown, don't schedule it again.
+  if (outer->shutdown_flag_) {
+    return;
+  }
+
+  write_i(SEND_MULTICAST);
+  local_send_task_->schedule(local_send_delay_i(*outer));
+}
+
+DCPS::TimeDuration Spdp::SpdpTransport::local_send_delay_i(const Spdp& outer)
+{
+  const double random = outer.resend_jitter_ > 0 ?
+    static_cast<double>(ACE_OS::rand_r(&jitter_seed_)) / (static_cast<double>(RAND_MAX) + 1) : 0;
+  return resend_delay(outer.resend_period_, outer.lease_duration_, outer.min_resend_delay_,
+                      outer.resend_load_threshold_, outer.participants_.size(),
+                      outer.resend_jitter_, random);
 }
 
 void Spdp::SpdpTransport::send_directed(const DCPS::MonotonicTimePoint& /*now*/)
@@ -4846,7 +4984,8 @@ namespace { namespace OPENDDS_RTPS_UNITY_BUILD_ID {
     Stats_Index_TotalReaderPending = 9,
     Stats_Index_TotalReaderAssociated = 10,
     Stats_Index_DirectedGuids = 11,
-    Stats_Len = 12;
+    Stats_Index_TotalUnchangedAnnouncements = 12,
+    Stats_Len = 13;
 } }
 
 DCPS::StatisticSeq Spdp::stats_template()
@@ -4867,6 +5006,7 @@ DCPS::StatisticSeq Spdp::stats_template()
   stats[Stats_Index_TotalReaderPending].name = "TotalReaderPending";
   stats[Stats_Index_TotalReaderAssociated].name = "TotalReaderAssociated";
   stats[Stats_Index_DirectedGuids].name = "DirectedGuids";
+  stats[Stats_Index_TotalUnchangedAnnouncements].name = "TotalUnchangedAnnouncements";
   for (DDS::UInt32 i = 0; i < sedp_template.length(); ++i) {
     stats[Stats_Len + i].name = sedp_template[i].name;
   }
@@ -4892,6 +5032,7 @@ void Spdp::fill_stats(DCPS::StatisticSeq& stats) const
   stats[Stats_Index_TotalReaderPending].value = total_reader_pending_;
   stats[Stats_Index_TotalReaderAssociated].value = total_reader_associated_;
   stats[Stats_Index_DirectedGuids].value = tport_ ? tport_->directed_guids_.size() : 0;
+  stats[Stats_Index_TotalUnchangedAnnouncements].value = total_unchanged_announcements_;
   sedp_->fill_stats(stats, Stats_Len);
 }
 
@@ -17,7 +17,6 @@
 #include <dds/DCPS/Discovery.h>
 #include <dds/DCPS/GuidUtils.h>
 #include <dds/DCPS/JobQueue.h>
-#include <dds/DCPS/MultiTask.h>
 #include <dds/DCPS/MulticastManager.h>
 #include <dds/DCPS/PeriodicTask.h>
 #include <dds/DCPS/PoolAllocationBase.h>
@@ -141,7 +140,19 @@ public:
                                const DCPS::MonotonicTimePoint& now,
                                const DCPS::SequenceNumber& seq,
                                const DCPS::NetworkAddress& from,
-                               bool from_sedp);
+                               bool from_sedp,
+                               const SpdpDigest& digest = SpdpDigest());
+
+  /**
+   * Delay between periodic participant announcements.  The resend period is
+   * stretched when more than load_threshold participants have been
+   * discovered and shortened by jitter times random, which is in [0, 1).
+   */
+  static DCPS::TimeDuration resend_delay(const DCPS::TimeDuration& resend_period,
+                                         const DCPS::TimeDuration& lease_duration,
+                                         const DCPS::TimeDuration& min_resend_delay,
+                                         size_t load_threshold, size_t participants,
+                                         double jitter, double random);
 
   bool validateSequenceNumber(const DCPS::MonotonicTimePoint& now, const DCPS::SequenceNumber& seq, DiscoveredParticipantIter& iter);
 
@@ -394,6 +405,8 @@ private:
   const CORBA::ULong participant_flags_;
   const DCPS::TimeDuration resend_period_;
   const double quick_resend_ratio_;
+  const double resend_jitter_;
+  const size_t resend_load_threshold_;
   const DCPS::TimeDuration min_resend_delay_;
   const DCPS::TimeDuration lease_duration_;
   const DCPS::TimeDuration lease_extension_;
@@ -425,7 +438,16 @@ private:
   DDS::UInt16 ipv6_participant_port_id_;
 #endif
 
-  void data_received(const DataSubmessage& data, const ParameterList& plist, const DCPS::NetworkAddress& from);
+  void data_received(const DataSubmessage& data, const ParameterList& plist, const DCPS::NetworkAddress& from,
+                     const SpdpDigest& digest);
+
+  /// If the announcement in digest repeats the last one that was processed
+  /// for the participant, only refresh the participant's lease and return
+  /// true.  Otherwise the announcement has to be parsed and passed to
+  /// data_received().
+  bool refresh_unchanged_participant(const DCPS::GUID_t& guid,
+                                     const DCPS::SequenceNumber& seq,
+                                     const SpdpDigest& digest);
 
   void match_unauthenticated(const DiscoveredParticipantIter& dp_iter);
 
@@ -575,9 +597,11 @@ private:
     DCPS::NetworkAddressSet send_addrs_;
     ACE_Message_Block buff_, wbuff_;
     typedef DCPS::PmfSporadicTask<SpdpTransport> SpdpSporadic;
-    typedef DCPS::PmfMultiTask<SpdpTransport> SpdpMulti;
     void send_local(const DCPS::MonotonicTimePoint& now);
-    DCPS::RcHandle<SpdpMulti> local_send_task_;
+    DCPS::TimeDuration local_send_delay_i(const Spdp& outer);
+    DCPS::RcHandle<SpdpSporadic> local_send_task_;
+    /// Used only by the reactor thread to jitter the periodic announcements.
+    unsigned int jitter_seed_;
     void send_directed(const DCPS::MonotonicTimePoint& now);
     DCPS::RcHandle<SpdpSporadic> directed_send_task_;
     OPENDDS_LIST(DCPS::GUID_t) directed_guids_;
@@ -707,7 +731,8 @@ private:
   static DCPS::StatisticSeq stats_template();
   const DCPS::StatisticSeq stats_template_;
   size_t total_location_updates_, total_builtin_pending_, total_builtin_associated_,
-    total_writer_pending_, total_writer_associated_, total_reader_pending_, total_reader_associated_;
+    total_writer_pending_, total_writer_associated_, total_reader_pending_, total_reader_associated_,
+    total_unchanged_announcements_;
 
   friend class ::DDS_TEST;
 };
@@ -8,12 +8,15 @@
 
 #include "ReceivedDataElementList.h"
 #include "SubscriptionInstance.h"
+#include "PoolAllocator.h"
 #include "dcps_export.h"
 
 #ifndef ACE_LACKS_PRAGMA_ONCE
 #  pragma once
 #endif
 
+#include <functional>
+
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 
 namespace OpenDDS {
@@ -28,6 +31,45 @@ struct OpenDDS_Dcps_Export RakeData {
   size_t index_in_instance_;
 };
 
+/// What RakeResults<T>::copy_into() needs to know about each sample it
+/// copied in order to fill in the *_rank fields of the SampleInfo once all
+/// samples are in the sequence.
+struct OpenDDS_Dcps_Export RakeCopyRecord {
+  SubscriptionInstance* inst_;
+  CORBA::ULong idx_;
+  size_t index_in_instance_;
+  CORBA::Long disposed_gc_, nowriters_gc_;
+  /// Generation counts of the instance's most recent sample
+  CORBA::Long mrs_disposed_gc_, mrs_nowriters_gc_;
+  bool most_recent_generation_;
+  bool released_;
+
+  /// Groups records by instance, keeping sequence order within an instance.
+  bool operator<(const RakeCopyRecord& other) const
+  {
+    if (inst_ != other.inst_) {
+      return std::less<SubscriptionInstance*>()(inst_, other.inst_);
+    }
+    return idx_ < other.idx_;
+  }
+};
+
+/// Containers used by RakeResults<T>.  The DataReader keeps one of these so
+/// that the storage is recycled from one read or take to the next instead of
+/// being allocated on every call.
+struct RakeScratch {
+  RakeScratch() : in_use_(false) {}
+
+  OPENDDS_VECTOR(RakeData) unsorted_;
+  OPENDDS_VECTOR(RakeCopyRecord) copied_;
+  /// Deferred samples that couldn't be deserialized, they are dropped
+  /// instead of being returned.  Once they are dropped only the ones that
+  /// were still in their instance are kept, to renumber the samples after
+  /// them.
+  OPENDDS_VECTOR(RakeData) undecodable_;
+  bool in_use_;
+};
+
 } // namespace DCPS
 } // namespace OpenDDS
 
@@ -13,6 +13,8 @@
 #include "QueryConditionImpl.h"
 #include "PoolAllocator.h"
 
+#include <algorithm>
+
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 
 namespace OpenDDS {
@@ -38,7 +40,11 @@ RakeResults<MessageType>::RakeResults(DataReaderImpl* reader,
   , oper_(oper)
   , do_sort_(false)
   , do_filter_(false)
+  , scratch_(reader && !reader->rake_scratch_.in_use_ ? &reader->rake_scratch_ : &local_scratch_)
+  , unsorted_(scratch_->unsorted_)
 {
+  scratch_->in_use_ = true;
+
 #ifndef OPENDDS_NO_QUERY_CONDITION
 
   if (cond_) {
@@ -78,18 +84,35 @@ RakeResults<MessageType>::RakeResults(DataReaderImpl* reader,
 #endif
 }
 
+template <class MessageType>
+RakeResults<MessageType>::~RakeResults()
+{
+  // clear() keeps the capacity for the next read or take
+  scratch_->unsorted_.clear();
+  scratch_->copied_.clear();
+  scratch_->undecodable_.clear();
+  scratch_->in_use_ = false;
+}
+
 template <class MessageType>
 bool RakeResults<MessageType>::insert_sample(ReceivedDataElement* sample,
                                              ReceivedDataElementList* rdel,
                                              SubscriptionInstance_rch instance,
                                              size_t index_in_instance)
 {
+  if (!do_sort_ && unsorted_.size() == max_samples_) return false;
+
+  if (!sample->materialize()) {
+    RakeData rd = {sample, rdel, instance, index_in_instance};
+    scratch_->undecodable_.push_back(rd);
+    return false;
+  }
+
 #ifndef OPENDDS_NO_QUERY_CONDITION
 
   if (do_filter_) {
     const QueryConditionImpl* qci = dynamic_cast<QueryConditionImpl*>(cond_);
-    const MessageType* typed_sample = static_cast<MessageType*>(sample->registered_data_);
-    if (!qci || !typed_sample || !qci->filter(*typed_sample, !sample->valid_data_)) {
+    if (!qci || !qci->filter<MessageType>(*sample)) {
       return false;
     }
   }
@@ -107,8 +130,6 @@ bool RakeResults<MessageType>::insert_sample(ReceivedDataElement* sample,
     sorted_.insert(rd);
 
   } else {
-    if (unsorted_.size() == max_samples_) return false;
-
     RakeData rd = {sample, rdel, instance, index_in_instance};
     unsorted_.push_back(rd);
   }
@@ -121,11 +142,11 @@ template <class FwdIter>
 bool RakeResults<MessageType>::copy_into(FwdIter iter, FwdIter end,
                                          MessageSequenceAdapterType& received_data_p)
 {
-  typedef OPENDDS_MAP(SubscriptionInstance*, InstanceData) InstanceMap;
-  InstanceMap inst_map;
+  OPENDDS_VECTOR(RakeCopyRecord)& records = scratch_->copied_;
+  records.clear();
 
-  typedef OPENDDS_SET(SubscriptionInstance*) InstanceSet;
-  InstanceSet released_instances;
+  const bool take_stats = oper_ == DDS_OPERATION_TAKE && reader_->statistics_enabled();
+  const SystemTimePoint now = take_stats ? SystemTimePoint::now() : SystemTimePoint();
 
   for (CORBA::ULong idx = 0; iter != end && idx < max_samples_; ++idx, ++iter) {
     // 1. Populate the Received Data sequence
@@ -150,81 +171,100 @@ bool RakeResults<MessageType>::copy_into(FwdIter iter, FwdIter end,
     inst.instance_state_->sample_info(info_seq_[idx], rde);
     rdel->mark_read(rde);
 
-    // 3. Record some info about per-instance SampleInfo (*_rank) so that
-    //    we can fill in the ranks after the loop has completed
-    std::pair<typename InstanceMap::iterator, bool> result =
-      inst_map.insert(std::make_pair(&inst, InstanceData()));
-    InstanceData& id = result.first->second;
-
-    if (result.second) { // first time we've seen this Instance
-      const ReceivedDataElement& mrs = *inst.rcvd_samples_.peek_tail();
-      id.MRS_disposed_gc_ =
-        static_cast<CORBA::Long>(mrs.disposed_generation_count_);
-      id.MRS_nowriters_gc_ =
-        static_cast<CORBA::Long>(mrs.no_writers_generation_count_);
-    }
-
-    if (iter->index_in_instance_ >= id.MRSIC_index_) {
-      id.MRSIC_index_ = iter->index_in_instance_;
-      id.MRSIC_disposed_gc_ =
-        static_cast<CORBA::Long>(rde->disposed_generation_count_);
-      id.MRSIC_nowriters_gc_ =
-        static_cast<CORBA::Long>(rde->no_writers_generation_count_);
-    }
-
-    if (!id.most_recent_generation_) {
-      id.most_recent_generation_ =
-        inst.instance_state_->most_recent_generation(rde);
-    }
-
-    id.sampleinfo_positions_.push_back(idx);
+    // 3. Record some info about the sample and its instance so that we can
+    //    fill in the ranks after the loop has completed
+    const ReceivedDataElement& mrs = *inst.rcvd_samples_.peek_tail();
+    RakeCopyRecord record;
+    record.inst_ = &inst;
+    record.idx_ = idx;
+    record.index_in_instance_ = index_in_instance(*iter);
+    record.disposed_gc_ = static_cast<CORBA::Long>(rde->disposed_generation_count_);
+    record.nowriters_gc_ = static_cast<CORBA::Long>(rde->no_writers_generation_count_);
+    record.mrs_disposed_gc_ = static_cast<CORBA::Long>(mrs.disposed_generation_count_);
+    record.mrs_nowriters_gc_ = static_cast<CORBA::Long>(mrs.no_writers_generation_count_);
+    record.most_recent_generation_ = inst.instance_state_->most_recent_generation(rde);
+    record.released_ = false;
 
     // 4. Take
     if (oper_ == DDS_OPERATION_TAKE) {
-      // If removing the sample releases it
-      if (inst.rcvd_samples_.remove(rde)) {
-        // Prevent access of the SampleInfo, below
-        released_instances.insert(&inst);
+      if (take_stats) {
+        reader_->process_take_latency(*rde, now);
       }
+      // If removing the sample releases it, prevent access of the instance below
+      record.released_ = inst.rcvd_samples_.remove(rde);
       rde->dec_ref();
     }
+
+    records.push_back(record);
   }
 
-  // Fill in the *_ranks in the SampleInfo, and set instance state (mrg)
-  for (typename InstanceMap::iterator i_iter(inst_map.begin()),
-       i_end(inst_map.end()); i_iter != i_end; ++i_iter) {
-
-    InstanceData& id = i_iter->second;
-    {  // Danger, limit visibility of inst
-      SubscriptionInstance& inst = *i_iter->first;
-      // If this instance has not been released
-      if (released_instances.find(&inst) == released_instances.end()) {
-        if (id.most_recent_generation_) {
-          inst.instance_state_->accessed();
-        }
+  // Fill in the *_ranks in the SampleInfo, and set instance state (mrg),
+  // one instance at a time
+  std::sort(records.begin(), records.end());
+  for (size_t first = 0, last = 0; first < records.size(); first = last) {
+    // The first record of an instance was its first sample in the results,
+    // so it has the instance's most recent sample as of the start of the copy.
+    const RakeCopyRecord& head = records[first];
+    size_t MRSIC_index = 0;
+    CORBA::Long MRSIC_disposed_gc = 0, MRSIC_nowriters_gc = 0;
+    bool most_recent_generation = false;
+    bool released = false;
+    for (last = first; last < records.size() && records[last].inst_ == head.inst_; ++last) {
+      const RakeCopyRecord& record = records[last];
+      if (record.index_in_instance_ >= MRSIC_index) {
+        MRSIC_index = record.index_in_instance_;
+        MRSIC_disposed_gc = record.disposed_gc_;
+        MRSIC_nowriters_gc = record.nowriters_gc_;
       }
+      most_recent_generation = most_recent_generation || record.most_recent_generation_;
+      released = released || record.released_;
     }
 
-    CORBA::Long sample_rank =
-      static_cast<CORBA::Long>(id.sampleinfo_positions_.size());
+    if (!released && most_recent_generation) {
+      head.inst_->instance_state_->accessed();
+    }
 
-    for (IndexList::iterator s_iter(id.sampleinfo_positions_.begin()),
-         s_end(id.sampleinfo_positions_.end()); s_iter != s_end; ++s_iter) {
-      DDS::SampleInfo& si = info_seq_[*s_iter];
+    CORBA::Long sample_rank = static_cast<CORBA::Long>(last - first);
+    for (size_t i = first; i < last; ++i) {
+      DDS::SampleInfo& si = info_seq_[records[i].idx_];
       si.sample_rank = --sample_rank;
-      si.generation_rank = id.MRSIC_disposed_gc_
-                           + id.MRSIC_nowriters_gc_ - si.generation_rank;
-      si.absolute_generation_rank = id.MRS_disposed_gc_ +
-                                    id.MRS_nowriters_gc_ - si.absolute_generation_rank;
+      si.generation_rank = MRSIC_disposed_gc
+                           + MRSIC_nowriters_gc - si.generation_rank;
+      si.absolute_generation_rank = head.mrs_disposed_gc_ +
+                                    head.mrs_nowriters_gc_ - si.absolute_generation_rank;
     }
   }
 
   return true;
 }
 
+template <class MessageType>
+size_t RakeResults<MessageType>::index_in_instance(const RakeData& rd) const
+{
+  size_t index = rd.index_in_instance_;
+  const OPENDDS_VECTOR(RakeData)& dropped = scratch_->undecodable_;
+  for (size_t i = 0; i < dropped.size(); ++i) {
+    if (dropped[i].rdel_ == rd.rdel_ && dropped[i].index_in_instance_ < rd.index_in_instance_) {
+      --index;
+    }
+  }
+  return index;
+}
+
 template <class MessageType>
 bool RakeResults<MessageType>::copy_to_user()
 {
+  // Keep the samples that were dropped so that index_in_instance() can
+  // renumber the ones that follow them.
+  OPENDDS_VECTOR(RakeData)& undecodable = scratch_->undecodable_;
+  size_t dropped = 0;
+  for (size_t i = 0; i < undecodable.size(); ++i) {
+    if (reader_ && reader_->drop_undecodable(undecodable[i].rde_, *undecodable[i].rdel_)) {
+      undecodable[dropped++] = undecodable[i];
+    }
+  }
+  undecodable.resize(dropped);
+
   MessageSequenceAdapterType received_data_p(received_data_);
 
   if (do_sort_) {
@@ -45,6 +45,8 @@ public:
 #endif
               Operation_t oper);
 
+  ~RakeResults();
+
   /// Returns false if the sample will definitely not be part of the
   /// resulting dataset, however if this returns true it still may be
   /// excluded (due to sorting and max_samples).
@@ -60,6 +62,10 @@ private:
   bool copy_into(FwdIter begin, FwdIter end,
                  MessageSequenceAdapterType& received_data_p);
 
+  /// Position of the sample in its instance once the undecodable samples
+  /// before it have been dropped.
+  size_t index_in_instance(const RakeData& rd) const;
+
   RakeResults(const RakeResults&); // no copy construction
   RakeResults& operator=(const RakeResults&); // no assignment
 
@@ -98,21 +104,12 @@ private:
   // Contains data for QueryCondition/Ordered access
   SortedSet sorted_;
 
-  // Contains data for all other use cases
-  OPENDDS_VECTOR(RakeData) unsorted_;
-
-  // data structures used by copy_into()
-  typedef OPENDDS_VECTOR(CORBA::ULong) IndexList;
-  struct InstanceData {
-    bool most_recent_generation_;
-    size_t MRSIC_index_;
-    IndexList sampleinfo_positions_;
-    CORBA::Long MRSIC_disposed_gc_, MRSIC_nowriters_gc_,
-    MRS_disposed_gc_, MRS_nowriters_gc_;
-    InstanceData() : most_recent_generation_(false), MRSIC_index_(0),
-      MRSIC_disposed_gc_(0), MRSIC_nowriters_gc_(0), MRS_disposed_gc_(0),
-      MRS_nowriters_gc_(0) {}
-  };
+  // Contains data for all other use cases and the records used by
+  // copy_into().  Normally this is the reader's RakeScratch, unless it is
+  // already in use further up the stack.
+  RakeScratch local_scratch_;
+  RakeScratch* scratch_;
+  OPENDDS_VECTOR(RakeData)& unsorted_;
 };
 
 } // namespace DCPS
@@ -87,6 +87,7 @@ OpenDDS::DCPS::ReceivedDataElementList::add_by_timestamp(ReceivedDataElement *da
       it->previous_data_sample_ = data_sample;
 
       ++size_;
+      sample_added();
 #ifndef OPENDDS_NO_OBJECT_MODEL_PROFILE
       if (!data_sample->coherent_change_)
 #endif
@@ -189,6 +190,13 @@ OpenDDS::DCPS::ReceivedDataElementList::remove(ReceivedDataElement* item)
   item->previous_data_sample_ = 0;
   item->next_data_sample_ = 0;
 
+#ifndef OPENDDS_NO_QUERY_CONDITION
+  DataReaderImpl_rch reader(reader_.lock());
+  if (reader) {
+    reader->query_sample_removed(*item);
+  }
+#endif
+
   if (instance_state_ && size_ == 0) {
     // let the instance know it is empty
     released = instance_state_->empty(true);
@@ -208,6 +216,17 @@ OpenDDS::DCPS::ReceivedDataElementList::has_zero_copies() const
   return false;
 }
 
+bool
+OpenDDS::DCPS::ReceivedDataElementList::contains(const ReceivedDataElement* item) const
+{
+  for (const ReceivedDataElement* i = head_; i != 0; i = i->next_data_sample_) {
+    if (i == item) {
+      return true;
+    }
+  }
+  return false;
+}
+
 bool
 OpenDDS::DCPS::ReceivedDataElementList::matches(CORBA::ULong sample_states) const
 {
@@ -262,6 +281,16 @@ OpenDDS::DCPS::ReceivedDataElementList::accept_coherent_change(OpenDDS::DCPS::Re
 }
 #endif
 
+void OpenDDS::DCPS::ReceivedDataElementList::sample_added()
+{
+#ifndef OPENDDS_NO_QUERY_CONDITION
+  DataReaderImpl_rch reader(reader_.lock());
+  if (reader) {
+    reader->query_sample_added();
+  }
+#endif
+}
+
 void OpenDDS::DCPS::ReceivedDataElementList::increment_read_count()
 {
   if (!read_sample_count_) {
@@ -49,6 +49,10 @@ public:
       sequence_(header.sequence_),
       previous_data_sample_(0),
       next_data_sample_(0),
+#ifndef OPENDDS_NO_QUERY_CONDITION
+      query_evaluated_(0),
+      query_matched_(0),
+#endif
       ref_count_(1),
       mx_(mx)
   {
@@ -83,6 +87,11 @@ public:
     return ref_count_;
   }
 
+  /// Deserialize registered_data_ if the DataReader deferred it when the
+  /// sample arrived.  Returns false, and clears valid_data_, if the retained
+  /// payload could not be deserialized.
+  virtual bool materialize() { return true; }
+
   GUID_t pub_;
 
   /**
@@ -136,6 +145,15 @@ public:
   /// the next data sample in the ReceivedDataElementList
   ReceivedDataElement* next_data_sample_;
 
+#ifndef OPENDDS_NO_QUERY_CONDITION
+  /// Results of the QueryConditions of the DataReader for this sample, one
+  /// bit for each, see QueryConditionImpl::filter.  A bit of
+  /// query_matched_ is only meaningful if it's set in query_evaluated_.
+  /// Guarded by the sample lock of the DataReader.
+  ACE_UINT32 query_evaluated_;
+  ACE_UINT32 query_matched_;
+#endif
+
   void* operator new(size_t size, ACE_New_Allocator& pool);
   void operator delete(void* memory);
   void operator delete(void* memory, ACE_New_Allocator& pool);
@@ -168,6 +186,15 @@ public:
               *mx_)
     delete static_cast<DataTypeWithAllocator*> (registered_data_);
   }
+
+  bool materialize()
+  {
+    if (registered_data_ && !static_cast<DataTypeWithAllocator*>(registered_data_)->materialize()) {
+      valid_data_ = false;
+      return false;
+    }
+    return true;
+  }
 };
 
 class OpenDDS_Dcps_Export ReceivedDataFilter {
@@ -212,6 +239,7 @@ public:
   size_t size() const { return size_; }
 
   bool has_zero_copies() const;
+  bool contains(const ReceivedDataElement* item) const;
   bool matches(CORBA::ULong sample_states) const;
   ReceivedDataElement* get_next_match(CORBA::ULong sample_states, ReceivedDataElement* prev);
 
@@ -236,6 +264,9 @@ private:
   CORBA::ULong not_read_sample_count_;
   CORBA::ULong sample_states_;
 
+  /// Tell the DataReader about a new sample, see
+  /// DataReaderImpl::query_sample_added.
+  void sample_added();
   void increment_read_count();
   void decrement_read_count();
   void increment_not_read_count();
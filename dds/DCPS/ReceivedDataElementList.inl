@@ -21,6 +21,7 @@ OpenDDS::DCPS::ReceivedDataElementList::add(ReceivedDataElement *data_sample)
   data_sample->next_data_sample_ = 0;
 
   ++size_;
+  sample_added();
 
 #ifndef OPENDDS_NO_OBJECT_MODEL_PROFILE
   if (!data_sample->coherent_change_)
@@ -87,6 +87,9 @@ public:
 
 #ifndef OPENDDS_NO_CONTENT_SUBSCRIPTION_PROFILE
   virtual bool eval(FilterEvaluator& evaluator, const DDS::StringSeq& params) const = 0;
+
+  /// Value of a field named the way filter expressions name it.
+  virtual Value get_field_value(const char* field) const = 0;
 #endif
 
 protected:
@@ -226,7 +229,13 @@ public:
   Sample_rch copy(Mutability mutability, Extent extent) const
   {
     NativeType* new_data = new NativeType;
-    *new_data = *data_;
+    if (extent == KeyOnly) {
+      // Instances are registered with a key-only copy of the sample, so
+      // don't copy and then hold on to large non-key members.
+      TraitsType::copy_keys(*new_data, *data_);
+    } else {
+      *new_data = *data_;
+    }
     return dynamic_rchandle_cast<Sample>(mutability == ReadOnly ?
       make_rch<Sample_T<NativeType> >(const_cast<const NativeType*>(new_data), extent) :
       make_rch<Sample_T<NativeType> >(new_data, extent));
@@ -259,6 +268,11 @@ public:
   {
     return evaluator.eval(*data_, params);
   }
+
+  Value get_field_value(const char* field) const
+  {
+    return getMetaStruct<NativeType>().getValue(data_, field);
+  }
 #endif
 
 private:
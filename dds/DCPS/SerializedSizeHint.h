@@ -0,0 +1,108 @@
+/*
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#ifndef OPENDDS_DCPS_SERIALIZED_SIZE_HINT_H
+#define OPENDDS_DCPS_SERIALIZED_SIZE_HINT_H
+
+#include "Atomic.h"
+#include "Definitions.h"
+
+#include <ace/Message_Block.h>
+
+#include <cstddef>
+
+#if !defined (ACE_LACKS_PRAGMA_ONCE)
+#  pragma once
+#endif /* ACE_LACKS_PRAGMA_ONCE */
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+/**
+ * Running estimate of the serialized size of samples of unbounded types.
+ * Samples are serialized into a buffer of buffer_size() without calling
+ * serialized_size first.  If that buffer is too small, the exact size is
+ * computed and passed to grow() before serializing again, so that samples
+ * that keep getting bigger don't keep overflowing the buffer.
+ */
+class SerializedSizeHint {
+public:
+  SerializedSizeHint()
+    : hint_(0)
+  {}
+
+  /// Size of the buffer to try, 0 if there is no estimate yet.
+  size_t buffer_size() const
+  {
+    const size_t hint = hint_.load();
+    return hint + hint / 8;
+  }
+
+  /// A sample of size bytes fit in the buffer.
+  void fit(size_t size)
+  {
+    // Grow immediately, but shrink slowly so an occasional small sample
+    // doesn't cause the next large one to overflow.
+    const size_t hint = hint_.load();
+    hint_ = size >= hint ? size : hint - (hint - size) / 16;
+  }
+
+  /// A sample of size bytes didn't fit in the buffer, or there was no
+  /// estimate.  The estimate is grown past size so the next sample has
+  /// room to be a bit bigger.
+  void grow(size_t size)
+  {
+    const size_t hint = hint_.load();
+    if (hint == 0) {
+      hint_ = size;
+    } else if (size >= hint) {
+      hint_ = size + size / 4;
+    }
+  }
+
+  size_t hint() const { return hint_.load(); }
+
+  /**
+   * Serialize a sample into a buffer of buffer_size(), or of its exact size
+   * if there is no estimate yet or it didn't fit.  Returns 0 if it couldn't
+   * be serialized.  SampleSerializer needs:
+   *   - ACE_Message_Block* serialize(size_t buffer_size, bool log_errors) const
+   *   - size_t exact_size() const, the size serialize() needs
+   *   - void serialize_failed() const, called if the sample failed to
+   *     serialize even though it fit in the buffer.  It isn't serialized
+   *     again since it would fail the same way.
+   */
+  template <typename SampleSerializer>
+  ACE_Message_Block* serialize(const SampleSerializer& serializer)
+  {
+    const size_t buffer = buffer_size();
+    if (buffer) {
+      ACE_Message_Block* const mb = serializer.serialize(buffer, false);
+      if (mb) {
+        fit(mb->length());
+        return mb;
+      }
+    }
+    const size_t size = serializer.exact_size();
+    if (buffer && size <= buffer) {
+      serializer.serialize_failed();
+      return 0;
+    }
+    grow(size);
+    return serializer.serialize(size, true);
+  }
+
+private:
+  Atomic<size_t> hint_;
+};
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#endif /* OPENDDS_DCPS_SERIALIZED_SIZE_HINT_H */
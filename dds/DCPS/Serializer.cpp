@@ -22,6 +22,7 @@
 #include <ace/Log_Msg.h>
 
 #include <cstdlib>
+#include <cstring>
 
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 
@@ -611,6 +612,64 @@ bool Serializer::write_parameter_id(const unsigned id, const size_t size, const
   return true;
 }
 
+bool Serializer::begin_parameter(ParameterMark& mark, unsigned id, bool must_understand)
+{
+  mark = ParameterMark();
+  // The space check covers the header and a member small enough to use one of
+  // the length codes without a NEXTINT, so that end_parameter can remove the
+  // NEXTINT without crossing into another block.
+  static const size_t reserved_space = 2 * uint32_cdr_size + 8;
+  if (encoding().xcdr_version() != Encoding::XCDR_VERSION_2 ||
+      static_cast<ACE_CDR::ULong>(id) > MEMBER_ID_MAX ||
+      !align_w(uint32_cdr_size) || !current_ || current_->space() < reserved_space) {
+    return false;
+  }
+  char* const slot = current_->wr_ptr();
+  if (!(*this << ACE_CDR::ULong(0)) || !(*this << ACE_CDR::ULong(0))) {
+    return false;
+  }
+  mark.slot = slot;
+  mark.start = wpos_;
+  mark.id = id;
+  mark.must_understand = must_understand;
+  return true;
+}
+
+bool Serializer::end_parameter(const ParameterMark& mark)
+{
+  if (!mark.slot) {
+    return true;
+  }
+  if (!good_bit_) {
+    return false;
+  }
+  const size_t size = wpos_ - mark.start;
+  const ACE_CDR::ULong lc = (size == 1 ? 0 : size == 2 ? 1 : size == 4 ? 2 : size == 8 ? 3 : 4);
+  const ACE_CDR::ULong emheader = (lc << 28) | mark.id | (mark.must_understand ? emheader_must_understand : 0);
+  char* const nextint = mark.slot + uint32_cdr_size;
+  if (lc != 4) {
+    // This member doesn't get a NEXTINT, so move it back over the one that was
+    // reserved. Members are 4-byte aligned in XCDR2, so this doesn't change
+    // the alignment of anything in the member.
+    if (current_->wr_ptr() != nextint + uint32_cdr_size + size) {
+      good_bit_ = false;
+      return false;
+    }
+    std::memmove(nextint, nextint + uint32_cdr_size, size);
+    current_->wr_ptr(nextint + size);
+    wpos_ -= uint32_cdr_size;
+  } else {
+    const ACE_CDR::ULong nextint_value = static_cast<ACE_CDR::ULong>(size);
+    swap_bytes_
+      ? swapcpy(nextint, reinterpret_cast<const char*>(&nextint_value), uint32_cdr_size)
+      : smemcpy(nextint, reinterpret_cast<const char*>(&nextint_value), uint32_cdr_size);
+  }
+  swap_bytes_
+    ? swapcpy(mark.slot, reinterpret_cast<const char*>(&emheader), uint32_cdr_size)
+    : smemcpy(mark.slot, reinterpret_cast<const char*>(&emheader), uint32_cdr_size);
+  return good_bit_;
+}
+
 } // namespace DCPS
 } // namespace OpenDDS
 
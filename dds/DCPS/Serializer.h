@@ -621,6 +621,35 @@ public:
    */
   bool write_parameter_id(const unsigned id, size_t size, bool must_understand = false);
 
+  /// Location of an XCDR2 member header reserved by begin_parameter.
+  struct ParameterMark {
+    ParameterMark() : slot(0), start(0), id(0), must_understand(false) {}
+    char* slot;
+    size_t start;
+    unsigned id;
+    bool must_understand;
+  };
+
+  /**
+   * Reserve the EMHEADER and NEXTINT of an XCDR2 mutable struct member that
+   * will be filled in by end_parameter once the member has been written. This
+   * allows the member to be written without calling serialized_size first.
+   *
+   * Returns false without writing anything if the header can't be reserved.
+   * In that case the caller should use write_parameter_id.
+   */
+  bool begin_parameter(ParameterMark& mark, unsigned id, bool must_understand = false);
+
+  /**
+   * Fill in the member header reserved by begin_parameter. The result is the
+   * same as if write_parameter_id had been called with the size of the member,
+   * including the length codes that don't use a NEXTINT. Does nothing if mark
+   * wasn't reserved.
+   *
+   * Returns true if successful.
+   */
+  bool end_parameter(const ParameterMark& mark);
+
   /**
    * Write the parameter ID that marks the end of XCDR1 parameter lists.
    *
@@ -651,6 +680,30 @@ public:
    */
   bool write_delimiter(size_t size);
 
+  /// Location of a delimiter reserved by begin_delimiter.
+  struct DelimiterMark {
+    DelimiterMark() : slot(0), start(0) {}
+    char* slot;
+    size_t start;
+  };
+
+  /**
+   * Reserve a delimiter used for XCDR2 delimited data that will be filled in
+   * by end_delimiter once the delimited data has been written. This allows
+   * delimited data to be written without calling serialized_size first.
+   *
+   * Returns false without writing the delimiter if it can't be reserved in
+   * contiguous space. In that case the caller should use write_delimiter.
+   */
+  bool begin_delimiter(DelimiterMark& mark);
+
+  /**
+   * Write the size of the data written since begin_delimiter into the
+   * delimiter it reserved. Does nothing if mark wasn't reserved.
+   * Returns true if successful.
+   */
+  bool end_delimiter(const DelimiterMark& mark);
+
   enum ConstructionStatus {
     ConstructionSuccessful,
     ElementConstructionFailure,
@@ -892,6 +892,39 @@ bool Serializer::write_delimiter(size_t size)
   return true;
 }
 
+ACE_INLINE
+bool Serializer::begin_delimiter(DelimiterMark& mark)
+{
+  mark = DelimiterMark();
+  if (encoding().xcdr_version() != Encoding::XCDR_VERSION_2 ||
+      !align_w(uint32_cdr_size) || !current_ || current_->space() < uint32_cdr_size) {
+    return false;
+  }
+  char* const slot = current_->wr_ptr();
+  if (!(*this << ACE_CDR::ULong(0))) {
+    return false;
+  }
+  mark.slot = slot;
+  mark.start = wpos_;
+  return true;
+}
+
+ACE_INLINE
+bool Serializer::end_delimiter(const DelimiterMark& mark)
+{
+  if (!mark.slot) {
+    return true;
+  }
+  if (!good_bit_) {
+    return false;
+  }
+  const ACE_CDR::ULong size = static_cast<ACE_CDR::ULong>(wpos_ - mark.start);
+  swap_bytes_
+    ? swapcpy(mark.slot, reinterpret_cast<const char*>(&size), uint32_cdr_size)
+    : smemcpy(mark.slot, reinterpret_cast<const char*>(&size), uint32_cdr_size);
+  return good_bit_;
+}
+
 ACE_INLINE
 bool Serializer::write_list_end_parameter_id()
 {
@@ -44,6 +44,12 @@ void ServiceEventDispatcher::shutdown(bool immediate)
   }
 }
 
+bool ServiceEventDispatcher::on_thread() const
+{
+  ACE_Guard<ACE_Thread_Mutex> guard(mutex_);
+  return dispatcher_ && dispatcher_->on_thread();
+}
+
 bool ServiceEventDispatcher::dispatch(EventBase_rch event)
 {
   ACE_Guard<ACE_Thread_Mutex> guard(mutex_);
@@ -27,6 +27,9 @@ public:
 
   void shutdown(bool immediate = false);
 
+  /// True if called from an event, where shutdown can't be called.
+  bool on_thread() const;
+
   bool dispatch(EventBase_rch event);
 
   long schedule(EventBase_rch event, const MonotonicTimePoint& expiration = MonotonicTimePoint::now());
@@ -1590,6 +1590,123 @@ Service_Participant::publisher_content_filter() const
                                     COMMON_DCPS_PUBLISHER_CONTENT_FILTER_default);
 }
 
+void
+Service_Participant::lazy_deserialization(bool flag)
+{
+  config_store_->set_boolean(COMMON_DCPS_LAZY_DESERIALIZATION, flag);
+}
+
+bool
+Service_Participant::lazy_deserialization() const
+{
+  return config_store_->get_boolean(COMMON_DCPS_LAZY_DESERIALIZATION,
+                                    COMMON_DCPS_LAZY_DESERIALIZATION_default);
+}
+
+void
+Service_Participant::spill_budget(DDS::UInt32 bytes)
+{
+  config_store_->set_uint32(COMMON_DCPS_SPILL_BUDGET, bytes);
+}
+
+DDS::UInt32
+Service_Participant::spill_budget() const
+{
+  return config_store_->get_uint32(COMMON_DCPS_SPILL_BUDGET,
+                                   COMMON_DCPS_SPILL_BUDGET_default);
+}
+
+void
+Service_Participant::spill_directory(const String& directory)
+{
+  config_store_->set(COMMON_DCPS_SPILL_DIRECTORY, directory);
+}
+
+String
+Service_Participant::spill_directory() const
+{
+  return config_store_->get(COMMON_DCPS_SPILL_DIRECTORY,
+                            COMMON_DCPS_SPILL_DIRECTORY_default);
+}
+
+void
+Service_Participant::listener_threads(DDS::UInt32 threads)
+{
+  config_store_->set_uint32(COMMON_DCPS_LISTENER_THREADS, threads);
+}
+
+DDS::UInt32
+Service_Participant::listener_threads() const
+{
+  return config_store_->get_uint32(COMMON_DCPS_LISTENER_THREADS,
+                                   COMMON_DCPS_LISTENER_THREADS_default);
+}
+
+void
+Service_Participant::listener_max_pending(DDS::UInt32 max_pending)
+{
+  config_store_->set_uint32(COMMON_DCPS_LISTENER_MAX_PENDING, max_pending);
+}
+
+DDS::UInt32
+Service_Participant::listener_max_pending() const
+{
+  return config_store_->get_uint32(COMMON_DCPS_LISTENER_MAX_PENDING,
+                                   COMMON_DCPS_LISTENER_MAX_PENDING_default);
+}
+
+void
+Service_Participant::deserialize_threads(DDS::UInt32 threads)
+{
+  config_store_->set_uint32(COMMON_DCPS_DESERIALIZE_THREADS, threads);
+}
+
+DDS::UInt32
+Service_Participant::deserialize_threads() const
+{
+  return config_store_->get_uint32(COMMON_DCPS_DESERIALIZE_THREADS,
+                                   COMMON_DCPS_DESERIALIZE_THREADS_default);
+}
+
+void
+Service_Participant::deserialize_min_size(DDS::UInt32 size)
+{
+  config_store_->set_uint32(COMMON_DCPS_DESERIALIZE_MIN_SIZE, size);
+}
+
+DDS::UInt32
+Service_Participant::deserialize_min_size() const
+{
+  return config_store_->get_uint32(COMMON_DCPS_DESERIALIZE_MIN_SIZE,
+                                   COMMON_DCPS_DESERIALIZE_MIN_SIZE_default);
+}
+
+void
+Service_Participant::queued_delivery(bool flag)
+{
+  config_store_->set_boolean(COMMON_DCPS_QUEUED_DELIVERY, flag);
+}
+
+bool
+Service_Participant::queued_delivery() const
+{
+  return config_store_->get_boolean(COMMON_DCPS_QUEUED_DELIVERY,
+                                    COMMON_DCPS_QUEUED_DELIVERY_default);
+}
+
+void
+Service_Participant::delivery_queue_max(DDS::UInt32 max_samples)
+{
+  config_store_->set_uint32(COMMON_DCPS_DELIVERY_QUEUE_MAX, max_samples);
+}
+
+DDS::UInt32
+Service_Participant::delivery_queue_max() const
+{
+  return config_store_->get_uint32(COMMON_DCPS_DELIVERY_QUEUE_MAX,
+                                   COMMON_DCPS_DELIVERY_QUEUE_MAX_default);
+}
+
 TimeDuration
 Service_Participant::pending_timeout() const
 {
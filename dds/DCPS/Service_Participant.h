@@ -99,11 +99,29 @@ const Discovery::RepoKey COMMON_DCPS_DEFAULT_DISCOVERY_default = Discovery::DEFA
 # endif
 #endif
 
+const char COMMON_DCPS_DELIVERY_QUEUE_MAX[] = "COMMON_DCPS_DELIVERY_QUEUE_MAX";
+const DDS::UInt32 COMMON_DCPS_DELIVERY_QUEUE_MAX_default = 1000;
+
+const char COMMON_DCPS_DESERIALIZE_MIN_SIZE[] = "COMMON_DCPS_DESERIALIZE_MIN_SIZE";
+const DDS::UInt32 COMMON_DCPS_DESERIALIZE_MIN_SIZE_default = 1024;
+
+const char COMMON_DCPS_DESERIALIZE_THREADS[] = "COMMON_DCPS_DESERIALIZE_THREADS";
+const DDS::UInt32 COMMON_DCPS_DESERIALIZE_THREADS_default = 0;
+
 const char COMMON_DCPS_GLOBAL_TRANSPORT_CONFIG[] = "COMMON_DCPS_GLOBAL_TRANSPORT_CONFIG";
 const String COMMON_DCPS_GLOBAL_TRANSPORT_CONFIG_default = "";
 
 const char COMMON_DCPS_INFO_REPO[] = "COMMON_DCPS_INFO_REPO";
 
+const char COMMON_DCPS_LAZY_DESERIALIZATION[] = "COMMON_DCPS_LAZY_DESERIALIZATION";
+const bool COMMON_DCPS_LAZY_DESERIALIZATION_default = false;
+
+const char COMMON_DCPS_LISTENER_MAX_PENDING[] = "COMMON_DCPS_LISTENER_MAX_PENDING";
+const DDS::UInt32 COMMON_DCPS_LISTENER_MAX_PENDING_default = 1000;
+
+const char COMMON_DCPS_LISTENER_THREADS[] = "COMMON_DCPS_LISTENER_THREADS";
+const DDS::UInt32 COMMON_DCPS_LISTENER_THREADS_default = 0;
+
 const char COMMON_DCPS_LIVELINESS_FACTOR[] = "COMMON_DCPS_LIVELINESS_FACTOR";
 const int COMMON_DCPS_LIVELINESS_FACTOR_default = 80;
 
@@ -124,6 +142,15 @@ const String COMMON_DCPS_PERSISTENT_DATA_DIR_default = "OpenDDS-durable-data-dir
 const char COMMON_DCPS_PUBLISHER_CONTENT_FILTER[] = "COMMON_DCPS_PUBLISHER_CONTENT_FILTER";
 const bool COMMON_DCPS_PUBLISHER_CONTENT_FILTER_default = true;
 
+const char COMMON_DCPS_QUEUED_DELIVERY[] = "COMMON_DCPS_QUEUED_DELIVERY";
+const bool COMMON_DCPS_QUEUED_DELIVERY_default = false;
+
+const char COMMON_DCPS_SPILL_BUDGET[] = "COMMON_DCPS_SPILL_BUDGET";
+const DDS::UInt32 COMMON_DCPS_SPILL_BUDGET_default = 0;
+
+const char COMMON_DCPS_SPILL_DIRECTORY[] = "COMMON_DCPS_SPILL_DIRECTORY";
+const String COMMON_DCPS_SPILL_DIRECTORY_default = "";
+
 const char COMMON_DCPS_THREAD_STATUS_INTERVAL[] = "COMMON_DCPS_THREAD_STATUS_INTERVAL";
 
 const char COMMON_DCPS_TRANSPORT_DEBUG_LEVEL[] = "COMMON_DCPS_TRANSPORT_DEBUG_LEVEL";
@@ -411,6 +438,60 @@ public:
   bool publisher_content_filter() const;
   //@}
 
+  /// Accessors for LazyDeserialization.
+  //@{
+  void lazy_deserialization(bool);
+  bool lazy_deserialization() const;
+  //@}
+
+  /// Accessors for SpillBudget.
+  //@{
+  void spill_budget(DDS::UInt32);
+  DDS::UInt32 spill_budget() const;
+  //@}
+
+  /// Accessors for SpillDirectory.
+  //@{
+  void spill_directory(const String&);
+  String spill_directory() const;
+  //@}
+
+  /// Accessors for ListenerThreads.
+  //@{
+  void listener_threads(DDS::UInt32);
+  DDS::UInt32 listener_threads() const;
+  //@}
+
+  /// Accessors for ListenerMaxPending.
+  //@{
+  void listener_max_pending(DDS::UInt32);
+  DDS::UInt32 listener_max_pending() const;
+  //@}
+
+  /// Accessors for DeserializeThreads.
+  //@{
+  void deserialize_threads(DDS::UInt32);
+  DDS::UInt32 deserialize_threads() const;
+  //@}
+
+  /// Accessors for DeserializeMinSize.
+  //@{
+  void deserialize_min_size(DDS::UInt32);
+  DDS::UInt32 deserialize_min_size() const;
+  //@}
+
+  /// Accessors for QueuedDelivery.
+  //@{
+  void queued_delivery(bool);
+  bool queued_delivery() const;
+  //@}
+
+  /// Accessors for DeliveryQueueMax.
+  //@{
+  void delivery_queue_max(DDS::UInt32);
+  DDS::UInt32 delivery_queue_max() const;
+  //@}
+
   /// Accessors for pending data timeout.
   //@{
   TimeDuration pending_timeout() const;
@@ -0,0 +1,211 @@
+/*
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "DCPS/DdsDcps_pch.h" //Only the _pch include should start with DCPS/
+
+#include "SpillLog.h"
+
+#include "debug.h"
+
+#include <ace/ACE.h>
+#include <ace/OS_NS_stdlib.h>
+#include <ace/OS_NS_string.h>
+#include <ace/OS_NS_unistd.h>
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+SpillLog::SpillLog(const String& directory)
+  : directory_(directory)
+  , handle_(ACE_INVALID_HANDLE)
+  , end_(0)
+  , file_size_(0)
+  , live_records_(0)
+{
+}
+
+SpillLog::~SpillLog()
+{
+  if (handle_ != ACE_INVALID_HANDLE) {
+    ACE_OS::close(handle_);
+    ACE_OS::unlink(path_.c_str());
+  }
+}
+
+bool SpillLog::open_i()
+{
+  String directory = directory_;
+  if (directory.empty()) {
+    ACE_TCHAR temp[MAXPATHLEN];
+    if (ACE::get_temp_dir(temp, MAXPATHLEN) == -1) {
+      if (log_level >= LogLevel::Error) {
+        ACE_ERROR((LM_ERROR, "(%P|%t) ERROR: SpillLog::open_i: "
+                   "could not find the temporary directory\n"));
+      }
+      return false;
+    }
+    directory = ACE_TEXT_ALWAYS_CHAR(temp);
+  }
+  if (!directory.empty() && directory[directory.size() - 1] != ACE_DIRECTORY_SEPARATOR_CHAR_A) {
+    directory += ACE_DIRECTORY_SEPARATOR_CHAR_A;
+  }
+
+  String path = directory + "opendds-spill-XXXXXX";
+  handle_ = ACE_OS::mkstemp(&path[0]);
+  if (handle_ == ACE_INVALID_HANDLE) {
+    if (log_level >= LogLevel::Error) {
+      ACE_ERROR((LM_ERROR, "(%P|%t) ERROR: SpillLog::open_i: "
+                 "could not create a file in %C: %p\n", directory.c_str(), ACE_TEXT("mkstemp")));
+    }
+    return false;
+  }
+  path_ = path;
+  return true;
+}
+
+ACE_OFF_T SpillLog::allocate_i(size_t length)
+{
+  // First fit: records are usually released in the order they were
+  // appended, so the free regions merge into a few large ones.
+  for (FreeRegions::iterator it = free_.begin(); it != free_.end(); ++it) {
+    if (it->second >= length) {
+      const ACE_OFF_T offset = it->first;
+      const size_t remaining = it->second - length;
+      free_.erase(it);
+      if (remaining) {
+        free_[offset + static_cast<ACE_OFF_T>(length)] = remaining;
+      }
+      return offset;
+    }
+  }
+  const ACE_OFF_T offset = end_;
+  end_ += static_cast<ACE_OFF_T>(length);
+  return offset;
+}
+
+bool SpillLog::append(const ACE_Message_Block& data, Record& record)
+{
+  ACE_Guard<ACE_Thread_Mutex> guard(lock_);
+  if (handle_ == ACE_INVALID_HANDLE && !open_i()) {
+    return false;
+  }
+
+  record.length_ = data.total_length();
+  record.offset_ = allocate_i(record.length_);
+  ACE_OFF_T position = record.offset_;
+  for (const ACE_Message_Block* mb = &data; mb; mb = mb->cont()) {
+    const size_t length = mb->length();
+    if (length && ACE_OS::pwrite(handle_, mb->rd_ptr(), length, position) != static_cast<ssize_t>(length)) {
+      if (log_level >= LogLevel::Error) {
+        ACE_ERROR((LM_ERROR, "(%P|%t) ERROR: SpillLog::append: %p\n", ACE_TEXT("pwrite")));
+      }
+      free_i(record.offset_, record.length_);
+      return false;
+    }
+    position += static_cast<ACE_OFF_T>(length);
+  }
+  if (position > file_size_) {
+    file_size_ = position;
+  }
+
+  ++live_records_;
+  return true;
+}
+
+ACE_Message_Block* SpillLog::read(const Record& record)
+{
+  ACE_Guard<ACE_Thread_Mutex> guard(lock_);
+  if (handle_ == ACE_INVALID_HANDLE) {
+    return 0;
+  }
+
+  ACE_Message_Block* const mb = new ACE_Message_Block(record.length_);
+  if (ACE_OS::pread(handle_, mb->wr_ptr(), record.length_, record.offset_) != static_cast<ssize_t>(record.length_)) {
+    if (log_level >= LogLevel::Error) {
+      ACE_ERROR((LM_ERROR, "(%P|%t) ERROR: SpillLog::read: %p\n", ACE_TEXT("pread")));
+    }
+    mb->release();
+    return 0;
+  }
+  mb->wr_ptr(record.length_);
+  return mb;
+}
+
+void SpillLog::release(const Record& record)
+{
+  ACE_Guard<ACE_Thread_Mutex> guard(lock_);
+  if (!live_records_ || handle_ == ACE_INVALID_HANDLE) {
+    return;
+  }
+
+  if (--live_records_ == 0) {
+    // Nothing refers to the file anymore, start over at the beginning.
+    free_.clear();
+    end_ = 0;
+    truncate_i();
+  } else {
+    free_i(record.offset_, record.length_);
+  }
+}
+
+void SpillLog::free_i(ACE_OFF_T offset, size_t length)
+{
+  if (!length) {
+    return;
+  }
+
+  FreeRegions::iterator next = free_.lower_bound(offset);
+  if (next != free_.end() && next->first == offset + static_cast<ACE_OFF_T>(length)) {
+    length += next->second;
+    free_.erase(next++);
+  }
+  if (next != free_.begin()) {
+    FreeRegions::iterator prev = next;
+    --prev;
+    if (prev->first + static_cast<ACE_OFF_T>(prev->second) == offset) {
+      offset = prev->first;
+      length += prev->second;
+      free_.erase(prev);
+    }
+  }
+
+  if (offset + static_cast<ACE_OFF_T>(length) == end_) {
+    end_ = offset;
+    truncate_i();
+  } else {
+    free_[offset] = length;
+  }
+}
+
+void SpillLog::truncate_i()
+{
+  if (file_size_ - end_ < TRUNCATE_SIZE && (end_ || !file_size_)) {
+    return;
+  }
+  if (ACE_OS::ftruncate(handle_, end_) == 0) {
+    file_size_ = end_;
+  } else if (log_level >= LogLevel::Warning) {
+    ACE_ERROR((LM_WARNING, "(%P|%t) WARNING: SpillLog::truncate_i: %p\n", ACE_TEXT("ftruncate")));
+  }
+}
+
+size_t SpillLog::live_records() const
+{
+  ACE_Guard<ACE_Thread_Mutex> guard(lock_);
+  return live_records_;
+}
+
+ACE_OFF_T SpillLog::file_size() const
+{
+  ACE_Guard<ACE_Thread_Mutex> guard(lock_);
+  return file_size_;
+}
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
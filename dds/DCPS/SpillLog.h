@@ -0,0 +1,103 @@
+/*
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#ifndef OPENDDS_DCPS_SPILL_LOG_H
+#define OPENDDS_DCPS_SPILL_LOG_H
+
+#include "PoolAllocator.h"
+#include "RcObject.h"
+#include "dcps_export.h"
+
+#include <ace/Message_Block.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/os_include/sys/os_types.h>
+
+#if !defined (ACE_LACKS_PRAGMA_ONCE)
+#  pragma once
+#endif /* ACE_LACKS_PRAGMA_ONCE */
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+/**
+ * @class SpillLog
+ *
+ * @brief File that holds serialized samples for a DataReader.
+ *
+ * Payloads are written to a temporary file and read back by position.
+ * The regions of released records are kept in a free list, merged with
+ * their neighbors, and reused by later records, so the file stays about as
+ * large as the backlog of records that haven't been released.  Once more
+ * than TRUNCATE_SIZE bytes at the end of the file are free the file is
+ * truncated.  The file is removed when the log is destroyed.
+ */
+class OpenDDS_Dcps_Export SpillLog : public virtual RcObject {
+public:
+  struct Record {
+    Record() : offset_(0), length_(0) {}
+
+    ACE_OFF_T offset_;
+    size_t length_;
+  };
+
+  /// The file is created in directory, or the system's temporary
+  /// directory if it's empty, when the first record is appended.
+  explicit SpillLog(const String& directory);
+  ~SpillLog();
+
+  /// Write the readable bytes of a message block chain to the end of the
+  /// log.  Returns false if the file could not be created or written.
+  bool append(const ACE_Message_Block& data, Record& record);
+
+  /// Read a record back into a new message block.  Returns 0 on failure.
+  ACE_Message_Block* read(const Record& record);
+
+  /// The record is no longer needed and its region can be reused.
+  void release(const Record& record);
+
+  /// Records that were appended and haven't been released.
+  size_t live_records() const;
+
+  /// Current size of the file.
+  ACE_OFF_T file_size() const;
+
+  static const ACE_OFF_T TRUNCATE_SIZE = 1024 * 1024;
+
+private:
+  bool open_i();
+
+  /// Find the position for a new record of length bytes.
+  ACE_OFF_T allocate_i(size_t length);
+
+  /// Make a region available for reuse.
+  void free_i(ACE_OFF_T offset, size_t length);
+
+  /// Shrink the file if enough of its end is unused.
+  void truncate_i();
+
+  mutable ACE_Thread_Mutex lock_;
+  const String directory_;
+  String path_;
+  ACE_HANDLE handle_;
+  /// End of the last region that is in use or free, everything after it
+  /// is unused.
+  ACE_OFF_T end_;
+  ACE_OFF_T file_size_;
+  size_t live_records_;
+  /// Released regions before end_ by offset.  Adjacent regions are merged.
+  typedef OPENDDS_MAP(ACE_OFF_T, size_t) FreeRegions;
+  FreeRegions free_;
+};
+
+typedef RcHandle<SpillLog> SpillLog_rch;
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#endif /* OPENDDS_DCPS_SPILL_LOG_H */
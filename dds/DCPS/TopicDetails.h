@@ -8,6 +8,7 @@
 
 #include "TopicCallbacks.h"
 #include "GuidUtils.h"
+#include "PartitionIndex.h"
 #include "debug.h"
 #include "Definitions.h"
 #include "XTypes/TypeObject.h"
@@ -73,6 +74,7 @@ namespace OpenDDS {
       void remove_local_publication(const DCPS::GUID_t& guid)
       {
         local_publications_.erase(guid);
+        publication_partitions_.remove(guid);
       }
 
       const RepoIdSet& local_publications() const
@@ -88,6 +90,7 @@ namespace OpenDDS {
       void remove_local_subscription(const DCPS::GUID_t& guid)
       {
         local_subscriptions_.erase(guid);
+        subscription_partitions_.remove(guid);
       }
 
       const RepoIdSet& local_subscriptions() const
@@ -103,6 +106,7 @@ namespace OpenDDS {
       void remove_discovered_publication(const DCPS::GUID_t& guid)
       {
         discovered_publications_.erase(guid);
+        publication_partitions_.remove(guid);
       }
 
       const RepoIdSet& discovered_publications() const
@@ -118,6 +122,7 @@ namespace OpenDDS {
       void remove_discovered_subscription(const DCPS::GUID_t& guid)
       {
         discovered_subscriptions_.erase(guid);
+        subscription_partitions_.remove(guid);
       }
 
       const RepoIdSet& discovered_subscriptions() const
@@ -125,6 +130,38 @@ namespace OpenDDS {
         return discovered_subscriptions_;
       }
 
+      /// Index a publication by its partition for publications_in_partition().
+      /// Only discovery that matches through the index has to call this.
+      void set_publication_partition(const DCPS::GUID_t& guid,
+                                     const DDS::PartitionQosPolicy& partition)
+      {
+        publication_partitions_.insert(guid, partition);
+      }
+
+      /// Index a subscription by its partition for subscriptions_in_partition().
+      /// Only discovery that matches through the index has to call this.
+      void set_subscription_partition(const DCPS::GUID_t& guid,
+                                      const DDS::PartitionQosPolicy& partition)
+      {
+        subscription_partitions_.insert(guid, partition);
+      }
+
+      /// Add the local and discovered publications that may be in a
+      /// partition that matches partition to guids.
+      void publications_in_partition(const DDS::PartitionQosPolicy& partition,
+                                     RepoIdSet& guids) const
+      {
+        publication_partitions_.lookup(partition, guids);
+      }
+
+      /// Add the local and discovered subscriptions that may be in a
+      /// partition that matches partition to guids.
+      void subscriptions_in_partition(const DDS::PartitionQosPolicy& partition,
+                                      RepoIdSet& guids) const
+      {
+        subscription_partitions_.lookup(partition, guids);
+      }
+
       void increment_inconsistent()
       {
         ++inconsistent_topic_count_;
@@ -158,6 +195,8 @@ namespace OpenDDS {
       RepoIdSet local_subscriptions_;
       RepoIdSet discovered_publications_;
       RepoIdSet discovered_subscriptions_;
+      PartitionIndex publication_partitions_;
+      PartitionIndex subscription_partitions_;
       int inconsistent_topic_count_;
       int assertion_count_;
     };
@@ -84,8 +84,8 @@ WriteDataContainer::WriteDataContainer(
   ACE_Recursive_Thread_Mutex& deadline_status_lock,
   DDS::OfferedDeadlineMissedStatus& deadline_status,
   CORBA::Long& deadline_last_total_count)
-  : cached_cumulative_ack_valid_(false)
-  , transaction_id_(0)
+  : transaction_id_(0)
+  , num_all_samples_(0)
   , publication_id_(GUID_UNKNOWN)
   , writer_(writer)
   , max_samples_per_instance_(max_samples_per_instance)
@@ -120,7 +120,7 @@ WriteDataContainer::WriteDataContainer(
                "sample_list_element_allocator %x with %d chunks\n",
                &sample_list_element_allocator_, n_chunks_));
   }
-  acked_sequences_[GUID_UNKNOWN].insert(SequenceNumber::ZERO());
+  acked_by_all_.insert(SequenceNumber::ZERO());
 }
 
 WriteDataContainer::~WriteDataContainer()
@@ -173,18 +173,11 @@ WriteDataContainer::~WriteDataContainer()
 }
 
 void
-WriteDataContainer::add_reader_acks(const GUID_t& reader, const SequenceNumber& base)
+WriteDataContainer::add_reader_acks(const GUID_t& reader)
 {
-  ACE_Guard<ACE_Thread_Mutex> guard(wfa_lock_);
-
-  DisjointSequence& ds = acked_sequences_[reader];
-  ds.reset();
-  if (base == SequenceNumber::SEQUENCENUMBER_UNKNOWN()) {
-    ds.insert(SequenceNumber::ZERO());
-  } else {
-    ds.insert(SequenceRange(SequenceNumber(), base));
-  }
-  cached_cumulative_ack_valid_ = false;
+  // Everything written so far counts as acknowledged by a new reader unless
+  // reenqueue_all() resends it.
+  remove_reader_acks(reader);
 }
 
 void
@@ -192,82 +185,60 @@ WriteDataContainer::remove_reader_acks(const GUID_t& reader)
 {
   ACE_Guard<ACE_Thread_Mutex> guard(wfa_lock_);
 
-  const SequenceNumber prev_cum_ack = get_cumulative_ack();
-  const AckedSequenceMap::iterator it = acked_sequences_.find(reader);
-  if (it != acked_sequences_.end()) {
-    acked_sequences_.erase(it);
-    cached_cumulative_ack_valid_ = false;
+  const PendingResendMap::iterator it = pending_resends_.find(reader);
+  if (it != pending_resends_.end()) {
+    const SequenceNumber prev_cum_ack = get_cumulative_ack();
+    remove_pending_resends(it, SequenceNumber::MAX_VALUE);
     if (prev_cum_ack != get_cumulative_ack()) {
       wfa_condition_.notify_all();
     }
   }
 }
 
-SequenceNumber
-WriteDataContainer::get_cumulative_ack()
+void
+WriteDataContainer::remove_pending_resends(PendingResendMap::iterator it,
+                                           const SequenceNumber& up_to)
 {
-  if (acked_sequences_.empty()) {
-    return SequenceNumber::SEQUENCENUMBER_UNKNOWN();
-  }
-
-  if (cached_cumulative_ack_valid_) {
-    return cached_cumulative_ack_;
+  SequenceSet& pending = it->second;
+  while (!pending.empty() && !(up_to < *pending.begin())) {
+    all_pending_resends_.erase(all_pending_resends_.find(*pending.begin()));
+    pending.erase(pending.begin());
   }
-
-  SequenceNumber result = SequenceNumber::SEQUENCENUMBER_UNKNOWN();
-  for (AckedSequenceMap::const_iterator it = acked_sequences_.begin(); it != acked_sequences_.end(); ++it) {
-    if (!it->second.empty()) {
-      result = result == SequenceNumber::SEQUENCENUMBER_UNKNOWN() ? it->second.cumulative_ack() : std::min(result, it->second.cumulative_ack());
-    }
+  if (pending.empty()) {
+    pending_resends_.erase(it);
   }
-  cached_cumulative_ack_ = result;
-  cached_cumulative_ack_valid_ = true;
-  return result;
 }
 
 SequenceNumber
-WriteDataContainer::get_last_ack()
+WriteDataContainer::get_cumulative_ack()
 {
-  if (acked_sequences_.empty()) {
+  if (acked_by_all_.empty()) {
     return SequenceNumber::SEQUENCENUMBER_UNKNOWN();
   }
 
-  SequenceNumber result = SequenceNumber::SEQUENCENUMBER_UNKNOWN();
-  for (AckedSequenceMap::const_iterator it = acked_sequences_.begin(); it != acked_sequences_.end(); ++it) {
-    if (!it->second.empty()) {
-      result = result == SequenceNumber::SEQUENCENUMBER_UNKNOWN() ? it->second.last_ack() : std::max(result, it->second.last_ack());
-    }
+  const SequenceNumber cum_ack = acked_by_all_.cumulative_ack();
+  if (all_pending_resends_.empty()) {
+    return cum_ack;
   }
-  return result;
+
+  // The earliest resend that hasn't been acknowledged holds the writer back.
+  return std::min(cum_ack, all_pending_resends_.begin()->previous());
 }
 
 void
 WriteDataContainer::update_acked(const SequenceNumber& seq, const GUID_t& id)
 {
-  bool do_notify = false;
+  const SequenceNumber prev_cum_ack = get_cumulative_ack();
   if (id == GUID_UNKNOWN) {
-    for (AckedSequenceMap::iterator it = acked_sequences_.begin(); it != acked_sequences_.end(); ++it) {
-      SequenceNumber prev_cum_ack = it->second.cumulative_ack();
-      it->second.insert(seq);
-      cached_cumulative_ack_valid_ = false;
-      if (prev_cum_ack != it->second.cumulative_ack()) {
-        do_notify = true;
-      }
-    }
+    acked_by_all_.insert(seq);
   } else {
-    const AckedSequenceMap::iterator it = acked_sequences_.find(id);
-    if (it != acked_sequences_.end()) {
-      SequenceNumber prev_cum_ack = it->second.cumulative_ack();
-      if (prev_cum_ack < seq) {
-        it->second.insert(SequenceRange(prev_cum_ack, seq));
-        cached_cumulative_ack_valid_ = false;
-        if (prev_cum_ack != it->second.cumulative_ack()) {
-          do_notify = true;
-        }
-      }
+    // Acks from a reader are cumulative.
+    const PendingResendMap::iterator it = pending_resends_.find(id);
+    if (it != pending_resends_.end()) {
+      remove_pending_resends(it, seq);
     }
   }
-  if (do_notify) {
+  if (prev_cum_ack != get_cumulative_ack()) {
     wfa_condition_.notify_all();
   }
 }
@@ -291,17 +262,13 @@ WriteDataContainer::enqueue_control(DataSampleElement* control_sample)
 
 // This method assumes that instance list has space for this sample.
 DDS::ReturnCode_t
-WriteDataContainer::enqueue(
-  DataSampleElement* sample,
-  DDS::InstanceHandle_t instance_handle)
+WriteDataContainer::enqueue(DataSampleElement* sample)
 {
   if (shutdown_) {
     return DDS::RETCODE_ERROR;
   }
 
-  // Get the PublicationInstance pointer from InstanceHandle_t.
-  PublicationInstance_rch instance =
-    get_handle_instance(instance_handle);
+  PublicationInstance_rch instance = sample->get_handle();
   // Extract the instance queue.
   InstanceDataSampleList& instance_list = instance->samples_;
 
@@ -318,6 +285,7 @@ WriteDataContainer::enqueue(
   //
   // Add this sample to the INSTANCE scope list.
   instance_list.enqueue_tail(sample);
+  ++num_all_samples_;
 
   return DDS::RETCODE_OK;
 }
@@ -367,15 +335,24 @@ WriteDataContainer::reenqueue_all(const GUID_t& reader_id,
 
   {
     ACE_Guard<ACE_SYNCH_MUTEX> wfa_guard(wfa_lock_);
-    cached_cumulative_ack_valid_ = false;
-    DisjointSequence& ds = acked_sequences_[reader_id];
-    ds = acked_sequences_[GUID_UNKNOWN];
-
-    // Remove exactly what will be sent
-    SendStateDataSampleList::iterator iter = resend_data_.begin();
-    while (iter != resend_data_.end()) {
-      ds.erase(iter->get_header().sequence_);
-      ++iter;
+    const PendingResendMap::iterator it = pending_resends_.find(reader_id);
+    if (it != pending_resends_.end()) {
+      remove_pending_resends(it, SequenceNumber::MAX_VALUE);
+    }
+
+    // Exactly what will be sent is not acknowledged by this reader.  Samples
+    // that weren't delivered to everyone yet are still held back by
+    // acked_by_all_.
+    SequenceSet& pending = pending_resends_[reader_id];
+    for (SendStateDataSampleList::iterator iter = resend_data_.begin();
+         iter != resend_data_.end(); ++iter) {
+      const SequenceNumber seq = iter->get_header().sequence_;
+      if (acked_by_all_.contains(seq) && pending.insert(seq).second) {
+        all_pending_resends_.insert(seq);
+      }
+    }
+    if (pending.empty()) {
+      pending_resends_.erase(reader_id);
     }
   }
 
@@ -562,20 +539,12 @@ WriteDataContainer::num_samples(DDS::InstanceHandle_t handle,
 size_t
 WriteDataContainer::num_all_samples()
 {
-  size_t size = 0;
-
   ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex,
                    guard,
                    lock_,
                    0);
 
-  for (PublicationInstanceMapType::iterator iter = instances_.begin();
-       iter != instances_.end();
-       ++iter) {
-    size += static_cast<size_t>(iter->second->samples_.size());
-  }
-
-  return size;
+  return num_all_samples_;
 }
 
 ACE_UINT64
@@ -765,7 +734,9 @@ WriteDataContainer::data_delivered(const DataSampleElement* sample)
     } else {
       if (InstanceDataSampleList::on_some_list(sample)) {
         PublicationInstance_rch inst = sample->get_handle();
-        inst->samples_.dequeue(sample);
+        if (inst->samples_.dequeue(sample)) {
+          --num_all_samples_;
+        }
       }
       release_buffer(stale);
       stale = 0;
@@ -959,7 +930,9 @@ WriteDataContainer::remove_excess_durable()
         if (durable_allowed) {
           --durable_allowed;
         } else {
-          instance_list.dequeue(it);
+          if (instance_list.dequeue(it)) {
+            --num_all_samples_;
+          }
           sent_data_.dequeue(it);
           release_buffer(it);
           ++n_released;
@@ -995,6 +968,7 @@ WriteDataContainer::remove_oldest_sample(
                       ACE_TEXT("dequeue_head_next_sample failed\n")),
                      DDS::RETCODE_ERROR);
   }
+  --num_all_samples_;
 
   //
   // Remove the stale data from the next_writer_sample_ list.  The
@@ -1618,6 +1592,7 @@ WriteDataContainer::set_deadline_period(const TimeDuration& deadline_period)
            iter != instances_.end();
            ++iter) {
         iter->second->deadline_ = deadline;
+        iter->second->deadline_key_ = deadline;
         deadline_map_.insert(std::make_pair(deadline, iter->second));
       }
 
@@ -1629,6 +1604,11 @@ WriteDataContainer::set_deadline_period(const TimeDuration& deadline_period)
         deadline_task_->cancel();
       }
 
+      for (DeadlineMapType::iterator iter = deadline_map_.begin();
+           iter != deadline_map_.end();
+           ++iter) {
+        iter->second->deadline_key_ = MonotonicTimePoint::zero_value;
+      }
       deadline_map_.clear();
     } else {
       DeadlineMapType new_map;
@@ -1636,7 +1616,8 @@ WriteDataContainer::set_deadline_period(const TimeDuration& deadline_period)
            iter != instances_.end();
            ++iter) {
         iter->second->deadline_ = deadline;
-        new_map.insert(std::make_pair(iter->second->deadline_, iter->second));
+        iter->second->deadline_key_ = deadline;
+        new_map.insert(std::make_pair(deadline, iter->second));
       }
       std::swap(new_map, deadline_map_);
 
@@ -1670,6 +1651,14 @@ WriteDataContainer::process_deadlines(const MonotonicTimePoint& now)
     PublicationInstance_rch instance = pos->second;
     deadline_map_.erase(pos);
 
+    if (!(instance->deadline_ < now)) {
+      // Written to since it was filed, so the deadline hasn't been missed.
+      // File it under the current deadline instead.
+      instance->deadline_key_ = instance->deadline_;
+      deadline_map_.insert(std::make_pair(instance->deadline_, instance));
+      continue;
+    }
+
     ++deadline_status_.total_count;
     deadline_status_.total_count_change = deadline_status_.total_count - deadline_last_total_count_;
     deadline_status_.last_instance_handle = instance->instance_handle_;
@@ -1697,6 +1686,7 @@ WriteDataContainer::process_deadlines(const MonotonicTimePoint& now)
     }
 
     instance->deadline_ += deadline_period_;
+    instance->deadline_key_ = instance->deadline_;
     deadline_map_.insert(std::make_pair(instance->deadline_, instance));
   }
 
@@ -1716,15 +1706,16 @@ WriteDataContainer::extend_deadline(const PublicationInstance_rch& instance)
     return;
   }
 
-  std::pair<DeadlineMapType::iterator, DeadlineMapType::iterator> r = deadline_map_.equal_range(instance->deadline_);
-  while (r.first != r.second && r.first->second != instance) {
-    ++r.first;
-  }
-  if (r.first != r.second) {
-    // The instance was in the map.
-    deadline_map_.erase(r.first);
-  }
   instance->deadline_ = MonotonicTimePoint::now() + deadline_period_;
+
+  // If the instance is already in the map its entry can only be earlier than
+  // the new deadline.  Leave it there; process_deadlines() re-files it when
+  // it comes due, so a write doesn't have to touch the map.
+  if (instance->deadline_key_ != MonotonicTimePoint::zero_value) {
+    return;
+  }
+
+  instance->deadline_key_ = instance->deadline_;
   bool schedule = deadline_map_.empty();
   deadline_map_.insert(std::make_pair(instance->deadline_, instance));
   if (schedule) {
@@ -1741,7 +1732,7 @@ WriteDataContainer::cancel_deadline(const PublicationInstance_rch& instance)
     return;
   }
 
-  std::pair<DeadlineMapType::iterator, DeadlineMapType::iterator> r = deadline_map_.equal_range(instance->deadline_);
+  std::pair<DeadlineMapType::iterator, DeadlineMapType::iterator> r = deadline_map_.equal_range(instance->deadline_key_);
   while (r.first != r.second && r.first->second != instance) {
     ++r.first;
   }
@@ -1751,6 +1742,7 @@ WriteDataContainer::cancel_deadline(const PublicationInstance_rch& instance)
       deadline_task_->cancel();
     }
   }
+  instance->deadline_key_ = MonotonicTimePoint::zero_value;
 }
 
 } // namespace DCPS
@@ -166,14 +166,12 @@ public:
   enqueue_control(DataSampleElement* control_sample);
 
   /**
-   * Enqueue the data sample in its instance thread. This method
-   * assumes there is an available space for the sample in the
-   * instance list.
+   * Enqueue the data sample in the instance thread it was bound to by
+   * obtain_buffer(). This method assumes there is an available space
+   * for the sample in the instance list.
   */
   DDS::ReturnCode_t
-  enqueue(
-    DataSampleElement* sample,
-    DDS::InstanceHandle_t instance);
+  enqueue(DataSampleElement* sample);
 
   /**
    * Create a resend list with the copies of all current "sending"
@@ -411,24 +409,40 @@ private:
    */
   void wakeup_blocking_writers (DataSampleElement* stale);
 
-  void add_reader_acks(const GUID_t& reader, const SequenceNumber& base);
+  void add_reader_acks(const GUID_t& reader);
   void remove_reader_acks(const GUID_t& reader);
 
 private:
 
   void log_send_state_lists (OPENDDS_STRING description);
 
+  /// Sequences that have been delivered to every associated reader.
+  DisjointSequence acked_by_all_;
+
+  typedef OPENDDS_SET(SequenceNumber) SequenceSet;
 #ifdef ACE_HAS_CPP11
-  typedef OPENDDS_UNORDERED_MAP(GUID_t, DisjointSequence) AckedSequenceMap;
+  typedef OPENDDS_UNORDERED_MAP(GUID_t, SequenceSet) PendingResendMap;
 #else
-  typedef OPENDDS_MAP_CMP(GUID_t, DisjointSequence, GUID_tKeyLessThan) AckedSequenceMap;
+  typedef OPENDDS_MAP_CMP(GUID_t, SequenceSet, GUID_tKeyLessThan) PendingResendMap;
 #endif
-  AckedSequenceMap acked_sequences_;
-  SequenceNumber cached_cumulative_ack_;
-  bool cached_cumulative_ack_valid_;
+  /// Per reader, the sequences in acked_by_all_ that are being resent to
+  /// it for durability and that it hasn't acknowledged yet.  Readers
+  /// without any are not in the map.
+  PendingResendMap pending_resends_;
+
+  /// Every sequence in pending_resends_.  The cumulative ack of the writer
+  /// is the cumulative ack of acked_by_all_, or the sequence before the
+  /// first of these if that is lower, so acks delivered to every reader
+  /// don't need to visit each reader.
+  typedef OPENDDS_MULTISET(SequenceNumber) PendingResendSet;
+  PendingResendSet all_pending_resends_;
+
+  /// Remove the pending resends of it up to and including up_to, and the
+  /// entry itself if none are left.
+  void remove_pending_resends(PendingResendMap::iterator it,
+                              const SequenceNumber& up_to);
 
   SequenceNumber get_cumulative_ack();
-  SequenceNumber get_last_ack();
   void update_acked(const SequenceNumber& seq, const GUID_t& id = GUID_UNKNOWN);
   bool sequence_acknowledged_i(const SequenceNumber& sequence);
 
@@ -462,6 +476,11 @@ private:
   /// The individual instance queue threads in the data.
   PublicationInstanceMapType instances_;
 
+  /// Total number of samples in the instance lists of instances_, kept
+  /// current as samples are added and removed so the resource limit check
+  /// in obtain_buffer() doesn't have to visit every instance.
+  size_t num_all_samples_;
+
   /// The publication Id from repo.
   GUID_t    publication_id_;
 
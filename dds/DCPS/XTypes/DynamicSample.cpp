@@ -113,6 +113,21 @@ bool DynamicSample::compare(const Sample& other) const
   return is_less_than;
 }
 
+size_t DynamicSample::key_hash() const
+{
+  size_t hash = 0;
+  const DDS::ReturnCode_t rc = XTypes::key_hash(hash, data_);
+  if (rc != DDS::RETCODE_OK) {
+    // Still correct since samples with equal keys then collide.
+    if (log_level >= LogLevel::Warning) {
+      ACE_ERROR((LM_WARNING, "(%P|%t) WARNING: DynamicSample::key_hash: "
+        "key_hash returned %C\n", retcode_to_string(rc)));
+    }
+    return 0;
+  }
+  return hash;
+}
+
 }
 }
 OPENDDS_END_VERSIONED_NAMESPACE_DECL
@@ -45,6 +45,8 @@ public:
   bool deserialize(DCPS::Serializer& ser);
   size_t serialized_size(const DCPS::Encoding& enc) const;
   bool compare(const DCPS::Sample& other) const;
+  /// Hash of the keys that agrees with compare.
+  size_t key_hash() const;
 
   bool to_message_block(ACE_Message_Block&) const
   {
@@ -86,6 +88,11 @@ public:
   {
     return evaluator.eval(*this, params);
   }
+
+  DCPS::Value get_field_value(const char* field) const
+  {
+    return DCPS::getMetaStruct<DynamicSample>().getValue(this, field);
+  }
 #endif
 
   struct KeyLessThan {
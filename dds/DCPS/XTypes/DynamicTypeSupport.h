@@ -61,6 +61,16 @@ namespace OpenDDS {
       typedef XTypes::DynamicSample::KeyLessThan LessThanType;
       typedef DCPS::KeyOnly<const XTypes::DynamicSample> KeyOnlyType;
       static const char* type_name() { return "Dynamic"; } // used for logging
+      static void copy_keys(XTypes::DynamicSample& dest, const XTypes::DynamicSample& src)
+      {
+        // DynamicSample shares its DynamicData, so there is nothing to save
+        // by copying just the keys.
+        dest = src;
+      }
+      static size_t key_hash(const XTypes::DynamicSample& sample)
+      {
+        return sample.key_hash();
+      }
     };
 
     template <>
@@ -12,6 +12,7 @@
 
 #  include <dds/DCPS/debug.h>
 #  include <dds/DCPS/DCPS_Utils.h>
+#  include <dds/DCPS/KeyHash.h>
 #  include <dds/DCPS/SafetyProfileStreams.h>
 
 #  include <algorithm>
@@ -509,6 +510,19 @@ namespace {
     }
   }
 
+  /// Orders NaN like the generated KeyLessThan, see DCPS::key_float_less.
+  template <typename T>
+  void cmp_float(int& result, const T& a, const T& b)
+  {
+    if (DCPS::key_float_less(a, b)) {
+      result = -1;
+    } else if (DCPS::key_float_less(b, a)) {
+      result = 1;
+    } else {
+      result = 0;
+    }
+  }
+
   DDS::ReturnCode_t member_compare(int& result,
     DDS::DynamicData_ptr a_data, DDS::MemberId a_id,
     DDS::DynamicData_ptr b_data, DDS::MemberId b_id)
@@ -611,7 +625,7 @@ namespace {
           DDS::Float32 b_value;
           b_rc = b_data->get_float32_value(b_value, b_id);
           if (b_rc == DDS::RETCODE_OK) {
-            cmp(result, a_value, b_value);
+            cmp_float(result, a_value, b_value);
           }
         }
       }
@@ -625,7 +639,7 @@ namespace {
           DDS::Float64 b_value;
           b_rc = b_data->get_float64_value(b_value, b_id);
           if (b_rc == DDS::RETCODE_OK) {
-            cmp(result, a_value, b_value);
+            cmp_float(result, a_value, b_value);
           }
         }
       }
@@ -639,7 +653,7 @@ namespace {
           DDS::Float128 b_value;
           b_rc = b_data->get_float128_value(b_value, b_id);
           if (b_rc == DDS::RETCODE_OK) {
-            cmp(result, a_value, b_value);
+            cmp_float(result, a_value, b_value);
           }
         }
       }
@@ -868,6 +882,206 @@ DDS::ReturnCode_t compare_members(int& result, DDS::DynamicData_ptr a, DDS::Dyna
   return member_compare(result, a, id, b, id);
 }
 
+namespace {
+  DDS::ReturnCode_t member_hash(ACE_UINT32& hash, DDS::DynamicData_ptr data, DDS::MemberId id)
+  {
+    DDS::DynamicType_var type;
+    DDS::ReturnCode_t rc = get_member_type(type, data, id);
+    if (rc != DDS::RETCODE_OK) {
+      return rc;
+    }
+    const DDS::TypeKind tk = type->get_kind();
+
+    // Values are read the same way as member_compare reads them so that
+    // members it finds equal hash the same.
+    switch (tk) {
+    case TK_BOOLEAN:
+      {
+        DDS::Boolean value = false;
+        rc = data->get_boolean_value(value, id);
+        if (rc == DDS::RETCODE_OK) {
+          hash = DCPS::key_hash_value(hash, value);
+        }
+      }
+      break;
+
+    case TK_BYTE:
+      {
+        DDS::Byte value;
+        rc = data->get_byte_value(value, id);
+        if (rc == DDS::RETCODE_OK) {
+          hash = DCPS::key_hash_value(hash, value);
+        }
+      }
+      break;
+
+    case TK_UINT8:
+    case TK_UINT16:
+    case TK_UINT32:
+    case TK_UINT64:
+      {
+        DDS::UInt64 value;
+        rc = get_uint_value(value, data, id, tk);
+        if (rc == DDS::RETCODE_OK) {
+          hash = DCPS::key_hash_value(hash, value);
+        }
+      }
+      break;
+
+    case TK_INT8:
+    case TK_INT16:
+    case TK_INT32:
+    case TK_INT64:
+      {
+        DDS::Int64 value;
+        rc = get_int_value(value, data, id, tk);
+        if (rc == DDS::RETCODE_OK) {
+          hash = DCPS::key_hash_value(hash, value);
+        }
+      }
+      break;
+
+    case TK_FLOAT32:
+      {
+        DDS::Float32 value;
+        rc = data->get_float32_value(value, id);
+        if (rc == DDS::RETCODE_OK) {
+          hash = DCPS::key_hash_float(hash, value);
+        }
+      }
+      break;
+
+    case TK_FLOAT64:
+      {
+        DDS::Float64 value;
+        rc = data->get_float64_value(value, id);
+        if (rc == DDS::RETCODE_OK) {
+          hash = DCPS::key_hash_float(hash, value);
+        }
+      }
+      break;
+
+    case TK_FLOAT128:
+      {
+        DDS::Float128 value;
+        rc = data->get_float128_value(value, id);
+        if (rc == DDS::RETCODE_OK) {
+          hash = DCPS::key_hash_float(hash, value);
+        }
+      }
+      break;
+
+    case TK_CHAR8:
+      {
+        CORBA::Char value;
+        rc = data->get_char8_value(value, id);
+        if (rc == DDS::RETCODE_OK) {
+          hash = DCPS::key_hash_value(hash, value);
+        }
+      }
+      break;
+
+    case TK_CHAR16:
+      {
+        CORBA::WChar value;
+        rc = data->get_char16_value(value, id);
+        if (rc == DDS::RETCODE_OK) {
+          hash = DCPS::key_hash_value(hash, value);
+        }
+      }
+      break;
+
+    case TK_STRING8:
+      {
+        CORBA::String_var value;
+        rc = data->get_string_value(value, id);
+        if (rc == DDS::RETCODE_OK) {
+          hash = DCPS::key_hash_string(hash, value.in());
+        }
+      }
+      break;
+
+    case TK_STRING16:
+      {
+        CORBA::WString_var value;
+        rc = data->get_wstring_value(value, id);
+        if (rc == DDS::RETCODE_OK) {
+          hash = DCPS::key_hash_string(hash, value.in());
+        }
+      }
+      break;
+
+    case TK_ENUM:
+      {
+        DDS::Int32 value;
+        rc = get_enum_value(value, type, data, id);
+        if (rc == DDS::RETCODE_OK) {
+          hash = DCPS::key_hash_value(hash, value);
+        }
+      }
+      break;
+
+    case TK_BITMASK:
+      {
+        DDS::UInt64 value;
+        rc = get_bitmask_value(value, type, data, id);
+        if (rc == DDS::RETCODE_OK) {
+          hash = DCPS::key_hash_value(hash, value);
+        }
+      }
+      break;
+
+    case TK_SEQUENCE:
+    case TK_ARRAY:
+      {
+        DDS::DynamicData_var value;
+        rc = data->get_complex_value(value, id);
+        const DDS::UInt32 count = rc == DDS::RETCODE_OK ? value->get_item_count() : 0;
+        for (DDS::UInt32 i = 0; rc == DDS::RETCODE_OK && i < count; ++i) {
+          rc = member_hash(hash, value, value->get_member_id_at_index(i));
+        }
+      }
+      break;
+
+    default:
+      if (log_level >= LogLevel::Warning) {
+        ACE_ERROR((LM_WARNING, "(%P|%t) WARNING: member_hash: "
+          "member has unexpected TypeKind %C\n", typekind_to_string(tk)));
+      }
+      rc = DDS::RETCODE_BAD_PARAMETER;
+    }
+
+    return rc;
+  }
+}
+
+DDS::ReturnCode_t key_hash(size_t& result, DDS::DynamicData_ptr data)
+{
+  DDS::DynamicType_var type = data->type();
+  MemberPathVec paths;
+  DDS::ReturnCode_t rc = get_keys(type, paths);
+  if (rc != DDS::RETCODE_OK) {
+    return rc;
+  }
+
+  ACE_UINT32 hash = 0;
+  for (MemberPathVec::iterator it = paths.begin(); it != paths.end(); ++it) {
+    DDS::DynamicData_var container;
+    DDS::MemberId member_id;
+    rc = it->get_member_from_data(data, container, member_id);
+    if (rc != DDS::RETCODE_OK) {
+      return rc;
+    }
+    rc = member_hash(hash, container, member_id);
+    if (rc != DDS::RETCODE_OK) {
+      return rc;
+    }
+  }
+
+  result = DCPS::key_hash_final(hash);
+  return DDS::RETCODE_OK;
+}
+
 DDS::ReturnCode_t get_member_type(DDS::DynamicType_var& member_type,
   DDS::DynamicType_ptr container_type, DDS::MemberId id)
 {
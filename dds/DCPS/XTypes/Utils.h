@@ -146,6 +146,8 @@ OpenDDS_Dcps_Export DDS::ReturnCode_t key_less_than(
   bool& result, DDS::DynamicData_ptr a, DDS::DynamicData_ptr b);
 OpenDDS_Dcps_Export DDS::ReturnCode_t compare_members(
   int& result, DDS::DynamicData_ptr a, DDS::DynamicData_ptr b, DDS::MemberId id);
+/// Hash of the keys of data that agrees with key_less_than.
+OpenDDS_Dcps_Export DDS::ReturnCode_t key_hash(size_t& result, DDS::DynamicData_ptr data);
 
 OpenDDS_Dcps_Export DDS::ReturnCode_t get_member_type(
   DDS::DynamicType_var& member_type, DDS::DynamicType_ptr container_type, DDS::MemberId id);
@@ -49,6 +49,7 @@ DataLink::DataLink(const TransportImpl_rch& impl, Priority priority, bool is_loo
   , is_active_(is_active)
   , started_(false)
   , send_response_listener_("DataLink")
+  , samples_dropped_early_(0)
 {
   DBG_ENTRY_LVL("DataLink", "DataLink", 6);
 
@@ -760,7 +761,11 @@ DataLink::data_received_i(ReceivedDataSample& sample,
 
   if (listener_set.is_nil()) {
     if (listener) {
-      listener->data_received(sample);
+      if (listener->drop_received(sample)) {
+        ++samples_dropped_early_;
+      } else {
+        listener->data_received(sample);
+      }
     } else {
       // Nobody has any interest in this message.  Drop it on the floor.
       if (Transport_debug_level > 4) {
@@ -775,7 +780,7 @@ DataLink::data_received_i(ReceivedDataSample& sample,
   }
 
   if (readerId != GUID_UNKNOWN) {
-    listener_set->data_received(sample, readerId);
+    samples_dropped_early_ += listener_set->data_received(sample, readerId);
     return;
   }
 
@@ -785,7 +790,7 @@ DataLink::data_received_i(ReceivedDataSample& sample,
       && sample.header_.content_filter_entries_.length()) {
     ReceiveListenerSet subset(*listener_set.in());
     subset.remove_all(sample.header_.content_filter_entries_);
-    subset.data_received(sample, incl_excl, constrain);
+    samples_dropped_early_ += subset.data_received(sample, incl_excl, constrain);
 
   } else {
 #endif /* OPENDDS_NO_CONTENT_SUBSCRIPTION_PROFILE */
@@ -805,7 +810,7 @@ DataLink::data_received_i(ReceivedDataSample& sample,
       ACE_DEBUG((LM_DEBUG, "(%P|%t) DataLink::data_received_i - normal data received to each subscription in listener_set %C ids:%C\n",
                  constrain == ReceiveListenerSet::SET_EXCLUDED ? "exclude" : "include", included_ids.c_str()));
     }
-    listener_set->data_received(sample, incl_excl, constrain);
+    samples_dropped_early_ += listener_set->data_received(sample, incl_excl, constrain);
 #ifndef OPENDDS_NO_CONTENT_SUBSCRIPTION_PROFILE
   }
 
@@ -1290,7 +1295,7 @@ DataLink::terminate_send_if_suspended()
 
 StatisticSeq DataLink::stats_template()
 {
-  static const DDS::UInt32 num_local_stats = 9;
+  static const DDS::UInt32 num_local_stats = 10;
   StatisticSeq stats(num_local_stats);
   stats.length(num_local_stats);
   stats[0].name = "DataLinkSendListeners";
@@ -1302,6 +1307,7 @@ StatisticSeq DataLink::stats_template()
   stats[6].name = "DataLinkPendingOnStarts";
   stats[7].name = "DataLinkMessageBlocks";
   stats[8].name = "DataLinkDataBlocks";
+  stats[9].name = "DataLinkSamplesDroppedEarly";
   return stats;
 }
 
@@ -1322,6 +1328,7 @@ void DataLink::fill_stats(StatisticSeq& stats, DDS::UInt32& idx) const
   }
   stats[idx++].value = mb_allocator_ ? mb_allocator_->bytes_heap_allocated() : 0;
   stats[idx++].value = db_allocator_ ? db_allocator_->bytes_heap_allocated() : 0;
+  stats[idx++].value = samples_dropped_early_;
 }
 
 }
@@ -20,6 +20,7 @@
 #include "TransportStrategy.h"
 #include "TransportStrategy_rch.h"
 
+#include "dds/DCPS/Atomic.h"
 #include "dds/DCPS/Definitions.h"
 #include "dds/DCPS/PoolAllocator.h"
 #include "dds/DCPS/RcEventHandler.h"
@@ -464,6 +465,11 @@ protected:
   /// Listener for TransportSendControlElements created in send_control
   SendResponseListener send_response_listener_;
 
+  /// Samples that a TransportReceiveListener dropped before they were
+  /// delivered (see TransportReceiveListener::drop_received), counted once
+  /// per listener.
+  Atomic<ACE_UINT64> samples_dropped_early_;
+
   static StatisticSeq stats_template();
   void fill_stats(StatisticSeq& stats, DDS::UInt32& idx) const;
 };
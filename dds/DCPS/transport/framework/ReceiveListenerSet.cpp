@@ -83,7 +83,7 @@ ReceiveListenerSet::clear()
   map_.clear();
 }
 
-void
+size_t
 ReceiveListenerSet::data_received(const ReceivedDataSample& sample,
                                   const RepoIdSet& incl_excl,
                                   ConstrainReceiveSet constrain)
@@ -108,10 +108,15 @@ ReceiveListenerSet::data_received(const ReceivedDataSample& sample,
     }
   }
 
+  size_t dropped = 0;
   for (size_t i = 0; i < handles.size(); ++i) {
     TransportReceiveListener_rch listener = handles[i].lock();
     if (!listener)
       continue;
+    if (listener->drop_received(sample)) {
+      ++dropped;
+      continue;
+    }
     if (i < handles.size() - 1 && sample.has_data()) {
       // demarshal (in data_received()) updates the rd_ptr() of any of
       // the message blocks in the chain, so give it a duplicated chain.
@@ -121,9 +126,10 @@ ReceiveListenerSet::data_received(const ReceivedDataSample& sample,
       listener->data_received(sample);
     }
   }
+  return dropped;
 }
 
-void
+size_t
 ReceiveListenerSet::data_received(const ReceivedDataSample& sample,
                                   const GUID_t& readerId)
 {
@@ -137,8 +143,14 @@ ReceiveListenerSet::data_received(const ReceivedDataSample& sample,
     }
   }
   TransportReceiveListener_rch listener = h.lock();
-  if (listener)
-    listener->data_received(sample);
+  if (!listener) {
+    return 0;
+  }
+  if (listener->drop_received(sample)) {
+    return 1;
+  }
+  listener->data_received(sample);
+  return 0;
 }
 
 }
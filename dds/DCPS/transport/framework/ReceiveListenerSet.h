@@ -46,10 +46,12 @@ public:
 
   ssize_t size() const;
 
-  void data_received(const ReceivedDataSample& sample,
-                     const RepoIdSet& incl_excl,
-                     ConstrainReceiveSet constrain);
-  void data_received(const ReceivedDataSample& sample, const GUID_t& readerId);
+  /// Deliver sample to the listeners.  Returns the number of listeners that
+  /// dropped it (see TransportReceiveListener::drop_received).
+  size_t data_received(const ReceivedDataSample& sample,
+                       const RepoIdSet& incl_excl,
+                       ConstrainReceiveSet constrain);
+  size_t data_received(const ReceivedDataSample& sample, const GUID_t& readerId);
 
   /// Give access to the underlying map for iteration purposes.
   MapType& map();
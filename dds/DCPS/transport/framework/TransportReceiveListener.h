@@ -28,6 +28,11 @@ public:
 
   virtual void data_received(const ReceivedDataSample& sample) = 0;
 
+  /// Called by the DataLink before data_received() and before the sample is
+  /// copied for this listener.  Returning true drops the sample, for example
+  /// because it doesn't match the listener's content filter.
+  virtual bool drop_received(const ReceivedDataSample&) { return false; }
+
   virtual void notify_subscription_disconnected(const WriterIdSeq& pubids) = 0;
   virtual void notify_subscription_reconnected(const WriterIdSeq& pubids) = 0;
   virtual void notify_subscription_lost(const WriterIdSeq& pubids) = 0;
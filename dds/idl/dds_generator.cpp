@@ -521,3 +521,126 @@ std::string dds_generator::call_gen_skip_over(AST_Type* type, const std::string&
     "      return false;\n"
     "    }\n";
 }
+
+namespace {
+
+// This function looks through the fields of a struct for the key
+// specified and returns the AST_Type associated with that key.
+// Because the key name can contain indexed arrays and nested
+// structures, things can get interesting.
+AST_Type* find_type_i(AST_Structure* struct_node, const string& key)
+{
+  string key_base = key;   // the field we are looking for here
+  string key_rem;          // the sub-field we will look for recursively
+  bool is_array = false;
+  size_t pos = key.find_first_of(".[");
+  if (pos != string::npos) {
+    key_base = key.substr(0, pos);
+    if (key[pos] == '[') {
+      is_array = true;
+      size_t l_brack = key.find("]");
+      if (l_brack == string::npos) {
+        throw string("Missing right bracket");
+      } else if (l_brack != key.length()) {
+        key_rem = key.substr(l_brack+1);
+      }
+    } else {
+      key_rem = key.substr(pos+1);
+    }
+  }
+
+  const Fields fields(struct_node);
+  const Fields::Iterator fields_end = fields.end();
+  for (Fields::Iterator i = fields.begin(); i != fields_end; ++i) {
+    AST_Field* const field = *i;
+    if (key_base == field->local_name()->get_string()) {
+      AST_Type* field_type = resolveActualType(field->field_type());
+      if (!is_array && key_rem.empty()) {
+        // The requested key field matches this one.  We do not allow
+        // arrays (must be indexed specifically) or structs (must
+        // identify specific sub-fields).
+        AST_Structure* sub_struct = dynamic_cast<AST_Structure*>(field_type);
+        if (sub_struct != 0) {
+          throw string("Structs not allowed as keys");
+        }
+        AST_Array* array_node = dynamic_cast<AST_Array*>(field_type);
+        if (array_node != 0) {
+          throw string("Arrays not allowed as keys");
+        }
+        return field_type;
+      } else if (is_array) {
+        // must be a typedef of an array
+        AST_Array* array_node = dynamic_cast<AST_Array*>(field_type);
+        if (array_node == 0) {
+          throw string("Indexing for non-array type");
+        }
+        if (array_node->n_dims() > 1) {
+          throw string("Only single dimension arrays allowed in keys");
+        }
+        if (key_rem == "") {
+          return array_node->base_type();
+        } else {
+          // This must be a struct...
+          if ((key_rem[0] != '.') || (key_rem.length() == 1)) {
+            throw string("Unexpected characters after array index");
+          } else {
+            // Set up key_rem and field_type and let things fall into
+            // the struct code below
+            key_rem = key_rem.substr(1);
+            field_type = array_node->base_type();
+          }
+        }
+      }
+
+      // nested structures
+      AST_Structure* sub_struct = dynamic_cast<AST_Structure*>(field_type);
+      if (sub_struct == 0) {
+        throw string("Expected structure field for ") + key_base;
+      }
+
+      // find type of nested struct field
+      return find_type_i(sub_struct, key_rem);
+    }
+  }
+  throw string("Field not found.");
+}
+
+}
+
+AST_Type* find_type(AST_Structure* struct_node, const string& key)
+{
+  try {
+    return find_type_i(struct_node, key);
+  } catch (const string& error) {
+    const std::string struct_name = scoped(struct_node->name());
+    be_util::misc_error_and_abort(
+      "Invalid key specification for " + struct_name + " (" + key + "): " + error,
+      struct_node);
+  }
+  return 0;
+}
+
+KeyMemberKind key_member_kind(AST_Type* type)
+{
+  AST_Type* const actual = resolveActualType(type);
+  const Classification cls = classify(actual);
+  if (cls & CL_STRING) {
+    return KeyMemberKind_String;
+  }
+  if (cls & CL_ENUM) {
+    return KeyMemberKind_Value;
+  }
+  if (cls & CL_PRIMITIVE) {
+    switch (dynamic_cast<AST_PredefinedType*>(actual)->pt()) {
+    case AST_PredefinedType::PT_float:
+    case AST_PredefinedType::PT_double:
+    case AST_PredefinedType::PT_longdouble:
+      return KeyMemberKind_Float;
+    default:
+      return KeyMemberKind_Value;
+    }
+  }
+  // Fixed values that compare equal can differ in scale, so they aren't
+  // hashed.
+  return KeyMemberKind_Other;
+}
@@ -738,6 +738,19 @@ inline std::string bounded_arg(AST_Type* type)
 std::string type_to_default(const std::string& indent, AST_Type* type,
   const std::string& name, bool is_anonymous = false, bool is_union = false, bool is_optional = false);
 
+/// Type of the key named by a #pragma DCPS_DATA_KEY of struct_node.
+AST_Type* find_type(AST_Structure* struct_node, const std::string& key);
+
+/// How KeyLessThan orders and DDSTraits<T>::key_hash hashes a key member.
+enum KeyMemberKind {
+  KeyMemberKind_Value, ///< ordered with < and hashed as its bytes
+  KeyMemberKind_Float, ///< ordered with key_float_less and hashed with key_hash_float
+  KeyMemberKind_String, ///< ordered with < and hashed as its characters
+  KeyMemberKind_Other ///< ordered with < and left out of the hash
+};
+
+KeyMemberKind key_member_kind(AST_Type* type);
+
 inline
 void generateBranchLabels(AST_UnionBranch* branch, AST_Type* discriminator,
                           size_t& n_labels, bool& has_default)
@@ -58,11 +58,18 @@ struct KeyLessThanWrapper {
   }
 
   void
-  key_compare(const string& member)
+  key_compare(const string& member, KeyMemberKind kind = KeyMemberKind_Value)
   {
-    be_global->header_ <<
-      "    if (v1." << member << " < v2." << member << ") return true;\n"
-      "    if (v2." << member << " < v1." << member << ") return false;\n";
+    if (kind == KeyMemberKind_Float) {
+      be_global->add_include("dds/DCPS/KeyHash.h", BE_GlobalData::STREAM_H);
+      be_global->header_ <<
+        "    if (OpenDDS::DCPS::key_float_less(v1." << member << ", v2." << member << ")) return true;\n"
+        "    if (OpenDDS::DCPS::key_float_less(v2." << member << ", v1." << member << ")) return false;\n";
+    } else {
+      be_global->header_ <<
+        "    if (v1." << member << " < v2." << member << ") return true;\n"
+        "    if (v2." << member << " < v1." << member << ") return false;\n";
+    }
   }
 
   ~KeyLessThanWrapper()
@@ -115,18 +122,20 @@ bool keys_generator::gen_struct(AST_Structure* node, UTL_ScopedName* name,
             fname = insert_cxx11_accessor_parens(fname, false);
           }
           if (i.root_type() == TopicKeys::UnionType) {
-            fname += "._d()";
+            wrapper.key_compare(fname + "._d()");
+          } else {
+            wrapper.key_compare(fname, key_member_kind(i.get_ast_type()));
           }
-          wrapper.key_compare(fname);
         }
       } else if (info) {
         IDL_GlobalData::DCPS_Data_Type_Info_Iter iter(info->key_list_);
         for (ACE_TString* kp = 0; iter.next(kp) != 0; iter.advance()) {
-          string fname = ACE_TEXT_ALWAYS_CHAR(kp->c_str());
+          const string key_name = ACE_TEXT_ALWAYS_CHAR(kp->c_str());
+          string fname = key_name;
           if (use_cxx11) {
             fname = insert_cxx11_accessor_parens(fname, false);
           }
-          wrapper.key_compare(fname);
+          wrapper.key_compare(fname, key_member_kind(find_type(node, key_name)));
         }
       }
     } else {
@@ -1450,100 +1450,6 @@ namespace {
     }
   }
 
-  // This function looks through the fields of a struct for the key
-  // specified and returns the AST_Type associated with that key.
-  // Because the key name can contain indexed arrays and nested
-  // structures, things can get interesting.
-  AST_Type* find_type_i(AST_Structure* struct_node, const string& key)
-  {
-    string key_base = key;   // the field we are looking for here
-    string key_rem;          // the sub-field we will look for recursively
-    bool is_array = false;
-    size_t pos = key.find_first_of(".[");
-    if (pos != string::npos) {
-      key_base = key.substr(0, pos);
-      if (key[pos] == '[') {
-        is_array = true;
-        size_t l_brack = key.find("]");
-        if (l_brack == string::npos) {
-          throw string("Missing right bracket");
-        } else if (l_brack != key.length()) {
-          key_rem = key.substr(l_brack+1);
-        }
-      } else {
-        key_rem = key.substr(pos+1);
-      }
-    }
-
-    const Fields fields(struct_node);
-    const Fields::Iterator fields_end = fields.end();
-    for (Fields::Iterator i = fields.begin(); i != fields_end; ++i) {
-      AST_Field* const field = *i;
-      if (key_base == field->local_name()->get_string()) {
-        AST_Type* field_type = resolveActualType(field->field_type());
-        if (!is_array && key_rem.empty()) {
-          // The requested key field matches this one.  We do not allow
-          // arrays (must be indexed specifically) or structs (must
-          // identify specific sub-fields).
-          AST_Structure* sub_struct = dynamic_cast<AST_Structure*>(field_type);
-          if (sub_struct != 0) {
-            throw string("Structs not allowed as keys");
-          }
-          AST_Array* array_node = dynamic_cast<AST_Array*>(field_type);
-          if (array_node != 0) {
-            throw string("Arrays not allowed as keys");
-          }
-          return field_type;
-        } else if (is_array) {
-          // must be a typedef of an array
-          AST_Array* array_node = dynamic_cast<AST_Array*>(field_type);
-          if (array_node == 0) {
-            throw string("Indexing for non-array type");
-          }
-          if (array_node->n_dims() > 1) {
-            throw string("Only single dimension arrays allowed in keys");
-          }
-          if (key_rem == "") {
-            return array_node->base_type();
-          } else {
-            // This must be a struct...
-            if ((key_rem[0] != '.') || (key_rem.length() == 1)) {
-              throw string("Unexpected characters after array index");
-            } else {
-              // Set up key_rem and field_type and let things fall into
-              // the struct code below
-              key_rem = key_rem.substr(1);
-              field_type = array_node->base_type();
-            }
-          }
-        }
-
-        // nested structures
-        AST_Structure* sub_struct = dynamic_cast<AST_Structure*>(field_type);
-        if (sub_struct == 0) {
-          throw string("Expected structure field for ") + key_base;
-        }
-
-        // find type of nested struct field
-        return find_type_i(sub_struct, key_rem);
-      }
-    }
-    throw string("Field not found.");
-  }
-
-  AST_Type* find_type(AST_Structure* struct_node, const string& key)
-  {
-    try {
-      return find_type_i(struct_node, key);
-    } catch (const string& error) {
-      const std::string struct_name = scoped(struct_node->name());
-      be_util::misc_error_and_abort(
-        "Invalid key specification for " + struct_name + " (" + key + "): " + error,
-        struct_node);
-    }
-    return 0;
-  }
-
   bool is_bounded_type(AST_Type* type, Encoding::Kind encoding)
   {
     bool bounded = true;
@@ -3174,10 +3080,18 @@ namespace {
       be_global->impl_ <<
         "  const Encoding& encoding = strm.encoding();\n"
         "  ACE_UNUSED_ARG(encoding);\n";
+      if (not_final) {
+        // Reserve the DHEADER and back-patch it once the members are written
+        // so the struct doesn't have to be walked by serialized_size first.
+        be_global->impl_ <<
+          "  Serializer::DelimiterMark dheader_mark;\n";
+      }
       marshal_generator::generate_dheader_code(
-        "    serialized_size(encoding, total_size, stru);\n"
-        "    if (!strm.write_delimiter(total_size)) {\n"
-        "      return false;\n"
+        "    if (!strm.begin_delimiter(dheader_mark)) {\n"
+        "      serialized_size(encoding, total_size, stru);\n"
+        "      if (!strm.write_delimiter(total_size)) {\n"
+        "        return false;\n"
+        "      }\n"
         "    }\n", not_final);
 
       // Mutable Code
@@ -3190,31 +3104,56 @@ namespace {
           "  if (encoding.xcdr_version() != Encoding::XCDR_VERSION_NONE) {\n"
           "    size_t size = 0;\n"
           "    ACE_UNUSED_ARG(size);\n";
+        bool member_mark_declared = false;
         for (Fields::Iterator i = fields.begin(); i != fields_end; ++i) {
           AST_Field* const field = *i;
           const OpenDDS::XTypes::MemberId id = be_global->get_id(field);
           const bool must_understand = be_global->is_effectively_must_understand(field);
-
-          mutable_fields
-            << generate_field_serialized_size(
-              mutable_indent, field, "stru" + value_access, wrap_nested_key_only, intro)
-            << "\n"
-            "    if (!strm.write_parameter_id("
-              << id << ", size" << (must_understand ? ", true" : "") << ")) {\n"
-            "      return false;\n"
-            "    }\n"
-            "    size = 0;\n"
-            "    if (!" << generate_field_stream(
-              mutable_indent, field, "<< stru" + value_access, field->local_name()->get_string(), wrap_nested_key_only, intro)
-            << ") {\n"
-            "      return false;\n"
-            "    }\n";
+          const Classification fld_cls = classify(resolveActualType(field->field_type()));
+          const std::string stream_field = generate_field_stream(
+            mutable_indent, field, "<< stru" + value_access, field->local_name()->get_string(), wrap_nested_key_only, intro);
+
+          if (fld_cls & (CL_PRIMITIVE | CL_ENUM)) {
+            mutable_fields
+              << generate_field_serialized_size(
+                mutable_indent, field, "stru" + value_access, wrap_nested_key_only, intro)
+              << "\n"
+              "    if (!strm.write_parameter_id("
+                << id << ", size" << (must_understand ? ", true" : "") << ")) {\n"
+              "      return false;\n"
+              "    }\n"
+              "    size = 0;\n"
+              "    if (!" << stream_field << ") {\n"
+              "      return false;\n"
+              "    }\n";
+          } else {
+            // Reserve the member header and fill it in after the member is
+            // written instead of walking the member with serialized_size.
+            if (!member_mark_declared) {
+              mutable_fields <<
+                "    Serializer::ParameterMark member_mark;\n";
+              member_mark_declared = true;
+            }
+            mutable_fields <<
+              "    if (!strm.begin_parameter(member_mark, " << id << (must_understand ? ", true" : "") << ")) {\n"
+              << generate_field_serialized_size(
+                mutable_indent + "  ", field, "stru" + value_access, wrap_nested_key_only, intro) <<
+              "      if (!strm.write_parameter_id("
+                << id << ", size" << (must_understand ? ", true" : "") << ")) {\n"
+              "        return false;\n"
+              "      }\n"
+              "      size = 0;\n"
+              "    }\n"
+              "    if (!(" << stream_field << ") || !strm.end_parameter(member_mark)) {\n"
+              "      return false;\n"
+              "    }\n";
+          }
         }
         mutable_fields << "\n"
           "    if (!strm.write_list_end_parameter_id()) {\n"
           "      return false;\n"
           "    }\n"
-          "    return true;\n"
+          "    return strm.end_delimiter(dheader_mark);\n"
           "  }\n";
       }
 
@@ -3250,6 +3189,9 @@ namespace {
       if (expr.empty()) {
         expr = "true";
       }
+      if (not_final) {
+        expr = "(" + expr + ")\n    && strm.end_delimiter(dheader_mark)";
+      }
       be_global->impl_ << mutable_fields.str() << "  return " << expr << ";\n";
     }
 
@@ -3671,6 +3613,213 @@ marshal_generator::gen_field_getValueFromSerialized(AST_Structure* node, const s
     "  }\n\n";
 }
 
+namespace {
+  /// Statements that read a scalar member into val and give it to values.
+  std::string getValues_read_scalar(AST_Field* field, const std::string& name,
+                                    const std::string& indent)
+  {
+    const bool use_cxx11 = be_global->language_mapping() == BE_GlobalData::LANGMAP_CXX11;
+    AST_Type* const field_type = resolveActualType(field->field_type());
+    const Classification fld_cls = classify(field_type);
+    size_t size = 0;
+    const std::string cxx_type = to_cxx_type(field_type, size);
+    const std::string val = (fld_cls & CL_STRING) ? (use_cxx11 ? "val" : "val.out()")
+      : getWrapper("val", field_type, WD_INPUT);
+    std::string result =
+      indent + cxx_type + " val;\n" +
+      indent + "if (!(strm >> " + val + ")) {\n" +
+      indent + "  return false;\n" +
+      indent + "}\n";
+    if (fld_cls & CL_ENUM) {
+      const std::string helper = "gen_" + scoped_helper(field_type->name(), "_") + "_helper";
+      result +=
+        indent + "if (!" + helper + "->valid(val)) {\n" +
+        indent + "  return false;\n" +
+        indent + "}\n" +
+        indent + "values.set(\"" + name + "\", " + helper + "->get_name(val));\n";
+    } else {
+      result += indent + "values.set(\"" + name + "\", val);\n";
+    }
+    return result;
+  }
+}
+
+void
+marshal_generator::gen_field_getValuesFromSerialized(AST_Structure* node)
+{
+  // Like getValue but reads every field that's asked for in one pass.  The
+  // stream is left after the struct unless all the fields have been read, so
+  // that nested structs can be read as part of the outer one.  In XCDR2 an
+  // appendable or mutable struct ends where its DHEADER says, whether the
+  // writer's type has more members than this one or fewer.
+  const bool use_cxx11 = be_global->language_mapping() == BE_GlobalData::LANGMAP_CXX11;
+  const ExtensibilityKind exten = be_global->extensibility(node);
+  const bool not_final = exten != extensibilitykind_final;
+  const bool is_mutable = exten == extensibilitykind_mutable;
+  const Fields fields(node);
+  const Fields::Iterator fields_end = fields.end();
+
+  be_global->impl_ <<
+    "  bool hasGetValues() const\n"
+    "  {\n"
+    "    return true;\n"
+    "  }\n\n"
+    "  bool getValues(Serializer& strm, FieldValues& values) const\n"
+    "  {\n"
+    "    const Encoding& encoding = strm.encoding();\n"
+    "    ACE_UNUSED_ARG(encoding);\n";
+  generate_dheader_code(
+    "      if (!strm.read_delimiter(total_size)) {\n"
+    "        return false;\n"
+    "      }\n", not_final, true, "    ");
+  if (not_final) {
+    be_global->impl_ <<
+      "    const bool delimited = encoding.xcdr_version() == Encoding::XCDR_VERSION_2;\n"
+      "    const size_t end_of_struct = strm.rpos() + total_size;\n";
+  }
+
+  if (is_mutable) {
+    std::ostringstream cases;
+    for (Fields::Iterator i = fields.begin(); i != fields_end; ++i) {
+      AST_Field* const field = *i;
+      const std::string name = canonical_name(field);
+      AST_Type* const field_type = resolveActualType(field->field_type());
+      const Classification fld_cls = classify(field_type);
+
+      cases << "        case " << be_global->get_id(field) << ":\n";
+      if (fld_cls & CL_SCALAR) {
+        cases <<
+          "          if (values.wants(\"" << name << "\")) {\n" <<
+          getValues_read_scalar(field, name, "            ") <<
+          "          }\n"
+          "          break;\n";
+      } else if (fld_cls & CL_STRUCTURE) {
+        cases <<
+          "          if (values.wants(\"" << name << "\")) {\n"
+          "            FieldValues nested(values, \"" << name << "\");\n"
+          "            if (!getMetaStruct<" << scoped(field_type->name()) << ">().getValues(strm, nested)) {\n"
+          "              return false;\n"
+          "            }\n"
+          "          }\n"
+          "          break;\n";
+      } else {
+        cases <<
+          "          break;\n";
+      }
+    }
+
+    be_global->impl_ <<
+      "    if (encoding.xcdr_version() != Encoding::XCDR_VERSION_NONE) {\n"
+      "      while (true) {\n"
+      "        if (delimited && strm.rpos() >= end_of_struct) {\n"
+      "          return true;\n"
+      "        }\n"
+      "        unsigned member_id;\n"
+      "        size_t field_size;\n"
+      "        bool must_understand = false;\n"
+      "        if (!strm.read_parameter_id(member_id, field_size, must_understand)) {\n"
+      "          return false;\n"
+      "        }\n"
+      "        if (encoding.xcdr_version() == Encoding::XCDR_VERSION_1 &&\n"
+      "            member_id == Serializer::pid_list_end) {\n"
+      "          return true;\n"
+      "        }\n"
+      "        const size_t end_of_field = strm.rpos() + field_size;\n"
+      "        switch (member_id) {\n"
+      << cases.str() <<
+      "        default:\n"
+      "          if (must_understand) {\n"
+      "            return false;\n"
+      "          }\n"
+      "          break;\n"
+      "        }\n"
+      "        if (values.done()) {\n"
+      "          return true;\n"
+      "        }\n"
+      "        if (strm.rpos() < end_of_field && !strm.skip(end_of_field - strm.rpos())) {\n"
+      "          return false;\n"
+      "        }\n"
+      "      }\n"
+      "    }\n";
+  }
+
+  // Appendable and final, also mutable when it's not XCDR1 or XCDR2
+  for (Fields::Iterator i = fields.begin(); i != fields_end; ++i) {
+    AST_Field* const field = *i;
+    const std::string name = canonical_name(field);
+    AST_Type* const field_type = resolveActualType(field->field_type());
+    const Classification fld_cls = classify(field_type);
+    if (not_final) {
+      be_global->impl_ <<
+        "    if (delimited && strm.rpos() >= end_of_struct) {\n"
+        "      return true;\n"
+        "    }\n";
+    }
+    if (fld_cls & CL_SCALAR) {
+      be_global->impl_ <<
+        "    if (values.wants(\"" << name << "\")) {\n" <<
+        getValues_read_scalar(field, name, "      ") <<
+        "      if (values.done()) {\n"
+        "        return true;\n"
+        "      }\n";
+      if (fld_cls & CL_STRING) {
+        be_global->impl_ <<
+          "    } else {\n"
+          "      ACE_CDR::ULong len;\n"
+          "      if (!(strm >> len) || !strm.skip(len)) {\n"
+          "        return false;\n"
+          "      }\n"
+          "    }\n";
+      } else {
+        size_t size = 0;
+        to_cxx_type(field_type, size);
+        be_global->impl_ <<
+          "    } else if (!strm.skip(1, " << size << ")) {\n"
+          "      return false;\n"
+          "    }\n";
+      }
+    } else if (fld_cls & CL_STRUCTURE) {
+      const std::string type = scoped(field_type->name());
+      be_global->impl_ <<
+        "    if (values.wants(\"" << name << "\")) {\n"
+        "      FieldValues nested(values, \"" << name << "\");\n"
+        "      if (!getMetaStruct<" << type << ">().getValues(strm, nested)) {\n"
+        "        return false;\n"
+        "      }\n"
+        "      if (values.done()) {\n"
+        "        return true;\n"
+        "      }\n"
+        "    } else if (!gen_skip_over(strm, static_cast<" << type << "*>(0))) {\n"
+        "      return false;\n"
+        "    }\n";
+    } else { // array, sequence, map, union:
+      std::string pre, post;
+      if (!use_cxx11 && (fld_cls & CL_ARRAY)) {
+        post = "_forany";
+      } else if (use_cxx11 && (fld_cls & (CL_ARRAY | CL_SEQUENCE | CL_MAP))) {
+        pre = "IDL::DistinctType<";
+        post = ", " + get_tag_name(scoped(deepest_named_type(field->field_type())->name())) + ">";
+      }
+      const std::string ptr = field->field_type()->anonymous() ?
+        FieldInfo(*field).ptr_ : (pre + field_type_name(field) + post + '*');
+      be_global->impl_ <<
+        "    if (!gen_skip_over(strm, static_cast<" << ptr << ">(0))) {\n"
+        "      return false;\n"
+        "    }\n";
+    }
+  }
+  if (not_final) {
+    be_global->impl_ <<
+      "    if (delimited && strm.rpos() < end_of_struct &&\n"
+      "        !strm.skip(end_of_struct - strm.rpos())) {\n"
+      "      return false;\n"
+      "    }\n";
+  }
+  be_global->impl_ <<
+    "    return true;\n"
+    "  }\n\n";
+}
+
 namespace {
   bool genRtpsParameter(const string&, AST_Union* u, AST_Type* discriminator,
                         const std::vector<AST_UnionBranch*>& branches)
@@ -323,6 +323,7 @@ namespace {
       "  }\n\n";
     if (struct_node) {
       marshal_generator::gen_field_getValueFromSerialized(struct_node, clazz);
+      marshal_generator::gen_field_getValuesFromSerialized(struct_node);
     } else {
       be_global->impl_ <<
         "  Value getValue(Serializer& ser, const char* field, TypeSupportImpl* = 0) const\n"
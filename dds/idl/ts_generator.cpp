@@ -91,6 +91,76 @@ namespace {
       gen_isDcpsKey_i(i.canonical_path().c_str());
     }
   }
+
+  void gen_copy_keys_i(const std::string& key)
+  {
+    const std::string member = insert_cxx11_accessor_parens(key);
+    be_global->impl_ <<
+      "  dest." << member << " = src." << member << ";\n";
+  }
+
+  void gen_copy_keys(IDL_GlobalData::DCPS_Data_Type_Info* info)
+  {
+    IDL_GlobalData::DCPS_Key_List::CONST_ITERATOR i(info->key_list_);
+    for (ACE_TString* key = 0; i.next(key); i.advance()) {
+      gen_copy_keys_i(ACE_TEXT_ALWAYS_CHAR(key->c_str()));
+    }
+  }
+
+  void gen_copy_keys(TopicKeys& keys)
+  {
+    // Union keys are copied whole, the path of a union key is the member
+    // that holds the union.
+    TopicKeys::Iterator finished = keys.end();
+    for (TopicKeys::Iterator i = keys.begin(); i != finished; ++i) {
+      gen_copy_keys_i(i.path());
+    }
+  }
+
+  void gen_key_hash_i(const std::string& member, KeyMemberKind kind)
+  {
+    const bool use_cxx11 = be_global->language_mapping() == BE_GlobalData::LANGMAP_CXX11;
+    switch (kind) {
+    case KeyMemberKind_Value:
+      be_global->impl_ <<
+        "  hash = key_hash_value(hash, sample." << member << ");\n";
+      break;
+    case KeyMemberKind_Float:
+      be_global->impl_ <<
+        "  hash = key_hash_float(hash, sample." << member << ");\n";
+      break;
+    case KeyMemberKind_String:
+      be_global->impl_ <<
+        "  hash = key_hash_string(hash, sample." << member << (use_cxx11 ? ".c_str()" : ".in()") << ");\n";
+      break;
+    case KeyMemberKind_Other:
+      break;
+    }
+  }
+
+  void gen_key_hash(AST_Structure* struct_node, IDL_GlobalData::DCPS_Data_Type_Info* info)
+  {
+    IDL_GlobalData::DCPS_Key_List::CONST_ITERATOR i(info->key_list_);
+    for (ACE_TString* key = 0; i.next(key); i.advance()) {
+      const std::string key_name = ACE_TEXT_ALWAYS_CHAR(key->c_str());
+      gen_key_hash_i(insert_cxx11_accessor_parens(key_name),
+        key_member_kind(find_type(struct_node, key_name)));
+    }
+  }
+
+  void gen_key_hash(TopicKeys& keys)
+  {
+    // Like KeyLessThan, only the discriminator of a union key is hashed.
+    TopicKeys::Iterator finished = keys.end();
+    for (TopicKeys::Iterator i = keys.begin(); i != finished; ++i) {
+      const std::string member = insert_cxx11_accessor_parens(i.path());
+      if (i.root_type() == TopicKeys::UnionType) {
+        gen_key_hash_i(member + "._d()", KeyMemberKind_Value);
+      } else {
+        gen_key_hash_i(member, key_member_kind(i.get_ast_type()));
+      }
+    }
+  }
 }
 
 bool ts_generator::generate_ts(AST_Type* node, UTL_ScopedName* name)
@@ -184,7 +254,8 @@ bool ts_generator::generate_ts(AST_Type* node, UTL_ScopedName* name)
     "dds/DCPS/BuiltInTopicUtils.h", "dds/DCPS/Util.h",
     "dds/DCPS/ContentFilteredTopicImpl.h", "dds/DCPS/RakeData.h",
     "dds/DCPS/MultiTopicDataReader_T.h", "dds/DCPS/DataWriterImpl_T.h",
-    "dds/DCPS/DataReaderImpl_T.h", "dds/DCPS/XTypes/TypeObject.h"
+    "dds/DCPS/DataReaderImpl_T.h", "dds/DCPS/XTypes/TypeObject.h",
+    "dds/DCPS/KeyHash.h"
   };
   add_includes(cpp_includes, BE_GlobalData::STREAM_CPP);
 
@@ -230,6 +301,8 @@ bool ts_generator::generate_ts(AST_Type* node, UTL_ScopedName* name)
     "  static const char* type_name() { return \"" << unescaped_name << "\"; }\n"
     "  static size_t key_count() { return " << key_count << "; }\n"
     "  static bool is_key(const char*);\n"
+    "  static void copy_keys(MessageType& dest, const MessageType& src);\n"
+    "  static size_t key_hash(const MessageType& sample);\n"
     "};\n"
     "} // namespace DCPS\n"
     "} // namespace OpenDDS\n"
@@ -251,6 +324,47 @@ bool ts_generator::generate_ts(AST_Type* node, UTL_ScopedName* name)
   }
   be_global->impl_ <<
     "  return false;\n"
+    "}\n\n"
+    "void DDSTraits<" << full_cxx_name << ">::copy_keys(MessageType& dest, const MessageType& src)\n"
+    "{\n";
+  if (struct_node && key_count) {
+    if (info) {
+      gen_copy_keys(info);
+    } else {
+      gen_copy_keys(keys);
+    }
+  } else if (key_count) {
+    // The discriminator is the key of a union, but it can't be set on its
+    // own without selecting a branch.
+    be_global->impl_ <<
+      "  dest = src;\n";
+  } else {
+    be_global->impl_ <<
+      "  ACE_UNUSED_ARG(dest);\n"
+      "  ACE_UNUSED_ARG(src);\n";
+  }
+  be_global->impl_ <<
+    "}\n\n"
+    "size_t DDSTraits<" << full_cxx_name << ">::key_hash(const MessageType& sample)\n"
+    "{\n";
+  if (key_count) {
+    be_global->impl_ <<
+      "  ACE_UINT32 hash = 0;\n";
+    if (struct_node && info) {
+      gen_key_hash(struct_node, info);
+    } else if (struct_node) {
+      gen_key_hash(keys);
+    } else {
+      gen_key_hash_i("_d()", KeyMemberKind_Value);
+    }
+    be_global->impl_ <<
+      "  return key_hash_final(hash);\n";
+  } else {
+    be_global->impl_ <<
+      "  ACE_UNUSED_ARG(sample);\n"
+      "  return 0;\n";
+  }
+  be_global->impl_ <<
     "}\n"
     "} // namespace DCPS\n"
     "} // namespace OpenDDS\n"
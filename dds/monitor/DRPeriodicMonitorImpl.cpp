@@ -16,6 +16,15 @@ OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 namespace OpenDDS {
 namespace Monitor {
 
+namespace {
+  void set_integer_value(NameValuePair& nvp, const char* name, size_t value)
+  {
+    nvp.name = name;
+    // Saturate rather than wrap since the report only carries a long.
+    const size_t max = static_cast<size_t>(ACE_INT32_MAX);
+    nvp.value.integer_value(static_cast<CORBA::Long>(value < max ? value : max));
+  }
+}
 
 DRPeriodicMonitorImpl::DRPeriodicMonitorImpl(DCPS::DataReaderImpl* dr,
                                              DataReaderPeriodicReportDataWriter_ptr dr_per_writer)
@@ -33,7 +42,42 @@ DRPeriodicMonitorImpl::report() {
   if (!CORBA::is_nil(this->dr_per_writer_.in())) {
     DataReaderPeriodicReport report;
     report.dr_id   = dr_->get_guid();
-    //report.associations = dr_->
+
+    DCPS::LatencyStatisticsSeq stats;
+    dr_->get_latency_stats(stats);
+    report.associations.length(stats.length());
+    for (CORBA::ULong i = 0; i < stats.length(); ++i) {
+      DataReaderAssociationPeriodic& assoc = report.associations[i];
+      const DCPS::LatencyStatistics& latency = stats[i];
+      assoc.dw_id = latency.publication;
+      assoc.samples_available = 0;
+
+      assoc.latency_stats.n = latency.n;
+      assoc.latency_stats.maximum = latency.maximum;
+      assoc.latency_stats.minimum = latency.minimum;
+      assoc.latency_stats.mean = latency.mean;
+      assoc.latency_stats.variance = latency.variance;
+      assoc.latency_stats.p50 = latency.p50;
+      assoc.latency_stats.p99 = latency.p99;
+      assoc.latency_stats.p999 = latency.p999;
+
+      assoc.take_latency_stats.n = latency.take_n;
+      assoc.take_latency_stats.maximum = latency.take_maximum;
+      assoc.take_latency_stats.minimum = latency.take_minimum;
+      assoc.take_latency_stats.mean = latency.take_mean;
+      assoc.take_latency_stats.variance = latency.take_variance;
+      assoc.take_latency_stats.p50 = latency.take_p50;
+      assoc.take_latency_stats.p99 = latency.take_p99;
+      assoc.take_latency_stats.p999 = latency.take_p999;
+    }
+
+    DCPS::DataReaderImpl::MemoryEstimate memory;
+    dr_->get_memory_estimate(memory);
+    report.values.length(3);
+    set_integer_value(report.values[0], "instances", memory.instances);
+    set_integer_value(report.values[1], "samples", memory.samples);
+    set_integer_value(report.values[2], "estimated_bytes", memory.estimated_bytes);
+
     this->dr_per_writer_->write(report, DDS::HANDLE_NIL);
   }
 }
@@ -392,7 +392,7 @@ Subscriber::rawData( std::ostream& str) const
        ++current, ++index) {
     str << std::endl << "  Writer[ " << OpenDDS::DCPS::LogGuid(current->first).conv_ << "]" << std::endl;
 #ifndef OPENDDS_SAFETY_PROFILE
-    current->second.raw_data( str);
+    current->second->raw_data( str);
 #endif //OPENDDS_SAFETY_PROFILE
   }
   return str;
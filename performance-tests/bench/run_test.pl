@@ -97,6 +97,10 @@ elsif ($test->flag('ci-echo-frag')) {
   $tc_opts .= " ci-echo-frag";
   $is_rtps_disc = 1;
 }
+elsif ($test->flag('ci-multi-writer')) {
+  $tc_opts .= " ci-multi-writer";
+  $is_rtps_disc = 1;
+}
 elsif ($test->flag('ci-force-worker-segfault')) {
   $tc_opts .= " ci-force-worker-segfault";
   $is_rtps_disc = 1;
@@ -0,0 +1,270 @@
+/**
+ * Checks DCPSDeserializeThreads: samples that are handed to the
+ * deserialization threads are stored in the order they were written along
+ * with the small samples and disposes that aren't, the DataReader's
+ * listener is never called on a deserialization thread, and no more than
+ * DCPSDeliveryQueueMax samples wait to be stored.
+ */
+#include "DeserializeThreadsTypeSupportImpl.h"
+
+#include <tests/Utils/DDSApp.h>
+#include <tests/Utils/StatusMatching.h>
+
+#include <dds/DCPS/Service_Participant.h>
+#include <dds/DCPS/Atomic.h>
+#include <dds/DCPS/AtomicBool.h>
+#include <dds/DCPS/DataReaderImpl.h>
+#include <dds/DCPS/DomainParticipantImpl.h>
+#include <dds/DCPS/LocalObject.h>
+#include <dds/DCPS/WaitSet.h>
+#ifdef ACE_AS_STATIC_LIBS
+#  include <dds/DCPS/transport/rtps_udp/RtpsUdp.h>
+#  include <dds/DCPS/RTPS/RtpsDiscovery.h>
+#endif
+
+using namespace DeserializeThreads;
+
+class DDS_TEST {
+public:
+  static size_t delivery_queue_size(DDS::DataReader* reader)
+  {
+    OpenDDS::DCPS::DataReaderImpl* const impl = dynamic_cast<OpenDDS::DCPS::DataReaderImpl*>(reader);
+    ACE_Guard<ACE_Thread_Mutex> guard(impl->delivery_queue_lock_);
+    return impl->delivery_queue_.size();
+  }
+};
+
+namespace {
+  const DDS::DomainId_t domain = 149;
+  const char* const topic_name = "DeserializeThreads";
+  const CORBA::Long instance_count = 3;
+  const CORBA::Long sample_count = 300;
+  /// Every third sample is large enough for the deserialization threads.
+  const CORBA::ULong large_length = 1000;
+
+  CORBA::ULong values_length(CORBA::Long seq)
+  {
+    return seq % 3 ? seq % 7 : large_length;
+  }
+
+  class Listener : public virtual OpenDDS::DCPS::LocalObject<DDS::DataReaderListener> {
+  public:
+    explicit Listener(OpenDDS::DCPS::DomainParticipantImpl* participant)
+      : participant_(participant)
+      , called_(false)
+      , on_deserialize_thread_(false)
+      , on_delivery_thread_(false)
+      , max_queued_(0)
+    {}
+
+    void on_data_available(DDS::DataReader_ptr reader)
+    {
+      called_ = true;
+      const size_t queued = DDS_TEST::delivery_queue_size(reader);
+      if (queued > max_queued_) {
+        max_queued_ = queued;
+      }
+      if (participant_->deserialize_dispatcher()->on_thread()) {
+        on_deserialize_thread_ = true;
+      }
+      if (participant_->delivery_dispatcher()->on_thread()) {
+        on_delivery_thread_ = true;
+      }
+    }
+
+    void on_requested_deadline_missed(DDS::DataReader_ptr, const DDS::RequestedDeadlineMissedStatus&) {}
+    void on_requested_incompatible_qos(DDS::DataReader_ptr, const DDS::RequestedIncompatibleQosStatus&) {}
+    void on_sample_rejected(DDS::DataReader_ptr, const DDS::SampleRejectedStatus&) {}
+    void on_liveliness_changed(DDS::DataReader_ptr, const DDS::LivelinessChangedStatus&) {}
+    void on_subscription_matched(DDS::DataReader_ptr, const DDS::SubscriptionMatchedStatus&) {}
+    void on_sample_lost(DDS::DataReader_ptr, const DDS::SampleLostStatus&) {}
+
+    bool check() const
+    {
+      if (!called_) {
+        ACE_ERROR((LM_ERROR, "ERROR: on_data_available wasn't called\n"));
+        return false;
+      }
+      if (on_deserialize_thread_) {
+        ACE_ERROR((LM_ERROR, "ERROR: on_data_available was called on a deserialization thread\n"));
+        return false;
+      }
+      if (!on_delivery_thread_) {
+        ACE_ERROR((LM_ERROR, "ERROR: on_data_available was never called on the delivery thread\n"));
+        return false;
+      }
+      const size_t queue_max = TheServiceParticipant->delivery_queue_max();
+      if (queue_max && max_queued_ > queue_max) {
+        ACE_ERROR((LM_ERROR, "ERROR: %B samples were queued, the limit is %B\n",
+                   size_t(max_queued_), queue_max));
+        return false;
+      }
+      return true;
+    }
+
+  private:
+    OpenDDS::DCPS::DomainParticipantImpl* const participant_;
+    OpenDDS::DCPS::AtomicBool called_;
+    OpenDDS::DCPS::AtomicBool on_deserialize_thread_;
+    OpenDDS::DCPS::AtomicBool on_delivery_thread_;
+    /// Only changed by the delivery thread.
+    OpenDDS::DCPS::Atomic<size_t> max_queued_;
+  };
+
+  void writer_qos(DDS::DataWriterQos& qos)
+  {
+    qos.reliability.kind = DDS::RELIABLE_RELIABILITY_QOS;
+    qos.history.kind = DDS::KEEP_ALL_HISTORY_QOS;
+  }
+
+  void reader_qos(DDS::DataReaderQos& qos)
+  {
+    qos.reliability.kind = DDS::RELIABLE_RELIABILITY_QOS;
+    qos.history.kind = DDS::KEEP_ALL_HISTORY_QOS;
+  }
+
+  /// Take until every sample and the disposes of all instances have
+  /// arrived.  Each instance's samples must be in the order they were
+  /// written and its dispose must come last.
+  bool take_in_order(DDS::DataReader* reader)
+  {
+    SampleDataReader_var dr = SampleDataReader::_narrow(reader);
+    DDS::ReadCondition_var condition = dr->create_readcondition(
+      DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE);
+    DDS::WaitSet_var ws = new DDS::WaitSet;
+    ws->attach_condition(condition);
+    const DDS::Duration_t timeout = {30, 0};
+
+    bool ok = true;
+    CORBA::Long last_seq[instance_count] = { -1, -1, -1 };
+    bool disposed[instance_count] = { false, false, false };
+    CORBA::Long received = 0, disposes = 0;
+    while (ok && (received < sample_count || disposes < instance_count)) {
+      DDS::ConditionSeq active;
+      if (ws->wait(active, timeout) != DDS::RETCODE_OK) {
+        ACE_ERROR((LM_ERROR, "ERROR: timed out after %d samples and %d disposes\n", received, disposes));
+        ok = false;
+        break;
+      }
+      SampleSeq data;
+      DDS::SampleInfoSeq info;
+      if (dr->take_w_condition(data, info, DDS::LENGTH_UNLIMITED, condition) != DDS::RETCODE_OK) {
+        continue;
+      }
+      for (CORBA::ULong i = 0; i < data.length(); ++i) {
+        const CORBA::Long id = data[i].id;
+        if (id < 0 || id >= instance_count) {
+          ACE_ERROR((LM_ERROR, "ERROR: sample has id %d\n", id));
+          ok = false;
+          continue;
+        }
+        if (!info[i].valid_data) {
+          if (info[i].instance_state == DDS::NOT_ALIVE_DISPOSED_INSTANCE_STATE) {
+            if (last_seq[id] + instance_count < sample_count) {
+              ACE_ERROR((LM_ERROR, "ERROR: instance %d was disposed after sample %d\n", id, last_seq[id]));
+              ok = false;
+            }
+            disposed[id] = true;
+            ++disposes;
+          }
+          continue;
+        }
+        const CORBA::Long seq = data[i].seq;
+        if (disposed[id] || seq <= last_seq[id] || seq % instance_count != id) {
+          ACE_ERROR((LM_ERROR, "ERROR: instance %d got sample %d after %d\n", id, seq, last_seq[id]));
+          ok = false;
+        }
+        if (data[i].values.length() != values_length(seq)) {
+          ACE_ERROR((LM_ERROR, "ERROR: sample %d has %u values, expected %u\n",
+                     seq, data[i].values.length(), values_length(seq)));
+          ok = false;
+        }
+        last_seq[id] = seq;
+        ++received;
+      }
+      dr->return_loan(data, info);
+    }
+
+    if (ok && received != sample_count) {
+      ACE_ERROR((LM_ERROR, "ERROR: got %d samples, expected %d\n", received, sample_count));
+      ok = false;
+    }
+    ws->detach_condition(condition);
+    dr->delete_readcondition(condition);
+    return ok;
+  }
+}
+
+int run_test(TestUtils::DDSApp& app)
+{
+  DDS::DomainParticipant_var participant = app.participant();
+  TestUtils::DDSTopicFacade<Sample> topic = app.topic_facade<Sample>(topic_name, participant);
+  Listener* const listener_impl = new Listener(dynamic_cast<OpenDDS::DCPS::DomainParticipantImpl*>(participant.in()));
+  DDS::DataReaderListener_var listener = listener_impl;
+  DDS::DataReader_var reader = topic.reader(listener, reader_qos, DDS::Subscriber_var(), DDS::DATA_AVAILABLE_STATUS);
+  SampleDataWriter_var sample_dw = topic.writer(writer_qos);
+  if (!reader || !sample_dw) {
+    ACE_ERROR((LM_ERROR, "ERROR: failed to create the reader or writer\n"));
+    return 1;
+  }
+
+  int status = 0;
+  if (Utils::wait_match(reader, 1)) {
+    status = 1;
+  }
+
+  if (!status) {
+    for (CORBA::Long seq = 0; seq < sample_count; ++seq) {
+      Sample sample;
+      sample.id = seq % instance_count;
+      sample.seq = seq;
+      sample.values.length(values_length(seq));
+      for (CORBA::ULong i = 0; i < sample.values.length(); ++i) {
+        sample.values[i] = seq;
+      }
+      if (sample_dw->write(sample, DDS::HANDLE_NIL) != DDS::RETCODE_OK) {
+        ACE_ERROR((LM_ERROR, "ERROR: write failed\n"));
+        status = 1;
+      }
+    }
+    // Disposes aren't deserialized by the threads, so they have to wait
+    // behind the samples that are.
+    for (CORBA::Long id = 0; id < instance_count; ++id) {
+      Sample sample;
+      sample.id = id;
+      if (sample_dw->dispose(sample, DDS::HANDLE_NIL) != DDS::RETCODE_OK) {
+        ACE_ERROR((LM_ERROR, "ERROR: dispose failed\n"));
+        status = 1;
+      }
+    }
+  }
+
+  if (!status && !take_in_order(reader)) {
+    status = 1;
+  }
+  if (!status && !listener_impl->check()) {
+    status = 1;
+  }
+
+  return status;
+}
+
+int ACE_TMAIN(int argc, ACE_TCHAR* argv[])
+{
+  int status = 1;
+  try {
+    TestUtils::DDSApp app(argc, argv, domain);
+    if (!TheServiceParticipant->deserialize_threads()) {
+      ACE_ERROR((LM_ERROR, "ERROR: DCPSDeserializeThreads is not set\n"));
+      return 1;
+    }
+    status = run_test(app);
+  } catch (const std::exception& e) {
+    ACE_ERROR((LM_ERROR, "ERROR: %C\n", e.what()));
+  }
+
+  if (!status) {
+    ACE_DEBUG((LM_INFO, "INFO: test passed\n"));
+  }
+  return status;
+}
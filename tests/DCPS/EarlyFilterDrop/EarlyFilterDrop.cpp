@@ -0,0 +1,242 @@
+/**
+ * Checks that samples of a ContentFilteredTopic that the writer doesn't
+ * filter are dropped by the DataReader as the transport delivers them: the
+ * reader only gets the samples that match, the DataLinkSamplesDroppedEarly
+ * transport statistic counts the rest, the dropped samples still count
+ * towards the reader's latency statistics, and the filter that is applied
+ * follows changes to its parameters.
+ */
+#include "EarlyFilterDropTypeSupportImpl.h"
+
+#include <tests/Utils/DDSApp.h>
+#include <tests/Utils/StatusMatching.h>
+
+#include <dds/DCPS/Service_Participant.h>
+#include <dds/DCPS/DataReaderImpl.h>
+#include <dds/DCPS/Qos_Helper.h>
+#include <dds/DCPS/Statistics.h>
+#ifdef ACE_AS_STATIC_LIBS
+#  include <dds/DCPS/transport/rtps_udp/RtpsUdp.h>
+#  include <dds/DCPS/RTPS/RtpsDiscovery.h>
+#endif
+
+#include <ace/OS_NS_unistd.h>
+
+#include <cstring>
+
+using namespace EarlyFilterDrop;
+
+namespace {
+  const DDS::DomainId_t domain = 150;
+  const char* const topic_name = "EarlyFilterDrop";
+  const CORBA::Long sample_count = 100;
+  const int timeout_sec = 30;
+
+  void writer_qos(DDS::DataWriterQos& qos)
+  {
+    qos.reliability.kind = DDS::RELIABLE_RELIABILITY_QOS;
+    qos.history.kind = DDS::KEEP_ALL_HISTORY_QOS;
+  }
+
+  /// The largest DataLinkSamplesDroppedEarly value reported so far.
+  ACE_UINT64 dropped_early(OpenDDS::DCPS::StatisticsDataReader& reader, ACE_UINT64 dropped)
+  {
+    OpenDDS::DCPS::StatisticsDataReader::SampleSequence samples;
+    OpenDDS::DCPS::InternalSampleInfoSequence infos;
+    reader.take(samples, infos, DDS::LENGTH_UNLIMITED,
+                DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE);
+    for (size_t i = 0; i < samples.size(); ++i) {
+      for (CORBA::ULong j = 0; j < samples[i].stats.length(); ++j) {
+        const OpenDDS::DCPS::Statistic& stat = samples[i].stats[j];
+        if (std::strcmp(stat.name.in(), "DataLinkSamplesDroppedEarly") == 0 && stat.value > dropped) {
+          dropped = stat.value;
+        }
+      }
+    }
+    return dropped;
+  }
+
+  CORBA::ULong latency_count(OpenDDS::DCPS::DataReaderImpl* reader)
+  {
+    OpenDDS::DCPS::LatencyStatisticsSeq stats;
+    reader->get_latency_stats(stats);
+    CORBA::ULong n = 0;
+    for (CORBA::ULong i = 0; i < stats.length(); ++i) {
+      n += stats[i].n;
+    }
+    return n;
+  }
+
+  class Test {
+  public:
+    Test(SampleDataWriter_ptr writer, SampleDataReader_ptr reader,
+         OpenDDS::DCPS::StatisticsDataReader& stats_reader)
+      : writer_(SampleDataWriter::_duplicate(writer))
+      , reader_(SampleDataReader::_duplicate(reader))
+      , reader_impl_(dynamic_cast<OpenDDS::DCPS::DataReaderImpl*>(reader))
+      , stats_reader_(stats_reader)
+      , seq_(0)
+      , dropped_(0)
+    {}
+
+    /// Write sample_count samples alternating between instances 0 and 1
+    /// and check that the reader only gets the ones of instance id.
+    bool run(const char* name, CORBA::Long id)
+    {
+      const CORBA::Long first = seq_;
+      for (CORBA::Long i = 0; i < sample_count; ++i) {
+        Sample sample;
+        sample.id = seq_ % 2;
+        sample.seq = seq_++;
+        if (writer_->write(sample, DDS::HANDLE_NIL) != DDS::RETCODE_OK) {
+          ACE_ERROR((LM_ERROR, "ERROR: %C: write failed\n", name));
+          return false;
+        }
+      }
+      const DDS::Duration_t timeout = {timeout_sec, 0};
+      if (writer_->wait_for_acknowledgments(timeout) != DDS::RETCODE_OK) {
+        ACE_ERROR((LM_ERROR, "ERROR: %C: wait_for_acknowledgments failed\n", name));
+        return false;
+      }
+
+      bool ok = true;
+      CORBA::Long received = 0;
+      for (int i = 0; i < timeout_sec * 10 && received < sample_count / 2; ++i) {
+        SampleSeq data;
+        DDS::SampleInfoSeq info;
+        if (reader_->take(data, info, DDS::LENGTH_UNLIMITED,
+              DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE) == DDS::RETCODE_OK) {
+          for (CORBA::ULong j = 0; j < data.length(); ++j) {
+            if (!info[j].valid_data) {
+              continue;
+            }
+            if (data[j].id != id || data[j].seq < first) {
+              ACE_ERROR((LM_ERROR, "ERROR: %C: got sample %d of instance %d\n", name, data[j].seq, data[j].id));
+              ok = false;
+            }
+            ++received;
+          }
+          reader_->return_loan(data, info);
+        } else {
+          ACE_OS::sleep(ACE_Time_Value(0, 100000));
+        }
+      }
+      if (received != sample_count / 2) {
+        ACE_ERROR((LM_ERROR, "ERROR: %C: got %d samples, expected %d\n", name, received, sample_count / 2));
+        ok = false;
+      }
+
+      // The statistics are written periodically, and the dropped samples
+      // count towards the latency statistics like the ones that are kept.
+      const ACE_UINT64 expected_dropped = seq_ / 2;
+      bool counted = false;
+      for (int i = 0; i < timeout_sec * 10 && !counted; ++i) {
+        dropped_ = dropped_early(stats_reader_, dropped_);
+        counted = dropped_ >= expected_dropped && latency_count(reader_impl_) >= CORBA::ULong(seq_);
+        if (!counted) {
+          ACE_OS::sleep(ACE_Time_Value(0, 100000));
+        }
+      }
+      if (dropped_ != expected_dropped) {
+        ACE_ERROR((LM_ERROR, "ERROR: %C: DataLinkSamplesDroppedEarly is %Q, expected %Q\n",
+                   name, dropped_, expected_dropped));
+        ok = false;
+      }
+      const CORBA::ULong latency_n = latency_count(reader_impl_);
+      if (latency_n != CORBA::ULong(seq_)) {
+        ACE_ERROR((LM_ERROR, "ERROR: %C: latency statistics have %u samples, expected %d\n",
+                   name, latency_n, seq_));
+        ok = false;
+      }
+      return ok;
+    }
+
+  private:
+    SampleDataWriter_var writer_;
+    SampleDataReader_var reader_;
+    OpenDDS::DCPS::DataReaderImpl* const reader_impl_;
+    OpenDDS::DCPS::StatisticsDataReader& stats_reader_;
+    CORBA::Long seq_;
+    ACE_UINT64 dropped_;
+  };
+}
+
+int run_test(TestUtils::DDSApp& app, OpenDDS::DCPS::StatisticsDataReader& stats_reader)
+{
+  DDS::DomainParticipant_var participant = app.participant();
+  TestUtils::DDSTopicFacade<Sample> topic = app.topic_facade<Sample>(topic_name, participant);
+  SampleDataWriter_var writer = topic.writer(writer_qos);
+
+  DDS::TopicDescription_var description = participant->lookup_topicdescription(topic_name);
+  DDS::Topic_var filtered_topic = DDS::Topic::_narrow(description);
+  DDS::StringSeq params(1);
+  params.length(1);
+  params[0] = "0";
+  DDS::ContentFilteredTopic_var cft =
+    participant->create_contentfilteredtopic("EarlyFilterDropFiltered", filtered_topic, "id = %0", params);
+  DDS::Subscriber_var sub = app.subscriber(participant);
+  if (!cft || !sub) {
+    ACE_ERROR((LM_ERROR, "ERROR: failed to create the filtered topic or subscriber\n"));
+    return 1;
+  }
+  DDS::DataReaderQos dr_qos;
+  sub->get_default_datareader_qos(dr_qos);
+  dr_qos.reliability.kind = DDS::RELIABLE_RELIABILITY_QOS;
+  dr_qos.history.kind = DDS::KEEP_ALL_HISTORY_QOS;
+  DDS::DataReader_var reader = sub->create_datareader(cft, dr_qos, 0, OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+  SampleDataReader_var sample_dr = SampleDataReader::_narrow(reader);
+  if (!sample_dr || !writer) {
+    ACE_ERROR((LM_ERROR, "ERROR: failed to create the reader or writer\n"));
+    return 1;
+  }
+  dynamic_cast<OpenDDS::DCPS::DataReaderImpl*>(reader.in())->statistics_enabled(true);
+
+  if (Utils::wait_match(reader, 1)) {
+    return 1;
+  }
+
+  int status = 0;
+  Test test(writer, sample_dr, stats_reader);
+  if (!test.run("initial", 0)) {
+    status = 1;
+  }
+  // The samples written after the change are filtered with the new
+  // parameters.
+  params[0] = "1";
+  if (cft->set_expression_parameters(params) != DDS::RETCODE_OK) {
+    ACE_ERROR((LM_ERROR, "ERROR: set_expression_parameters failed\n"));
+    status = 1;
+  } else if (!test.run("changed", 1)) {
+    status = 1;
+  }
+  return status;
+}
+
+int ACE_TMAIN(int argc, ACE_TCHAR* argv[])
+{
+  int status = 1;
+  try {
+    TestUtils::DDSApp app(argc, argv, domain);
+    if (TheServiceParticipant->publisher_content_filter()) {
+      ACE_ERROR((LM_ERROR, "ERROR: DCPSPublisherContentFilter is set\n"));
+      return 1;
+    }
+    TheServiceParticipant->statistics_period(OpenDDS::DCPS::TimeDuration(0, 100000));
+    const OpenDDS::DCPS::StatisticsDataReader_rch stats_reader =
+      OpenDDS::DCPS::make_rch<OpenDDS::DCPS::StatisticsDataReader>(
+        OpenDDS::DCPS::DataReaderQosBuilder().reliability_reliable());
+    TheServiceParticipant->statistics_topic()->connect(stats_reader);
+
+    status = run_test(app, *stats_reader);
+
+    app.cleanup();
+    TheServiceParticipant->statistics_topic()->disconnect(stats_reader);
+  } catch (const std::exception& e) {
+    ACE_ERROR((LM_ERROR, "ERROR: %C\n", e.what()));
+  }
+
+  if (!status) {
+    ACE_DEBUG((LM_INFO, "INFO: test passed\n"));
+  }
+  return status;
+}
@@ -9,6 +9,8 @@
 #include "dds/DCPS/FilterExpressionGrammar.h"
 #include "dds/DCPS/yard/yard_parser.hpp"
 #include "dds/DCPS/FilterEvaluator.h"
+#include "dds/DCPS/FilterIndex.h"
+#include "dds/DCPS/Sample.h"
 
 #include "dds/DCPS/XTypes/DynamicDataFactory.h"
 #include "dds/DCPS/XTypes/DynamicSample.h"
@@ -20,6 +22,7 @@
 #include <cstring>
 #include <cstdio>
 #include <iostream>
+#include <limits>
 
 DDS::DynamicData_var copy(const TBTD& sample, DDS::DynamicType* type)
 {
@@ -140,7 +143,12 @@ bool testEval() {
                                          "durability_service.history_depth > %0",
                                          "durability_service.service_cleanup_delay.sec = 0 AND durability_service.service_cleanup_delay.nanosec >= 10",
                                          "durability_service.service_cleanup_delay.sec < durability_service.service_cleanup_delay.nanosec",
-                                         "MOD(durability_service.history_depth,3) = 0"
+                                         "MOD(durability_service.history_depth,3) = 0",
+                                         "name = 'Bob' OR durability_service.history_depth = 15",
+                                         "NOT name = 'Bob'",
+                                         "durability_service.history_depth NOT BETWEEN 1 AND 10",
+                                         "(name = 'Bob' OR name LIKE 'A_am') AND durability_service.history_depth BETWEEN 10 AND 20",
+                                         "durability_service.max_samples = 0 AND durability.kind = 'PERSISTENT_DURABILITY_QOS' AND name = 'Adam'"
     };
 
     static const char* filters_fail[] = {"name LIKE 'ZZ%'",
@@ -148,7 +156,10 @@ bool testEval() {
                                          "durability_service.history_depth < %0",
                                          "durability_service.service_cleanup_delay.sec = 0 AND durability_service.service_cleanup_delay.nanosec BETWEEN 3 AND 5",
                                          "durability_service.service_cleanup_delay.sec = durability_service.service_cleanup_delay.nanosec",
-                                         "MOD(durability_service.history_depth,4) = 0"};
+                                         "MOD(durability_service.history_depth,4) = 0",
+                                         "name = 'Adam' AND NOT durability_service.history_depth = 15",
+                                         "name LIKE 'A*'",
+                                         "durability_service.history_depth NOT BETWEEN 10 AND 20"};
 
     std::cout << std::boolalpha;
     TBTDTypeSupportImpl tsStat;
@@ -163,6 +174,176 @@ bool testEval() {
 
 }
 
+bool testFilterIndex()
+{
+  using namespace OpenDDS::DCPS;
+
+  TBTD sample;
+  sample.name = "Adam";
+  sample.durability.kind = DDS::PERSISTENT_DURABILITY_QOS;
+  sample.durability_service.history_depth = 15;
+  sample.durability_service.service_cleanup_delay.sec = 0;
+  sample.durability_service.service_cleanup_delay.nanosec = 10;
+
+  DDS::StringSeq no_params;
+  DDS::StringSeq params;
+  params.length(1);
+  params[0] = "15";
+
+  struct Case {
+    const char* filter;
+    bool uses_params;
+    bool expected;
+  };
+  static const Case cases[] = {
+    {"durability_service.history_depth = 15", false, true},
+    {"durability_service.history_depth = %0", true, true},
+    {"durability_service.history_depth = 14", false, false},
+    {"durability_service.history_depth < 15", false, false},
+    {"durability_service.history_depth <= 15", false, true},
+    {"durability_service.history_depth > 14", false, true},
+    {"durability_service.history_depth >= 16", false, false},
+    {"14 < durability_service.history_depth", false, true},
+    {"16 <= durability_service.history_depth", false, false},
+    {"durability_service.history_depth BETWEEN 10 AND 20", false, true},
+    {"durability_service.history_depth BETWEEN 16 AND 20", false, false},
+    {"durability_service.history_depth BETWEEN 10 AND 14", false, false},
+    {"durability_service.history_depth BETWEEN 10.5 AND 20", false, true},
+    {"name = 'Adam'", false, true},
+    {"name > 'Bob'", false, false},
+    {"name LIKE 'A%'", false, true},
+    {"name = 'Adam' AND durability_service.history_depth = 14", false, false},
+  };
+  static const size_t n = sizeof cases / sizeof cases[0];
+
+  FilterIndex index;
+  OPENDDS_VECTOR(RcHandle<FilterEvaluator>) evals;
+  for (size_t i = 0; i < n; ++i) {
+    evals.push_back(make_rch<FilterEvaluator>(cases[i].filter, false));
+    // Two readers per filter so that groups are exercised.
+    for (CORBA::Octet j = 0; j < 2; ++j) {
+      GUID_t reader = GUID_UNKNOWN;
+      reader.entityId.entityKey[1] = static_cast<CORBA::Octet>(i);
+      reader.entityId.entityKey[2] = j;
+      index.insert(reader, evals.back(), cases[i].uses_params ? params : no_params);
+    }
+  }
+
+  bool ok = true;
+  const Sample_T<TBTD> wrapped(sample);
+  for (int pass = 0; pass < 2; ++pass) {
+    GUIDSeq filter_out;
+    index.filter(wrapped, filter_out);
+    for (size_t i = 0; i < n; ++i) {
+      size_t found = 0;
+      for (CORBA::ULong k = 0; k < filter_out.length(); ++k) {
+        if (filter_out[k].entityId.entityKey[1] == i) {
+          ++found;
+        }
+      }
+      const size_t expected_found = cases[i].expected ? 0 : 2;
+      if (found != expected_found) {
+        std::cout << "FilterIndex: " << cases[i].filter << " filtered out "
+                  << found << " readers, expected " << expected_found << std::endl;
+        ok = false;
+      }
+    }
+
+    // Removing a reader takes it out of the result, its group stays.
+    GUID_t reader = GUID_UNKNOWN;
+    reader.entityId.entityKey[1] = 2;
+    reader.entityId.entityKey[2] = 1;
+    index.remove(reader);
+    GUIDSeq after_remove;
+    index.filter(wrapped, after_remove);
+    if (after_remove.length() + 1 != filter_out.length()) {
+      std::cout << "FilterIndex: remove didn't drop the reader" << std::endl;
+      ok = false;
+    }
+    index.insert(reader, evals[2], no_params);
+  }
+  return ok;
+}
+
+bool testFilterIndexNaN()
+{
+  using namespace OpenDDS::DCPS;
+
+  Measurement sample;
+  sample.x = std::numeric_limits<double>::quiet_NaN();
+
+  static const char* const filters[] = {
+    "x = 5",
+    "x < 5",
+    "x <= 5",
+    "x > 5",
+    "x >= 5",
+    "x BETWEEN 1 AND 10",
+    "x <> 5",
+  };
+  static const size_t n = sizeof filters / sizeof filters[0];
+
+  DDS::StringSeq no_params;
+  FilterIndex index;
+  OPENDDS_VECTOR(RcHandle<FilterEvaluator>) evals;
+  for (size_t i = 0; i < n; ++i) {
+    evals.push_back(make_rch<FilterEvaluator>(filters[i], false));
+    GUID_t reader = GUID_UNKNOWN;
+    reader.entityId.entityKey[1] = static_cast<CORBA::Octet>(i);
+    index.insert(reader, evals.back(), no_params);
+  }
+
+  // The index has to agree with evaluating each filter on its own.
+  bool ok = true;
+  const Sample_T<Measurement> wrapped(sample);
+  GUIDSeq filter_out;
+  index.filter(wrapped, filter_out);
+  for (size_t i = 0; i < n; ++i) {
+    bool found = false;
+    for (CORBA::ULong k = 0; k < filter_out.length(); ++k) {
+      found = found || filter_out[k].entityId.entityKey[1] == i;
+    }
+    if (found == evals[i]->eval(sample, no_params)) {
+      std::cout << "FilterIndex: " << filters[i] << " with NaN "
+                << (found ? "filtered out" : "kept") << " the reader" << std::endl;
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+bool testOlderWriterType()
+{
+  using namespace OpenDDS::DCPS;
+  static const Encoding enc_xcdr2(Encoding::KIND_XCDR2);
+
+  // A sample of an older version of the type ends before the new member, so
+  // it can't be evaluated until it's deserialized.
+  ShortVersion sample;
+  sample.a = 1;
+  Message_Block_Ptr amb(serialize(enc_xcdr2, sample));
+  LongVersionTypeSupportImpl ts;
+  DDS::StringSeq no_params;
+  FilterEvaluator fe("a = 1 AND b = 0", false);
+  try {
+    const bool result = fe.eval(amb.get(), enc_xcdr2, ts, no_params);
+    std::cout << "Older writer type: evaluated to " << result
+              << " instead of throwing" << std::endl;
+    return false;
+  } catch (const std::runtime_error&) {
+  }
+
+  LongVersion current;
+  current.a = 1;
+  current.b = 0;
+  amb.reset(serialize(enc_xcdr2, current));
+  if (!fe.eval(amb.get(), enc_xcdr2, ts, no_params)) {
+    std::cout << "Current writer type: didn't match" << std::endl;
+    return false;
+  }
+  return true;
+}
+
 // parsing test helpers
 namespace yard_test {
 
@@ -321,6 +502,9 @@ int ACE_TMAIN(int argc, ACE_TCHAR* argv[])
 
   bool ok = testParsing();
   ok &= testEval();
+  ok &= testFilterIndex();
+  ok &= testFilterIndexNaN();
+  ok &= testOlderWriterType();
 
   return ok ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -93,6 +93,30 @@ SubscriberListenerImpl::on_data_on_readers(DDS::Subscriber_ptr subs)
       verify_result_ = false;
     }
 
+    // Asking for the readers again doesn't consume any of the samples.
+    ::DDS::DataReaderSeq_var again = new ::DDS::DataReaderSeq(100);
+    ret = subs->get_datareaders(again.inout(),
+                                ::DDS::NOT_READ_SAMPLE_STATE,
+                                ::DDS::ANY_VIEW_STATE,
+                                ::DDS::ANY_INSTANCE_STATE);
+    if (ret != ::DDS::RETCODE_OK || again->length() != len) {
+      ACE_ERROR((LM_ERROR,
+                  ACE_TEXT("%N:%l: SubscriberListenerImpl::on_data_on_readers()")
+                  ACE_TEXT(" ERROR: second get_datareaders returned %d readers, expecting %d!\n"),
+                  again->length(), len));
+      verify_result_ = false;
+    } else {
+      for (CORBA::ULong i = 0; i < len; ++i) {
+        if (again[i].in() != readers[i].in()) {
+          ACE_ERROR((LM_ERROR,
+                      ACE_TEXT("%N:%l: SubscriberListenerImpl::on_data_on_readers()")
+                      ACE_TEXT(" ERROR: second get_datareaders returned a different reader at %d!\n"),
+                      i));
+          verify_result_ = false;
+        }
+      }
+    }
+
     for (CORBA::ULong i = 0; i < len; ++i) {
       Messenger::MessageDataReader_var message_dr =
         Messenger::MessageDataReader::_narrow(readers[i]);
@@ -0,0 +1,200 @@
+/**
+ * Checks that samples of DataReaders using DCPSLazyDeserialization are
+ * deserialized when they are read or taken, and that samples whose payload
+ * can't be deserialized are dropped instead of being returned.
+ *
+ * The payloads that can't be deserialized come from a writer in a second
+ * participant that registers Truncated under the type name of Sample.
+ */
+#include "LazyDeserializationTypeSupportImpl.h"
+
+#include <tests/Utils/DDSApp.h>
+#include <tests/Utils/StatusMatching.h>
+
+#include <dds/DCPS/Service_Participant.h>
+#include <dds/DCPS/Marked_Default_Qos.h>
+#include <dds/DCPS/DCPS_Utils.h>
+#include <dds/DCPS/SafetyProfileStreams.h>
+#ifdef ACE_AS_STATIC_LIBS
+#  include <dds/DCPS/transport/rtps_udp/RtpsUdp.h>
+#  include <dds/DCPS/RTPS/RtpsDiscovery.h>
+#endif
+
+#include <string>
+
+using OpenDDS::DCPS::DEFAULT_STATUS_MASK;
+using namespace LazyDeserialization;
+
+namespace {
+  const DDS::DomainId_t domain = 144;
+  const char* const topic_name = "LazyDeserialization";
+  const CORBA::Long sample_count = 5;
+
+  std::string expected_text(CORBA::Long id)
+  {
+    return "sample " + OpenDDS::DCPS::to_dds_string(id);
+  }
+
+  void writer_qos(DDS::DataWriterQos& qos)
+  {
+    qos.reliability.kind = DDS::RELIABLE_RELIABILITY_QOS;
+    qos.history.kind = DDS::KEEP_ALL_HISTORY_QOS;
+  }
+
+  void reader_qos(DDS::DataReaderQos& qos)
+  {
+    qos.reliability.kind = DDS::RELIABLE_RELIABILITY_QOS;
+    qos.history.kind = DDS::KEEP_ALL_HISTORY_QOS;
+  }
+
+  /// A writer in its own participant that writes Truncated samples on the
+  /// topic, with Truncated registered under the type name of Sample.
+  TruncatedDataWriter_ptr truncated_writer(TestUtils::DDSApp& app, const char* type_name)
+  {
+    DDS::DomainParticipant_var participant = app.participant();
+    TruncatedTypeSupport_var ts = new TruncatedTypeSupportImpl;
+    if (ts->register_type(participant, type_name) != DDS::RETCODE_OK) {
+      ACE_ERROR((LM_ERROR, "ERROR: register_type failed\n"));
+      return 0;
+    }
+    DDS::Topic_var topic = participant->create_topic(topic_name, type_name,
+      TOPIC_QOS_DEFAULT, 0, DEFAULT_STATUS_MASK);
+    DDS::Publisher_var pub = app.publisher(participant);
+    if (!topic || !pub) {
+      ACE_ERROR((LM_ERROR, "ERROR: failed to create the topic or publisher for Truncated\n"));
+      return 0;
+    }
+    DDS::DataWriterQos qos;
+    pub->get_default_datawriter_qos(qos);
+    writer_qos(qos);
+    DDS::DataWriter_var writer = pub->create_datawriter(topic, qos, 0, DEFAULT_STATUS_MASK);
+    return TruncatedDataWriter::_narrow(writer);
+  }
+
+  bool check_sample(const Sample& sample, const DDS::SampleInfo& info)
+  {
+    if (!info.valid_data) {
+      ACE_ERROR((LM_ERROR, "ERROR: got a sample without valid data\n"));
+      return false;
+    }
+    if (expected_text(sample.id) != sample.text.in()) {
+      ACE_ERROR((LM_ERROR, "ERROR: sample %d has text \"%C\"\n", sample.id, sample.text.in()));
+      return false;
+    }
+    return true;
+  }
+
+  /// Take everything with take(), which goes through RakeResults.
+  bool take_all(DDS::DataReader* reader)
+  {
+    SampleDataReader_var dr = SampleDataReader::_narrow(reader);
+    SampleSeq data;
+    DDS::SampleInfoSeq info;
+    const DDS::ReturnCode_t rc = dr->take(data, info, DDS::LENGTH_UNLIMITED,
+      DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE);
+    if (rc != DDS::RETCODE_OK) {
+      ACE_ERROR((LM_ERROR, "ERROR: take returned %C\n", OpenDDS::DCPS::retcode_to_string(rc)));
+      return false;
+    }
+    bool ok = true;
+    for (CORBA::ULong i = 0; i < data.length(); ++i) {
+      ok = check_sample(data[i], info[i]) && ok;
+    }
+    if (data.length() != static_cast<CORBA::ULong>(sample_count)) {
+      ACE_ERROR((LM_ERROR, "ERROR: take returned %u samples, expected %d\n", data.length(), sample_count));
+      ok = false;
+    }
+    dr->return_loan(data, info);
+    return ok;
+  }
+
+  /// Take everything with take_next_sample().
+  bool take_next_all(DDS::DataReader* reader)
+  {
+    SampleDataReader_var dr = SampleDataReader::_narrow(reader);
+    bool ok = true;
+    CORBA::Long count = 0;
+    Sample sample;
+    DDS::SampleInfo info;
+    while (dr->take_next_sample(sample, info) == DDS::RETCODE_OK) {
+      ok = check_sample(sample, info) && ok;
+      ++count;
+    }
+    if (count != sample_count) {
+      ACE_ERROR((LM_ERROR, "ERROR: take_next_sample returned %d samples, expected %d\n", count, sample_count));
+      ok = false;
+    }
+    return ok;
+  }
+}
+
+int run_test(TestUtils::DDSApp& app)
+{
+  DDS::DomainParticipant_var participant = app.participant();
+  TestUtils::DDSTopicFacade<Sample> topic = app.topic_facade<Sample>(topic_name, participant);
+  DDS::DataReader_var take_reader = topic.reader(DDS::DataReaderListener::_nil(), reader_qos);
+  DDS::DataReader_var take_next_reader = topic.reader(DDS::DataReaderListener::_nil(), reader_qos);
+  SampleDataWriter_var sample_dw = topic.writer(writer_qos);
+
+  SampleTypeSupport_var ts = new SampleTypeSupportImpl;
+  CORBA::String_var type_name = ts->get_type_name();
+  TruncatedDataWriter_var truncated_dw = truncated_writer(app, type_name);
+  if (!take_reader || !take_next_reader || !sample_dw || !truncated_dw) {
+    ACE_ERROR((LM_ERROR, "ERROR: failed to create the readers or writers\n"));
+    return 1;
+  }
+
+  int status = 0;
+  if (Utils::wait_match(take_reader, 2) || Utils::wait_match(take_next_reader, 2)) {
+    status = 1;
+  }
+
+  if (!status) {
+    for (CORBA::Long id = 0; id < sample_count; ++id) {
+      Sample sample;
+      sample.id = id;
+      sample.text = expected_text(id).c_str();
+      Truncated truncated;
+      truncated.id = sample_count + id;
+      if (sample_dw->write(sample, DDS::HANDLE_NIL) != DDS::RETCODE_OK
+          || truncated_dw->write(truncated, DDS::HANDLE_NIL) != DDS::RETCODE_OK) {
+        ACE_ERROR((LM_ERROR, "ERROR: write failed\n"));
+        status = 1;
+      }
+    }
+
+    // Both writers' samples are stored before they are acknowledged.
+    const DDS::Duration_t timeout = {30, 0};
+    if (sample_dw->wait_for_acknowledgments(timeout) != DDS::RETCODE_OK
+        || truncated_dw->wait_for_acknowledgments(timeout) != DDS::RETCODE_OK) {
+      ACE_ERROR((LM_ERROR, "ERROR: wait_for_acknowledgments failed\n"));
+      status = 1;
+    }
+  }
+
+  if (!status && (!take_all(take_reader) || !take_next_all(take_next_reader))) {
+    status = 1;
+  }
+
+  return status;
+}
+
+int ACE_TMAIN(int argc, ACE_TCHAR* argv[])
+{
+  int status = 1;
+  try {
+    TestUtils::DDSApp app(argc, argv, domain);
+    if (!TheServiceParticipant->lazy_deserialization()) {
+      ACE_ERROR((LM_ERROR, "ERROR: DCPSLazyDeserialization is not enabled\n"));
+      return 1;
+    }
+    status = run_test(app);
+  } catch (const std::exception& e) {
+    ACE_ERROR((LM_ERROR, "ERROR: %C\n", e.what()));
+  }
+
+  if (!status) {
+    ACE_DEBUG((LM_INFO, "INFO: test passed\n"));
+  }
+  return status;
+}
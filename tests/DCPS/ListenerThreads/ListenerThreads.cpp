@@ -0,0 +1,287 @@
+/**
+ * Checks DCPSListenerThreads: on_data_available is called on a participant
+ * listener thread, a callback can delete the participant's contained
+ * entities without waiting for its own thread, the participant makes
+ * callbacks again for entities created afterwards, and callbacks for the
+ * same reader never overlap even though there are several listener threads.
+ */
+#include "ListenerThreadsTypeSupportImpl.h"
+
+#include <tests/Utils/DDSApp.h>
+#include <tests/Utils/StatusMatching.h>
+
+#include <dds/DCPS/Service_Participant.h>
+#include <dds/DCPS/Atomic.h>
+#include <dds/DCPS/AtomicBool.h>
+#include <dds/DCPS/LocalObject.h>
+#include <dds/DCPS/DCPS_Utils.h>
+#ifdef ACE_AS_STATIC_LIBS
+#  include <dds/DCPS/transport/rtps_udp/RtpsUdp.h>
+#  include <dds/DCPS/RTPS/RtpsDiscovery.h>
+#endif
+
+using namespace ListenerThreads;
+
+namespace {
+  const DDS::DomainId_t domain = 147;
+  const char* const topic_name = "ListenerThreads";
+
+  class Listener : public virtual OpenDDS::DCPS::LocalObject<DDS::DataReaderListener> {
+  public:
+    Listener(DDS::DomainParticipant_ptr participant, bool delete_entities)
+      : participant_(DDS::DomainParticipant::_duplicate(participant))
+      , delete_entities_(delete_entities)
+      , delete_result_(DDS::RETCODE_ERROR)
+      , on_main_thread_(false)
+      , done_(false)
+      , main_thread_(ACE_Thread::self())
+    {}
+
+    void on_data_available(DDS::DataReader_ptr reader)
+    {
+      if (done_) {
+        return;
+      }
+      on_main_thread_ = ACE_OS::thr_equal(ACE_Thread::self(), main_thread_);
+
+      SampleDataReader_var dr = SampleDataReader::_narrow(reader);
+      SampleSeq data;
+      DDS::SampleInfoSeq info;
+      if (dr->take(data, info, DDS::LENGTH_UNLIMITED,
+            DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE) == DDS::RETCODE_OK) {
+        dr->return_loan(data, info);
+      }
+      dr = 0;
+
+      if (delete_entities_) {
+        // Stops the listener threads, including this one.
+        delete_result_ = participant_->delete_contained_entities();
+      }
+      done_ = true;
+    }
+
+    void on_requested_deadline_missed(DDS::DataReader_ptr, const DDS::RequestedDeadlineMissedStatus&) {}
+    void on_requested_incompatible_qos(DDS::DataReader_ptr, const DDS::RequestedIncompatibleQosStatus&) {}
+    void on_sample_rejected(DDS::DataReader_ptr, const DDS::SampleRejectedStatus&) {}
+    void on_liveliness_changed(DDS::DataReader_ptr, const DDS::LivelinessChangedStatus&) {}
+    void on_subscription_matched(DDS::DataReader_ptr, const DDS::SubscriptionMatchedStatus&) {}
+    void on_sample_lost(DDS::DataReader_ptr, const DDS::SampleLostStatus&) {}
+
+    bool wait(const char* name)
+    {
+      for (int i = 0; i < 300 && !done_; ++i) {
+        ACE_OS::sleep(ACE_Time_Value(0, 100000));
+      }
+      if (!done_) {
+        ACE_ERROR((LM_ERROR, "ERROR: %C: on_data_available wasn't called\n", name));
+        return false;
+      }
+      if (on_main_thread_) {
+        ACE_ERROR((LM_ERROR, "ERROR: %C: on_data_available was called on the main thread\n", name));
+        return false;
+      }
+      if (delete_entities_ && delete_result_ != DDS::RETCODE_OK) {
+        ACE_ERROR((LM_ERROR, "ERROR: %C: delete_contained_entities from the listener returned %C\n",
+                   name, OpenDDS::DCPS::retcode_to_string(delete_result_)));
+        return false;
+      }
+      return true;
+    }
+
+  private:
+    const DDS::DomainParticipant_var participant_;
+    const bool delete_entities_;
+    DDS::ReturnCode_t delete_result_;
+    OpenDDS::DCPS::AtomicBool on_main_thread_;
+    OpenDDS::DCPS::AtomicBool done_;
+    const ACE_thread_t main_thread_;
+  };
+
+  /// Takes its time in on_data_available so that data arrives while it
+  /// runs, and checks that it's never called while it's already running.
+  class SlowListener : public virtual OpenDDS::DCPS::LocalObject<DDS::DataReaderListener> {
+  public:
+    SlowListener()
+      : running_(0)
+      , received_(0)
+      , overlapped_(false)
+    {}
+
+    void on_data_available(DDS::DataReader_ptr reader)
+    {
+      if (++running_ > 1) {
+        overlapped_ = true;
+      }
+      ACE_OS::sleep(ACE_Time_Value(0, 50000));
+
+      SampleDataReader_var dr = SampleDataReader::_narrow(reader);
+      SampleSeq data;
+      DDS::SampleInfoSeq info;
+      if (dr->take(data, info, DDS::LENGTH_UNLIMITED,
+            DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE) == DDS::RETCODE_OK) {
+        for (CORBA::ULong i = 0; i < info.length(); ++i) {
+          if (info[i].valid_data) {
+            ++received_;
+          }
+        }
+        dr->return_loan(data, info);
+      }
+      --running_;
+    }
+
+    void on_requested_deadline_missed(DDS::DataReader_ptr, const DDS::RequestedDeadlineMissedStatus&) {}
+    void on_requested_incompatible_qos(DDS::DataReader_ptr, const DDS::RequestedIncompatibleQosStatus&) {}
+    void on_sample_rejected(DDS::DataReader_ptr, const DDS::SampleRejectedStatus&) {}
+    void on_liveliness_changed(DDS::DataReader_ptr, const DDS::LivelinessChangedStatus&) {}
+    void on_subscription_matched(DDS::DataReader_ptr, const DDS::SubscriptionMatchedStatus&) {}
+    void on_sample_lost(DDS::DataReader_ptr, const DDS::SampleLostStatus&) {}
+
+    bool wait(int count)
+    {
+      for (int i = 0; i < 300 && received_ < count; ++i) {
+        ACE_OS::sleep(ACE_Time_Value(0, 100000));
+      }
+      if (received_ < count) {
+        ACE_ERROR((LM_ERROR, "ERROR: slow: received %d of %d samples\n", int(received_), count));
+        return false;
+      }
+      if (overlapped_) {
+        ACE_ERROR((LM_ERROR, "ERROR: slow: on_data_available calls overlapped\n"));
+        return false;
+      }
+      return true;
+    }
+
+  private:
+    OpenDDS::DCPS::Atomic<int> running_;
+    OpenDDS::DCPS::Atomic<int> received_;
+    OpenDDS::DCPS::AtomicBool overlapped_;
+  };
+
+  void writer_qos(DDS::DataWriterQos& qos)
+  {
+    qos.reliability.kind = DDS::RELIABLE_RELIABILITY_QOS;
+  }
+
+  void reader_qos(DDS::DataReaderQos& qos)
+  {
+    qos.reliability.kind = DDS::RELIABLE_RELIABILITY_QOS;
+  }
+
+  void keep_all_reader_qos(DDS::DataReaderQos& qos)
+  {
+    qos.reliability.kind = DDS::RELIABLE_RELIABILITY_QOS;
+    qos.history.kind = DDS::KEEP_ALL_HISTORY_QOS;
+  }
+
+  /// Create a reader with listener in participant, then write a sample for
+  /// it and wait for the callback.
+  bool run_reader(TestUtils::DDSApp& app, const DDS::DomainParticipant_var& participant,
+                  const DDS::DataReaderListener_var& listener, const DDS::DataWriter_var& writer,
+                  unsigned match_count, const char* name)
+  {
+    TestUtils::DDSTopicFacade<Sample> topic = app.topic_facade<Sample>(topic_name, participant);
+    DDS::DataReader_var reader = topic.reader(listener, reader_qos, DDS::Subscriber_var(), DDS::DATA_AVAILABLE_STATUS);
+    if (!reader) {
+      ACE_ERROR((LM_ERROR, "ERROR: %C: failed to create the reader\n", name));
+      return false;
+    }
+    if (Utils::wait_match(writer, match_count)) {
+      return false;
+    }
+
+    SampleDataWriter_var sample_dw = SampleDataWriter::_narrow(writer);
+    Sample sample;
+    sample.seq = 0;
+    if (sample_dw->write(sample, DDS::HANDLE_NIL) != DDS::RETCODE_OK) {
+      ACE_ERROR((LM_ERROR, "ERROR: %C: write failed\n", name));
+      return false;
+    }
+    return dynamic_cast<Listener*>(listener.in())->wait(name);
+  }
+
+  /// Write samples faster than a slow listener takes them.
+  bool run_slow_reader(TestUtils::DDSApp& app, const DDS::DomainParticipant_var& participant,
+                       const DDS::DataWriter_var& writer, unsigned match_count)
+  {
+    TestUtils::DDSTopicFacade<Sample> topic = app.topic_facade<Sample>(topic_name, participant);
+    DDS::DataReaderListener_var listener = new SlowListener;
+    DDS::DataReader_var reader =
+      topic.reader(listener, keep_all_reader_qos, DDS::Subscriber_var(), DDS::DATA_AVAILABLE_STATUS);
+    if (!reader) {
+      ACE_ERROR((LM_ERROR, "ERROR: slow: failed to create the reader\n"));
+      return false;
+    }
+    if (Utils::wait_match(writer, match_count)) {
+      return false;
+    }
+
+    const int count = 20;
+    SampleDataWriter_var sample_dw = SampleDataWriter::_narrow(writer);
+    for (int i = 0; i < count; ++i) {
+      Sample sample;
+      sample.seq = i;
+      if (sample_dw->write(sample, DDS::HANDLE_NIL) != DDS::RETCODE_OK) {
+        ACE_ERROR((LM_ERROR, "ERROR: slow: write failed\n"));
+        return false;
+      }
+      ACE_OS::sleep(ACE_Time_Value(0, 10000));
+    }
+    return dynamic_cast<SlowListener*>(listener.in())->wait(count);
+  }
+}
+
+int run_test(TestUtils::DDSApp& app)
+{
+  DDS::DomainParticipant_var sub_participant = app.participant();
+  DDS::DomainParticipant_var pub_participant = app.participant();
+  TestUtils::DDSTopicFacade<Sample> topic = app.topic_facade<Sample>(topic_name, pub_participant);
+  DDS::DataWriter_var writer = TestUtils::DDSApp::datawriter(topic.writer(writer_qos));
+  if (!writer) {
+    ACE_ERROR((LM_ERROR, "ERROR: failed to create the writer\n"));
+    return 1;
+  }
+
+  // The callback deletes the reader it was called for along with the rest
+  // of the participant's entities.
+  DDS::DataReaderListener_var deleting_listener = new Listener(sub_participant, true);
+  if (!run_reader(app, sub_participant, deleting_listener, writer, 1, "deleting")) {
+    return 1;
+  }
+
+  // New entities of the participant get callbacks from new listener
+  // threads.  The writer has to see the deleted reader go first, so that
+  // the new one is the reader it matches.
+  DDS::DataReaderListener_var listener = new Listener(sub_participant, false);
+  if (Utils::wait_match(writer, 0)
+      || !run_reader(app, sub_participant, listener, writer, 1, "recreated")) {
+    return 1;
+  }
+
+  // Data that arrives while on_data_available runs on one listener thread
+  // doesn't start another call on the other.
+  if (!run_slow_reader(app, sub_participant, writer, 2)) {
+    return 1;
+  }
+  return 0;
+}
+
+int ACE_TMAIN(int argc, ACE_TCHAR* argv[])
+{
+  int status = 1;
+  try {
+    TestUtils::DDSApp app(argc, argv, domain);
+    if (!TheServiceParticipant->listener_threads()) {
+      ACE_ERROR((LM_ERROR, "ERROR: DCPSListenerThreads is not set\n"));
+      return 1;
+    }
+    status = run_test(app);
+  } catch (const std::exception& e) {
+    ACE_ERROR((LM_ERROR, "ERROR: %C\n", e.what()));
+  }
+
+  if (!status) {
+    ACE_DEBUG((LM_INFO, "INFO: test passed\n"));
+  }
+  return status;
+}
@@ -235,11 +235,143 @@ bool run_test()
   return success;
 }
 
+template<typename Type>
+bool serialize(const Type& sample, const Encoding& encoding, Message_Block_Ptr& data)
+{
+  data.reset(new ACE_Message_Block(serialized_size(encoding, sample)));
+  Serializer ser(data.get(), encoding);
+  if (!(ser << sample)) {
+    std::cout << "ERROR: Failed to serialize " << DDSTraits<Type>::type_name() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/// Read fields from data, which has a sample of some version of Type, with
+/// MetaStruct::getValues.
+template<typename Type>
+bool get_values(ACE_Message_Block* data, const Encoding& encoding, FieldValues& values)
+{
+  Message_Block_Ptr mb(data->duplicate());
+  Serializer ser(mb.get(), encoding);
+  if (!getMetaStruct<Type>().getValues(ser, values)) {
+    std::cout << "ERROR: getValues failed for " << DDSTraits<Type>::type_name() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool check_value(const FieldValues& values, size_t index, int expected, const char* name)
+{
+  const Value* const value = values.get(index);
+  if (!value) {
+    std::cout << "ERROR: getValues didn't read " << name << std::endl;
+    return false;
+  }
+  if (value->type_ != Value::VAL_INT || value->i_ != expected) {
+    std::cout << "ERROR: getValues read " << name << " as " << value->i_
+              << " expected " << expected << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool check_value(const FieldValues& values, size_t index, const char* expected, const char* name)
+{
+  const Value* const value = values.get(index);
+  if (!value || value->type_ != Value::VAL_STRING || std::strcmp(value->s_, expected)) {
+    std::cout << "ERROR: getValues didn't read " << name << " as " << expected << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool check_missing(const FieldValues& values, size_t index, const char* name)
+{
+  if (values.get(index)) {
+    std::cout << "ERROR: getValues read " << name
+              << " which isn't in the type that was written" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/// Appendable structs in XCDR2 end where their DHEADER says, so a reader
+/// can get the values of fields written with a newer or older version of
+/// its type.
+bool run_evolution_test()
+{
+  std::cout << "run_evolution_test" << std::endl;
+  const Encoding encoding(Encoding::KIND_XCDR2);
+
+  EvolvedV2 v2;
+  v2.n.x = 1;
+  v2.n.extra = "extra";
+  v2.n.more = 2;
+  v2.after = 3;
+  v2.tail = "tail";
+  Message_Block_Ptr v2_data;
+  if (!serialize(v2, encoding, v2_data)) {
+    return false;
+  }
+
+  EvolvedV1 v1;
+  v1.n.x = 4;
+  v1.after = 5;
+  Message_Block_Ptr v1_data;
+  if (!serialize(v1, encoding, v1_data)) {
+    return false;
+  }
+
+  bool success = true;
+
+  // The same version, the nested struct isn't read to its end.
+  {
+    OPENDDS_VECTOR(OPENDDS_STRING) fields;
+    fields.push_back("n.x");
+    fields.push_back("tail");
+    FieldValues values(fields);
+    success &= get_values<EvolvedV2>(v2_data.get(), encoding, values)
+      && check_value(values, 0, 1, "n.x")
+      && check_value(values, 1, "tail", "tail");
+  }
+
+  // Written with a newer version, the extra members of the nested struct
+  // are skipped.
+  {
+    OPENDDS_VECTOR(OPENDDS_STRING) fields;
+    fields.push_back("n.x");
+    fields.push_back("after");
+    FieldValues values(fields);
+    success &= get_values<EvolvedV1>(v2_data.get(), encoding, values)
+      && check_value(values, 0, 1, "n.x")
+      && check_value(values, 1, 3, "after");
+  }
+
+  // Written with an older version, the members it doesn't have aren't read.
+  {
+    OPENDDS_VECTOR(OPENDDS_STRING) fields;
+    fields.push_back("n.more");
+    fields.push_back("after");
+    fields.push_back("tail");
+    fields.push_back("n.x");
+    FieldValues values(fields);
+    success &= get_values<EvolvedV2>(v1_data.get(), encoding, values)
+      && check_missing(values, 0, "n.more")
+      && check_value(values, 1, 5, "after")
+      && check_missing(values, 2, "tail")
+      && check_value(values, 3, 4, "n.x");
+  }
+
+  return success;
+}
+
 int ACE_TMAIN(int /*argc*/, ACE_TCHAR* /*argv*/[])
 {
   bool success = true;
   success &= run_test<FinalStruct>();
   success &= run_test<AppenableStruct>();
   success &= run_test<MutableStruct>();
+  success &= run_evolution_test();
   return success ? 0 : 1;
 }
@@ -142,9 +142,11 @@ public:
                              bool&,
                              bool&,
                              OpenDDS::DCPS::MarshalingType) {}
+#ifndef OPENDDS_NO_QUERY_CONDITION
   bool contains_sample_filtered(DDS::SampleStateMask, DDS::ViewStateMask,
-    DDS::InstanceStateMask, const OpenDDS::DCPS::FilterEvaluator&,
-    const DDS::StringSeq&) { return true; }
+    DDS::InstanceStateMask, const OpenDDS::DCPS::QueryConditionImpl&) { return true; }
+  void clear_query_results(ACE_UINT32) {}
+#endif
   virtual void lookup_instance(const OpenDDS::DCPS::ReceivedDataSample&,
                                OpenDDS::DCPS::SubscriptionInstance_rch&) {}
 
@@ -18,6 +18,8 @@
 
 #include <stdexcept>
 #include <string>
+#include <set>
+#include <sstream>
 #include <ostream>
 
 using namespace DDS;
@@ -103,6 +105,34 @@ private:
   UnrelatedInfo value_;
 };
 
+class GateInfoWrapper {
+public:
+  TAO::String_Manager& gate() { return value_.gate; }
+  CORBA::ULong& flight_id() { return value_.flight_id; }
+  CORBA::ULong& departure_date() { return value_.departure_date; }
+
+  operator GateInfo() const { return value_; }
+
+private:
+  GateInfo value_;
+};
+
+class GateResultingWrapper {
+public:
+  explicit GateResultingWrapper(const GateResulting& value)
+  : value_(value)
+  {
+  }
+
+  CORBA::ULong& flight_id() { return value_.flight_id; }
+  CORBA::ULong& departure_date() { return value_.departure_date; }
+  TAO::String_Manager& gate() { return value_.gate; }
+  CORBA::Long& x() { return value_.x; }
+
+private:
+  GateResulting value_;
+};
+
 class ResultingWrapper {
 public:
   explicit ResultingWrapper(const Resulting& value)
@@ -146,6 +176,8 @@ using LocationInfoWrapper = LocationInfo;
 using PlanInfoWrapper = PlanInfo;
 using MoreInfoWrapper = MoreInfo;
 using UnrelatedInfoWrapper = UnrelatedInfo;
+using GateInfoWrapper = GateInfo;
+using GateResultingWrapper = GateResulting;
 using ResultingWrapper = Resulting;
 
 #  define ENUM_WRAPPER(TYPE, MEMBER) TYPE::MEMBER
@@ -638,6 +670,180 @@ bool run_multitopic_test(const Publisher_var& pub, const Subscriber_var& sub)
   return !(info[0].valid_data || info[0].instance_state != NOT_ALIVE_DISPOSED_INSTANCE_STATE);
 }
 
+typedef std::set<std::string> JoinResults;
+
+template <typename Gate>
+std::string join_result(CORBA::ULong flight_id, const Gate& gate, CORBA::Long x)
+{
+  std::ostringstream os;
+  os << flight_id << '/' << gate << '/' << x;
+  return os.str();
+}
+
+void print_join_results(std::ostream& os, const JoinResults& results)
+{
+  for (JoinResults::const_iterator it = results.begin(); it != results.end(); ++it) {
+    if (it != results.begin()) {
+      os << ", ";
+    }
+    os << *it;
+  }
+}
+
+// Take resulting samples until there are as many as expected and check that
+// they are the expected ones.
+bool expect_join_results(const DataReader_var& dr, const char* step, const JoinResults& expected)
+{
+  GateResultingDataReader_var res_dr = GateResultingDataReader::_narrow(dr);
+  ReadCondition_var rc = dr->create_readcondition(NOT_READ_SAMPLE_STATE,
+    ANY_VIEW_STATE, ALIVE_INSTANCE_STATE);
+  WaitSet_var ws = new WaitSet;
+  ws->attach_condition(rc);
+  JoinResults received;
+  while (received.size() < expected.size()) {
+    ConditionSeq active;
+    if (ws->wait(active, max_wait) != RETCODE_OK) {
+      break;
+    }
+    GateResultingSeq data;
+    SampleInfoSeq info;
+    if (res_dr->take_w_condition(data, info, LENGTH_UNLIMITED, rc) != RETCODE_OK) {
+      continue;
+    }
+    for (unsigned i = 0; i < data.length(); ++i) {
+      if (info[i].valid_data) {
+        GateResultingWrapper rw(data[i]);
+        received.insert(join_result(rw.flight_id(), rw.gate(), rw.x()));
+      }
+    }
+  }
+  ws->detach_condition(rc);
+  dr->delete_readcondition(rc);
+
+  if (received != expected) {
+    std::cerr << "ERROR: " << step << ": expected {";
+    print_join_results(std::cerr, expected);
+    std::cerr << "}, but got {";
+    print_join_results(std::cerr, received);
+    std::cerr << '}' << std::endl;
+    return false;
+  }
+  return true;
+}
+
+void wait_for_dispose(const DataReader_var& dr)
+{
+  ReadCondition_var rc = dr->create_readcondition(ANY_SAMPLE_STATE,
+    ANY_VIEW_STATE, NOT_ALIVE_DISPOSED_INSTANCE_STATE);
+  WaitSet_var ws = new WaitSet;
+  ws->attach_condition(rc);
+  ConditionSeq active;
+  const ReturnCode_t ret = ws->wait(active, max_wait);
+  ws->detach_condition(rc);
+  dr->delete_readcondition(rc);
+  check_rc(ret, "wait for dispose of joined instance");
+}
+
+GateInfoWrapper make_gate(const char* gate, CORBA::ULong flight_id)
+{
+  GateInfoWrapper gi;
+  gi.gate() = gate;
+  gi.flight_id() = flight_id;
+  gi.departure_date() = 10;
+  return gi;
+}
+
+void write_gate(const GateInfoDataWriter_var& dw, const char* gate, CORBA::ULong flight_id)
+{
+  check_rc(dw->write(make_gate(gate, flight_id), HANDLE_NIL), "write gate", gate);
+}
+
+void write_location(const LocationInfoDataWriter_var& dw, CORBA::ULong flight_id, CORBA::Long x)
+{
+  LocationInfoWrapper li;
+  li.flight_id() = flight_id;
+  li.departure_date() = 10;
+  li.x() = x;
+  li.y() = 0;
+  li.z() = 0;
+  check_rc(dw->write(li, HANDLE_NIL), "write location");
+}
+
+// Gate is joined on fields that aren't all of its keys, so joins that start
+// from a JoinLocation sample look its instances up by those fields.  Moving a
+// gate to another flight and disposing it have to be seen by the next join.
+bool run_join_index_test(const Publisher_var& pub, const Subscriber_var& sub)
+{
+  DomainParticipant_var sub_dp = sub->get_participant();
+
+  Writer<LocationInfo> location(pub, "JoinLocation", sub_dp);
+  Writer<GateInfo> gates(pub, "Gate", sub_dp);
+  LocationInfoDataWriter_var locdw = LocationInfoDataWriter::_narrow(location.dw_);
+  GateInfoDataWriter_var gdw = GateInfoDataWriter::_narrow(gates.dw_);
+
+  GateResultingTypeSupport_var ts_res = new GateResultingTypeSupportImpl;
+  check_rc(ts_res->register_type(sub_dp, ""), "register gate resulting type");
+  CORBA::String_var type_name = ts_res->get_type_name();
+  MultiTopic_var mt = sub_dp->create_multitopic("GateMultiTopic", type_name,
+    "SELECT * FROM JoinLocation NATURAL JOIN Gate", StringSeq());
+  if (!mt) {
+    throw std::runtime_error("failed to create gate multitopic");
+  }
+  DataReader_var dr = sub->create_datareader(mt, DATAREADER_QOS_DEFAULT, 0, DEFAULT_STATUS_MASK);
+  waitForMatch(location.dw_);
+  waitForMatch(gates.dw_);
+
+  bool ok = true;
+
+  // The first join from each JoinLocation sample builds the index.
+  write_gate(gdw, "A", 1);
+  write_gate(gdw, "B", 1);
+  write_gate(gdw, "C", 2);
+  check_rc(gates.dw_->wait_for_acknowledgments(max_wait), "wait for gate acknowledgments");
+  write_location(locdw, 1, 1);
+  write_location(locdw, 2, 2);
+  JoinResults expected;
+  expected.insert(join_result(1, "A", 1));
+  expected.insert(join_result(1, "B", 1));
+  expected.insert(join_result(2, "C", 2));
+  ok &= expect_join_results(dr, "initial join", expected);
+
+  // Gate A moves to flight 2, which is joined from the Gate sample.
+  write_gate(gdw, "A", 2);
+  expected.clear();
+  expected.insert(join_result(2, "A", 2));
+  ok &= expect_join_results(dr, "gate update", expected);
+
+  // Joins from JoinLocation find A under its new flight only.
+  write_location(locdw, 1, 11);
+  write_location(locdw, 2, 12);
+  expected.clear();
+  expected.insert(join_result(1, "B", 11));
+  expected.insert(join_result(2, "A", 12));
+  expected.insert(join_result(2, "C", 12));
+  ok &= expect_join_results(dr, "join after gate update", expected);
+
+  // Gate B is removed and comes back for flight 2.
+  check_rc(gdw->dispose(make_gate("B", 1), HANDLE_NIL), "dispose gate B");
+  wait_for_dispose(dr);
+  write_gate(gdw, "B", 2);
+  expected.clear();
+  expected.insert(join_result(2, "B", 12));
+  ok &= expect_join_results(dr, "gate recreated", expected);
+
+  write_location(locdw, 1, 21);
+  write_location(locdw, 2, 22);
+  expected.clear();
+  expected.insert(join_result(2, "A", 22));
+  expected.insert(join_result(2, "B", 22));
+  expected.insert(join_result(2, "C", 22));
+  ok &= expect_join_results(dr, "join after gate removal", expected);
+
+  sub->delete_datareader(dr);
+  sub_dp->delete_multitopic(mt);
+  return ok;
+}
+
 int run_test(int argc, ACE_TCHAR* argv[])
 {
   DomainParticipantFactory_var dpf = TheParticipantFactoryWithArgs(argc, argv);
@@ -661,7 +867,8 @@ int run_test(int argc, ACE_TCHAR* argv[])
     treg.bind_config("t2", sub);
   }
 
-  const bool passed = run_multitopic_test(pub, sub);
+  bool passed = run_multitopic_test(pub, sub);
+  passed &= run_join_index_test(pub, sub);
 
   dp->delete_contained_entities();
   dpf->delete_participant(dp);
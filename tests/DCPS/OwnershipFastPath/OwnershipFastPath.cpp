@@ -0,0 +1,268 @@
+/**
+ * Checks EXCLUSIVE ownership once the owner of an instance is known: the
+ * owner's samples are kept and a weaker writer's are dropped, a writer that
+ * becomes stronger than the owner takes over, and the owner loses the
+ * instance once its strength drops below the other writer's.
+ */
+#include "OwnershipFastPathTypeSupportImpl.h"
+
+#include <tests/Utils/DDSApp.h>
+#include <tests/Utils/StatusMatching.h>
+
+#include <dds/DCPS/Service_Participant.h>
+#ifdef ACE_AS_STATIC_LIBS
+#  include <dds/DCPS/transport/rtps_udp/RtpsUdp.h>
+#  include <dds/DCPS/RTPS/RtpsDiscovery.h>
+#endif
+
+#include <ace/OS_NS_unistd.h>
+
+#include <vector>
+
+using namespace OwnershipFastPath;
+
+namespace {
+  const DDS::DomainId_t domain = 143;
+  const char* const topic_name = "OwnershipFastPath";
+  const CORBA::Long sample_count = 100;
+  const CORBA::Long initial_strength[2] = { 10, 5 };
+  const DDS::Duration_t timeout = {30, 0};
+
+  struct Received {
+    CORBA::Long writer;
+    CORBA::Long seq;
+  };
+
+  void reader_qos(DDS::DataReaderQos& qos)
+  {
+    qos.reliability.kind = DDS::RELIABLE_RELIABILITY_QOS;
+    qos.history.kind = DDS::KEEP_ALL_HISTORY_QOS;
+    qos.ownership.kind = DDS::EXCLUSIVE_OWNERSHIP_QOS;
+  }
+
+  struct WriterQos {
+    explicit WriterQos(CORBA::Long strength)
+      : strength_(strength)
+    {}
+
+    void operator()(DDS::DataWriterQos& qos) const
+    {
+      qos.reliability.kind = DDS::RELIABLE_RELIABILITY_QOS;
+      qos.history.kind = DDS::KEEP_ALL_HISTORY_QOS;
+      qos.ownership.kind = DDS::EXCLUSIVE_OWNERSHIP_QOS;
+      qos.ownership_strength.value = strength_;
+    }
+
+    const CORBA::Long strength_;
+  };
+
+  class Test {
+  public:
+    Test()
+      : seq_(0)
+    {}
+
+    bool init(TestUtils::DDSApp& app)
+    {
+      DDS::DomainParticipant_var sub_participant = app.participant();
+      DDS::DomainParticipant_var pub_participant = app.participant();
+      TestUtils::DDSTopicFacade<Sample> sub_topic = app.topic_facade<Sample>(topic_name, sub_participant);
+      TestUtils::DDSTopicFacade<Sample> pub_topic = app.topic_facade<Sample>(topic_name, pub_participant);
+
+      DDS::DataReader_var reader = sub_topic.reader(DDS::DataReaderListener::_nil(), reader_qos);
+      reader_ = SampleDataReader::_narrow(reader);
+      if (!reader_) {
+        ACE_ERROR((LM_ERROR, "ERROR: failed to create the reader\n"));
+        return false;
+      }
+
+      for (int i = 0; i < 2; ++i) {
+        writers_[i] = pub_topic.writer(WriterQos(initial_strength[i]));
+        if (!writers_[i] || Utils::wait_match(TestUtils::DDSApp::datawriter(writers_[i]), 1)) {
+          ACE_ERROR((LM_ERROR, "ERROR: failed to create and match writer %d\n", i));
+          return false;
+        }
+      }
+      return true;
+    }
+
+    /// The stronger writer's samples are kept from its first sample on,
+    /// the weaker writer's are all dropped.
+    bool owner_keeps_instance()
+    {
+      const size_t from = received_.size();
+      if (!write(0) || !wait_for_writer(0, from)) {
+        return false;
+      }
+      for (CORBA::Long i = 0; i < sample_count; ++i) {
+        if (!write(0) || !write(1)) {
+          return false;
+        }
+      }
+      if (!wait_for_acknowledgments()) {
+        return false;
+      }
+      take();
+      return check("owner", from, 0, 1, sample_count + 1);
+    }
+
+    /// Once the reader has seen the new strength of writer, owner keeps
+    /// the instance: from the first of its samples that the reader keeps,
+    /// the samples of the other writer are dropped.
+    bool change_strength(const char* name, int writer, CORBA::Long strength, int owner)
+    {
+      DDS::DataWriterQos qos;
+      writers_[writer]->get_qos(qos);
+      qos.ownership_strength.value = strength;
+      if (writers_[writer]->set_qos(qos) != DDS::RETCODE_OK) {
+        ACE_ERROR((LM_ERROR, "ERROR: %C: set_qos failed\n", name));
+        return false;
+      }
+
+      // The previous owner keeps the instance until the reader knows about
+      // the change and gets a sample from the writer that changed, so keep
+      // writing with both until the new owner shows up.
+      const int other = 1 - owner;
+      const size_t from = received_.size();
+      size_t takeover = from;
+      for (int i = 0; i < timeout.sec * 10 && takeover == received_.size(); ++i) {
+        if (!write(other) || !write(owner)) {
+          return false;
+        }
+        ACE_OS::sleep(ACE_Time_Value(0, 100000));
+        take();
+        takeover = first_from(owner, from);
+      }
+      if (takeover == received_.size()) {
+        ACE_ERROR((LM_ERROR, "ERROR: %C: writer %d never took over\n", name, owner));
+        return false;
+      }
+
+      for (CORBA::Long i = 0; i < sample_count; ++i) {
+        if (!write(other) || !write(owner)) {
+          return false;
+        }
+      }
+      if (!wait_for_acknowledgments()) {
+        return false;
+      }
+      take();
+      return check(name, takeover, owner, other, sample_count + 1);
+    }
+
+  private:
+    bool write(int writer)
+    {
+      Sample sample;
+      sample.id = 0;
+      sample.writer = writer;
+      sample.seq = seq_++;
+      if (writers_[writer]->write(sample, DDS::HANDLE_NIL) != DDS::RETCODE_OK) {
+        ACE_ERROR((LM_ERROR, "ERROR: write from writer %d failed\n", writer));
+        return false;
+      }
+      return true;
+    }
+
+    bool wait_for_acknowledgments()
+    {
+      for (int i = 0; i < 2; ++i) {
+        if (writers_[i]->wait_for_acknowledgments(timeout) != DDS::RETCODE_OK) {
+          ACE_ERROR((LM_ERROR, "ERROR: wait_for_acknowledgments for writer %d failed\n", i));
+          return false;
+        }
+      }
+      return true;
+    }
+
+    void take()
+    {
+      SampleSeq data;
+      DDS::SampleInfoSeq info;
+      if (reader_->take(data, info, DDS::LENGTH_UNLIMITED,
+            DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE) != DDS::RETCODE_OK) {
+        return;
+      }
+      for (CORBA::ULong i = 0; i < data.length(); ++i) {
+        if (info[i].valid_data) {
+          const Received received = { data[i].writer, data[i].seq };
+          received_.push_back(received);
+        }
+      }
+      reader_->return_loan(data, info);
+    }
+
+    size_t first_from(int writer, size_t from) const
+    {
+      for (size_t i = from; i < received_.size(); ++i) {
+        if (received_[i].writer == writer) {
+          return i;
+        }
+      }
+      return received_.size();
+    }
+
+    bool wait_for_writer(int writer, size_t from)
+    {
+      for (int i = 0; i < timeout.sec * 10; ++i) {
+        take();
+        if (first_from(writer, from) < received_.size()) {
+          return true;
+        }
+        ACE_OS::sleep(ACE_Time_Value(0, 100000));
+      }
+      ACE_ERROR((LM_ERROR, "ERROR: no sample from writer %d\n", writer));
+      return false;
+    }
+
+    /// From received_[from] on, all of the samples are from owner and at
+    /// least count of them were kept.
+    bool check(const char* name, size_t from, int owner, int other, CORBA::Long count) const
+    {
+      bool ok = true;
+      CORBA::Long kept = 0;
+      for (size_t i = from; i < received_.size(); ++i) {
+        if (received_[i].writer == other) {
+          ACE_ERROR((LM_ERROR, "ERROR: %C: kept sample %d of writer %d\n", name, received_[i].seq, other));
+          ok = false;
+        } else if (received_[i].writer == owner) {
+          ++kept;
+        }
+      }
+      if (kept < count) {
+        ACE_ERROR((LM_ERROR, "ERROR: %C: kept %d samples of writer %d, expected %d\n", name, kept, owner, count));
+        ok = false;
+      }
+      return ok;
+    }
+
+    SampleDataWriter_var writers_[2];
+    SampleDataReader_var reader_;
+    std::vector<Received> received_;
+    CORBA::Long seq_;
+  };
+}
+
+int ACE_TMAIN(int argc, ACE_TCHAR* argv[])
+{
+  int status = 1;
+  try {
+    TestUtils::DDSApp app(argc, argv, domain);
+    Test test;
+    if (test.init(app)
+        && test.owner_keeps_instance()
+        // The weaker writer becomes stronger than the owner.
+        && test.change_strength("stronger", 1, 20, 1)
+        // The new owner becomes weaker than the writer it took over from.
+        && test.change_strength("weaker", 1, 1, 0)) {
+      status = 0;
+    }
+  } catch (const std::exception& e) {
+    ACE_ERROR((LM_ERROR, "ERROR: %C\n", e.what()));
+  }
+
+  if (!status) {
+    ACE_DEBUG((LM_INFO, "INFO: test passed\n"));
+  }
+  return status;
+}
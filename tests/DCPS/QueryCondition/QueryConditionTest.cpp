@@ -19,9 +19,12 @@
 #endif
 
 #include <ace/Argv_Type_Converter.h>
+#include <ace/OS_NS_unistd.h>
 
 #include <cstdlib>
 #include <iostream>
+#include <set>
+#include <string>
 using namespace std;
 using namespace DDS;
 using namespace OpenDDS::DCPS;
@@ -76,6 +79,20 @@ struct Readers {
     return msg_reader_->read_w_condition(data, infoseq, LENGTH_UNLIMITED, cond);
   }
 
+  DDS::ReturnCode_t read(MessageSeq& data, DDS::SampleInfoSeq& info, DDS::ReadCondition* cond)
+  {
+    if (dynamic) {
+      DynamicDataSeq dyn_data;
+      const DDS::ReturnCode_t ret = dyn_reader_->read_w_condition(dyn_data, info, LENGTH_UNLIMITED, cond);
+      if (ret == RETCODE_OK) {
+        copy(data, dyn_data, info);
+      }
+      return ret;
+    }
+
+    return msg_reader_->read_w_condition(data, info, LENGTH_UNLIMITED, cond);
+  }
+
   DDS::ReturnCode_t take(MessageSeq& data, DDS::SampleInfoSeq& info, DDS::ReadCondition* cond)
   {
     if (dynamic) {
@@ -935,6 +952,192 @@ bool run_single_dispose_filter_test(const MessageTypeSupport_var& ts, const Publ
   return true;
 }
 
+/// The keys of the samples that read_w_condition returns, in order.
+std::string read_keys(Readers& readers, ReadCondition* cond)
+{
+  MessageSeq data;
+  SampleInfoSeq infoseq;
+  const ReturnCode_t ret = readers.read(data, infoseq, cond);
+  if (ret != RETCODE_OK && ret != RETCODE_NO_DATA) {
+    cerr << "ERROR: read_w_condition failed: " << retcode_to_string(ret) << endl;
+  }
+  std::set<CORBA::Long> keys;
+  for (CORBA::ULong i = 0; i < data.length(); ++i) {
+    keys.insert(data[i].key);
+  }
+  std::string result;
+  for (std::set<CORBA::Long>::const_iterator it = keys.begin(); it != keys.end(); ++it) {
+    result += result.empty() ? "" : " ";
+    result += to_dds_string(*it).c_str();
+  }
+  return result;
+}
+
+bool check_keys(Readers& readers, ReadCondition* cond, const std::string& expected, const char* what)
+{
+  const std::string keys = read_keys(readers, cond);
+  if (keys != expected) {
+    cerr << "ERROR: run_cached_results_test: " << what << " read keys \"" << keys
+      << "\" expected \"" << expected << '"' << endl;
+    return false;
+  }
+  return true;
+}
+
+DDS::StringSeq key_param(CORBA::Long key)
+{
+  DDS::StringSeq params(1);
+  params.length(1);
+  params[0] = to_dds_string(key).c_str();
+  return params;
+}
+
+/*
+ * The results of a QueryCondition are kept in the samples until its
+ * parameters change, and a DataReader keeps them for a limited number of
+ * QueryConditions at a time.  Check that reads after set_query_parameters
+ * use the new parameters, also for QueryConditions past that limit and
+ * ones that were given the results of a deleted QueryCondition.
+ */
+bool run_cached_results_test(const MessageTypeSupport_var& ts, const Publisher_var& pub,
+  const Subscriber_var& sub)
+{
+  DataWriter_var dw;
+  DataReader_var dr;
+  if (!test_setup(ts, pub, sub, "MyTopic5", dw, dr)) {
+    cerr << "ERROR: run_cached_results_test: setup failed" << endl;
+    return false;
+  }
+
+  MessageDataWriter_var mdw = MessageDataWriter::_narrow(dw);
+  for (CORBA::Long key = 1; key <= 3; ++key) {
+    Message sample;
+    sample.key = key;
+    sample.iteration = 0;
+    sample.name = "cached";
+    sample.nest.value = A;
+    const ReturnCode_t ret = mdw->write(sample, HANDLE_NIL);
+    if (ret != RETCODE_OK) {
+      cerr << "ERROR: run_cached_results_test: write failed: " << retcode_to_string(ret) << endl;
+      return false;
+    }
+  }
+
+  Readers readers(dr);
+  ReadCondition_var all = dr->create_readcondition(ANY_SAMPLE_STATE, ANY_VIEW_STATE, ANY_INSTANCE_STATE);
+  for (int i = 0; i < 100 && read_keys(readers, all) != "1 2 3"; ++i) {
+    ACE_OS::sleep(ACE_Time_Value(0, 100000));
+  }
+  if (!check_keys(readers, all, "1 2 3", "ReadCondition")) {
+    return false;
+  }
+  dr->delete_readcondition(all);
+
+  ReadCondition_var qc = dr->create_querycondition(ANY_SAMPLE_STATE,
+    ANY_VIEW_STATE, ANY_INSTANCE_STATE, "key = %0", key_param(1));
+  QueryCondition_var query = QueryCondition::_narrow(qc);
+  if (!query) {
+    cerr << "ERROR: run_cached_results_test: failed to create QueryCondition" << endl;
+    return false;
+  }
+  // The second read of each uses the results kept in the samples.
+  if (!check_keys(readers, qc, "1", "key = 1") || !check_keys(readers, qc, "1", "key = 1 again")) {
+    return false;
+  }
+  if (query->set_query_parameters(key_param(2)) != RETCODE_OK
+      || !check_keys(readers, qc, "2", "key = 2") || !check_keys(readers, qc, "2", "key = 2 again")) {
+    return false;
+  }
+  if (query->set_query_parameters(key_param(1)) != RETCODE_OK
+      || !check_keys(readers, qc, "1", "key = 1 after key = 2")) {
+    return false;
+  }
+
+  // The trigger value follows the number of matching samples: none match
+  // until one is written and again none once it's taken.
+  ReadCondition_var trigger_rc = dr->create_querycondition(ANY_SAMPLE_STATE,
+    ANY_VIEW_STATE, ANY_INSTANCE_STATE, "key = %0", key_param(4));
+  if (!trigger_rc || trigger_rc->get_trigger_value() || trigger_rc->get_trigger_value()) {
+    cerr << "ERROR: run_cached_results_test: trigger value without matching samples" << endl;
+    return false;
+  }
+  Message fourth;
+  fourth.key = 4;
+  fourth.iteration = 0;
+  fourth.name = "cached";
+  fourth.nest.value = A;
+  if (mdw->write(fourth, HANDLE_NIL) != RETCODE_OK) {
+    cerr << "ERROR: run_cached_results_test: write of key 4 failed" << endl;
+    return false;
+  }
+  bool triggered = false;
+  for (int i = 0; i < 100 && !triggered; ++i) {
+    triggered = trigger_rc->get_trigger_value();
+    if (!triggered) {
+      ACE_OS::sleep(ACE_Time_Value(0, 100000));
+    }
+  }
+  if (!triggered) {
+    cerr << "ERROR: run_cached_results_test: no trigger value for a matching sample" << endl;
+    return false;
+  }
+  {
+    MessageSeq data;
+    SampleInfoSeq infoseq;
+    if (readers.take(data, infoseq, trigger_rc) != RETCODE_OK || data.length() != 1
+        || trigger_rc->get_trigger_value()) {
+      cerr << "ERROR: run_cached_results_test: trigger value after taking the matching sample" << endl;
+      return false;
+    }
+  }
+  dr->delete_readcondition(trigger_rc);
+
+  // More QueryConditions than the DataReader keeps results for.
+  const int many = 40;
+  QueryCondition_var queries[many];
+  for (int i = 0; i < many; ++i) {
+    ReadCondition_var rc = dr->create_querycondition(ANY_SAMPLE_STATE,
+      ANY_VIEW_STATE, ANY_INSTANCE_STATE, "key = %0", key_param(i % 3 + 1));
+    queries[i] = QueryCondition::_narrow(rc);
+    if (!queries[i]) {
+      cerr << "ERROR: run_cached_results_test: failed to create QueryCondition " << i << endl;
+      return false;
+    }
+  }
+  bool passed = true;
+  for (int i = 0; i < many; ++i) {
+    passed &= check_keys(readers, queries[i], to_dds_string(i % 3 + 1).c_str(), "one of many");
+  }
+  for (int i = 0; i < many; ++i) {
+    passed &= queries[i]->set_query_parameters(key_param((i + 1) % 3 + 1)) == RETCODE_OK;
+  }
+  for (int i = 0; i < many; ++i) {
+    passed &= check_keys(readers, queries[i], to_dds_string((i + 1) % 3 + 1).c_str(), "one of many after set_query_parameters");
+  }
+  passed &= check_keys(readers, qc, "1", "key = 1 with many");
+
+  // New QueryConditions get the results of deleted ones, which have to be
+  // forgotten.
+  for (int i = 0; i < many; ++i) {
+    dr->delete_readcondition(queries[i]);
+  }
+  dr->delete_readcondition(qc);
+  qc = dr->create_querycondition(ANY_SAMPLE_STATE,
+    ANY_VIEW_STATE, ANY_INSTANCE_STATE, "key >= %0", key_param(2));
+  if (!qc) {
+    cerr << "ERROR: run_cached_results_test: failed to create QueryCondition after deleting" << endl;
+    return false;
+  }
+  passed &= check_keys(readers, qc, "2 3", "key >= 2 after deleting");
+  dr->delete_readcondition(qc);
+
+  if (!test_cleanup(pub, sub, dw, dr)) {
+    cerr << "ERROR: run_cached_results_test: cleanup failed" << endl;
+    return false;
+  }
+  return passed;
+}
+
 bool run_dispose_filter_tests(const MessageTypeSupport_var& ts, const Publisher_var& pub,
   const Subscriber_var& sub)
 {
@@ -1002,6 +1205,7 @@ int run_test(int argc, ACE_TCHAR* argv[])
   passed &= run_change_parameter_test(ts, pub, sub);
   passed &= run_complex_filtering_test(ts, pub, sub);
   passed &= run_dispose_filter_tests(ts, pub, sub);
+  passed &= run_cached_results_test(ts, pub, sub);
 
   pub = 0;
   ts = 0;
@@ -0,0 +1,251 @@
+/**
+ * Checks DCPSQueuedDelivery: while a DataReader is busy, samples for it are
+ * queued instead of holding up the transport, the service's job queue keeps
+ * running, and once the DataReader is free the queued samples are delivered
+ * in the order they were written.  With DCPSDeliveryQueueMax, no more than
+ * that many samples are queued for a busy DataReader.
+ *
+ * The DataReader is kept busy by holding its sample lock.
+ */
+#include "QueuedDeliveryTypeSupportImpl.h"
+
+#include <tests/Utils/DDSApp.h>
+#include <tests/Utils/StatusMatching.h>
+
+#include <dds/DCPS/Service_Participant.h>
+#include <dds/DCPS/AtomicBool.h>
+#include <dds/DCPS/DataReaderImpl.h>
+#include <dds/DCPS/JobQueue.h>
+#include <dds/DCPS/WaitSet.h>
+#include <dds/DCPS/DCPS_Utils.h>
+#ifdef ACE_AS_STATIC_LIBS
+#  include <dds/DCPS/transport/rtps_udp/RtpsUdp.h>
+#  include <dds/DCPS/RTPS/RtpsDiscovery.h>
+#endif
+
+using namespace QueuedDelivery;
+
+class DDS_TEST {
+public:
+  static ACE_Recursive_Thread_Mutex& sample_lock(DDS::DataReader* reader)
+  {
+    return dynamic_cast<OpenDDS::DCPS::DataReaderImpl*>(reader)->sample_lock_;
+  }
+
+  static size_t delivery_queue_size(DDS::DataReader* reader)
+  {
+    OpenDDS::DCPS::DataReaderImpl* const impl = dynamic_cast<OpenDDS::DCPS::DataReaderImpl*>(reader);
+    ACE_Guard<ACE_Thread_Mutex> guard(impl->delivery_queue_lock_);
+    return impl->delivery_queue_.size();
+  }
+};
+
+namespace {
+  const DDS::DomainId_t domain = 145;
+  const char* const topic_name = "QueuedDelivery";
+  const CORBA::Long sample_count = 20;
+  const size_t queue_max = 5;
+
+  class ProbeJob : public OpenDDS::DCPS::Job {
+  public:
+    explicit ProbeJob(OpenDDS::DCPS::AtomicBool& ran)
+      : ran_(ran)
+    {}
+
+    void execute()
+    {
+      ran_ = true;
+    }
+
+  private:
+    OpenDDS::DCPS::AtomicBool& ran_;
+  };
+
+  void writer_qos(DDS::DataWriterQos& qos)
+  {
+    qos.reliability.kind = DDS::RELIABLE_RELIABILITY_QOS;
+    qos.history.kind = DDS::KEEP_ALL_HISTORY_QOS;
+  }
+
+  void reader_qos(DDS::DataReaderQos& qos)
+  {
+    qos.reliability.kind = DDS::RELIABLE_RELIABILITY_QOS;
+    qos.history.kind = DDS::KEEP_ALL_HISTORY_QOS;
+  }
+
+  /// Take sample_count samples, which must be in the order they were written.
+  bool take_in_order(DDS::DataReader* reader, const char* name)
+  {
+    SampleDataReader_var dr = SampleDataReader::_narrow(reader);
+    DDS::ReadCondition_var condition = dr->create_readcondition(
+      DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE);
+    DDS::WaitSet_var ws = new DDS::WaitSet;
+    ws->attach_condition(condition);
+    const DDS::Duration_t timeout = {30, 0};
+
+    bool ok = true;
+    CORBA::Long expected = 0;
+    while (ok && expected < sample_count) {
+      DDS::ConditionSeq active;
+      if (ws->wait(active, timeout) != DDS::RETCODE_OK) {
+        ACE_ERROR((LM_ERROR, "ERROR: %C timed out after %d samples\n", name, expected));
+        ok = false;
+        break;
+      }
+      SampleSeq data;
+      DDS::SampleInfoSeq info;
+      if (dr->take_w_condition(data, info, DDS::LENGTH_UNLIMITED, condition) != DDS::RETCODE_OK) {
+        continue;
+      }
+      for (CORBA::ULong i = 0; i < data.length(); ++i) {
+        if (!info[i].valid_data) {
+          continue;
+        }
+        if (data[i].seq != expected) {
+          ACE_ERROR((LM_ERROR, "ERROR: %C got sample %d, expected %d\n", name, data[i].seq, expected));
+          ok = false;
+        }
+        ++expected;
+      }
+      dr->return_loan(data, info);
+    }
+
+    ws->detach_condition(condition);
+    dr->delete_readcondition(condition);
+    return ok;
+  }
+}
+
+int run_test(TestUtils::DDSApp& app)
+{
+  TestUtils::DDSTopicFacade<Sample> topic = app.topic_facade<Sample>(topic_name);
+  DDS::DataReader_var busy_reader = topic.reader(DDS::DataReaderListener::_nil(), reader_qos);
+  DDS::DataReader_var free_reader = topic.reader(DDS::DataReaderListener::_nil(), reader_qos);
+  SampleDataWriter_var sample_dw = topic.writer(writer_qos);
+  if (!busy_reader || !free_reader || !sample_dw) {
+    ACE_ERROR((LM_ERROR, "ERROR: failed to create the readers or writer\n"));
+    return 1;
+  }
+
+  int status = 0;
+  if (Utils::wait_match(busy_reader, 1) || Utils::wait_match(free_reader, 1)) {
+    status = 1;
+  }
+
+  if (!status) {
+    ACE_Guard<ACE_Recursive_Thread_Mutex> busy(DDS_TEST::sample_lock(busy_reader));
+
+    for (CORBA::Long seq = 0; seq < sample_count; ++seq) {
+      Sample sample;
+      sample.seq = seq;
+      if (sample_dw->write(sample, DDS::HANDLE_NIL) != DDS::RETCODE_OK) {
+        ACE_ERROR((LM_ERROR, "ERROR: write failed\n"));
+        status = 1;
+      }
+    }
+
+    // The transport acknowledges and keeps delivering to other readers
+    // while busy_reader can't take the samples.
+    const DDS::Duration_t timeout = {30, 0};
+    if (sample_dw->wait_for_acknowledgments(timeout) != DDS::RETCODE_OK) {
+      ACE_ERROR((LM_ERROR, "ERROR: wait_for_acknowledgments failed while the reader was busy\n"));
+      status = 1;
+    }
+    if (!take_in_order(free_reader, "free_reader")) {
+      status = 1;
+    }
+
+    // Delivery to busy_reader doesn't hold up the service's job queue.
+    OpenDDS::DCPS::AtomicBool probe_ran(false);
+    TheServiceParticipant->job_queue()->enqueue(OpenDDS::DCPS::make_rch<ProbeJob>(OpenDDS::DCPS::ref(probe_ran)));
+    for (int i = 0; i < 300 && !probe_ran; ++i) {
+      ACE_OS::sleep(ACE_Time_Value(0, 100000));
+    }
+    if (!probe_ran) {
+      ACE_ERROR((LM_ERROR, "ERROR: the job queue didn't run while the reader was busy\n"));
+      status = 1;
+    }
+
+    // The samples are still waiting in busy_reader's queue.
+    SampleDataReader_var dr = SampleDataReader::_narrow(busy_reader);
+    SampleSeq data;
+    DDS::SampleInfoSeq info;
+    const DDS::ReturnCode_t rc = dr->read(data, info, DDS::LENGTH_UNLIMITED,
+      DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE);
+    if (rc != DDS::RETCODE_NO_DATA) {
+      ACE_ERROR((LM_ERROR, "ERROR: read of the busy reader returned %C, expected no data\n",
+                 OpenDDS::DCPS::retcode_to_string(rc)));
+      status = 1;
+      if (rc == DDS::RETCODE_OK) {
+        dr->return_loan(data, info);
+      }
+    }
+  }
+
+  if (!status && !take_in_order(busy_reader, "busy_reader")) {
+    status = 1;
+  }
+
+  // A busy DataReader created with a limit queues that many samples, the
+  // rest wait for room instead of growing the queue.
+  TheServiceParticipant->delivery_queue_max(queue_max);
+  DDS::DataReader_var capped_reader;
+  if (!status) {
+    capped_reader = topic.reader(DDS::DataReaderListener::_nil(), reader_qos);
+    if (!capped_reader || Utils::wait_match(capped_reader, 1)) {
+      ACE_ERROR((LM_ERROR, "ERROR: failed to create and match the capped reader\n"));
+      status = 1;
+    }
+  }
+  if (!status) {
+    ACE_Guard<ACE_Recursive_Thread_Mutex> busy(DDS_TEST::sample_lock(capped_reader));
+
+    for (CORBA::Long seq = 0; seq < sample_count; ++seq) {
+      Sample sample;
+      sample.seq = seq;
+      if (sample_dw->write(sample, DDS::HANDLE_NIL) != DDS::RETCODE_OK) {
+        ACE_ERROR((LM_ERROR, "ERROR: write failed\n"));
+        status = 1;
+      }
+    }
+
+    size_t queued = 0;
+    for (int i = 0; i < 300 && queued < queue_max; ++i) {
+      ACE_OS::sleep(ACE_Time_Value(0, 100000));
+      queued = DDS_TEST::delivery_queue_size(capped_reader);
+    }
+    // Give the transport time to go past the limit if it were going to.
+    ACE_OS::sleep(ACE_Time_Value(0, 500000));
+    queued = DDS_TEST::delivery_queue_size(capped_reader);
+    if (queued != queue_max) {
+      ACE_ERROR((LM_ERROR, "ERROR: the capped reader queued %B samples, expected %B\n",
+                 queued, queue_max));
+      status = 1;
+    }
+  }
+  if (!status && !take_in_order(capped_reader, "capped_reader")) {
+    status = 1;
+  }
+
+  return status;
+}
+
+int ACE_TMAIN(int argc, ACE_TCHAR* argv[])
+{
+  int status = 1;
+  try {
+    TestUtils::DDSApp app(argc, argv, domain);
+    if (!TheServiceParticipant->queued_delivery()) {
+      ACE_ERROR((LM_ERROR, "ERROR: DCPSQueuedDelivery is not enabled\n"));
+      return 1;
+    }
+    status = run_test(app);
+  } catch (const std::exception& e) {
+    ACE_ERROR((LM_ERROR, "ERROR: %C\n", e.what()));
+  }
+
+  if (!status) {
+    ACE_DEBUG((LM_INFO, "INFO: test passed\n"));
+  }
+  return status;
+}
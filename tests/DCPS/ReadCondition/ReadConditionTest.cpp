@@ -6,8 +6,15 @@
 #include "dds/DCPS/SubscriberImpl.h"
 #include "dds/DCPS/StaticIncludes.h"
 #include "dds/DCPS/DCPS_Utils.h"
+#include "dds/DCPS/EntityImpl.h"
+#include "dds/DCPS/Observer.h"
+
+#include "tests/Utils/StatusMatching.h"
 
 #include "GeneratedCode/MessengerTypeSupportImpl.h"
+
+#include <ace/OS_NS_unistd.h>
+
 #include <iostream>
 using namespace std;
 
@@ -236,6 +243,197 @@ int run_test_next_instance(DDS::DomainParticipant_ptr dp)
   return passed ? 0 : 1;
 }
 
+/// Read every sample, waiting up to 10 seconds for count samples with
+/// valid data to arrive.
+bool read_all(Messenger::MessageDataReader_ptr mdr, CORBA::ULong count,
+              Messenger::MessageSeq& data, DDS::SampleInfoSeq& info)
+{
+  for (int i = 0; i < 100; ++i) {
+    const DDS::ReturnCode_t ret = mdr->read(data, info, DDS::LENGTH_UNLIMITED,
+      DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE);
+    if (ret != DDS::RETCODE_OK && ret != DDS::RETCODE_NO_DATA) {
+      cout << "ERROR: read returned " << OpenDDS::DCPS::retcode_to_string(ret) << endl;
+      return false;
+    }
+    CORBA::ULong valid = 0;
+    for (CORBA::ULong j = 0; j < info.length(); ++j) {
+      if (info[j].valid_data) {
+        ++valid;
+      }
+    }
+    if (valid >= count) {
+      return true;
+    }
+    ACE_OS::sleep(ACE_Time_Value(0, 100000));
+  }
+  cout << "ERROR: timed out waiting for " << count << " samples" << endl;
+  return false;
+}
+
+CORBA::Long generation(const DDS::SampleInfo& info)
+{
+  return info.disposed_generation_count + info.no_writers_generation_count;
+}
+
+/// Check the *_rank fields of a read that returned every sample of each
+/// instance against the positions and generation counts of the samples.
+bool check_ranks(const DDS::SampleInfoSeq& info)
+{
+  bool passed = true;
+  for (CORBA::ULong i = 0; i < info.length(); ++i) {
+    CORBA::Long following = 0;
+    CORBA::ULong last = i;
+    for (CORBA::ULong j = i + 1; j < info.length(); ++j) {
+      if (info[j].instance_handle == info[i].instance_handle) {
+        ++following;
+        last = j;
+      }
+    }
+    const CORBA::Long generation_rank = generation(info[last]) - generation(info[i]);
+    if (info[i].sample_rank != following ||
+        info[i].generation_rank != generation_rank ||
+        info[i].absolute_generation_rank != generation_rank) {
+      cout << "ERROR: sample " << i << " of instance " << info[i].instance_handle
+           << " has ranks " << info[i].sample_rank << ' ' << info[i].generation_rank
+           << ' ' << info[i].absolute_generation_rank << ", expected " << following
+           << ' ' << generation_rank << ' ' << generation_rank << endl;
+      passed = false;
+    }
+  }
+  return passed;
+}
+
+/// Reads the same DataReader again from on_sample_read.
+class NestedReadObserver : public OpenDDS::DCPS::Observer {
+public:
+  explicit NestedReadObserver(Messenger::MessageDataReader_ptr mdr)
+    : mdr_(Messenger::MessageDataReader::_duplicate(mdr))
+    , nested_(false)
+    , nested_count_(0)
+  {}
+
+  void on_sample_read(DDS::DataReader_ptr, const Sample&)
+  {
+    if (nested_ || nested_count_) {
+      return;
+    }
+    nested_ = true;
+    Messenger::MessageSeq data;
+    DDS::SampleInfoSeq info;
+    if (mdr_->read(data, info, DDS::LENGTH_UNLIMITED, DDS::ANY_SAMPLE_STATE,
+                   DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE) == DDS::RETCODE_OK) {
+      nested_count_ = data.length();
+    }
+    nested_ = false;
+  }
+
+  CORBA::ULong nested_count() const { return nested_count_; }
+
+private:
+  Messenger::MessageDataReader_var mdr_;
+  bool nested_;
+  CORBA::ULong nested_count_;
+};
+
+int run_test_ranks(DDS::DomainParticipant_ptr dp)
+{
+  using namespace DDS;
+  using namespace OpenDDS::DCPS;
+  using namespace Messenger;
+  MessageTypeSupport_var ts = new MessageTypeSupportImpl;
+  ts->register_type(dp, "");
+  CORBA::String_var type_name = ts->get_type_name();
+  Topic_var topic = dp->create_topic("MyTopic", type_name,
+    TOPIC_QOS_DEFAULT, 0, ::OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+
+  Publisher_var pub = dp->create_publisher(PUBLISHER_QOS_DEFAULT, 0,
+    ::OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+  DataWriterQos dw_qos;
+  pub->get_default_datawriter_qos(dw_qos);
+  dw_qos.history.kind = KEEP_ALL_HISTORY_QOS;
+  DataWriter_var dw = pub->create_datawriter(topic, dw_qos, 0,
+    ::OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+
+  Subscriber_var sub = dp->create_subscriber(SUBSCRIBER_QOS_DEFAULT, 0,
+    ::OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+  DataReaderQos dr_qos;
+  sub->get_default_datareader_qos(dr_qos);
+  dr_qos.reliability.kind = RELIABLE_RELIABILITY_QOS;
+  dr_qos.history.kind = KEEP_ALL_HISTORY_QOS;
+  DataReader_var dr = sub->create_datareader(topic, dr_qos, 0,
+    ::OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+
+  if (Utils::wait_match(dw, 1)) {
+    return 1;
+  }
+
+  // Instance 1 gets a new generation after its first two samples, instance
+  // 2 has three samples of one generation, and instance 3 has one sample.
+  MessageDataWriter_var mdw = MessageDataWriter::_narrow(dw);
+  const CORBA::Long writes[] = {1, 2, 1, 3, 2, 2};
+  Message msg = {0};
+  for (size_t i = 0; i < sizeof writes / sizeof writes[0]; ++i) {
+    msg.subject_id = writes[i];
+    if (mdw->write(msg, HANDLE_NIL) != RETCODE_OK) return 1;
+  }
+  msg.subject_id = 1;
+  if (mdw->dispose(msg, HANDLE_NIL) != RETCODE_OK) return 1;
+  if (mdw->write(msg, HANDLE_NIL) != RETCODE_OK) return 1;
+
+  MessageDataReader_var mdr = MessageDataReader::_narrow(dr);
+  bool passed = true;
+  MessageSeq data;
+  SampleInfoSeq info;
+  if (!read_all(mdr, 7, data, info) || !check_ranks(info)) {
+    passed = false;
+  }
+
+  // Reading part of instance 1: the most recent sample in the collection is
+  // still of the first generation, the most recent one of the instance isn't.
+  const InstanceHandle_t handle = mdr->lookup_instance(msg);
+  MessageSeq first_data;
+  SampleInfoSeq first_info;
+  ReturnCode_t ret = mdr->read_instance(first_data, first_info, 2, handle,
+    ANY_SAMPLE_STATE, ANY_VIEW_STATE, ANY_INSTANCE_STATE);
+  if (ret != RETCODE_OK || first_info.length() != 2) {
+    cout << "ERROR: read_instance returned " << retcode_to_string(ret) << endl;
+    passed = false;
+  } else {
+    for (CORBA::ULong i = 0; i < first_info.length(); ++i) {
+      if (first_info[i].sample_rank != static_cast<CORBA::Long>(1 - i) ||
+          first_info[i].generation_rank != 0 ||
+          first_info[i].absolute_generation_rank != 1) {
+        cout << "ERROR: partial read of instance 1 sample " << i << " has ranks "
+             << first_info[i].sample_rank << ' ' << first_info[i].generation_rank
+             << ' ' << first_info[i].absolute_generation_rank << endl;
+        passed = false;
+      }
+    }
+  }
+
+  // A read from an observer callback in the middle of a read doesn't take
+  // the storage of the outer read.
+  const RcHandle<NestedReadObserver> observer = make_rch<NestedReadObserver>(mdr.in());
+  dynamic_cast<EntityImpl*>(dr.in())->set_observer(observer, Observer::e_SAMPLE_READ);
+  MessageSeq outer_data;
+  SampleInfoSeq outer_info;
+  ret = mdr->read(outer_data, outer_info, LENGTH_UNLIMITED,
+    ANY_SAMPLE_STATE, ANY_VIEW_STATE, ANY_INSTANCE_STATE);
+  dynamic_cast<EntityImpl*>(dr.in())->set_observer(Observer_rch(), Observer::e_SAMPLE_READ);
+  if (ret != RETCODE_OK || outer_info.length() != info.length() ||
+      observer->nested_count() != info.length()) {
+    cout << "ERROR: nested read returned " << observer->nested_count()
+         << " samples and the outer read " << outer_info.length()
+         << ", expected " << info.length() << endl;
+    passed = false;
+  } else if (!check_ranks(outer_info)) {
+    passed = false;
+  }
+
+  dp->delete_contained_entities();
+  return passed ? 0 : 1;
+}
+
 int ACE_TMAIN(int argc, ACE_TCHAR *argv[])
 {
   int ret = 1;
@@ -248,6 +446,7 @@ int ACE_TMAIN(int argc, ACE_TCHAR *argv[])
 
     ret = run_test_next_instance(dp);
     ret += run_test_instance(dp);
+    ret += run_test_ranks(dp);
 
     dpf->delete_participant(dp);
     TheServiceParticipant->shutdown();
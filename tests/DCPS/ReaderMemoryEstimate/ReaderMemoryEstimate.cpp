@@ -0,0 +1,177 @@
+/**
+ * Checks DataReaderImpl::get_memory_estimate: the instance and sample counts
+ * follow what the DataReader holds as samples arrive and are taken, and
+ * autopurged instances are no longer counted.
+ */
+#include "ReaderMemoryEstimateTypeSupportImpl.h"
+
+#include <tests/Utils/DDSApp.h>
+#include <tests/Utils/StatusMatching.h>
+
+#include <dds/DCPS/DataReaderImpl.h>
+#ifdef ACE_AS_STATIC_LIBS
+#  include <dds/DCPS/transport/rtps_udp/RtpsUdp.h>
+#  include <dds/DCPS/RTPS/RtpsDiscovery.h>
+#endif
+
+using OpenDDS::DCPS::DataReaderImpl;
+using namespace ReaderMemoryEstimate;
+
+namespace {
+  const DDS::DomainId_t domain = 146;
+  const char* const topic_name = "ReaderMemoryEstimate";
+  const CORBA::Long instance_count = 3;
+  const CORBA::Long samples_per_instance = 4;
+  const size_t sample_count = instance_count * samples_per_instance;
+
+  void writer_qos(DDS::DataWriterQos& qos)
+  {
+    qos.reliability.kind = DDS::RELIABLE_RELIABILITY_QOS;
+    qos.history.kind = DDS::KEEP_ALL_HISTORY_QOS;
+    qos.writer_data_lifecycle.autodispose_unregistered_instances = false;
+  }
+
+  void reader_qos(DDS::DataReaderQos& qos)
+  {
+    qos.reliability.kind = DDS::RELIABLE_RELIABILITY_QOS;
+    qos.history.kind = DDS::KEEP_ALL_HISTORY_QOS;
+    const DDS::Duration_t purge_delay = {0, 100000000};
+    qos.reader_data_lifecycle.autopurge_nowriter_samples_delay = purge_delay;
+  }
+
+  DataReaderImpl::MemoryEstimate estimate(DDS::DataReader* reader)
+  {
+    DataReaderImpl::MemoryEstimate memory;
+    dynamic_cast<DataReaderImpl*>(reader)->get_memory_estimate(memory);
+    return memory;
+  }
+
+  bool check(const DataReaderImpl::MemoryEstimate& memory, size_t instances, size_t samples, const char* when)
+  {
+    if (memory.instances != instances || memory.samples != samples) {
+      ACE_ERROR((LM_ERROR, "ERROR: %C: estimate has %B instances and %B samples, expected %B and %B\n",
+                 when, memory.instances, memory.samples, instances, samples));
+      return false;
+    }
+    if (instances && !memory.estimated_bytes) {
+      ACE_ERROR((LM_ERROR, "ERROR: %C: estimate has no bytes\n", when));
+      return false;
+    }
+    return true;
+  }
+}
+
+int run_test(TestUtils::DDSApp& app)
+{
+  TestUtils::DDSTopicFacade<Sample> topic = app.topic_facade<Sample>(topic_name);
+  DDS::DataReader_var reader = topic.reader(DDS::DataReaderListener::_nil(), reader_qos);
+  SampleDataReader_var sample_dr = SampleDataReader::_narrow(reader);
+  SampleDataWriter_var sample_dw = topic.writer(writer_qos);
+  DDS::DataWriter_var writer = TestUtils::DDSApp::datawriter(sample_dw);
+  if (!sample_dr || !sample_dw) {
+    ACE_ERROR((LM_ERROR, "ERROR: failed to create the reader or writer\n"));
+    return 1;
+  }
+
+  int status = 0;
+  if (Utils::wait_match(reader, 1) || !check(estimate(reader), 0, 0, "before writing")) {
+    status = 1;
+  }
+
+  const DDS::Duration_t timeout = {30, 0};
+  size_t full_bytes = 0;
+  if (!status) {
+    for (CORBA::Long seq = 0; seq < samples_per_instance; ++seq) {
+      for (CORBA::Long id = 0; id < instance_count; ++id) {
+        Sample sample;
+        sample.id = id;
+        sample.seq = seq;
+        if (sample_dw->write(sample, DDS::HANDLE_NIL) != DDS::RETCODE_OK) {
+          ACE_ERROR((LM_ERROR, "ERROR: write failed\n"));
+          status = 1;
+        }
+      }
+    }
+    if (writer->wait_for_acknowledgments(timeout) != DDS::RETCODE_OK) {
+      ACE_ERROR((LM_ERROR, "ERROR: wait_for_acknowledgments failed\n"));
+      status = 1;
+    }
+
+    const DataReaderImpl::MemoryEstimate memory = estimate(reader);
+    full_bytes = memory.estimated_bytes;
+    if (!check(memory, instance_count, sample_count, "after writing")) {
+      status = 1;
+    }
+  }
+
+  if (!status) {
+    SampleSeq data;
+    DDS::SampleInfoSeq info;
+    if (sample_dr->take(data, info, DDS::LENGTH_UNLIMITED,
+          DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE) != DDS::RETCODE_OK) {
+      ACE_ERROR((LM_ERROR, "ERROR: take failed\n"));
+      status = 1;
+    } else {
+      sample_dr->return_loan(data, info);
+    }
+
+    const DataReaderImpl::MemoryEstimate memory = estimate(reader);
+    if (!check(memory, instance_count, 0, "after taking")) {
+      status = 1;
+    } else if (memory.estimated_bytes >= full_bytes) {
+      ACE_ERROR((LM_ERROR, "ERROR: estimate didn't shrink after taking: %B bytes, was %B\n",
+                 memory.estimated_bytes, full_bytes));
+      status = 1;
+    }
+  }
+
+  if (!status) {
+    // Unregistering leaves one invalid sample per instance until it is
+    // taken, then the instances are autopurged.
+    for (CORBA::Long id = 0; id < instance_count; ++id) {
+      Sample sample;
+      sample.id = id;
+      if (sample_dw->unregister_instance(sample, DDS::HANDLE_NIL) != DDS::RETCODE_OK) {
+        ACE_ERROR((LM_ERROR, "ERROR: unregister_instance failed\n"));
+        status = 1;
+      }
+    }
+    if (writer->wait_for_acknowledgments(timeout) != DDS::RETCODE_OK) {
+      ACE_ERROR((LM_ERROR, "ERROR: wait_for_acknowledgments failed after unregistering\n"));
+      status = 1;
+    }
+
+    DataReaderImpl::MemoryEstimate memory = estimate(reader);
+    for (int i = 0; i < 100 && memory.instances; ++i) {
+      ACE_OS::sleep(ACE_Time_Value(0, 100000));
+      SampleSeq data;
+      DDS::SampleInfoSeq info;
+      if (sample_dr->take(data, info, DDS::LENGTH_UNLIMITED,
+            DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE) == DDS::RETCODE_OK) {
+        sample_dr->return_loan(data, info);
+      }
+      memory = estimate(reader);
+    }
+    if (!check(memory, 0, 0, "after autopurge")) {
+      status = 1;
+    }
+  }
+
+  return status;
+}
+
+int ACE_TMAIN(int argc, ACE_TCHAR* argv[])
+{
+  int status = 1;
+  try {
+    TestUtils::DDSApp app(argc, argv, domain);
+    status = run_test(app);
+  } catch (const std::exception& e) {
+    ACE_ERROR((LM_ERROR, "ERROR: %C\n", e.what()));
+  }
+
+  if (!status) {
+    ACE_DEBUG((LM_INFO, "INFO: test passed\n"));
+  }
+  return status;
+}
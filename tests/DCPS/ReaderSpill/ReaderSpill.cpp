@@ -0,0 +1,188 @@
+/**
+ * Checks DCPSSpillBudget: once a DataReader holds more than the budget,
+ * the payloads of further samples are written to a file in
+ * DCPSSpillDirectory, read and take return them unchanged from there, and
+ * the file is emptied once they have been taken and removed with the
+ * DataReaders.  Both keyed and keyless topics are checked.
+ */
+#include "ReaderSpillTypeSupportImpl.h"
+
+#include <tests/Utils/DDSApp.h>
+#include <tests/Utils/StatusMatching.h>
+
+#include <dds/DCPS/Service_Participant.h>
+#ifdef ACE_AS_STATIC_LIBS
+#  include <dds/DCPS/transport/rtps_udp/RtpsUdp.h>
+#  include <dds/DCPS/RTPS/RtpsDiscovery.h>
+#endif
+
+#include <ace/Dirent.h>
+#include <ace/OS_NS_sys_stat.h>
+#include <ace/OS_NS_unistd.h>
+
+#include <string>
+
+using namespace ReaderSpill;
+
+namespace {
+  const DDS::DomainId_t domain = 148;
+  const CORBA::Long instance_count = 4;
+  const CORBA::Long sample_count = 40;
+  const size_t payload_size = 1000;
+
+  void set_id(KeyedSample& sample, CORBA::Long id) { sample.id = id; }
+  void set_id(KeylessSample&, CORBA::Long) {}
+  CORBA::Long get_id(const KeyedSample& sample) { return sample.id; }
+  CORBA::Long get_id(const KeylessSample&) { return 0; }
+
+  std::string payload(CORBA::Long seq)
+  {
+    return std::string(payload_size, static_cast<char>('a' + seq % 26));
+  }
+
+  /// Total size of the spill files, or -1 if there are none.  A reader's
+  /// file is removed once nothing refers to the reader, so an earlier
+  /// reader's empty file may still be there.
+  ACE_OFF_T spill_file_size()
+  {
+    const std::string directory = TheServiceParticipant->spill_directory().c_str();
+    ACE_Dirent dir(ACE_TEXT_CHAR_TO_TCHAR(directory.c_str()));
+    ACE_OFF_T size = -1;
+    for (ACE_DIRENT* entry = dir.read(); entry; entry = dir.read()) {
+      const std::string name = ACE_TEXT_ALWAYS_CHAR(entry->d_name);
+      if (name.compare(0, 14, "opendds-spill-") == 0) {
+        ACE_stat st;
+        const std::string path = directory + "/" + name;
+        size = (size < 0 ? 0 : size) + (ACE_OS::stat(path.c_str(), &st) == 0 ? st.st_size : 0);
+      }
+    }
+    return size;
+  }
+
+  void writer_qos(DDS::DataWriterQos& qos)
+  {
+    qos.reliability.kind = DDS::RELIABLE_RELIABILITY_QOS;
+    qos.history.kind = DDS::KEEP_ALL_HISTORY_QOS;
+  }
+
+  void reader_qos(DDS::DataReaderQos& qos)
+  {
+    qos.reliability.kind = DDS::RELIABLE_RELIABILITY_QOS;
+    qos.history.kind = DDS::KEEP_ALL_HISTORY_QOS;
+  }
+
+  template <typename Sample>
+  bool run(TestUtils::DDSApp& app, const char* topic_name)
+  {
+    typedef OpenDDS::DCPS::DDSTraits<Sample> Traits;
+    TestUtils::DDSTopicFacade<Sample> topic = app.topic_facade<Sample>(topic_name);
+    DDS::DataReader_var reader = topic.reader(DDS::DataReaderListener::_nil(), reader_qos);
+    typename Traits::DataWriterType::_var_type sample_dw = topic.writer(writer_qos);
+    if (!reader || !sample_dw || Utils::wait_match(reader, 1)) {
+      ACE_ERROR((LM_ERROR, "ERROR: %C: failed to create and match the reader and writer\n", topic_name));
+      return false;
+    }
+
+    bool ok = true;
+    for (CORBA::Long seq = 0; seq < sample_count; ++seq) {
+      Sample sample;
+      set_id(sample, seq % instance_count);
+      sample.seq = seq;
+      sample.payload = payload(seq).c_str();
+      if (sample_dw->write(sample, DDS::HANDLE_NIL) != DDS::RETCODE_OK) {
+        ACE_ERROR((LM_ERROR, "ERROR: %C: write failed\n", topic_name));
+        ok = false;
+      }
+    }
+    const DDS::Duration_t timeout = {30, 0};
+    if (sample_dw->wait_for_acknowledgments(timeout) != DDS::RETCODE_OK) {
+      ACE_ERROR((LM_ERROR, "ERROR: %C: wait_for_acknowledgments failed\n", topic_name));
+      ok = false;
+    }
+
+    const ACE_OFF_T spilled_size = spill_file_size();
+    if (spilled_size <= 0) {
+      ACE_ERROR((LM_ERROR, "ERROR: %C: nothing was spilled\n", topic_name));
+      ok = false;
+    }
+
+    typename Traits::DataReaderType::_var_type sample_dr = Traits::DataReaderType::_narrow(reader);
+    typename Traits::MessageSequenceType data;
+    DDS::SampleInfoSeq info;
+    if (sample_dr->take(data, info, DDS::LENGTH_UNLIMITED,
+          DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE) != DDS::RETCODE_OK) {
+      ACE_ERROR((LM_ERROR, "ERROR: %C: take failed\n", topic_name));
+      return false;
+    }
+    if (data.length() != static_cast<CORBA::ULong>(sample_count)) {
+      ACE_ERROR((LM_ERROR, "ERROR: %C: took %u samples, expected %d\n", topic_name, data.length(), sample_count));
+      ok = false;
+    }
+    CORBA::Long last_seq[instance_count] = { -1, -1, -1, -1 };
+    for (CORBA::ULong i = 0; i < data.length(); ++i) {
+      const CORBA::Long seq = data[i].seq;
+      const CORBA::Long id = get_id(data[i]);
+      if (!info[i].valid_data || seq < 0 || seq >= sample_count || id < 0 || id >= instance_count) {
+        ACE_ERROR((LM_ERROR, "ERROR: %C: sample %u is invalid\n", topic_name, i));
+        ok = false;
+        continue;
+      }
+      if (payload(seq) != data[i].payload.in()) {
+        ACE_ERROR((LM_ERROR, "ERROR: %C: sample %d has the wrong payload\n", topic_name, seq));
+        ok = false;
+      }
+      if (seq <= last_seq[id]) {
+        ACE_ERROR((LM_ERROR, "ERROR: %C: sample %d after %d\n", topic_name, seq, last_seq[id]));
+        ok = false;
+      }
+      last_seq[id] = seq;
+    }
+    sample_dr->return_loan(data, info);
+
+    const ACE_OFF_T taken_size = spill_file_size();
+    if (taken_size != 0) {
+      ACE_ERROR((LM_ERROR, "ERROR: %C: spill file has %q bytes after taking every sample\n",
+                 topic_name, static_cast<ACE_INT64>(taken_size)));
+      ok = false;
+    }
+
+    return ok;
+  }
+}
+
+int ACE_TMAIN(int argc, ACE_TCHAR* argv[])
+{
+  int status = 1;
+  try {
+    TestUtils::DDSApp app(argc, argv, domain);
+    if (!TheServiceParticipant->spill_budget()) {
+      ACE_ERROR((LM_ERROR, "ERROR: DCPSSpillBudget is not set\n"));
+      return 1;
+    }
+    const OpenDDS::DCPS::String directory = TheServiceParticipant->spill_directory();
+    ACE_OS::mkdir(ACE_TEXT_CHAR_TO_TCHAR(directory.c_str()));
+
+    status = 0;
+    if (!run<KeyedSample>(app, "ReaderSpillKeyed")) {
+      status = 1;
+    }
+    if (!run<KeylessSample>(app, "ReaderSpillKeyless")) {
+      status = 1;
+    }
+
+    app.shutdown();
+    if (spill_file_size() != -1) {
+      ACE_ERROR((LM_ERROR, "ERROR: spill files are left after deleting the readers\n"));
+      status = 1;
+    }
+    ACE_OS::rmdir(ACE_TEXT_CHAR_TO_TCHAR(directory.c_str()));
+  } catch (const std::exception& e) {
+    ACE_ERROR((LM_ERROR, "ERROR: %C\n", e.what()));
+    status = 1;
+  }
+
+  if (!status) {
+    ACE_DEBUG((LM_INFO, "INFO: test passed\n"));
+  }
+  return status;
+}
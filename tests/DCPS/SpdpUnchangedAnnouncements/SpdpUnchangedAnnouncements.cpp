@@ -0,0 +1,211 @@
+/**
+ * Checks that SPDP announcements that repeat the previous announcement of a
+ * participant take the fast path: they are counted by the
+ * TotalUnchangedAnnouncements statistic, they keep the lease of the remote
+ * participant alive even though the lease duration is shorter than the time
+ * the test runs for, and a change to the participant is still seen by the
+ * other participant.
+ */
+#include <dds/DCPS/Service_Participant.h>
+#include <dds/DCPS/Marked_Default_Qos.h>
+#include <dds/DCPS/Qos_Helper.h>
+#include <dds/DCPS/Statistics.h>
+#ifdef ACE_AS_STATIC_LIBS
+#  include <dds/DCPS/transport/rtps_udp/RtpsUdp.h>
+#  include <dds/DCPS/RTPS/RtpsDiscovery.h>
+#endif
+
+#include <ace/OS_NS_unistd.h>
+
+#include <cstring>
+
+using OpenDDS::DCPS::DEFAULT_STATUS_MASK;
+
+namespace {
+  const DDS::DomainId_t domain = 151;
+  const int timeout_sec = 30;
+  /// The LeaseDuration in rtps_disc.ini.
+  const int lease_sec = 3;
+
+  struct SpdpStats {
+    SpdpStats() : seen(false), discovered(0), unchanged(0), base(0) {}
+    bool seen;
+    ACE_UINT64 discovered;
+    ACE_UINT64 unchanged;
+    ACE_UINT64 base;
+  };
+
+  class Monitor {
+  public:
+    explicit Monitor(OpenDDS::DCPS::StatisticsDataReader& reader)
+      : reader_(reader)
+      , ok_(true)
+    {}
+
+    /// Take the statistics written since the last call and check that
+    /// neither participant lost the other once it had been discovered.
+    void update()
+    {
+      OpenDDS::DCPS::StatisticsDataReader::SampleSequence samples;
+      OpenDDS::DCPS::InternalSampleInfoSequence infos;
+      reader_.take(samples, infos, DDS::LENGTH_UNLIMITED,
+                   DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE);
+      for (size_t i = 0; i < samples.size(); ++i) {
+        if (std::strncmp(samples[i].id.in(), "RtpsDiscovery ", 14) != 0) {
+          continue;
+        }
+        SpdpStats& stats = stats_[samples[i].id.in()];
+        for (CORBA::ULong j = 0; j < samples[i].stats.length(); ++j) {
+          const OpenDDS::DCPS::Statistic& stat = samples[i].stats[j];
+          if (std::strcmp(stat.name.in(), "DiscoveredParticipants") == 0) {
+            if (stats.seen && stats.discovered && !stat.value) {
+              ACE_ERROR((LM_ERROR, "ERROR: %C lost the other participant\n", samples[i].id.in()));
+              ok_ = false;
+            }
+            stats.discovered = stat.value;
+          } else if (std::strcmp(stat.name.in(), "TotalUnchangedAnnouncements") == 0) {
+            stats.unchanged = stat.value;
+          }
+        }
+        stats.seen = true;
+      }
+    }
+
+    /// Count the unchanged announcements from here on.
+    void mark()
+    {
+      for (StatsMap::iterator it = stats_.begin(); it != stats_.end(); ++it) {
+        it->second.base = it->second.unchanged;
+      }
+    }
+
+    /// Both participants have handled at least count unchanged announcements
+    /// since mark().
+    bool unchanged(ACE_UINT64 count) const
+    {
+      if (stats_.size() != 2) {
+        return false;
+      }
+      for (StatsMap::const_iterator it = stats_.begin(); it != stats_.end(); ++it) {
+        if (it->second.discovered != 1 || it->second.unchanged - it->second.base < count) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    bool ok() const { return ok_; }
+
+  private:
+    OpenDDS::DCPS::StatisticsDataReader& reader_;
+    typedef OPENDDS_MAP(OPENDDS_STRING, SpdpStats) StatsMap;
+    StatsMap stats_;
+    bool ok_;
+  };
+
+  /// Wait for the fast path to be used for longer than the lease duration,
+  /// announcements are sent every second.
+  bool wait_for_unchanged(Monitor& monitor, const char* name)
+  {
+    monitor.update();
+    monitor.mark();
+    for (int i = 0; i < timeout_sec * 10; ++i) {
+      monitor.update();
+      if (monitor.unchanged(2 * lease_sec)) {
+        return monitor.ok();
+      }
+      ACE_OS::sleep(ACE_Time_Value(0, 100000));
+    }
+    ACE_ERROR((LM_ERROR, "ERROR: %C: timed out waiting for unchanged announcements\n", name));
+    return false;
+  }
+
+  bool has_user_data(DDS::DomainParticipant* participant, const char* value)
+  {
+    DDS::InstanceHandleSeq handles;
+    if (participant->get_discovered_participants(handles) != DDS::RETCODE_OK) {
+      return false;
+    }
+    const CORBA::ULong length = static_cast<CORBA::ULong>(std::strlen(value));
+    for (CORBA::ULong i = 0; i < handles.length(); ++i) {
+      DDS::ParticipantBuiltinTopicData data;
+      if (participant->get_discovered_participant_data(data, handles[i]) == DDS::RETCODE_OK
+          && data.user_data.value.length() == length
+          && std::memcmp(data.user_data.value.get_buffer(), value, length) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void set_user_data(DDS::DomainParticipantQos& qos, const char* value)
+  {
+    const CORBA::ULong length = static_cast<CORBA::ULong>(std::strlen(value));
+    qos.user_data.value.length(length);
+    std::memcpy(qos.user_data.value.get_buffer(), value, length);
+  }
+}
+
+int ACE_TMAIN(int argc, ACE_TCHAR* argv[])
+{
+  DDS::DomainParticipantFactory_var dpf = TheParticipantFactoryWithArgs(argc, argv);
+  TheServiceParticipant->statistics_period(OpenDDS::DCPS::TimeDuration(0, 100000));
+  const OpenDDS::DCPS::StatisticsDataReader_rch stats_reader =
+    OpenDDS::DCPS::make_rch<OpenDDS::DCPS::StatisticsDataReader>(
+      OpenDDS::DCPS::DataReaderQosBuilder().reliability_reliable());
+  TheServiceParticipant->statistics_topic()->connect(stats_reader);
+
+  DDS::DomainParticipantQos qos;
+  dpf->get_default_participant_qos(qos);
+  set_user_data(qos, "initial");
+  DDS::DomainParticipant_var changing = dpf->create_participant(domain, qos, 0, DEFAULT_STATUS_MASK);
+  DDS::DomainParticipant_var observer =
+    dpf->create_participant(domain, PARTICIPANT_QOS_DEFAULT, 0, DEFAULT_STATUS_MASK);
+  if (!changing || !observer) {
+    ACE_ERROR((LM_ERROR, "ERROR: create_participant failed\n"));
+    return 1;
+  }
+
+  int status = 0;
+  Monitor monitor(*stats_reader);
+  if (!wait_for_unchanged(monitor, "initial")) {
+    status = 1;
+  }
+
+  if (!status) {
+    // A changed announcement isn't mistaken for the previous one...
+    set_user_data(qos, "changed");
+    if (changing->set_qos(qos) != DDS::RETCODE_OK) {
+      ACE_ERROR((LM_ERROR, "ERROR: set_qos failed\n"));
+      status = 1;
+    } else {
+      bool changed = false;
+      for (int i = 0; i < timeout_sec * 10 && !changed; ++i) {
+        changed = has_user_data(observer, "changed");
+        if (!changed) {
+          ACE_OS::sleep(ACE_Time_Value(0, 100000));
+        }
+      }
+      if (!changed) {
+        ACE_ERROR((LM_ERROR, "ERROR: the changed user data wasn't discovered\n"));
+        status = 1;
+      }
+    }
+    // ...and once processed, repeats of it take the fast path again.
+    if (!status && !wait_for_unchanged(monitor, "changed")) {
+      status = 1;
+    }
+  }
+
+  changing->delete_contained_entities();
+  observer->delete_contained_entities();
+  dpf->delete_participant(changing);
+  dpf->delete_participant(observer);
+  TheServiceParticipant->statistics_topic()->disconnect(stats_reader);
+  TheServiceParticipant->shutdown();
+
+  if (!status) {
+    ACE_DEBUG((LM_INFO, "INFO: test passed\n"));
+  }
+  return status;
+}
@@ -133,6 +133,67 @@ public:
 
   ACE_Recursive_Thread_Mutex& lock_wdc(WriteDataContainer* wdc) { return wdc->lock_; }
 
+  void add_reader_acks(WriteDataContainer* wdc, const GUID_t& reader)
+  {
+    wdc->add_reader_acks(reader);
+  }
+
+  void remove_reader_acks(WriteDataContainer* wdc, const GUID_t& reader)
+  {
+    wdc->remove_reader_acks(reader);
+  }
+
+  void update_acked(WriteDataContainer* wdc, const SequenceNumber& seq,
+                    const GUID_t& reader = GUID_UNKNOWN)
+  {
+    ACE_Guard<ACE_Thread_Mutex> guard(wdc->wfa_lock_);
+    wdc->update_acked(seq, reader);
+  }
+
+  /// What reenqueue_all() records for a sample it resends to reader.
+  void resend(WriteDataContainer* wdc, const GUID_t& reader, const SequenceNumber& seq)
+  {
+    ACE_Guard<ACE_Thread_Mutex> guard(wdc->wfa_lock_);
+    if (wdc->pending_resends_[reader].insert(seq).second) {
+      wdc->all_pending_resends_.insert(seq);
+    }
+  }
+
+  void set_deadline_period(WriteDataContainer* wdc, const TimeDuration& period)
+  {
+    ACE_GUARD(ACE_Recursive_Thread_Mutex, guard, wdc->lock_);
+    wdc->set_deadline_period(period);
+  }
+
+  void extend_deadline(WriteDataContainer* wdc, const PublicationInstance_rch& instance)
+  {
+    ACE_GUARD(ACE_Recursive_Thread_Mutex, guard, wdc->lock_);
+    wdc->extend_deadline(instance);
+  }
+
+  void cancel_deadline(WriteDataContainer* wdc, const PublicationInstance_rch& instance)
+  {
+    ACE_GUARD(ACE_Recursive_Thread_Mutex, guard, wdc->lock_);
+    wdc->cancel_deadline(instance);
+  }
+
+  void process_deadlines(WriteDataContainer* wdc, const MonotonicTimePoint& now)
+  {
+    wdc->process_deadlines(now);
+  }
+
+  size_t deadline_entries(WriteDataContainer* wdc)
+  {
+    ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, wdc->lock_, 0);
+    return wdc->deadline_map_.size();
+  }
+
+  SequenceNumber cumulative_ack(WriteDataContainer* wdc)
+  {
+    ACE_Guard<ACE_Thread_Mutex> guard(wdc->wfa_lock_);
+    return wdc->get_cumulative_ack();
+  }
+
   WriteDataContainer* get_test_data_container(DDS::DataWriterQos const& dw_qos,
                                               Test::SimpleDataWriterImpl* fast_dw,
                                               ACE_Recursive_Thread_Mutex& deadline_status_lock,
@@ -424,7 +485,7 @@ int run_test(int argc, ACE_TCHAR *argv[])
           return ret;
         }
 
-        ret = test_data_container->enqueue(element_0, handle1);
+        ret = test_data_container->enqueue(element_0);
         test->log_send_state_lists("After enqueue", test_data_container);
 
         if (ret != DDS::RETCODE_OK) {
@@ -451,7 +512,7 @@ int run_test(int argc, ACE_TCHAR *argv[])
           return ret;
         }
 
-        ret = test_data_container->enqueue(element_1, handle1);
+        ret = test_data_container->enqueue(element_1);
         test->log_send_state_lists("After enqueue", test_data_container);
 
         if (ret != DDS::RETCODE_OK) {
@@ -544,7 +605,7 @@ int run_test(int argc, ACE_TCHAR *argv[])
           return ret;
         }
 
-        ret = test_data_container->enqueue(element_1, handle1);
+        ret = test_data_container->enqueue(element_1);
         test->log_send_state_lists("After enqueue", test_data_container);
 
         if (ret != DDS::RETCODE_OK) {
@@ -579,7 +640,7 @@ int run_test(int argc, ACE_TCHAR *argv[])
           return ret;
         }
 
-        ret = test_data_container->enqueue(element_2, handle2);
+        ret = test_data_container->enqueue(element_2);
         test->log_send_state_lists("After enqueue", test_data_container);
 
         if (ret != DDS::RETCODE_OK) {
@@ -679,7 +740,7 @@ int run_test(int argc, ACE_TCHAR *argv[])
           return ret;
         }
 
-        ret = test_data_container->enqueue(element_1, handle1);
+        ret = test_data_container->enqueue(element_1);
         test->log_send_state_lists("After enqueue", test_data_container);
 
         if (ret != DDS::RETCODE_OK) {
@@ -714,7 +775,7 @@ int run_test(int argc, ACE_TCHAR *argv[])
           return ret;
         }
 
-        ret = test_data_container->enqueue(element_2, handle2);
+        ret = test_data_container->enqueue(element_2);
         test->log_send_state_lists("After enqueue", test_data_container);
 
         if (ret != DDS::RETCODE_OK) {
@@ -818,7 +879,7 @@ int run_test(int argc, ACE_TCHAR *argv[])
           return ret;
         }
 
-        ret = test_data_container->enqueue(element_0, handle1);
+        ret = test_data_container->enqueue(element_0);
         test->log_send_state_lists("After enqueue", test_data_container);
 
         if (ret != DDS::RETCODE_OK) {
@@ -844,7 +905,7 @@ int run_test(int argc, ACE_TCHAR *argv[])
           return ret;
         }
 
-        ret = test_data_container->enqueue(element_1, handle1);
+        ret = test_data_container->enqueue(element_1);
         test->log_send_state_lists("After enqueue", test_data_container);
 
         if (ret != DDS::RETCODE_OK) {
@@ -876,6 +937,153 @@ int run_test(int argc, ACE_TCHAR *argv[])
         delete test_data_container;
       } //End Test Case 4 scope
 
+      { //Test Case 5 scope
+        //=====================================================
+        ACE_DEBUG((LM_INFO,
+          ACE_TEXT("\n\n==== TEST case 5 : Reliable, cumulative ack with many readers.\n")
+          ACE_TEXT("Acks delivered to all readers advance the cumulative ack, resends hold it back\n")
+          ACE_TEXT("===============================================\n")));
+
+        test->get_default_datawriter_qos(dw_qos);
+        dw_qos.reliability.kind = DDS::RELIABLE_RELIABILITY_QOS;
+
+        OpenDDS::DCPS::unique_ptr<Test::SimpleDataWriterImpl> fast_dw(new Test::SimpleDataWriterImpl());
+        GuidBuilder builder;
+        fast_dw->set_publication_id(builder.create());
+        fast_dw->set_qos(dw_qos);
+        test->setup_serialization(fast_dw.get());
+        test->substitute_dw_particpant(fast_dw.get(), tpi);
+        WriteDataContainer* test_data_container =
+          test->get_test_data_container(dw_qos, fast_dw.get(), deadline_status_lock,
+                                        deadline_status, deadline_last_total_count);
+
+        const int reader_count = 1000;
+        OPENDDS_VECTOR(GUID_t) readers;
+        for (int i = 0; i < reader_count; ++i) {
+          GuidBuilder reader_builder;
+          reader_builder.entityKey(i + 1);
+          reader_builder.entityKind(ENTITYKIND_USER_READER_WITH_KEY);
+          readers.push_back(reader_builder);
+          test->add_reader_acks(test_data_container, readers.back());
+        }
+
+        TEST_ASSERT(test->cumulative_ack(test_data_container) == SequenceNumber::ZERO());
+
+        // Out of order acks leave a gap until it's filled.
+        test->update_acked(test_data_container, 1);
+        test->update_acked(test_data_container, 3);
+        TEST_ASSERT(test->cumulative_ack(test_data_container) == 1);
+        TEST_ASSERT(!test_data_container->sequence_acknowledged(3));
+        test->update_acked(test_data_container, 2);
+        TEST_ASSERT(test->cumulative_ack(test_data_container) == 3);
+        TEST_ASSERT(test_data_container->sequence_acknowledged(3));
+
+        // A durable resend to one reader holds the writer back until that
+        // reader acknowledges it.
+        test->resend(test_data_container, readers[5], 2);
+        test->resend(test_data_container, readers[5], 3);
+        test->resend(test_data_container, readers[7], 3);
+        test->update_acked(test_data_container, 4);
+        TEST_ASSERT(test->cumulative_ack(test_data_container) == 1);
+        test->update_acked(test_data_container, 3, readers[6]);
+        TEST_ASSERT(test->cumulative_ack(test_data_container) == 1);
+        test->update_acked(test_data_container, 2, readers[5]);
+        TEST_ASSERT(test->cumulative_ack(test_data_container) == 2);
+        test->update_acked(test_data_container, 3, readers[5]);
+        TEST_ASSERT(test->cumulative_ack(test_data_container) == 2);
+
+        // A reader that goes away or is associated again no longer holds
+        // the writer back.
+        test->remove_reader_acks(test_data_container, readers[7]);
+        TEST_ASSERT(test->cumulative_ack(test_data_container) == 4);
+        test->resend(test_data_container, readers[9], 4);
+        TEST_ASSERT(test->cumulative_ack(test_data_container) == 3);
+        test->add_reader_acks(test_data_container, readers[9]);
+        TEST_ASSERT(test->cumulative_ack(test_data_container) == 4);
+
+        for (int i = 0; i < reader_count; ++i) {
+          test->remove_reader_acks(test_data_container, readers[i]);
+        }
+        delete test_data_container;
+      } //End Test Case 5 scope
+
+      { //Test Case 6 scope
+        //=====================================================
+        ACE_DEBUG((LM_INFO,
+          ACE_TEXT("\n\n==== TEST case 6 : Offered deadline.\n")
+          ACE_TEXT("Writes don't re-file the instance, deadlines are only missed without writes\n")
+          ACE_TEXT("===============================================\n")));
+
+        test->get_default_datawriter_qos(dw_qos);
+
+        OpenDDS::DCPS::unique_ptr<Test::SimpleDataWriterImpl> fast_dw(new Test::SimpleDataWriterImpl());
+        GuidBuilder builder;
+        fast_dw->set_publication_id(builder.create());
+        fast_dw->set_qos(dw_qos);
+        test->setup_serialization(fast_dw.get());
+        test->substitute_dw_particpant(fast_dw.get(), tpi);
+        WriteDataContainer* test_data_container =
+          test->get_test_data_container(dw_qos, fast_dw.get(), deadline_status_lock,
+                                        deadline_status, deadline_last_total_count);
+
+        const TimeDuration period(10);
+        test->set_deadline_period(test_data_container, period);
+
+        Test::Simple foo1;
+        foo1.key = 1;
+        foo1.count = 1;
+        Message_Block_Ptr mb(test->serialize_sample(fast_dw.get(), foo1, Sample::KeyOnly));
+        DDS::InstanceHandle_t handle1 = DDS::HANDLE_NIL;
+        TEST_ASSERT(test_data_container->register_instance(handle1, mb) == DDS::RETCODE_OK);
+        const PublicationInstance_rch instance = test_data_container->get_handle_instance(handle1);
+        TEST_ASSERT(instance);
+
+        const CORBA::Long missed = deadline_status.total_count;
+        const MonotonicTimePoint filed = instance->deadline_key_;
+        TEST_ASSERT(filed != MonotonicTimePoint::zero_value);
+        TEST_ASSERT(test->deadline_entries(test_data_container) == 1);
+
+        // Writes only move the deadline of the instance.
+        ACE_OS::sleep(ACE_Time_Value(0, 10000));
+        test->extend_deadline(test_data_container, instance);
+        test->extend_deadline(test_data_container, instance);
+        TEST_ASSERT(test->deadline_entries(test_data_container) == 1);
+        TEST_ASSERT(instance->deadline_key_ == filed);
+        TEST_ASSERT(filed < instance->deadline_);
+
+        // When the entry comes due the instance was written to since, so it
+        // is filed again under its current deadline without missing it.
+        const MonotonicTimePoint written = instance->deadline_;
+        test->process_deadlines(test_data_container, filed + TimeDuration(0, 1));
+        TEST_ASSERT(deadline_status.total_count == missed);
+        TEST_ASSERT(test->deadline_entries(test_data_container) == 1);
+        TEST_ASSERT(instance->deadline_key_ == written);
+
+        // Without another write the deadline is missed once per period.
+        test->process_deadlines(test_data_container, written + TimeDuration(0, 1));
+        TEST_ASSERT(deadline_status.total_count == missed + 1);
+        TEST_ASSERT(deadline_status.last_instance_handle == handle1);
+        TEST_ASSERT(instance->deadline_key_ == written + period);
+        TEST_ASSERT(instance->deadline_ == written + period);
+        TEST_ASSERT(test->deadline_entries(test_data_container) == 1);
+
+        test->cancel_deadline(test_data_container, instance);
+        TEST_ASSERT(test->deadline_entries(test_data_container) == 0);
+        TEST_ASSERT(instance->deadline_key_ == MonotonicTimePoint::zero_value);
+
+        // The next write files it again.
+        test->extend_deadline(test_data_container, instance);
+        TEST_ASSERT(test->deadline_entries(test_data_container) == 1);
+        TEST_ASSERT(instance->deadline_key_ == instance->deadline_);
+
+        test->set_deadline_period(test_data_container, TimeDuration::max_value);
+        TEST_ASSERT(test->deadline_entries(test_data_container) == 0);
+        TEST_ASSERT(instance->deadline_key_ == MonotonicTimePoint::zero_value);
+
+        test_data_container->unregister_all();
+        delete test_data_container;
+      } //End Test Case 6 scope
+
     } catch (const TestException&) {
       ACE_ERROR((LM_ERROR, ACE_TEXT("(%P|%t) TestException caught in main.cpp.")));
       return 1;
@@ -0,0 +1,140 @@
+#include <dds/DCPS/GroupRakeData.h>
+
+#include <dds/DCPS/ReceivedDataElementList.h>
+
+#include <gtest/gtest.h>
+
+using namespace OpenDDS::DCPS;
+
+namespace {
+  // Stands in for the deserialized sample.
+  int value = 0;
+
+  DataSampleHeader header(ACE_INT32 sec, bool valid = true)
+  {
+    DataSampleHeader h;
+    h.message_id_ = valid ? SAMPLE_DATA : DISPOSE_INSTANCE;
+    h.source_timestamp_sec_ = sec;
+    h.source_timestamp_nanosec_ = 0;
+    return h;
+  }
+
+  void expect_next(GroupRakeData& data, ReceivedDataElement& sample, size_t index_in_instance)
+  {
+    RakeData rd = RakeData();
+    ASSERT_TRUE(data.get_data(rd));
+    EXPECT_EQ(&sample, rd.rde_);
+    EXPECT_EQ(index_in_instance, rd.index_in_instance_);
+  }
+
+  void expect_end(GroupRakeData& data)
+  {
+    RakeData rd = RakeData();
+    EXPECT_FALSE(data.get_data(rd));
+    EXPECT_EQ(0u, data.size());
+  }
+}
+
+TEST(dds_DCPS_GroupRakeData, merges_instances)
+{
+  ReceivedDataElement a1(header(1), &value, 0), a4(header(4), &value, 0), a5(header(5), &value, 0);
+  ReceivedDataElement b2(header(2), &value, 0), b3(header(3), &value, 0), b6(header(6), &value, 0);
+  ReceivedDataElement c5(header(5), &value, 0);
+  ReceivedDataElementList a((DataReaderImpl_rch())), b((DataReaderImpl_rch())), c((DataReaderImpl_rch()));
+  a.add(&a1);
+  a.add(&a4);
+  a.add(&a5);
+  b.add(&b2);
+  b.add(&b3);
+  b.add(&b6);
+  c.add(&c5);
+
+  GroupRakeData data;
+  data.insert_instance(&a, SubscriptionInstance_rch(), DDS::ANY_SAMPLE_STATE);
+  data.insert_instance(&b, SubscriptionInstance_rch(), DDS::ANY_SAMPLE_STATE);
+  data.insert_instance(&c, SubscriptionInstance_rch(), DDS::ANY_SAMPLE_STATE);
+  EXPECT_EQ(7u, data.size());
+
+  expect_next(data, a1, 1);
+  expect_next(data, b2, 1);
+  expect_next(data, b3, 2);
+  expect_next(data, a4, 2);
+  // Equal timestamps are read in the order they were inserted.
+  expect_next(data, a5, 3);
+  expect_next(data, c5, 1);
+  expect_next(data, b6, 3);
+  expect_end(data);
+}
+
+TEST(dds_DCPS_GroupRakeData, instance_out_of_order)
+{
+  // BY_RECEPTION_TIMESTAMP destination order can leave an instance's
+  // samples out of source timestamp order.
+  ReceivedDataElement s3(header(3), &value, 0), s1(header(1), &value, 0), s2(header(2), &value, 0);
+  ReceivedDataElementList list((DataReaderImpl_rch()));
+  list.add(&s3);
+  list.add(&s1);
+  list.add(&s2);
+
+  GroupRakeData data;
+  data.insert_instance(&list, SubscriptionInstance_rch(), DDS::ANY_SAMPLE_STATE);
+  EXPECT_EQ(3u, data.size());
+  expect_next(data, s1, 2);
+  expect_next(data, s2, 3);
+  expect_next(data, s3, 1);
+  expect_end(data);
+}
+
+TEST(dds_DCPS_GroupRakeData, skips_invalid_and_unmatched)
+{
+  ReceivedDataElement valid1(header(1), &value, 0), dispose(header(2, false), &value, 0);
+  ReceivedDataElement read(header(3), &value, 0), valid4(header(4), &value, 0);
+  read.sample_state_ = DDS::READ_SAMPLE_STATE;
+  ReceivedDataElementList list((DataReaderImpl_rch()));
+  list.add(&valid1);
+  list.add(&dispose);
+  list.add(&read);
+  list.add(&valid4);
+
+  GroupRakeData data;
+  data.insert_instance(&list, SubscriptionInstance_rch(), DDS::NOT_READ_SAMPLE_STATE);
+  EXPECT_EQ(2u, data.size());
+  expect_next(data, valid1, 1);
+  expect_next(data, valid4, 2);
+  expect_end(data);
+}
+
+TEST(dds_DCPS_GroupRakeData, snapshot)
+{
+  ReceivedDataElement s1(header(1), &value, 0), s2(header(2), &value, 0), s3(header(3), &value, 0);
+  ReceivedDataElementList list((DataReaderImpl_rch()));
+  list.add(&s1);
+  list.add(&s2);
+  list.add(&s3);
+
+  GroupRakeData data;
+  data.insert_instance(&list, SubscriptionInstance_rch(), DDS::ANY_SAMPLE_STATE);
+
+  // Taking a sample removes it from the instance, and samples that arrive
+  // during the access aren't part of it.
+  expect_next(data, s1, 1);
+  list.remove(&s1);
+  ReceivedDataElement s0(header(0), &value, 0), s4(header(4), &value, 0);
+  list.add_by_timestamp(&s0);
+  list.add(&s4);
+  EXPECT_EQ(2u, data.size());
+  expect_next(data, s2, 2);
+  list.remove(&s2);
+  expect_next(data, s3, 3);
+  expect_end(data);
+
+  // reset() forgets the samples, the next insert starts over.
+  data.reset();
+  expect_end(data);
+  data.insert_instance(&list, SubscriptionInstance_rch(), DDS::ANY_SAMPLE_STATE);
+  EXPECT_EQ(3u, data.size());
+  expect_next(data, s0, 1);
+  expect_next(data, s3, 2);
+  expect_next(data, s4, 3);
+  expect_end(data);
+}
@@ -0,0 +1,36 @@
+#include <dds/DCPS/InstanceState.h>
+
+#include <gtest/gtest.h>
+
+using OpenDDS::DCPS::InstanceState;
+
+TEST(dds_DCPS_InstanceState, owner_word_without_owner)
+{
+  EXPECT_EQ(0u, InstanceState::make_owner_word(DDS::HANDLE_NIL, 0));
+  EXPECT_EQ(0u, InstanceState::make_owner_word(DDS::HANDLE_NIL, 10));
+}
+
+TEST(dds_DCPS_InstanceState, owner_word_handle)
+{
+  const DDS::InstanceHandle_t handles[] = { 1, 2, 0x1234, 0x7fffffff };
+  const CORBA::Long strengths[] = { 0, 1, -1, 0x7fffffff, -0x7fffffff - 1 };
+  for (size_t h = 0; h < sizeof handles / sizeof handles[0]; ++h) {
+    for (size_t s = 0; s < sizeof strengths / sizeof strengths[0]; ++s) {
+      const ACE_UINT64 word = InstanceState::make_owner_word(handles[h], strengths[s]);
+      EXPECT_NE(0u, word);
+      EXPECT_EQ(handles[h], InstanceState::owner_word_handle(word));
+    }
+  }
+}
+
+TEST(dds_DCPS_InstanceState, owner_word_strength)
+{
+  // A change of strength alone has to change the word, so that the owner's
+  // samples after a change go through the ownership manager.
+  const ACE_UINT64 word = InstanceState::make_owner_word(5, 10);
+  EXPECT_EQ(word, InstanceState::make_owner_word(5, 10));
+  EXPECT_NE(word, InstanceState::make_owner_word(5, 11));
+  EXPECT_NE(word, InstanceState::make_owner_word(5, -10));
+  EXPECT_NE(word, InstanceState::make_owner_word(6, 10));
+  EXPECT_NE(InstanceState::make_owner_word(5, -1), InstanceState::make_owner_word(5, 0));
+}
@@ -0,0 +1,184 @@
+#include <KeyHashTypeSupportImpl.h>
+#include <key_annotationTypeSupportImpl.h>
+
+#include <dds/DCPS/KeyHash.h>
+#ifndef OPENDDS_SAFETY_PROFILE
+#  include <dds/DCPS/XTypes/DynamicDataFactory.h>
+#  include <dds/DCPS/XTypes/DynamicTypeSupport.h>
+#  include <dds/DCPS/XTypes/TypeLookupService.h>
+#endif
+
+#include <gtest/gtest.h>
+
+#include <limits>
+
+using namespace OpenDDS::DCPS;
+
+namespace {
+  const CORBA::Float float_nan = std::numeric_limits<CORBA::Float>::quiet_NaN();
+  const CORBA::Double double_nan = std::numeric_limits<CORBA::Double>::quiet_NaN();
+  const CORBA::Double double_inf = std::numeric_limits<CORBA::Double>::infinity();
+
+  template <typename T>
+  bool same_keys(const T& a, const T& b)
+  {
+    typename DDSTraits<T>::LessThanType less;
+    return !less(a, b) && !less(b, a);
+  }
+
+  /// Samples that are the same instance must also hash the same.
+  template <typename T>
+  void expect_same_instance(const T& a, const T& b)
+  {
+    EXPECT_TRUE(same_keys(a, b));
+    EXPECT_EQ(DDSTraits<T>::key_hash(a), DDSTraits<T>::key_hash(b));
+  }
+
+  KeyHash::FloatKeys float_keys(CORBA::Float f, CORBA::Double d, CORBA::Long value = 0)
+  {
+    KeyHash::FloatKeys sample;
+    sample.f = f;
+    sample.d = d;
+    sample.value = value;
+    return sample;
+  }
+}
+
+TEST(dds_DCPS_KeyHash, non_keys_are_ignored)
+{
+  expect_same_instance(float_keys(1.5f, 2.5, 1), float_keys(1.5f, 2.5, 2));
+  EXPECT_FALSE(same_keys(float_keys(1.5f, 2.5), float_keys(1.5f, 3.5)));
+  EXPECT_NE(DDSTraits<KeyHash::FloatKeys>::key_hash(float_keys(1.5f, 2.5)),
+            DDSTraits<KeyHash::FloatKeys>::key_hash(float_keys(1.5f, 3.5)));
+}
+
+TEST(dds_DCPS_KeyHash, signed_zeros)
+{
+  expect_same_instance(float_keys(0.0f, 0.0), float_keys(-0.0f, -0.0));
+  expect_same_instance(float_keys(-0.0f, 1.0), float_keys(0.0f, 1.0));
+}
+
+TEST(dds_DCPS_KeyHash, nans)
+{
+  expect_same_instance(float_keys(float_nan, double_nan), float_keys(-float_nan, -double_nan));
+  expect_same_instance(float_keys(float_nan, 1.0),
+    float_keys(std::numeric_limits<CORBA::Float>::signaling_NaN(), 1.0));
+
+  // NaN is after all the numbers, so the ordering stays a strict weak
+  // ordering and later keys are still compared.
+  DDSTraits<KeyHash::FloatKeys>::LessThanType less;
+  EXPECT_TRUE(less(float_keys(1.0f, double_inf), float_keys(1.0f, double_nan)));
+  EXPECT_FALSE(less(float_keys(1.0f, double_nan), float_keys(1.0f, double_inf)));
+  EXPECT_TRUE(less(float_keys(float_nan, 1.0), float_keys(float_nan, 2.0)));
+  EXPECT_FALSE(less(float_keys(float_nan, 2.0), float_keys(float_nan, 1.0)));
+}
+
+TEST(dds_DCPS_KeyHash, helpers)
+{
+  EXPECT_EQ(key_hash_float(0, 0.0f), key_hash_float(0, -0.0));
+  EXPECT_EQ(key_hash_float(0, float_nan), key_hash_float(0, -double_nan));
+  EXPECT_NE(key_hash_float(0, 0.0), key_hash_float(0, double_nan));
+  EXPECT_FALSE(key_float_less(0.0, -0.0));
+  EXPECT_FALSE(key_float_less(-0.0, 0.0));
+  EXPECT_FALSE(key_float_less(double_nan, double_nan));
+  EXPECT_TRUE(key_float_less(double_inf, double_nan));
+
+  // The terminator keeps consecutive strings apart.
+  EXPECT_NE(key_hash_string(key_hash_string(0, "ab"), "c"),
+            key_hash_string(key_hash_string(0, "a"), "bc"));
+}
+
+TEST(dds_DCPS_KeyHash, strings)
+{
+  KeyHash::StringKeys a;
+  a.s = "key";
+  a.w = L"wide key";
+  a.value = 1;
+  KeyHash::StringKeys b;
+  b.s = CORBA::string_dup("key");
+  b.w = CORBA::wstring_dup(L"wide key");
+  b.value = 2;
+  expect_same_instance(a, b);
+
+  b.w = L"other key";
+  EXPECT_FALSE(same_keys(a, b));
+}
+
+TEST(dds_DCPS_KeyHash, implied_keys)
+{
+  using namespace key_annotation;
+  ImpliedKeys::StructB a = ImpliedKeys::StructB();
+  a.as_key.nested_no_keys.c = 0.0f;
+  a.as_key.nested_one_key.a = 4;
+  a.yet_another_key = 8;
+  ImpliedKeys::StructB b = a;
+  b.as_key.nested_no_keys.c = -0.0f;
+  b.as_key.nested_one_key.b = 5;
+  b.not_as_key.non_nested = 7;
+  expect_same_instance(a, b);
+
+  b.as_key.nested_no_keys.c = float_nan;
+  EXPECT_FALSE(same_keys(a, b));
+}
+
+TEST(dds_DCPS_KeyHash, unions)
+{
+  using namespace key_annotation;
+  KeyedUnionStruct a;
+  a.value.b('x');
+  a.unkeyed_unkeyed_union.a(1);
+  a.keyed_unkeyed_union.c(2.0f);
+  a.another_key = 3;
+  KeyedUnionStruct b = a;
+  b.value.b('y');
+  b.unkeyed_unkeyed_union.b('z');
+  b.keyed_unkeyed_union.c(-2.0f);
+  expect_same_instance(a, b);
+
+  KeyedUnion a_union;
+  a_union.a(1);
+  KeyedUnion b_union;
+  b_union.a(2);
+  expect_same_instance(a_union, b_union);
+}
+
+#ifndef OPENDDS_SAFETY_PROFILE
+TEST(dds_DCPS_KeyHash, dynamic_samples)
+{
+  using namespace OpenDDS::XTypes;
+  typedef DDSTraits<KeyHash::FloatKeys>::XtagType Xtag;
+  TypeLookupService_rch tls = make_rch<TypeLookupService>();
+  TypeIdentifierPairSeq tid_pairs;
+  TypeIdentifierPair tid_pair;
+  tid_pair.type_identifier1 = getCompleteTypeIdentifier<Xtag>();
+  tid_pair.type_identifier2 = getMinimalTypeIdentifier<Xtag>();
+  tid_pairs.append(tid_pair);
+  tls->update_type_identifier_map(tid_pairs);
+  KeyHash::FloatKeysTypeSupportImpl tsi;
+  tsi.add_types(tls);
+  const TypeMap& type_map = getCompleteTypeMap<Xtag>();
+  const TypeMap::const_iterator pos = type_map.find(getCompleteTypeIdentifier<Xtag>());
+  ASSERT_TRUE(pos != type_map.end());
+  DDS::DynamicType_var type = tls->complete_to_dynamic(pos->second.complete, GUID_UNKNOWN);
+
+  DDS::DynamicData_var a_data = DDS::DynamicDataFactory::get_instance()->create_data(type);
+  DDS::DynamicData_var b_data = DDS::DynamicDataFactory::get_instance()->create_data(type);
+  ASSERT_EQ(DDS::RETCODE_OK, a_data->set_float32_value(0, 0.0f));
+  ASSERT_EQ(DDS::RETCODE_OK, b_data->set_float32_value(0, -0.0f));
+  ASSERT_EQ(DDS::RETCODE_OK, a_data->set_float64_value(1, double_nan));
+  ASSERT_EQ(DDS::RETCODE_OK, b_data->set_float64_value(1, -double_nan));
+  ASSERT_EQ(DDS::RETCODE_OK, a_data->set_int32_value(2, 1));
+  ASSERT_EQ(DDS::RETCODE_OK, b_data->set_int32_value(2, 2));
+
+  const DynamicSample a(a_data);
+  const DynamicSample b(b_data);
+  DDSTraits<DynamicSample>::LessThanType less;
+  EXPECT_FALSE(less(a, b));
+  EXPECT_FALSE(less(b, a));
+  EXPECT_EQ(DDSTraits<DynamicSample>::key_hash(a), DDSTraits<DynamicSample>::key_hash(b));
+
+  ASSERT_EQ(DDS::RETCODE_OK, b_data->set_float64_value(1, double_inf));
+  EXPECT_TRUE(less(b, a));
+  EXPECT_FALSE(less(a, b));
+}
+#endif
@@ -0,0 +1,123 @@
+#include <dds/DCPS/LatencyHistogram.h>
+
+#include <gtest/gtest.h>
+
+using OpenDDS::DCPS::LatencyHistogram;
+using OpenDDS::DCPS::TimeDuration;
+
+namespace {
+  TimeDuration usec(ACE_UINT64 value)
+  {
+    return TimeDuration(static_cast<time_t>(value / 1000000), static_cast<suseconds_t>(value % 1000000));
+  }
+
+  /// Within the precision the histogram promises.
+  void expect_near(double expected, double actual)
+  {
+    EXPECT_NEAR(expected, actual, expected / LatencyHistogram::SUB_BUCKETS);
+  }
+}
+
+TEST(dds_DCPS_LatencyHistogram, buckets)
+{
+  for (ACE_UINT64 value = 0; value < LatencyHistogram::SUB_BUCKETS; ++value) {
+    EXPECT_EQ(value, LatencyHistogram::bucket_index(value));
+    EXPECT_EQ(value, LatencyHistogram::bucket_lower_bound(static_cast<unsigned int>(value)));
+  }
+
+  for (unsigned int index = 0; index < LatencyHistogram::BUCKET_COUNT; ++index) {
+    const ACE_UINT64 lower = LatencyHistogram::bucket_lower_bound(index);
+    EXPECT_EQ(index, LatencyHistogram::bucket_index(lower));
+    if (index + 1 < LatencyHistogram::BUCKET_COUNT) {
+      const ACE_UINT64 next = LatencyHistogram::bucket_lower_bound(index + 1);
+      EXPECT_LT(lower, next);
+      EXPECT_EQ(index, LatencyHistogram::bucket_index(next - 1));
+      EXPECT_LE(static_cast<double>(lower), LatencyHistogram::bucket_value(index));
+      EXPECT_GE(static_cast<double>(next - 1), LatencyHistogram::bucket_value(index));
+    }
+  }
+
+  // Values that are too large go in the last bucket.
+  EXPECT_EQ(LatencyHistogram::BUCKET_COUNT - 1,
+            LatencyHistogram::bucket_index(ACE_UINT64(1) << LatencyHistogram::MAX_EXPONENT));
+  EXPECT_EQ(LatencyHistogram::BUCKET_COUNT - 1, LatencyHistogram::bucket_index(ACE_UINT64(-1)));
+}
+
+TEST(dds_DCPS_LatencyHistogram, empty)
+{
+  LatencyHistogram histogram;
+  const LatencyHistogram::Summary summary = histogram.summarize();
+  EXPECT_EQ(0u, summary.n);
+  EXPECT_EQ(0, summary.minimum);
+  EXPECT_EQ(0, summary.maximum);
+  EXPECT_EQ(0, summary.mean);
+  EXPECT_EQ(0, summary.variance);
+  EXPECT_EQ(0, summary.p50);
+}
+
+TEST(dds_DCPS_LatencyHistogram, exact_extremes)
+{
+  LatencyHistogram histogram;
+  histogram.record(usec(1234567));
+  histogram.record(usec(1001));
+  histogram.record(usec(98765));
+
+  const LatencyHistogram::Summary summary = histogram.summarize();
+  EXPECT_EQ(3u, summary.n);
+  EXPECT_DOUBLE_EQ(0.001001, summary.minimum);
+  EXPECT_DOUBLE_EQ(1.234567, summary.maximum);
+  EXPECT_GE(summary.p999, summary.minimum);
+  EXPECT_LE(summary.p999, summary.maximum);
+}
+
+TEST(dds_DCPS_LatencyHistogram, negative_is_zero)
+{
+  LatencyHistogram histogram;
+  histogram.record(TimeDuration(-1));
+  const LatencyHistogram::Summary summary = histogram.summarize();
+  EXPECT_EQ(1u, summary.n);
+  EXPECT_EQ(0, summary.minimum);
+  EXPECT_EQ(0, summary.maximum);
+}
+
+TEST(dds_DCPS_LatencyHistogram, moments_and_percentiles)
+{
+  LatencyHistogram histogram;
+  const ACE_UINT64 count = 1000;
+  double sum = 0;
+  for (ACE_UINT64 i = 1; i <= count; ++i) {
+    histogram.record(usec(i * 100));
+    sum += i * 100;
+  }
+  const double mean = sum / count;
+  double squares = 0;
+  for (ACE_UINT64 i = 1; i <= count; ++i) {
+    squares += (i * 100 - mean) * (i * 100 - mean);
+  }
+
+  const LatencyHistogram::Summary summary = histogram.summarize();
+  EXPECT_EQ(count, summary.n);
+  EXPECT_DOUBLE_EQ(0.0001, summary.minimum);
+  EXPECT_DOUBLE_EQ(0.1, summary.maximum);
+  expect_near(mean / 1e6, summary.mean);
+  expect_near(squares / count / 1e12, summary.variance);
+  expect_near(0.05, summary.p50);
+  expect_near(0.099, summary.p99);
+  expect_near(0.0999, summary.p999);
+}
+
+TEST(dds_DCPS_LatencyHistogram, reset)
+{
+  LatencyHistogram histogram;
+  histogram.record(usec(5000));
+  histogram.reset();
+  EXPECT_EQ(0u, histogram.summarize().n);
+
+  // The extremes start over too.
+  histogram.record(usec(20));
+  const LatencyHistogram::Summary summary = histogram.summarize();
+  EXPECT_EQ(1u, summary.n);
+  EXPECT_DOUBLE_EQ(0.00002, summary.minimum);
+  EXPECT_DOUBLE_EQ(0.00002, summary.maximum);
+  EXPECT_DOUBLE_EQ(0.00002, summary.p50);
+}
@@ -0,0 +1,183 @@
+/*
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include <gtest/gtest.h>
+
+#include <dds/DCPS/PartitionIndex.h>
+#include <dds/DCPS/DCPS_Utils.h>
+
+using namespace OpenDDS::DCPS;
+
+namespace {
+  DDS::PartitionQosPolicy partition(const char* name1 = 0, const char* name2 = 0)
+  {
+    DDS::PartitionQosPolicy p;
+    if (name1) {
+      p.name.length(1);
+      p.name[0] = name1;
+    }
+    if (name2) {
+      p.name.length(2);
+      p.name[1] = name2;
+    }
+    return p;
+  }
+
+  GUID_t endpoint(unsigned char key)
+  {
+    GUID_t id = GUID_UNKNOWN;
+    id.entityId.entityKey[2] = key;
+    id.entityId.entityKind = ENTITYKIND_USER_WRITER_WITH_KEY;
+    return id;
+  }
+
+  typedef OPENDDS_VECTOR(DDS::PartitionQosPolicy) Partitions;
+
+  Partitions partitions()
+  {
+    Partitions p;
+    p.push_back(partition());
+    p.push_back(partition(""));
+    p.push_back(partition("A"));
+    p.push_back(partition("B"));
+    p.push_back(partition("A", "B"));
+    p.push_back(partition("AB"));
+    p.push_back(partition("", "C"));
+    p.push_back(partition("A*"));
+    p.push_back(partition("?"));
+    p.push_back(partition("[AB]"));
+    p.push_back(partition("*"));
+    p.push_back(partition("C", "B*"));
+    p.push_back(partition("A\\*"));
+    p.push_back(partition("A*", "A\\*"));
+    p.push_back(partition("\\?"));
+    return p;
+  }
+
+  /// Each endpoint is in the partition at the same index of partitions().
+  void insert_all(PartitionIndex& index)
+  {
+    const Partitions all = partitions();
+    for (size_t i = 0; i < all.size(); ++i) {
+      index.insert(endpoint(static_cast<unsigned char>(i)), all[i]);
+    }
+  }
+
+  /// The lookup returns every endpoint in a matching partition, whichever
+  /// side the partitions are on.
+  void expect_matching(const PartitionIndex& index, const DDS::PartitionQosPolicy& query)
+  {
+    RepoIdSet guids;
+    index.lookup(query, guids);
+    const Partitions all = partitions();
+    for (size_t i = 0; i < all.size(); ++i) {
+      if (matching_partitions(query, all[i]) || matching_partitions(all[i], query)) {
+        EXPECT_EQ(1u, guids.count(endpoint(static_cast<unsigned char>(i)))) << "endpoint " << i;
+      }
+    }
+  }
+
+  bool found(const PartitionIndex& index, const DDS::PartitionQosPolicy& query, unsigned char key)
+  {
+    RepoIdSet guids;
+    index.lookup(query, guids);
+    return guids.count(endpoint(key)) != 0;
+  }
+}
+
+TEST(dds_DCPS_PartitionIndex, lookup_matches)
+{
+  PartitionIndex index;
+  insert_all(index);
+
+  const Partitions all = partitions();
+  for (size_t i = 0; i < all.size(); ++i) {
+    SCOPED_TRACE(i);
+    expect_matching(index, all[i]);
+  }
+  expect_matching(index, partition("D"));
+  expect_matching(index, partition("D*"));
+}
+
+TEST(dds_DCPS_PartitionIndex, literal)
+{
+  PartitionIndex index;
+  insert_all(index);
+
+  EXPECT_TRUE(found(index, partition("A"), 2));
+  EXPECT_TRUE(found(index, partition("A"), 4));
+  EXPECT_FALSE(found(index, partition("A"), 3));
+  EXPECT_FALSE(found(index, partition("A"), 5));
+  EXPECT_FALSE(found(index, partition("A"), 0));
+  // Literal names are looked up together with every wildcard.
+  EXPECT_TRUE(found(index, partition("A"), 7));
+  EXPECT_TRUE(found(index, partition("D"), 10));
+}
+
+TEST(dds_DCPS_PartitionIndex, wildcard)
+{
+  PartitionIndex index;
+  insert_all(index);
+
+  EXPECT_TRUE(found(index, partition("A*"), 2));
+  EXPECT_TRUE(found(index, partition("A*"), 5));
+  EXPECT_FALSE(found(index, partition("A*"), 3));
+  EXPECT_TRUE(found(index, partition("[AB]"), 3));
+  EXPECT_FALSE(found(index, partition("[AB]"), 5));
+  EXPECT_TRUE(found(index, partition("*"), 0));
+  // Wildcards never match each other.
+  EXPECT_FALSE(found(index, partition("*"), 8));
+}
+
+TEST(dds_DCPS_PartitionIndex, escaped)
+{
+  PartitionIndex index;
+  insert_all(index);
+
+  // An escaped wildcard character is a literal name.
+  EXPECT_TRUE(found(index, partition("A\\*"), 12));
+  EXPECT_TRUE(found(index, partition("A\\*"), 13));
+  EXPECT_FALSE(found(index, partition("A\\*"), 2));
+  EXPECT_TRUE(found(index, partition("\\?"), 14));
+  EXPECT_FALSE(found(index, partition("\\?"), 2));
+}
+
+TEST(dds_DCPS_PartitionIndex, default_partition)
+{
+  PartitionIndex index;
+  insert_all(index);
+
+  // An empty partition QoS is the same as the default partition "".
+  EXPECT_TRUE(found(index, partition(), 0));
+  EXPECT_TRUE(found(index, partition(), 1));
+  EXPECT_TRUE(found(index, partition(), 6));
+  EXPECT_TRUE(found(index, partition(""), 0));
+  EXPECT_FALSE(found(index, partition(), 2));
+}
+
+TEST(dds_DCPS_PartitionIndex, insert_remove)
+{
+  PartitionIndex index;
+  EXPECT_TRUE(index.empty());
+
+  index.insert(endpoint(1), partition("A"));
+  index.insert(endpoint(2), partition("B*"));
+  EXPECT_FALSE(index.empty());
+  EXPECT_TRUE(found(index, partition("A"), 1));
+
+  // Inserting again replaces the partition.
+  index.insert(endpoint(1), partition("C"));
+  EXPECT_FALSE(found(index, partition("A"), 1));
+  EXPECT_TRUE(found(index, partition("C"), 1));
+  index.insert(endpoint(2), partition("D"));
+  EXPECT_FALSE(found(index, partition("A"), 2));
+
+  index.remove(endpoint(1));
+  index.remove(endpoint(2));
+  index.remove(endpoint(3));
+  EXPECT_TRUE(index.empty());
+  EXPECT_FALSE(found(index, partition("C"), 1));
+  EXPECT_FALSE(found(index, partition("*"), 2));
+}
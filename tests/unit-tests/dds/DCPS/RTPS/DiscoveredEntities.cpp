@@ -214,3 +214,36 @@ TEST(dds_DCPS_RTPS_DiscoveredEntities, DiscoveredPublication_ctor)
     EXPECT_STREQ(uut.get_type_name(), "a type");
   }
 }
+
+TEST(dds_DCPS_RTPS_DiscoveredEntities, SpdpDigest_matches)
+{
+  const char payload[] = "participant announcement";
+  SpdpDigest a;
+  a.valid_ = true;
+  MD5Hash(a.hash_, payload, sizeof payload);
+  a.user_tag_ = 1;
+  a.from_ = NetworkAddress(7410, "1.2.3.4");
+
+  SpdpDigest b = a;
+  EXPECT_TRUE(a.matches(b));
+
+  // Nothing has been recorded for a participant that wasn't processed yet.
+  EXPECT_FALSE(SpdpDigest().matches(a));
+  EXPECT_FALSE(a.matches(SpdpDigest()));
+  EXPECT_FALSE(SpdpDigest().matches(SpdpDigest()));
+  b.valid_ = false;
+  EXPECT_FALSE(a.matches(b));
+
+  b = a;
+  const char changed[] = "participant announcemenT";
+  MD5Hash(b.hash_, changed, sizeof changed);
+  EXPECT_FALSE(a.matches(b));
+
+  b = a;
+  b.user_tag_ = 2;
+  EXPECT_FALSE(a.matches(b));
+
+  b = a;
+  b.from_ = NetworkAddress(7410, "1.2.3.5");
+  EXPECT_FALSE(a.matches(b));
+}
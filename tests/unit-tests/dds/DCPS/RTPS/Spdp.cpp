@@ -0,0 +1,57 @@
+/*
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include <gtest/gtest.h>
+
+#include <dds/DCPS/RTPS/Spdp.h>
+
+using namespace OpenDDS::DCPS;
+using namespace OpenDDS::RTPS;
+
+namespace {
+  const TimeDuration resend_period(30);
+  const TimeDuration lease_duration(300);
+  const TimeDuration min_resend_delay = TimeDuration::from_msec(100);
+}
+
+TEST(dds_DCPS_RTPS_Spdp, resend_delay_defaults)
+{
+  // No jitter and no load threshold announce every resend period.
+  EXPECT_EQ(resend_period, Spdp::resend_delay(resend_period, lease_duration, min_resend_delay, 0, 0, 0, 0));
+  EXPECT_EQ(resend_period, Spdp::resend_delay(resend_period, lease_duration, min_resend_delay, 0, 1000, 0, 0.5));
+}
+
+TEST(dds_DCPS_RTPS_Spdp, resend_delay_jitter)
+{
+  // The delay is between 1 - jitter and 1 times the resend period.
+  EXPECT_EQ(resend_period, Spdp::resend_delay(resend_period, lease_duration, min_resend_delay, 0, 0, 0.5, 0));
+  EXPECT_EQ(TimeDuration(22, 500000), Spdp::resend_delay(resend_period, lease_duration, min_resend_delay, 0, 0, 0.5, 0.5));
+  EXPECT_EQ(TimeDuration(15), Spdp::resend_delay(resend_period, lease_duration, min_resend_delay, 0, 0, 1, 0.5));
+
+  // The jitter is limited to [0, 1] and the delay to the minimum resend delay.
+  EXPECT_EQ(resend_period, Spdp::resend_delay(resend_period, lease_duration, min_resend_delay, 0, 0, -1, 0.5));
+  EXPECT_EQ(TimeDuration(15), Spdp::resend_delay(resend_period, lease_duration, min_resend_delay, 0, 0, 2, 0.5));
+  EXPECT_EQ(min_resend_delay, Spdp::resend_delay(resend_period, lease_duration, min_resend_delay, 0, 0, 1, 0.999));
+}
+
+TEST(dds_DCPS_RTPS_Spdp, resend_delay_load_threshold)
+{
+  // Up to the threshold the period doesn't change.
+  EXPECT_EQ(resend_period, Spdp::resend_delay(resend_period, lease_duration, min_resend_delay, 10, 5, 0, 0));
+  EXPECT_EQ(resend_period, Spdp::resend_delay(resend_period, lease_duration, min_resend_delay, 10, 10, 0, 0));
+
+  // Above it the period grows with the number of participants...
+  EXPECT_EQ(TimeDuration(60), Spdp::resend_delay(resend_period, lease_duration, min_resend_delay, 10, 20, 0, 0));
+  EXPECT_EQ(TimeDuration(90), Spdp::resend_delay(resend_period, lease_duration, min_resend_delay, 10, 30, 0, 0));
+
+  // ...up to a third of the lease duration.
+  EXPECT_EQ(TimeDuration(100), Spdp::resend_delay(resend_period, lease_duration, min_resend_delay, 10, 1000, 0, 0));
+
+  // A lease duration shorter than three resend periods never shortens it.
+  EXPECT_EQ(resend_period, Spdp::resend_delay(resend_period, TimeDuration(60), min_resend_delay, 10, 1000, 0, 0));
+
+  // Jitter applies to the stretched period.
+  EXPECT_EQ(TimeDuration(45), Spdp::resend_delay(resend_period, lease_duration, min_resend_delay, 10, 30, 1, 0.5));
+}
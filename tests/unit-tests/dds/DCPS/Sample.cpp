@@ -0,0 +1,125 @@
+#include <key_annotationTypeSupportImpl.h>
+
+#include <dds/DCPS/Sample.h>
+
+#include <gtest/gtest.h>
+
+using namespace OpenDDS::DCPS;
+using namespace key_annotation;
+
+namespace {
+  template <typename T>
+  bool same_keys(const T& a, const T& b)
+  {
+    typename DDSTraits<T>::LessThanType less;
+    return !less(a, b) && !less(b, a);
+  }
+}
+
+TEST(dds_DCPS_Sample, copy_keys_simple)
+{
+  SimpleKeyStruct src;
+  src.key = 5;
+  src.value = 7;
+  SimpleKeyStruct dest = SimpleKeyStruct();
+  DDSTraits<SimpleKeyStruct>::copy_keys(dest, src);
+  EXPECT_EQ(dest.key, 5);
+  EXPECT_EQ(dest.value, 0);
+}
+
+TEST(dds_DCPS_Sample, copy_keys_nested_and_implied)
+{
+  ImpliedKeys::StructB src = ImpliedKeys::StructB();
+  src.as_key.nested_no_keys.a = 1;
+  src.as_key.nested_no_keys.b = 2;
+  src.as_key.nested_no_keys.c = 3.0f;
+  src.as_key.nested_one_key.a = 4;
+  src.as_key.nested_one_key.b = 5;
+  src.as_key.non_nested = 6;
+  src.not_as_key.non_nested = 7;
+  src.yet_another_key = 8;
+
+  ImpliedKeys::StructB dest = ImpliedKeys::StructB();
+  DDSTraits<ImpliedKeys::StructB>::copy_keys(dest, src);
+  EXPECT_EQ(dest.as_key.nested_no_keys.a, 1);
+  EXPECT_EQ(dest.as_key.nested_no_keys.b, 2);
+  EXPECT_EQ(dest.as_key.nested_no_keys.c, 3.0f);
+  EXPECT_EQ(dest.as_key.nested_one_key.a, 4);
+  EXPECT_EQ(dest.as_key.nested_one_key.b, 0);
+  EXPECT_EQ(dest.as_key.non_nested, 6);
+  EXPECT_EQ(dest.not_as_key.non_nested, 0);
+  EXPECT_EQ(dest.yet_another_key, 8);
+  EXPECT_TRUE(same_keys(dest, src));
+}
+
+TEST(dds_DCPS_Sample, copy_keys_arrays)
+{
+  SimpleKeyArray src;
+  src.values[0].key = 1;
+  src.values[0].value = 2;
+  src.values[1].key = 3;
+  src.values[1].value = 4;
+  SimpleKeyArray dest = SimpleKeyArray();
+  DDSTraits<SimpleKeyArray>::copy_keys(dest, src);
+  EXPECT_EQ(dest.values[0].key, 1);
+  EXPECT_EQ(dest.values[0].value, 0);
+  EXPECT_EQ(dest.values[1].key, 3);
+  EXPECT_EQ(dest.values[1].value, 0);
+
+  MultidimensionalArrayStruct src_md = MultidimensionalArrayStruct();
+  src_md.array1[1][2] = 12;
+  src_md.array2[1][2][3] = 123;
+  MultidimensionalArrayStruct dest_md = MultidimensionalArrayStruct();
+  DDSTraits<MultidimensionalArrayStruct>::copy_keys(dest_md, src_md);
+  EXPECT_EQ(dest_md.array1[1][2], 12);
+  EXPECT_EQ(dest_md.array2[1][2][3], 123);
+  EXPECT_TRUE(same_keys(dest_md, src_md));
+}
+
+TEST(dds_DCPS_Sample, copy_keys_unions)
+{
+  KeyedUnionStruct src;
+  src.value.b('x');
+  src.unkeyed_unkeyed_union.a(1);
+  src.keyed_unkeyed_union.c(2.0f);
+  src.another_key = 3;
+  KeyedUnionStruct dest;
+  dest.unkeyed_unkeyed_union.a(0);
+  DDSTraits<KeyedUnionStruct>::copy_keys(dest, src);
+  EXPECT_EQ(dest.value._d(), 5);
+  EXPECT_EQ(dest.value.b(), 'x');
+  EXPECT_EQ(dest.unkeyed_unkeyed_union.a(), 0);
+  EXPECT_EQ(dest.keyed_unkeyed_union.c(), 2.0f);
+  EXPECT_EQ(dest.another_key, 3);
+  EXPECT_TRUE(same_keys(dest, src));
+
+  KeyedUnion src_union;
+  src_union.a(4);
+  KeyedUnion dest_union;
+  DDSTraits<KeyedUnion>::copy_keys(dest_union, src_union);
+  EXPECT_EQ(dest_union._d(), 0);
+  EXPECT_EQ(dest_union.a(), 4);
+}
+
+TEST(dds_DCPS_Sample, key_only_copy)
+{
+  NestedKeyStruct data;
+  data.non_nested_key = 1;
+  data.nested_key.key = 2;
+  data.nested_key.value = 3;
+  const Sample_T<NestedKeyStruct> sample(data, Sample::KeyOnly);
+
+  const Sample_rch copy = sample.copy(Sample::ReadOnly);
+  EXPECT_TRUE(copy->key_only());
+  EXPECT_TRUE(copy->read_only());
+  EXPECT_FALSE(sample.compare(*copy));
+  EXPECT_FALSE(copy->compare(sample));
+  const NestedKeyStruct* const copied = static_cast<const NestedKeyStruct*>(copy->native_data());
+  EXPECT_EQ(copied->non_nested_key, 1);
+  EXPECT_EQ(copied->nested_key.key, 2);
+
+  const Sample_rch full = sample.copy(Sample::Mutable, Sample::Full);
+  EXPECT_FALSE(full->key_only());
+  const NestedKeyStruct* const full_copied = static_cast<const NestedKeyStruct*>(full->native_data());
+  EXPECT_EQ(full_copied->nested_key.value, 3);
+}
@@ -0,0 +1,182 @@
+#include <SerializedSizeHintTypeSupportImpl.h>
+
+#include <dds/DCPS/SerializedSizeHint.h>
+#include <dds/DCPS/Message_Block_Ptr.h>
+
+#include <gtest/gtest.h>
+
+using namespace OpenDDS::DCPS;
+
+namespace {
+  const Encoding encoding(Encoding::KIND_XCDR2);
+
+  /// Serializes a generated type like DataWriterImpl does and counts the
+  /// attempts.
+  template <typename T>
+  class TestSerializer {
+  public:
+    explicit TestSerializer(const T& sample)
+      : sample_(sample)
+      , attempts_(0)
+      , failures_(0)
+    {}
+
+    ACE_Message_Block* serialize(size_t buffer_size, bool) const
+    {
+      ++attempts_;
+      Message_Block_Ptr mb(new ACE_Message_Block(buffer_size));
+      Serializer ser(mb.get(), encoding);
+      return (ser << sample_) ? mb.release() : 0;
+    }
+
+    size_t exact_size() const
+    {
+      return serialized_size(encoding, sample_);
+    }
+
+    void serialize_failed() const
+    {
+      ++failures_;
+    }
+
+    int attempts() const { return attempts_; }
+    int failures() const { return failures_; }
+
+  private:
+    const T& sample_;
+    mutable int attempts_;
+    mutable int failures_;
+  };
+
+  SizeHint::Unbounded unbounded(CORBA::ULong values, const char* label = "")
+  {
+    SizeHint::Unbounded sample;
+    sample.id = 1;
+    sample.values.length(values);
+    for (CORBA::ULong i = 0; i < values; ++i) {
+      sample.values[i] = static_cast<CORBA::Long>(i);
+    }
+    sample.label = label;
+    return sample;
+  }
+
+  /// Serialize sample with the hint, check that the result is exactly what
+  /// serialized_size says it is, and return the number of attempts.
+  int serialize(SerializedSizeHint& hint, const SizeHint::Unbounded& sample)
+  {
+    const TestSerializer<SizeHint::Unbounded> serializer(sample);
+    Message_Block_Ptr mb(hint.serialize(serializer));
+    EXPECT_TRUE(mb.get());
+    if (mb) {
+      EXPECT_EQ(serialized_size(encoding, sample), mb->length());
+    }
+    EXPECT_EQ(0, serializer.failures());
+    return serializer.attempts();
+  }
+}
+
+TEST(dds_DCPS_SerializedSizeHint, first_sample_uses_exact_size)
+{
+  SerializedSizeHint hint;
+  EXPECT_EQ(0u, hint.buffer_size());
+  const SizeHint::Unbounded sample = unbounded(10);
+  EXPECT_EQ(1, serialize(hint, sample));
+  EXPECT_EQ(serialized_size(encoding, sample), hint.hint());
+  EXPECT_GE(hint.buffer_size(), serialized_size(encoding, sample));
+}
+
+TEST(dds_DCPS_SerializedSizeHint, overflow_grows_hint)
+{
+  SerializedSizeHint hint;
+  EXPECT_EQ(1, serialize(hint, unbounded(10)));
+
+  // The first try overflows the buffer, the second one has the exact size.
+  const SizeHint::Unbounded large = unbounded(1000);
+  EXPECT_EQ(2, serialize(hint, large));
+  EXPECT_GT(hint.hint(), serialized_size(encoding, large));
+  EXPECT_EQ(1, serialize(hint, large));
+  EXPECT_EQ(1, serialize(hint, unbounded(1100)));
+}
+
+TEST(dds_DCPS_SerializedSizeHint, fit_shrinks_slowly)
+{
+  SerializedSizeHint hint;
+  const SizeHint::Unbounded large = unbounded(1000);
+  EXPECT_EQ(1, serialize(hint, large));
+  EXPECT_EQ(1, serialize(hint, unbounded(10)));
+  EXPECT_LT(hint.hint(), serialized_size(encoding, large));
+  // An occasional small sample doesn't make the next large one overflow.
+  EXPECT_EQ(1, serialize(hint, large));
+}
+
+TEST(dds_DCPS_SerializedSizeHint, growing_samples_dont_always_retry)
+{
+  SerializedSizeHint hint;
+  CORBA::ULong values = 100;
+  int attempts = 0;
+  for (int i = 0; i < 50; ++i) {
+    attempts += serialize(hint, unbounded(values));
+    values += values / 10;
+  }
+  // Samples growing by 10% each time overflow at most every other time.
+  EXPECT_LE(attempts, 75);
+}
+
+TEST(dds_DCPS_SerializedSizeHint, failure_isnt_retried)
+{
+  SerializedSizeHint hint;
+  EXPECT_EQ(1, serialize(hint, unbounded(100)));
+  const size_t hint_before = hint.hint();
+
+  // The label is longer than its bound, so the sample fits in the buffer
+  // but can't be serialized.
+  const SizeHint::Unbounded sample = unbounded(10, "longer than eight");
+  const TestSerializer<SizeHint::Unbounded> serializer(sample);
+  Message_Block_Ptr mb(hint.serialize(serializer));
+  EXPECT_FALSE(mb.get());
+  EXPECT_EQ(1, serializer.attempts());
+  EXPECT_EQ(1, serializer.failures());
+  EXPECT_EQ(hint_before, hint.hint());
+}
+
+TEST(dds_DCPS_SerializedSizeHint, failure_without_hint)
+{
+  SerializedSizeHint hint;
+  const SizeHint::Unbounded sample = unbounded(10, "longer than eight");
+  const TestSerializer<SizeHint::Unbounded> serializer(sample);
+  Message_Block_Ptr mb(hint.serialize(serializer));
+  EXPECT_FALSE(mb.get());
+  // The only attempt used the exact size and reports its own error.
+  EXPECT_EQ(1, serializer.attempts());
+  EXPECT_EQ(0, serializer.failures());
+}
+
+TEST(dds_DCPS_SerializedSizeHint, bounded_types_have_a_bound)
+{
+  // DataWriterImpl only uses the hint for types without a bound.
+  EXPECT_FALSE(MarshalTraits<SizeHint::Unbounded>::serialized_size_bound(encoding));
+  const SerializedSizeBound bound = MarshalTraits<SizeHint::Bounded>::serialized_size_bound(encoding);
+  ASSERT_TRUE(bound);
+
+  SizeHint::Bounded sample;
+  sample.id = 1;
+  sample.values.length(64);
+  for (CORBA::ULong i = 0; i < sample.values.length(); ++i) {
+    sample.values[i] = static_cast<CORBA::Long>(i);
+  }
+  EXPECT_LE(serialized_size(encoding, sample), bound.get());
+
+  // A buffer of the bound always fits the largest sample.
+  const TestSerializer<SizeHint::Bounded> serializer(sample);
+  Message_Block_Ptr mb(serializer.serialize(bound.get(), true));
+  ASSERT_TRUE(mb.get());
+  EXPECT_EQ(serialized_size(encoding, sample), mb->length());
+}
+
+TEST(dds_DCPS_SerializedSizeHint, grow_never_shrinks)
+{
+  SerializedSizeHint hint;
+  hint.grow(1000);
+  hint.grow(10);
+  EXPECT_EQ(1000u, hint.hint());
+}
@@ -645,3 +645,109 @@ TEST(dds_DCPS_Serializer, read_parameter_id_xcdr2)
   EXPECT_FALSE(must_understand);
   ASSERT_TRUE(ser.skip(size));
 }
+
+TEST(dds_DCPS_Serializer, begin_end_delimiter)
+{
+  const Encoding enc(Encoding::KIND_XCDR2, ENDIAN_BIG);
+  ACE_Message_Block mb(16);
+  Serializer ser(&mb, enc);
+  ASSERT_TRUE(ser << ACE_CDR::Octet(0xff));
+
+  Serializer::DelimiterMark mark;
+  ASSERT_TRUE(ser.begin_delimiter(mark));
+  ASSERT_TRUE(ser << ACE_CDR::Octet(0xaa));
+  ASSERT_TRUE(ser << ACE_CDR::ULong(0x01020304));
+  ASSERT_TRUE(ser.end_delimiter(mark));
+
+  const unsigned char expected[] = {
+    0xff, 0x0, 0x0, 0x0, // Octet and padding
+    0x0, 0x0, 0x0, 0x8, // DHEADER
+    0xaa, 0x0, 0x0, 0x0, // Octet and padding
+    0x01, 0x02, 0x03, 0x04,
+  };
+  ASSERT_EQ(sizeof(expected), mb.length());
+  EXPECT_EQ(0, std::memcmp(expected, mb.rd_ptr(), sizeof(expected)));
+}
+
+TEST(dds_DCPS_Serializer, begin_delimiter_not_contiguous)
+{
+  const Encoding enc(Encoding::KIND_XCDR2, ENDIAN_LITTLE);
+  Message_Block_Ptr amb(new ACE_Message_Block(6));
+  amb->cont(new ACE_Message_Block(8));
+  Serializer ser(amb.get(), enc);
+  ASSERT_TRUE(ser << ACE_CDR::ULong(1));
+
+  // Only 2 bytes are left in the first block
+  Serializer::DelimiterMark mark;
+  EXPECT_FALSE(ser.begin_delimiter(mark));
+  EXPECT_TRUE(ser.end_delimiter(mark));
+  EXPECT_EQ(4u, ser.wpos());
+}
+
+TEST(dds_DCPS_Serializer, begin_delimiter_xcdr1)
+{
+  const Encoding enc(Encoding::KIND_XCDR1);
+  ACE_Message_Block mb(8);
+  Serializer ser(&mb, enc);
+  Serializer::DelimiterMark mark;
+  EXPECT_FALSE(ser.begin_delimiter(mark));
+  EXPECT_EQ(0u, mb.length());
+}
+
+TEST(dds_DCPS_Serializer, begin_end_parameter)
+{
+  const Encoding enc(Encoding::KIND_XCDR2, ENDIAN_BIG);
+  ACE_Message_Block mb(32);
+  Serializer ser(&mb, enc);
+
+  Serializer::ParameterMark mark;
+  ASSERT_TRUE(ser.begin_parameter(mark, 5));
+  ASSERT_TRUE(ser << ACE_CDR::ULong(1));
+  ASSERT_TRUE(ser << ACE_CDR::ULong(2));
+  ASSERT_TRUE(ser << ACE_CDR::ULong(3));
+  ASSERT_TRUE(ser.end_parameter(mark));
+
+  ACE_Message_Block expected_mb(32);
+  Serializer expected_ser(&expected_mb, enc);
+  ASSERT_TRUE(expected_ser.write_parameter_id(5, 12));
+  ASSERT_TRUE(expected_ser << ACE_CDR::ULong(1));
+  ASSERT_TRUE(expected_ser << ACE_CDR::ULong(2));
+  ASSERT_TRUE(expected_ser << ACE_CDR::ULong(3));
+
+  ASSERT_EQ(expected_mb.length(), mb.length());
+  EXPECT_EQ(0, std::memcmp(expected_mb.rd_ptr(), mb.rd_ptr(), mb.length()));
+}
+
+TEST(dds_DCPS_Serializer, begin_end_parameter_length_code)
+{
+  const Encoding enc(Encoding::KIND_XCDR2, ENDIAN_LITTLE);
+  ACE_Message_Block mb(32);
+  Serializer ser(&mb, enc);
+
+  Serializer::ParameterMark mark;
+  ASSERT_TRUE(ser.begin_parameter(mark, 7, true));
+  ASSERT_TRUE(ser << ACE_CDR::ULong(0x01020304));
+  ASSERT_TRUE(ser.end_parameter(mark));
+  EXPECT_EQ(8u, ser.wpos());
+  ASSERT_TRUE(ser << ACE_CDR::Octet(0xff));
+
+  // The reserved NEXTINT is removed since the member has a length code
+  const unsigned char expected[] = {
+    0x07, 0x0, 0x0, 0xa0, // EMHEADER: M flag, LC 2, id 7
+    0x04, 0x03, 0x02, 0x01,
+    0xff
+  };
+  ASSERT_EQ(sizeof(expected), mb.length());
+  EXPECT_EQ(0, std::memcmp(expected, mb.rd_ptr(), sizeof(expected)));
+}
+
+TEST(dds_DCPS_Serializer, begin_parameter_no_space)
+{
+  const Encoding enc(Encoding::KIND_XCDR2);
+  ACE_Message_Block mb(12);
+  Serializer ser(&mb, enc);
+  Serializer::ParameterMark mark;
+  EXPECT_FALSE(ser.begin_parameter(mark, 1));
+  EXPECT_TRUE(ser.end_parameter(mark));
+  EXPECT_EQ(0u, mb.length());
+}
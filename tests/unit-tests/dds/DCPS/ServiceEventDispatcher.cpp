@@ -87,6 +87,23 @@ struct RecursiveTestEventTwo : public TestEventBase {
   OpenDDS::DCPS::Atomic<size_t> dispatch_scale_;
 };
 
+struct OnThreadTestEvent : public TestEventBase {
+  OnThreadTestEvent(OpenDDS::DCPS::RcHandle<OpenDDS::DCPS::ServiceEventDispatcher> dispatcher)
+    : dispatcher_(dispatcher)
+    , on_thread_(false)
+  {}
+
+  void handle_event()
+  {
+    OpenDDS::DCPS::RcHandle<OpenDDS::DCPS::ServiceEventDispatcher> dispatcher = dispatcher_.lock();
+    on_thread_ = dispatcher && dispatcher->on_thread();
+    increment_call_count();
+  }
+
+  OpenDDS::DCPS::WeakRcHandle<OpenDDS::DCPS::ServiceEventDispatcher> dispatcher_;
+  OpenDDS::DCPS::Atomic<bool> on_thread_;
+};
+
 } // (anonymous) namespace
 
 TEST(dds_DCPS_ServiceEventDispatcher, DefaultConstructor)
@@ -252,6 +269,20 @@ TEST(dds_DCPS_ServiceEventDispatcher, TestShutdown)
   EXPECT_EQ(test_event->call_count(), 1u);
 }
 
+TEST(dds_DCPS_ServiceEventDispatcher, OnThread)
+{
+  OpenDDS::DCPS::RcHandle<OpenDDS::DCPS::ServiceEventDispatcher> dispatcher = OpenDDS::DCPS::make_rch<OpenDDS::DCPS::ServiceEventDispatcher>(2);
+  OpenDDS::DCPS::RcHandle<OnThreadTestEvent> test_event = OpenDDS::DCPS::make_rch<OnThreadTestEvent>(dispatcher);
+
+  EXPECT_FALSE(dispatcher->on_thread());
+  dispatcher->dispatch(test_event);
+  test_event->wait(1u);
+  EXPECT_TRUE(test_event->on_thread_);
+
+  dispatcher->shutdown();
+  EXPECT_FALSE(dispatcher->on_thread());
+}
+
 TEST(dds_DCPS_ServiceEventDispatcher, TimedDispatch)
 {
   OpenDDS::DCPS::RcHandle<SimpleTestEvent> test_event = OpenDDS::DCPS::make_rch<SimpleTestEvent>();
@@ -0,0 +1,128 @@
+#include <dds/DCPS/SpillLog.h>
+
+#include <dds/DCPS/Message_Block_Ptr.h>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+using namespace OpenDDS::DCPS;
+
+namespace {
+  /// A two block chain so that append() has to gather it.
+  ACE_Message_Block* make_payload(char fill, size_t length)
+  {
+    const size_t first = length / 2;
+    ACE_Message_Block* const head = new ACE_Message_Block(first);
+    std::memset(head->wr_ptr(), fill, first);
+    head->wr_ptr(first);
+    ACE_Message_Block* const tail = new ACE_Message_Block(length - first);
+    std::memset(tail->wr_ptr(), fill + 1, length - first);
+    tail->wr_ptr(length - first);
+    head->cont(tail);
+    return head;
+  }
+
+  void expect_payload(SpillLog& log, const SpillLog::Record& record, char fill, size_t length)
+  {
+    Message_Block_Ptr read(log.read(record));
+    ASSERT_TRUE(read);
+    ASSERT_EQ(length, read->total_length());
+    const size_t first = length / 2;
+    for (size_t i = 0; i < length; ++i) {
+      EXPECT_EQ(i < first ? fill : fill + 1, read->rd_ptr()[i]);
+    }
+  }
+}
+
+TEST(dds_DCPS_SpillLog, append_read_release)
+{
+  SpillLog log("");
+  EXPECT_EQ(0u, log.live_records());
+
+  SpillLog::Record a, b;
+  Message_Block_Ptr payload_a(make_payload('a', 100));
+  Message_Block_Ptr payload_b(make_payload('m', 51));
+  ASSERT_TRUE(log.append(*payload_a, a));
+  ASSERT_TRUE(log.append(*payload_b, b));
+  EXPECT_EQ(2u, log.live_records());
+  EXPECT_EQ(0, a.offset_);
+  EXPECT_EQ(100u, a.length_);
+  EXPECT_EQ(100, b.offset_);
+  EXPECT_EQ(151, log.file_size());
+
+  // Records can be read back in any order, more than once.
+  expect_payload(log, b, 'm', 51);
+  expect_payload(log, a, 'a', 100);
+  expect_payload(log, a, 'a', 100);
+
+  log.release(a);
+  EXPECT_EQ(1u, log.live_records());
+  expect_payload(log, b, 'm', 51);
+
+  // The file is emptied once nothing refers to it.
+  log.release(b);
+  EXPECT_EQ(0u, log.live_records());
+  EXPECT_EQ(0, log.file_size());
+}
+
+TEST(dds_DCPS_SpillLog, reuses_released_regions)
+{
+  SpillLog log("");
+  SpillLog::Record records[4];
+  for (int i = 0; i < 4; ++i) {
+    Message_Block_Ptr payload(make_payload(static_cast<char>('a' + 2 * i), 64));
+    ASSERT_TRUE(log.append(*payload, records[i]));
+  }
+  EXPECT_EQ(256, log.file_size());
+
+  // Released neighbors are merged, so a record that doesn't fit in either
+  // region on its own fits in both.
+  log.release(records[0]);
+  log.release(records[1]);
+  SpillLog::Record reused;
+  Message_Block_Ptr large(make_payload('x', 100));
+  ASSERT_TRUE(log.append(*large, reused));
+  EXPECT_EQ(0, reused.offset_);
+  EXPECT_EQ(256, log.file_size());
+
+  // The rest of the merged region is used next.
+  SpillLog::Record rest;
+  Message_Block_Ptr small(make_payload('y', 28));
+  ASSERT_TRUE(log.append(*small, rest));
+  EXPECT_EQ(100, rest.offset_);
+  EXPECT_EQ(256, log.file_size());
+
+  expect_payload(log, reused, 'x', 100);
+  expect_payload(log, rest, 'y', 28);
+  expect_payload(log, records[2], 'e', 64);
+  expect_payload(log, records[3], 'g', 64);
+}
+
+TEST(dds_DCPS_SpillLog, truncates_unused_end)
+{
+  SpillLog log("");
+  const size_t length = static_cast<size_t>(SpillLog::TRUNCATE_SIZE / 2);
+  SpillLog::Record first, middle, last;
+  Message_Block_Ptr payload(make_payload('a', length));
+  ASSERT_TRUE(log.append(*payload, first));
+  ASSERT_TRUE(log.append(*payload, middle));
+  ASSERT_TRUE(log.append(*payload, last));
+  const ACE_OFF_T full = log.file_size();
+  EXPECT_EQ(static_cast<ACE_OFF_T>(3 * length), full);
+
+  // Less than TRUNCATE_SIZE at the end is free.
+  log.release(last);
+  EXPECT_EQ(full, log.file_size());
+
+  // Now the free region at the end is large enough to give back.
+  log.release(middle);
+  EXPECT_EQ(static_cast<ACE_OFF_T>(length), log.file_size());
+  expect_payload(log, first, 'a', length);
+
+  // Appending again grows the file from the new end.
+  SpillLog::Record again;
+  ASSERT_TRUE(log.append(*payload, again));
+  EXPECT_EQ(static_cast<ACE_OFF_T>(length), again.offset_);
+  expect_payload(log, again, 'a', length);
+}
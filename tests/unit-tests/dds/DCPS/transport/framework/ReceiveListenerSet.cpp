@@ -0,0 +1,122 @@
+/*
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include <gtest/gtest.h>
+
+#include "dds/DCPS/transport/framework/ReceiveListenerSet.h"
+#include "dds/DCPS/transport/framework/ReceivedDataSample.h"
+#include "dds/DCPS/transport/framework/TransportReceiveListener.h"
+
+using namespace OpenDDS::DCPS;
+
+namespace {
+  class Listener : public TransportReceiveListener {
+  public:
+    explicit Listener(bool drop)
+      : drop_(drop)
+      , drop_calls_(0)
+      , received_(0)
+    {}
+
+    bool drop_received(const ReceivedDataSample&)
+    {
+      ++drop_calls_;
+      return drop_;
+    }
+
+    void data_received(const ReceivedDataSample&)
+    {
+      ++received_;
+    }
+
+    void notify_subscription_disconnected(const WriterIdSeq&) {}
+    void notify_subscription_reconnected(const WriterIdSeq&) {}
+    void notify_subscription_lost(const WriterIdSeq&) {}
+    void remove_associations(const WriterIdSeq&, bool) {}
+
+    const bool drop_;
+    int drop_calls_;
+    int received_;
+  };
+
+  GUID_t reader_id(unsigned char key)
+  {
+    GUID_t id = GUID_UNKNOWN;
+    id.entityId.entityKey[2] = key;
+    id.entityId.entityKind = ENTITYKIND_USER_READER_WITH_KEY;
+    return id;
+  }
+
+  void insert(ReceiveListenerSet& set, unsigned char key, const RcHandle<Listener>& listener)
+  {
+    set.insert(reader_id(key), static_rchandle_cast<TransportReceiveListener>(listener));
+  }
+
+  ReceivedDataSample make_sample()
+  {
+    static char buffer[8] = {};
+    ACE_Message_Block mb(buffer, sizeof buffer);
+    mb.wr_ptr(sizeof buffer);
+    return ReceivedDataSample(mb);
+  }
+}
+
+TEST(dds_DCPS_transport_framework_ReceiveListenerSet, drop_received_excluded)
+{
+  const RcHandle<Listener> keep1 = make_rch<Listener>(false);
+  const RcHandle<Listener> drop = make_rch<Listener>(true);
+  const RcHandle<Listener> keep2 = make_rch<Listener>(false);
+  ReceiveListenerSet set;
+  insert(set, 1, keep1);
+  insert(set, 2, drop);
+  insert(set, 3, keep2);
+
+  const ReceivedDataSample sample = make_sample();
+  EXPECT_EQ(1u, set.data_received(sample, RepoIdSet(), ReceiveListenerSet::SET_EXCLUDED));
+  EXPECT_EQ(1, keep1->drop_calls_);
+  EXPECT_EQ(1, keep1->received_);
+  EXPECT_EQ(1, drop->drop_calls_);
+  EXPECT_EQ(0, drop->received_);
+  EXPECT_EQ(1, keep2->drop_calls_);
+  EXPECT_EQ(1, keep2->received_);
+}
+
+TEST(dds_DCPS_transport_framework_ReceiveListenerSet, drop_received_included)
+{
+  const RcHandle<Listener> drop1 = make_rch<Listener>(true);
+  const RcHandle<Listener> drop2 = make_rch<Listener>(true);
+  const RcHandle<Listener> other = make_rch<Listener>(false);
+  ReceiveListenerSet set;
+  insert(set, 1, drop1);
+  insert(set, 2, drop2);
+  insert(set, 3, other);
+
+  RepoIdSet included;
+  included.insert(reader_id(1));
+  included.insert(reader_id(2));
+  const ReceivedDataSample sample = make_sample();
+  EXPECT_EQ(2u, set.data_received(sample, included, ReceiveListenerSet::SET_INCLUDED));
+  EXPECT_EQ(0, drop1->received_);
+  EXPECT_EQ(0, drop2->received_);
+  EXPECT_EQ(0, other->drop_calls_);
+  EXPECT_EQ(0, other->received_);
+}
+
+TEST(dds_DCPS_transport_framework_ReceiveListenerSet, drop_received_reader)
+{
+  const RcHandle<Listener> keep = make_rch<Listener>(false);
+  const RcHandle<Listener> drop = make_rch<Listener>(true);
+  ReceiveListenerSet set;
+  insert(set, 1, keep);
+  insert(set, 2, drop);
+
+  const ReceivedDataSample sample = make_sample();
+  EXPECT_EQ(0u, set.data_received(sample, reader_id(1)));
+  EXPECT_EQ(1, keep->received_);
+  EXPECT_EQ(1u, set.data_received(sample, reader_id(2)));
+  EXPECT_EQ(1, drop->drop_calls_);
+  EXPECT_EQ(0, drop->received_);
+  EXPECT_EQ(0u, set.data_received(sample, reader_id(3)));
+}